@@ -0,0 +1,120 @@
+//
+// Benchmark of the coordinate transformations: one point at a time, as before
+// the batch functions existed, against the batch functions over arrays.
+//
+
+#include "geometry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace mavsdk::geometry;
+using std::chrono::steady_clock;
+
+static void usage(const std::string& bin_name)
+{
+    std::cerr << "Usage : " << bin_name << " [points]\n"
+              << '\n'
+              << "points: how many coordinates are transformed (default: 200000)\n";
+}
+
+static void print_result(const std::string& name, steady_clock::duration duration, std::size_t num)
+{
+    const auto ns =
+        static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+    std::cout << std::left << std::setw(32) << name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << ns / 1e6 << " ms" << std::setw(10)
+              << ns / static_cast<double>(num) << " ns/point\n";
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const std::size_t num_points =
+        (argc > 1) ? static_cast<std::size_t>(std::max(1, std::atoi(argv[1]))) : 200000;
+
+    // A survey grid of about 10 by 10 km.
+    const CoordinateTransformation::GlobalCoordinate reference{47.397742, 8.545594};
+    const auto side = static_cast<std::size_t>(std::ceil(std::sqrt(num_points)));
+
+    std::vector<CoordinateTransformation::GlobalCoordinate> globals;
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+    globals.reserve(num_points);
+    for (std::size_t i = 0; i < num_points; ++i) {
+        const double latitude = reference.latitude_deg + 0.09 * static_cast<double>(i / side) /
+                                                             static_cast<double>(side);
+        const double longitude = reference.longitude_deg + 0.13 * static_cast<double>(i % side) /
+                                                               static_cast<double>(side);
+        globals.push_back({latitude, longitude});
+        latitudes.push_back(latitude);
+        longitudes.push_back(longitude);
+    }
+
+    const CoordinateTransformation ct(reference);
+
+    auto start = steady_clock::now();
+    std::vector<CoordinateTransformation::LocalCoordinate> locals;
+    locals.reserve(num_points);
+    for (const auto& global : globals) {
+        locals.push_back(ct.local_from_global(global));
+    }
+    const auto single_local_duration = steady_clock::now() - start;
+
+    start = steady_clock::now();
+    std::vector<double> norths(num_points);
+    std::vector<double> easts(num_points);
+    ct.local_from_global(
+        latitudes.data(), longitudes.data(), norths.data(), easts.data(), num_points);
+    const auto batch_local_duration = steady_clock::now() - start;
+
+    start = steady_clock::now();
+    std::vector<CoordinateTransformation::GlobalCoordinate> globals_again;
+    globals_again.reserve(num_points);
+    for (const auto& local : locals) {
+        globals_again.push_back(ct.global_from_local(local));
+    }
+    const auto single_global_duration = steady_clock::now() - start;
+
+    start = steady_clock::now();
+    std::vector<double> latitudes_again(num_points);
+    std::vector<double> longitudes_again(num_points);
+    ct.global_from_local(
+        norths.data(), easts.data(), latitudes_again.data(), longitudes_again.data(), num_points);
+    const auto batch_global_duration = steady_clock::now() - start;
+
+    // Both paths need to agree, and the round trip needs to come back.
+    double max_difference_m = 0.0;
+    double max_round_trip_deg = 0.0;
+    for (std::size_t i = 0; i < num_points; ++i) {
+        max_difference_m = std::max(
+            {max_difference_m,
+             std::abs(norths[i] - locals[i].north_m),
+             std::abs(easts[i] - locals[i].east_m)});
+        max_round_trip_deg = std::max(
+            {max_round_trip_deg,
+             std::abs(latitudes_again[i] - latitudes[i]),
+             std::abs(longitudes_again[i] - longitudes[i]),
+             std::abs(globals_again[i].latitude_deg - latitudes[i])});
+    }
+
+    std::cout << num_points << " points\n\n";
+    print_result("local_from_global (single)", single_local_duration, num_points);
+    print_result("local_from_global (batch)", batch_local_duration, num_points);
+    print_result("global_from_local (single)", single_global_duration, num_points);
+    print_result("global_from_local (batch)", batch_global_duration, num_points);
+    std::cout << "\nmax difference single/batch: " << std::scientific << max_difference_m
+              << " m, max round trip error: " << max_round_trip_deg << " deg\n";
+
+    return 0;
+}
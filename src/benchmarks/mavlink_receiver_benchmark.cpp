@@ -0,0 +1,235 @@
+//
+// Benchmark of the receive path: parsing bytes into MAVLink messages and
+// dispatching them to the registered message handlers.
+//
+// A raw byte stream as it comes out of a serial port or UDP socket can be
+// replayed, otherwise a synthetic stream with typical telemetry is used.
+//
+
+#include "mavlink_include.h"
+#include "mavlink_message_handler.h"
+#include "mavlink_receiver.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace mavsdk;
+using std::chrono::steady_clock;
+
+static constexpr std::size_t max_messages_per_batch = 32;
+
+static void usage(const std::string& bin_name)
+{
+    std::cerr << "Usage : " << bin_name << " [recording] [iterations] [chunk size]\n"
+              << '\n'
+              << "recording:  raw MAVLink byte stream to replay (default: synthetic telemetry)\n"
+              << "iterations: how many times the stream is replayed (default: 100)\n"
+              << "chunk size: bytes handed to the parser at once, like one datagram or\n"
+              << "            serial read (default: 1024)\n";
+}
+
+static std::vector<char> synthetic_stream()
+{
+    std::vector<char> stream;
+    std::array<uint8_t, MAVLINK_MAX_PACKET_LEN> buffer{};
+
+    const auto append = [&](const mavlink_message_t& message) {
+        const auto len = mavlink_msg_to_send_buffer(buffer.data(), &message);
+        stream.insert(stream.end(), buffer.begin(), buffer.begin() + len);
+    };
+
+    for (uint32_t i = 0; i < 10000; ++i) {
+        mavlink_message_t message;
+
+        mavlink_attitude_t attitude{};
+        attitude.time_boot_ms = i;
+        attitude.roll = 0.1f;
+        mavlink_msg_attitude_encode(1, 1, &message, &attitude);
+        append(message);
+
+        mavlink_global_position_int_t global_position_int{};
+        global_position_int.time_boot_ms = i;
+        global_position_int.lat = 473977420;
+        global_position_int.lon = 85455940;
+        mavlink_msg_global_position_int_encode(1, 1, &message, &global_position_int);
+        append(message);
+
+        if (i % 5 == 0) {
+            mavlink_gps_raw_int_t gps_raw_int{};
+            gps_raw_int.time_usec = i;
+            gps_raw_int.fix_type = GPS_FIX_TYPE_3D_FIX;
+            mavlink_msg_gps_raw_int_encode(1, 1, &message, &gps_raw_int);
+            append(message);
+        }
+
+        if (i % 50 == 0) {
+            mavlink_heartbeat_t heartbeat{};
+            heartbeat.type = MAV_TYPE_QUADROTOR;
+            heartbeat.autopilot = MAV_AUTOPILOT_PX4;
+            mavlink_msg_heartbeat_encode(1, 1, &message, &heartbeat);
+            append(message);
+
+            mavlink_sys_status_t sys_status{};
+            sys_status.voltage_battery = 12000;
+            mavlink_msg_sys_status_encode(1, 1, &message, &sys_status);
+            append(message);
+        }
+    }
+
+    return stream;
+}
+
+static double ns_per_message(steady_clock::duration duration, uint64_t num_messages)
+{
+    if (num_messages == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(
+               std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) /
+           static_cast<double>(num_messages);
+}
+
+static void print_result(const std::string& name, steady_clock::duration duration, uint64_t num)
+{
+    std::cout << std::left << std::setw(40) << name << std::right << std::setw(10) << std::fixed
+              << std::setprecision(1) << ns_per_message(duration, num) << " ns/message\n";
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 4) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<char> stream;
+    if (argc > 1) {
+        std::ifstream file(argv[1], std::ios::binary);
+        if (!file) {
+            std::cerr << "Could not open " << argv[1] << '\n';
+            return 1;
+        }
+        stream.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    } else {
+        stream = synthetic_stream();
+    }
+
+    const unsigned iterations = (argc > 2) ? std::max(1, std::atoi(argv[2])) : 100;
+    const unsigned chunk_size = (argc > 3) ? std::max(1, std::atoi(argv[3])) : 1024;
+
+    std::cout << "Replaying " << stream.size() << " bytes " << iterations << " times in chunks of "
+              << chunk_size << " bytes\n";
+
+    // Parse stage, one message at a time.
+    std::vector<mavlink_message_t> messages;
+    uint64_t num_parsed_single = 0;
+    steady_clock::duration parse_single_duration{};
+    {
+        MAVLinkReceiver receiver(0);
+        const auto start = steady_clock::now();
+        for (unsigned iteration = 0; iteration < iterations; ++iteration) {
+            for (std::size_t offset = 0; offset < stream.size(); offset += chunk_size) {
+                const auto len = std::min<std::size_t>(chunk_size, stream.size() - offset);
+                receiver.set_new_datagram(&stream[offset], static_cast<unsigned>(len));
+                while (receiver.parse_message()) {
+                    ++num_parsed_single;
+                    if (iteration == 0) {
+                        messages.push_back(receiver.get_last_message());
+                    }
+                }
+            }
+        }
+        parse_single_duration = steady_clock::now() - start;
+    }
+
+    // Parse stage, in batches.
+    uint64_t num_parsed_batch = 0;
+    steady_clock::duration parse_batch_duration{};
+    {
+        MAVLinkReceiver receiver(1);
+        std::array<mavlink_message_t, max_messages_per_batch> batch{};
+        const auto start = steady_clock::now();
+        for (unsigned iteration = 0; iteration < iterations; ++iteration) {
+            for (std::size_t offset = 0; offset < stream.size(); offset += chunk_size) {
+                const auto len = std::min<std::size_t>(chunk_size, stream.size() - offset);
+                receiver.set_new_datagram(&stream[offset], static_cast<unsigned>(len));
+                std::size_t count;
+                while ((count = receiver.parse_messages(batch.data(), batch.size())) > 0) {
+                    num_parsed_batch += count;
+                }
+            }
+        }
+        parse_batch_duration = steady_clock::now() - start;
+    }
+
+    if (num_parsed_single != num_parsed_batch) {
+        std::cerr << "Parsed " << num_parsed_single << " messages one by one but "
+                  << num_parsed_batch << " in batches\n";
+        return 1;
+    }
+
+    // Dispatch stage, with handlers for the messages plugins typically subscribe to.
+    MavlinkMessageHandler message_handler;
+    uint64_t num_handled = 0;
+    const int cookie = 0;
+    for (const uint16_t message_id :
+         {MAVLINK_MSG_ID_HEARTBEAT,
+          MAVLINK_MSG_ID_SYS_STATUS,
+          MAVLINK_MSG_ID_ATTITUDE,
+          MAVLINK_MSG_ID_ATTITUDE_QUATERNION,
+          MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
+          MAVLINK_MSG_ID_GPS_RAW_INT,
+          MAVLINK_MSG_ID_LOCAL_POSITION_NED,
+          MAVLINK_MSG_ID_VFR_HUD,
+          MAVLINK_MSG_ID_EXTENDED_SYS_STATE,
+          MAVLINK_MSG_ID_COMMAND_ACK}) {
+        message_handler.register_one(
+            message_id, [&num_handled](const mavlink_message_t&) { ++num_handled; }, &cookie);
+    }
+
+    steady_clock::duration dispatch_single_duration{};
+    {
+        const auto start = steady_clock::now();
+        for (unsigned iteration = 0; iteration < iterations; ++iteration) {
+            for (const auto& message : messages) {
+                message_handler.process_message(message);
+            }
+        }
+        dispatch_single_duration = steady_clock::now() - start;
+    }
+
+    steady_clock::duration dispatch_batch_duration{};
+    {
+        const auto start = steady_clock::now();
+        for (unsigned iteration = 0; iteration < iterations; ++iteration) {
+            for (std::size_t offset = 0; offset < messages.size();
+                 offset += max_messages_per_batch) {
+                message_handler.process_messages(
+                    &messages[offset],
+                    std::min(max_messages_per_batch, messages.size() - offset));
+            }
+        }
+        dispatch_batch_duration = steady_clock::now() - start;
+    }
+
+    const uint64_t num_dispatched = static_cast<uint64_t>(messages.size()) * iterations;
+
+    std::cout << messages.size() << " messages per replay, "
+              << num_handled / (2 * static_cast<uint64_t>(iterations))
+              << " of them handled\n\n";
+    print_result("parse (one message at a time)", parse_single_duration, num_parsed_single);
+    print_result("parse (batches)", parse_batch_duration, num_parsed_batch);
+    print_result("dispatch (one message at a time)", dispatch_single_duration, num_dispatched);
+    print_result("dispatch (batches)", dispatch_batch_duration, num_dispatched);
+
+    return 0;
+}
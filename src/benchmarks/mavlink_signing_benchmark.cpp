@@ -0,0 +1,176 @@
+//
+// Benchmark of MAVLink 2 message signing: the cost of signing outgoing and
+// verifying incoming frames, compared to plain serialization, and what that
+// means for a 1 kHz offboard setpoint stream.
+//
+
+#include "mavlink_include.h"
+#include "mavlink_receiver.h"
+#include "mavlink_signing.h"
+#include "mavsdk_time.h"
+#include "sha256.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace mavsdk;
+using std::chrono::steady_clock;
+
+static void usage(const std::string& bin_name)
+{
+    std::cerr << "Usage : " << bin_name << " [messages]\n"
+              << '\n'
+              << "messages: how many setpoints are signed and verified (default: 100000)\n";
+}
+
+static mavlink_message_t setpoint(uint32_t i)
+{
+    mavlink_set_position_target_local_ned_t set_position_target{};
+    set_position_target.time_boot_ms = i;
+    set_position_target.target_system = 1;
+    set_position_target.target_component = 1;
+    set_position_target.coordinate_frame = MAV_FRAME_LOCAL_NED;
+    set_position_target.type_mask = 0x0dc7;
+    set_position_target.vx = 1.0f;
+    set_position_target.vy = 0.5f;
+
+    mavlink_message_t message;
+    mavlink_msg_set_position_target_local_ned_encode(245, 190, &message, &set_position_target);
+    return message;
+}
+
+static double ns_per_message(steady_clock::duration duration, uint64_t num_messages)
+{
+    if (num_messages == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(
+               std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) /
+           static_cast<double>(num_messages);
+}
+
+static void print_result(const std::string& name, steady_clock::duration duration, uint64_t num)
+{
+    const auto ns = ns_per_message(duration, num);
+    // At 1 kHz, one ns per message is one microsecond of CPU time per second.
+    std::cout << std::left << std::setw(40) << name << std::right << std::setw(10) << std::fixed
+              << std::setprecision(1) << ns << " ns/message" << std::setw(10)
+              << std::setprecision(4) << ns * 1e-4 << " % CPU at 1 kHz\n";
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const unsigned num_messages = (argc > 1) ? std::max(1, std::atoi(argv[1])) : 100000;
+
+    std::vector<mavlink_message_t> messages;
+    messages.reserve(num_messages);
+    for (unsigned i = 0; i < num_messages; ++i) {
+        messages.push_back(setpoint(i));
+    }
+
+    MavlinkSigning::Options options;
+    options.secret_key.fill(0x42);
+    options.link_id = 1;
+
+    Time time;
+    std::array<uint8_t, MAVLINK_MAX_PACKET_LEN> buffer{};
+    uint64_t num_bytes = 0;
+
+    // Hashing alone, over as many bytes as a signed setpoint.
+    const std::size_t hashed_len =
+        options.secret_key.size() + MAVLINK_NUM_NON_PAYLOAD_BYTES +
+        MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED_LEN + 7;
+    std::vector<steady_clock::duration> hash_durations;
+    for (const auto implementation :
+         {Sha256::Implementation::Portable, Sha256::fastest_implementation()}) {
+        const auto start = steady_clock::now();
+        uint8_t sink = 0;
+        for (unsigned i = 0; i < num_messages; ++i) {
+            buffer[0] = static_cast<uint8_t>(i);
+            Sha256 sha256(implementation);
+            sha256.update(buffer.data(), hashed_len);
+            sink ^= sha256.finish()[0];
+        }
+        hash_durations.push_back(steady_clock::now() - start);
+        buffer[1] = sink;
+    }
+
+    // Serialization without signing, as the baseline.
+    steady_clock::duration unsigned_duration{};
+    {
+        MavlinkSigning signing(time);
+        const auto start = steady_clock::now();
+        for (const auto& message : messages) {
+            num_bytes += signing.serialize(buffer.data(), message);
+        }
+        unsigned_duration = steady_clock::now() - start;
+    }
+
+    // Serialization with signing, keeping the frames to verify them afterwards.
+    std::vector<char> stream;
+    steady_clock::duration signed_duration{};
+    {
+        MavlinkSigning signing(time);
+        signing.enable(options);
+        stream.reserve(static_cast<std::size_t>(num_messages) * MAVLINK_MAX_PACKET_LEN);
+        const auto start = steady_clock::now();
+        for (const auto& message : messages) {
+            const auto len = signing.serialize(buffer.data(), message);
+            stream.insert(stream.end(), buffer.begin(), buffer.begin() + len);
+        }
+        signed_duration = steady_clock::now() - start;
+    }
+
+    std::vector<mavlink_message_t> received;
+    received.reserve(num_messages);
+    {
+        MAVLinkReceiver receiver(0);
+        receiver.set_new_datagram(stream.data(), static_cast<unsigned>(stream.size()));
+        while (receiver.parse_message()) {
+            received.push_back(receiver.get_last_message());
+        }
+    }
+
+    uint64_t num_verified = 0;
+    steady_clock::duration verify_duration{};
+    {
+        MavlinkSigning signing(time);
+        signing.enable(options);
+        const auto start = steady_clock::now();
+        for (const auto& message : received) {
+            if (signing.verify(message)) {
+                ++num_verified;
+            }
+        }
+        verify_duration = steady_clock::now() - start;
+    }
+
+    if (num_verified != num_messages) {
+        std::cerr << "Verified " << num_verified << " of " << num_messages << " messages\n";
+        return 1;
+    }
+
+    std::cout << num_messages << " SET_POSITION_TARGET_LOCAL_NED messages, SHA-256 using "
+              << Sha256::implementation_name(Sha256::fastest_implementation()) << ", "
+              << num_bytes / num_messages << " bytes per frame unsigned, "
+              << stream.size() / num_messages << " signed\n\n";
+    print_result("sha256 (portable)", hash_durations[0], num_messages);
+    print_result("sha256 (fastest)", hash_durations[1], num_messages);
+    print_result("serialize (unsigned)", unsigned_duration, num_messages);
+    print_result("serialize (signed)", signed_duration, num_messages);
+    print_result("verify", verify_duration, num_messages);
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+//
+// Benchmark of QGroundControl .plan import and export: the test plans, and a
+// generated survey with many items as produced by planning tools.
+//
+
+#include "mavlink_include.h"
+#include "mission_export.h"
+#include "mission_import.h"
+#include "plugins/mission_raw/mission_raw.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace mavsdk;
+using std::chrono::steady_clock;
+
+static void usage(const std::string& bin_name)
+{
+    std::cerr << "Usage : " << bin_name << " [items] [test_plans]\n"
+              << '\n'
+              << "items: number of items of the generated survey (default: 50000)\n"
+              << "test_plans: directory of the test plans\n"
+              << "            (default: src/mavsdk/plugins/mission_raw/test_plans)\n";
+}
+
+static std::vector<MissionRaw::MissionItem> generate_survey(unsigned num_items)
+{
+    std::vector<MissionRaw::MissionItem> items;
+    items.reserve(num_items);
+    for (unsigned i = 0; i < num_items; ++i) {
+        MissionRaw::MissionItem item{};
+        item.seq = i;
+        item.current = (i == 0) ? 1 : 0;
+        item.autocontinue = 1;
+        item.mission_type = MAV_MISSION_TYPE_MISSION;
+        if (i % 4 == 3) {
+            // Camera trigger distance at the end of every transect.
+            item.frame = MAV_FRAME_MISSION;
+            item.command = MAV_CMD_DO_SET_CAM_TRIGG_DIST;
+            item.param1 = 25.0f;
+            item.param3 = 1.0f;
+        } else {
+            item.frame = MAV_FRAME_GLOBAL_RELATIVE_ALT;
+            item.command = MAV_CMD_NAV_WAYPOINT;
+            item.param4 = NAN;
+            item.x = 473977060 + static_cast<int32_t>((i / 4) * 37);
+            item.y = 85462068 + static_cast<int32_t>((i % 4) * 1329);
+            item.z = 50.0f;
+        }
+        items.push_back(item);
+    }
+    return items;
+}
+
+static void print_result(
+    const std::string& name, steady_clock::duration duration, uint64_t num_items, uint64_t bytes)
+{
+    const auto ns =
+        static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+    std::cout << std::left << std::setw(48) << name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(12) << ns / 1e3 << " us" << std::setw(10)
+              << (num_items > 0 ? ns / static_cast<double>(num_items) : 0.0) << " ns/item"
+              << std::setw(10) << (ns > 0.0 ? static_cast<double>(bytes) * 1e3 / ns : 0.0)
+              << " MB/s\n";
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 3) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const unsigned num_items = (argc > 1) ? std::max(1, std::atoi(argv[1])) : 50000;
+    const std::string test_plans =
+        (argc > 2) ? argv[2] : "src/mavsdk/plugins/mission_raw/test_plans";
+
+    for (const auto& name :
+         {"qgroundcontrol_sample.plan", "qgroundcontrol_sample_with_survey.plan"}) {
+        std::ifstream file(test_plans + "/" + name);
+        if (!file) {
+            std::cerr << "Could not open " << test_plans << "/" << name << '\n';
+            usage(argv[0]);
+            return 1;
+        }
+        std::stringstream buf;
+        buf << file.rdbuf();
+        const auto plan = buf.str();
+
+        // Small plans are imported many times to get a measurable duration.
+        constexpr unsigned repetitions = 1000;
+        std::size_t num_imported = 0;
+        const auto start = steady_clock::now();
+        for (unsigned i = 0; i < repetitions; ++i) {
+            num_imported += MissionImport::parse_json(plan).second.mission_items.size();
+        }
+        const auto duration = (steady_clock::now() - start) / repetitions;
+
+        if (num_imported == 0) {
+            std::cerr << "Import of " << name << " failed\n";
+            return 1;
+        }
+        print_result(
+            std::string("import ") + name, duration, num_imported / repetitions, plan.size());
+    }
+
+    const auto items = generate_survey(num_items);
+
+    auto start = steady_clock::now();
+    const auto plan = MissionExport::to_json(items);
+    const auto export_duration = steady_clock::now() - start;
+
+    start = steady_clock::now();
+    const auto result = MissionImport::parse_json(plan);
+    const auto import_duration = steady_clock::now() - start;
+
+    if (result.first != MissionRaw::Result::Success || result.second.mission_items != items) {
+        std::cerr << "Generated survey did not import the same as exported\n";
+        return 1;
+    }
+
+    std::cout << '\n'
+              << "Generated survey: " << num_items << " items, " << plan.size() / 1024
+              << " KiB\n";
+    print_result("export survey", export_duration, num_items, plan.size());
+    print_result("import survey", import_duration, num_items, plan.size());
+
+    return 0;
+}
@@ -6,6 +6,7 @@
 #include <string>
 #include <thread>
 #include <gtest/gtest.h>
+#include "async_log_writer.h"
 #include "log.h"
 #include "unused.h"
 
@@ -18,14 +19,15 @@ protected:
 #ifndef WINDOWS
         const int ret = system((std::string("./tools/start_sitl.sh ") + model).c_str());
         if (ret != 0) {
-            mavsdk::LogErr() << "./tools/start_sitl.sh failed, giving up.";
+            LogErr() << "./tools/start_sitl.sh failed, giving up.";
+            mavsdk::AsyncLogWriter::instance().flush();
             fflush(stdout);
             fflush(stderr);
             abort();
         }
 #else
         UNUSED(model);
-        mavsdk::LogErr() << "Auto-starting SITL not supported on Windows.";
+        LogErr() << "Auto-starting SITL not supported on Windows.";
 #endif
     }
 
@@ -34,13 +36,14 @@ protected:
 #ifndef WINDOWS
         const int ret = system("./tools/stop_sitl.sh");
         if (ret != 0) {
-            mavsdk::LogErr() << "./tools/stop_sitl.sh failed, giving up.";
+            LogErr() << "./tools/stop_sitl.sh failed, giving up.";
+            mavsdk::AsyncLogWriter::instance().flush();
             fflush(stdout);
             fflush(stderr);
             abort();
         }
 #else
-        mavsdk::LogErr() << "Auto-starting SITL not supported on Windows.";
+        LogErr() << "Auto-starting SITL not supported on Windows.";
 #endif
     }
 
@@ -61,7 +64,7 @@ private:
             model_name = test_name.substr(pos + 1, test_name.length() - pos - 1);
         }
 
-        mavsdk::LogDebug() << "Model chosen: '" << model_name << "'";
+        LogDebug() << "Model chosen: '" << model_name << "'";
         return model_name;
     }
 };
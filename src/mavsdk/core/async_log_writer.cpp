@@ -0,0 +1,301 @@
+#include "async_log_writer.h"
+#include "log.h"
+
+#include <cstdlib>
+
+namespace mavsdk {
+
+namespace {
+
+// A plain atomic is still usable during static destruction.
+std::atomic<bool> instance_destroyed{false};
+
+struct InstanceGuard {
+    ~InstanceGuard() { instance_destroyed = true; }
+};
+
+} // namespace
+
+AsyncLogWriter::AsyncLogWriter() : AsyncLogWriter(Options{}) {}
+
+AsyncLogWriter::AsyncLogWriter(const Options& options) :
+    _options(options),
+    _ring(options.synchronous ? 1 : options.capacity),
+    _batch(64)
+{
+    if (!_options.synchronous) {
+        _thread = std::thread(&AsyncLogWriter::run, this);
+    }
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+    if (_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(_wake_mutex);
+            _should_exit = true;
+        }
+        _wake_cv.notify_one();
+        _thread.join();
+    }
+
+    while (write_batch()) {
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(_write_mutex);
+    report_suppressed(std::chrono::steady_clock::now(), true);
+}
+
+AsyncLogWriter& AsyncLogWriter::instance()
+{
+    static AsyncLogWriter writer([]() {
+        Options options;
+        if (const char* env_p = std::getenv("MAVSDK_LOG_SYNC")) {
+            options.synchronous = (std::string(env_p) == "1");
+        }
+        return options;
+    }());
+    // Destroyed before the writer, so logging from then on doesn't use it anymore.
+    static const InstanceGuard guard{};
+    return writer;
+}
+
+bool AsyncLogWriter::instance_available()
+{
+    return !instance_destroyed;
+}
+
+void AsyncLogWriter::push(
+    log::Level level, const char* filename, int line, const std::string& message)
+{
+    if (_options.synchronous) {
+        std::lock_guard<std::recursive_mutex> lock(_write_mutex);
+        write_rate_limited(Record{level, std::time(nullptr), filename, line, message});
+        return;
+    }
+
+    const bool pushed = _ring.push_with([&](Record& record) {
+        record.level = level;
+        record.time = std::time(nullptr);
+        record.filename = filename;
+        record.line = line;
+        record.message.assign(message);
+    });
+    if (!pushed) {
+        // The writer can't keep up, better lose the message than block.
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    _pushed.fetch_add(1, std::memory_order_release);
+
+    // Only wake the writer if it went to sleep, which is the uncommon case.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_writer_sleeping.load(std::memory_order_relaxed)) {
+        {
+            std::lock_guard<std::mutex> lock(_wake_mutex);
+        }
+        _wake_cv.notify_one();
+    }
+}
+
+void AsyncLogWriter::flush()
+{
+    if (!_thread.joinable() || std::this_thread::get_id() == _thread.get_id()) {
+        return;
+    }
+
+    const auto target = _pushed.load(std::memory_order_acquire);
+    while (_written.load(std::memory_order_acquire) < target) {
+        {
+            std::lock_guard<std::mutex> lock(_wake_mutex);
+        }
+        _wake_cv.notify_one();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void AsyncLogWriter::run()
+{
+    while (true) {
+        while (write_batch()) {
+        }
+
+        const auto dropped = _dropped.load(std::memory_order_relaxed);
+        {
+            std::lock_guard<std::recursive_mutex> lock(_write_mutex);
+            if (dropped != _dropped_reported) {
+                write(Record{
+                    log::Level::Warn,
+                    std::time(nullptr),
+                    FILENAME,
+                    __LINE__,
+                    std::to_string(dropped - _dropped_reported) +
+                        " log messages dropped, logging too fast"});
+                _dropped_reported = dropped;
+            }
+            report_suppressed(std::chrono::steady_clock::now(), false);
+        }
+
+        std::unique_lock<std::mutex> lock(_wake_mutex);
+        if (_should_exit) {
+            break;
+        }
+        _writer_sleeping = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // Without wake up, check now and then for suppressed messages to report.
+        _wake_cv.wait_for(lock, _options.rate_limit_interval, [this]() {
+            return _should_exit || _ring.ready();
+        });
+        _writer_sleeping = false;
+    }
+
+    // Whatever came in until the end.
+    while (write_batch()) {
+    }
+}
+
+bool AsyncLogWriter::write_batch()
+{
+    const auto count = _ring.pop(_batch.data(), _batch.size());
+    if (count == 0) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(_write_mutex);
+        for (std::size_t i = 0; i < count; ++i) {
+            write_rate_limited(_batch[i]);
+        }
+    }
+
+    _written.fetch_add(count, std::memory_order_release);
+    return true;
+}
+
+void AsyncLogWriter::write_rate_limited(const Record& record)
+{
+    // Errors are rare and usually the one message that matters, never drop them.
+    if (record.level == log::Level::Err) {
+        write(record);
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    auto& call_site = _call_sites[{record.filename, record.line}];
+
+    if (now - call_site.interval_start >= _options.rate_limit_interval) {
+        if (call_site.suppressed > 0) {
+            write(Record{
+                call_site.level,
+                record.time,
+                record.filename,
+                record.line,
+                std::to_string(call_site.suppressed) + " similar messages suppressed"});
+            call_site.suppressed = 0;
+        }
+        call_site.interval_start = now;
+        call_site.count = 0;
+    }
+
+    if (++call_site.count > _options.rate_limit_burst) {
+        ++call_site.suppressed;
+        call_site.level = record.level;
+        return;
+    }
+
+    write(record);
+}
+
+void AsyncLogWriter::report_suppressed(std::chrono::steady_clock::time_point now, bool all)
+{
+    if (!all && now - _last_report < _options.rate_limit_interval) {
+        return;
+    }
+    _last_report = now;
+
+    for (auto& [call_site_key, call_site] : _call_sites) {
+        if (call_site.suppressed == 0 ||
+            (!all && now - call_site.interval_start < _options.rate_limit_interval)) {
+            continue;
+        }
+        write(Record{
+            call_site.level,
+            std::time(nullptr),
+            call_site_key.first,
+            call_site_key.second,
+            std::to_string(call_site.suppressed) + " similar messages suppressed"});
+        call_site.suppressed = 0;
+    }
+}
+
+void AsyncLogWriter::write(const Record& record)
+{
+    if (log::get_callback() &&
+        log::get_callback()(record.level, record.message, record.filename, record.line)) {
+        return;
+    }
+
+#if ANDROID
+    switch (record.level) {
+        case log::Level::Debug:
+            __android_log_print(ANDROID_LOG_DEBUG, "Mavsdk", "%s", record.message.c_str());
+            break;
+        case log::Level::Info:
+            __android_log_print(ANDROID_LOG_INFO, "Mavsdk", "%s", record.message.c_str());
+            break;
+        case log::Level::Warn:
+            __android_log_print(ANDROID_LOG_WARN, "Mavsdk", "%s", record.message.c_str());
+            break;
+        case log::Level::Err:
+            __android_log_print(ANDROID_LOG_ERROR, "Mavsdk", "%s", record.message.c_str());
+            break;
+    }
+#else
+
+    switch (record.level) {
+        case log::Level::Debug:
+            set_color(Color::Green);
+            break;
+        case log::Level::Info:
+            set_color(Color::Blue);
+            break;
+        case log::Level::Warn:
+            set_color(Color::Yellow);
+            break;
+        case log::Level::Err:
+            set_color(Color::Red);
+            break;
+    }
+
+    // Time output taken from:
+    // https://stackoverflow.com/questions/16357999#answer-16358264
+    struct tm* timeinfo = localtime(&record.time);
+    char time_buffer[10]{}; // We need 8 characters + \0
+    strftime(time_buffer, sizeof(time_buffer), "%I:%M:%S", timeinfo);
+    std::cout << "[" << time_buffer;
+
+    switch (record.level) {
+        case log::Level::Debug:
+            std::cout << "|Debug] ";
+            break;
+        case log::Level::Info:
+            std::cout << "|Info ] ";
+            break;
+        case log::Level::Warn:
+            std::cout << "|Warn ] ";
+            break;
+        case log::Level::Err:
+            std::cout << "|Error] ";
+            break;
+    }
+
+    set_color(Color::Reset);
+
+    std::cout << record.message;
+    std::cout << " (" << record.filename << ":" << std::dec << record.line << ")";
+
+    std::cout << '\n';
+#endif
+}
+
+} // namespace mavsdk
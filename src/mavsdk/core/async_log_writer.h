@@ -0,0 +1,109 @@
+#pragma once
+
+#include "log_callback.h"
+#include "mpsc_ring.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mavsdk {
+
+// Hands log messages from any thread to a background thread which calls the
+// user callback and prints them.
+//
+// Logging threads only copy the formatted message into a slot of a lock-free
+// ring, so they never wait on stdout or the user callback. When the ring is full,
+// messages are dropped and counted rather than blocking. Call sites which log
+// more than a burst of messages within an interval are muted until the interval
+// is over, and then the number of suppressed messages is reported. Errors are
+// never muted.
+class AsyncLogWriter {
+public:
+    struct Record {
+        log::Level level{log::Level::Debug};
+        std::time_t time{0};
+        const char* filename{""};
+        int line{0};
+        std::string message{};
+    };
+
+    struct Options {
+        // Number of messages which can be queued, rounded up to a power of two.
+        std::size_t capacity{1024};
+        unsigned rate_limit_burst{20};
+        std::chrono::milliseconds rate_limit_interval{1000};
+        // Write from the logging thread, no background thread.
+        bool synchronous{false};
+    };
+
+    AsyncLogWriter();
+    explicit AsyncLogWriter(const Options& options);
+    ~AsyncLogWriter();
+
+    // The one used by LogDebug() and friends. It writes synchronously if
+    // MAVSDK_LOG_SYNC is set to 1.
+    static AsyncLogWriter& instance();
+
+    // Whether instance() can still be used, it can't during static destruction.
+    static bool instance_available();
+
+    void push(log::Level level, const char* filename, int line, const std::string& message);
+
+    // Waits until everything pushed so far is written.
+    void flush();
+
+    [[nodiscard]] uint64_t dropped() const { return _dropped; }
+
+    // Writes a record to the user callback or stdout, without rate limiting.
+    static void write(const Record& record);
+
+    // Non-copyable
+    AsyncLogWriter(const AsyncLogWriter&) = delete;
+    const AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+private:
+    struct CallSite {
+        std::chrono::steady_clock::time_point interval_start{};
+        unsigned count{0};
+        unsigned suppressed{0};
+        log::Level level{log::Level::Debug};
+    };
+
+    void run();
+    bool write_batch();
+    void write_rate_limited(const Record& record);
+    void report_suppressed(std::chrono::steady_clock::time_point now, bool all);
+
+    const Options _options;
+    MpscRing<Record> _ring;
+    // Only used by the writer thread, the strings keep their capacity.
+    std::vector<Record> _batch;
+
+    std::atomic<uint64_t> _pushed{0};
+    std::atomic<uint64_t> _written{0};
+    std::atomic<uint64_t> _dropped{0};
+    uint64_t _dropped_reported{0};
+
+    std::mutex _wake_mutex{};
+    std::condition_variable _wake_cv{};
+    std::atomic<bool> _writer_sleeping{false};
+    std::atomic<bool> _should_exit{false};
+
+    // Serializes writing. It's recursive because the user callback can log
+    // itself, which writes straight away in the synchronous case.
+    std::recursive_mutex _write_mutex{};
+    std::map<std::pair<const char*, int>, CallSite> _call_sites{};
+    std::chrono::steady_clock::time_point _last_report{};
+
+    std::thread _thread{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,180 @@
+#include "async_log_writer.h"
+#include "log.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+// Collects what reaches the user callback, which is called from the writer thread.
+class Collector {
+public:
+    Collector()
+    {
+        log::subscribe([this](log::Level, const std::string& message, const std::string&, int) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _messages.push_back(message);
+            return true;
+        });
+    }
+
+    ~Collector() { log::subscribe(nullptr); }
+
+    std::vector<std::string> messages()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _messages;
+    }
+
+private:
+    std::mutex _mutex{};
+    std::vector<std::string> _messages{};
+};
+
+std::string nested_log()
+{
+    LogDebug() << "inner";
+    return "outer";
+}
+
+} // namespace
+
+TEST(AsyncLogWriter, WritesInOrder)
+{
+    Collector collector;
+    AsyncLogWriter::Options options;
+    options.rate_limit_burst = 1000;
+    AsyncLogWriter writer(options);
+
+    for (int i = 0; i < 100; ++i) {
+        writer.push(log::Level::Info, "file.cpp", 1, std::to_string(i));
+    }
+    writer.flush();
+
+    const auto messages = collector.messages();
+    ASSERT_EQ(messages.size(), 100);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(messages[i], std::to_string(i));
+    }
+    EXPECT_EQ(writer.dropped(), 0);
+}
+
+TEST(AsyncLogWriter, DropsAndReportsWhenFull)
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool writer_blocked = false;
+    bool release = false;
+    std::vector<std::string> messages;
+
+    log::subscribe([&](log::Level, const std::string& message, const std::string&, int) {
+        std::unique_lock<std::mutex> lock(mutex);
+        messages.push_back(message);
+        writer_blocked = true;
+        cv.notify_all();
+        cv.wait(lock, [&]() { return release; });
+        return true;
+    });
+
+    {
+        AsyncLogWriter::Options options;
+        options.capacity = 4;
+        AsyncLogWriter writer(options);
+
+        // The writer blocks in the callback of the first message, so the ring fills up.
+        writer.push(log::Level::Warn, "file.cpp", 1, "first");
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return writer_blocked; });
+        }
+        for (int i = 0; i < 7; ++i) {
+            writer.push(log::Level::Warn, "file.cpp", 2, std::to_string(i));
+        }
+        EXPECT_EQ(writer.dropped(), 3);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            release = true;
+        }
+        cv.notify_all();
+        writer.flush();
+    }
+    log::subscribe(nullptr);
+
+    ASSERT_EQ(messages.size(), 6);
+    EXPECT_EQ(messages[0], "first");
+    EXPECT_EQ(messages[1], "0");
+    EXPECT_EQ(messages[4], "3");
+    EXPECT_EQ(messages[5], "3 log messages dropped, logging too fast");
+}
+
+TEST(AsyncLogWriter, RateLimitsPerCallSite)
+{
+    Collector collector;
+    {
+        AsyncLogWriter::Options options;
+        options.synchronous = true;
+        options.rate_limit_burst = 3;
+        options.rate_limit_interval = std::chrono::hours(1);
+        AsyncLogWriter writer(options);
+
+        for (int i = 0; i < 10; ++i) {
+            writer.push(log::Level::Warn, "file.cpp", 1, "same");
+        }
+        // Another call site is not affected.
+        writer.push(log::Level::Warn, "file.cpp", 2, "other");
+
+        EXPECT_EQ(collector.messages().size(), 4);
+    }
+
+    // The rest is reported when the writer goes away.
+    const auto messages = collector.messages();
+    ASSERT_EQ(messages.size(), 5);
+    EXPECT_EQ(messages[0], "same");
+    EXPECT_EQ(messages[3], "other");
+    EXPECT_EQ(messages[4], "7 similar messages suppressed");
+}
+
+TEST(AsyncLogWriter, NeverRateLimitsErrors)
+{
+    Collector collector;
+    {
+        AsyncLogWriter::Options options;
+        options.synchronous = true;
+        options.rate_limit_burst = 3;
+        options.rate_limit_interval = std::chrono::hours(1);
+        AsyncLogWriter writer(options);
+
+        for (int i = 0; i < 10; ++i) {
+            writer.push(log::Level::Err, "file.cpp", 1, "error");
+        }
+
+        EXPECT_EQ(collector.messages().size(), 10);
+    }
+
+    EXPECT_EQ(collector.messages().size(), 10);
+}
+
+TEST(AsyncLogWriter, LogMacrosResetFormattingAndNest)
+{
+    Collector collector;
+
+    LogDebug() << "hex " << std::hex << 255;
+    LogDebug() << "dec " << 255;
+    LogInfo() << nested_log();
+    AsyncLogWriter::instance().flush();
+
+    const auto messages = collector.messages();
+    ASSERT_EQ(messages.size(), 4);
+    EXPECT_EQ(messages[0], "hex ff");
+    EXPECT_EQ(messages[1], "dec 255");
+    // The inner line is complete first.
+    EXPECT_EQ(messages[2], "inner");
+    EXPECT_EQ(messages[3], "outer");
+}
@@ -2,6 +2,7 @@
 #include "log.h"
 #include <cctype>
 #include <algorithm>
+#include <cstdlib>
 #include <limits>
 
 namespace mavsdk {
@@ -12,6 +13,7 @@ void CliArg::reset()
     _path.clear();
     _baudrate = 0;
     _port = 0;
+    _replay_speed = 1.0;
 }
 
 bool CliArg::parse(const std::string& uri)
@@ -23,6 +25,11 @@ bool CliArg::parse(const std::string& uri)
         return false;
     }
 
+    if (_protocol == Protocol::File) {
+        // Paths can contain ':', so everything up to the options is the path.
+        return find_replay_speed(rest);
+    }
+
     if (!find_path(rest)) {
         return false;
     }
@@ -46,6 +53,7 @@ bool CliArg::find_protocol(std::string& rest)
     const std::string tcp = "tcp";
     const std::string serial = "serial";
     const std::string serial_flowcontrol = "serial_flowcontrol";
+    const std::string file = "file";
     const std::string delimiter = "://";
 
     if (rest.find(udp + delimiter) == 0) {
@@ -66,6 +74,10 @@ bool CliArg::find_protocol(std::string& rest)
         _flow_control_enabled = true;
         rest.erase(0, serial_flowcontrol.length() + delimiter.length());
         return true;
+    } else if (rest.find(file + delimiter) == 0) {
+        _protocol = Protocol::File;
+        rest.erase(0, file.length() + delimiter.length());
+        return true;
     } else {
         LogWarn() << "Unknown protocol";
         return false;
@@ -172,4 +184,34 @@ bool CliArg::find_baudrate(std::string& rest)
     return true;
 }
 
+bool CliArg::find_replay_speed(std::string& rest)
+{
+    const std::string option = "?speed=";
+    const size_t pos = rest.find(option);
+
+    _path = rest.substr(0, pos);
+    if (_path.empty()) {
+        LogWarn() << "Path for file required.";
+        return false;
+    }
+
+    if (pos == std::string::npos) {
+        rest = "";
+        return true;
+    }
+
+    const std::string value = rest.substr(pos + option.length());
+    char* end = nullptr;
+    _replay_speed = std::strtod(value.c_str(), &end);
+    if (value.empty() || *end != '\0' || !(_replay_speed >= 0.0)) {
+        LogWarn() << "Invalid replay speed";
+        _path = "";
+        _replay_speed = 1.0;
+        return false;
+    }
+
+    rest = "";
+    return true;
+}
+
 } // namespace mavsdk
@@ -6,7 +6,7 @@ namespace mavsdk {
 
 class CliArg {
 public:
-    enum class Protocol { None, Udp, Tcp, Serial };
+    enum class Protocol { None, Udp, Tcp, Serial, File };
 
     bool parse(const std::string& uri);
 
@@ -20,18 +20,23 @@ public:
 
     [[nodiscard]] std::string get_path() const { return _path; }
 
+    // Only for file://, 1 is real time, 0 as fast as possible.
+    [[nodiscard]] double get_replay_speed() const { return _replay_speed; }
+
 private:
     void reset();
     bool find_protocol(std::string& rest);
     bool find_path(std::string& rest);
     bool find_port(std::string& rest);
     bool find_baudrate(std::string& rest);
+    bool find_replay_speed(std::string& rest);
 
     Protocol _protocol{Protocol::None};
     std::string _path{};
     int _port{0};
     int _baudrate{0};
     bool _flow_control_enabled{false};
+    double _replay_speed{1.0};
 };
 
 } // namespace mavsdk
@@ -167,3 +167,31 @@ TEST(CliArg, SerialConnections)
     EXPECT_FALSE(ca.parse("serial://SOM3:57600"));
     EXPECT_FALSE(ca.parse("serial://COM3:-1"));
 }
+
+TEST(CliArg, FileConnections)
+{
+    CliArg ca;
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::None);
+
+    EXPECT_TRUE(ca.parse("file:///tmp/flight.tlog"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::File);
+    EXPECT_STREQ(ca.get_path().c_str(), "/tmp/flight.tlog");
+    EXPECT_EQ(1.0, ca.get_replay_speed());
+
+    EXPECT_TRUE(ca.parse("file://C:\\logs\\flight.tlog?speed=2.5"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::File);
+    EXPECT_STREQ(ca.get_path().c_str(), "C:\\logs\\flight.tlog");
+    EXPECT_EQ(2.5, ca.get_replay_speed());
+
+    EXPECT_TRUE(ca.parse("file://flight.tlog?speed=0"));
+    EXPECT_STREQ(ca.get_path().c_str(), "flight.tlog");
+    EXPECT_EQ(0.0, ca.get_replay_speed());
+
+    // All the wrong combinations.
+    EXPECT_FALSE(ca.parse("file://"));
+    EXPECT_FALSE(ca.parse("file:/tmp/flight.tlog"));
+    EXPECT_FALSE(ca.parse("file://?speed=2"));
+    EXPECT_FALSE(ca.parse("file:///tmp/flight.tlog?speed="));
+    EXPECT_FALSE(ca.parse("file:///tmp/flight.tlog?speed=fast"));
+    EXPECT_FALSE(ca.parse("file:///tmp/flight.tlog?speed=-1"));
+}
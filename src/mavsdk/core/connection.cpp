@@ -14,9 +14,6 @@ Connection::Connection(receiver_callback_t receiver_callback, ForwardingOption f
     _mavlink_receiver(),
     _forwarding_option(forwarding_option)
 {
-    // Insert system ID 0 in all connections for broadcast.
-    _system_ids.insert(0);
-
     if (forwarding_option == ForwardingOption::ForwardingOn) {
         _forwarding_connections_count++;
     }
@@ -50,13 +47,48 @@ void Connection::stop_mavlink_receiver()
     }
 }
 
-void Connection::receive_message(mavlink_message_t& message, Connection* connection)
+void Connection::receive_datagram(char* datagram, unsigned datagram_len)
+{
+    _statistics.add_received_bytes(datagram_len);
+    _mavlink_receiver->set_new_datagram(datagram, datagram_len);
+
+    // One datagram can contain many messages, we parse them all, one batch at a time.
+    std::size_t count;
+    while ((count = _mavlink_receiver->parse_messages(
+                _received_messages.data(), _received_messages.size())) > 0) {
+        receive_messages(_received_messages.data(), count);
+    }
+
+    _statistics.add_parse_errors(_mavlink_receiver->take_parse_errors());
+}
+
+void Connection::receive_messages(mavlink_message_t* messages, std::size_t count)
+{
+    const auto accepted = accept_messages(messages, count);
+    if (accepted > 0) {
+        _receiver_callback(messages, accepted, this);
+    }
+}
+
+std::size_t Connection::accept_messages(mavlink_message_t* messages, std::size_t count)
 {
-    // Register system ID when receiving a message from a new system.
-    if (_system_ids.find(message.sysid) == _system_ids.end()) {
-        _system_ids.insert(message.sysid);
+    // Frames failing verification are dropped, and the rest moved up to close the gap.
+    std::size_t accepted = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!_signing.verify(messages[i])) {
+            continue;
+        }
+        if (accepted != i) {
+            messages[accepted] = messages[i];
+        }
+        _statistics.add_received_frame(messages[accepted]);
+        ++accepted;
+    }
+
+    if (accepted < count) {
+        _statistics.add_parse_errors(static_cast<unsigned>(count - accepted));
     }
-    _receiver_callback(message, connection);
+    return accepted;
 }
 
 bool Connection::should_forward_messages() const
@@ -69,9 +101,4 @@ unsigned Connection::forwarding_connections_count()
     return _forwarding_connections_count;
 }
 
-bool Connection::has_system_id(uint8_t system_id)
-{
-    return _system_ids.find(system_id) != _system_ids.end();
-}
-
 } // namespace mavsdk
@@ -1,15 +1,24 @@
 #pragma once
 
 #include "mavsdk.h"
+#include "link_statistics.h"
 #include "mavlink_receiver.h"
+#include "mavlink_signing.h"
+#include "mavsdk_time.h"
+#include <array>
+#include <atomic>
+#include <climits>
+#include <cstddef>
 #include <memory>
-#include <unordered_set>
+#include <string>
+#include <vector>
 
 namespace mavsdk {
 
 class Connection {
 public:
-    typedef std::function<void(mavlink_message_t& message, Connection* connection)>
+    typedef std::function<void(
+        mavlink_message_t* messages, std::size_t count, Connection* connection)>
         receiver_callback_t;
 
     explicit Connection(
@@ -22,7 +31,24 @@ public:
 
     virtual bool send_message(const mavlink_message_t& message) = 0;
 
-    bool has_system_id(uint8_t system_id);
+    // Describes the connection in URL form, e.g. udp://0.0.0.0:14540.
+    virtual std::string description() const = 0;
+
+    LinkStatistics::Snapshot statistics() { return _statistics.snapshot(); }
+    void evaluate_sources() { _statistics.evaluate_sources(); }
+    std::vector<MavlinkSequenceTracker::SourceQuality> source_qualities() const
+    {
+        return _statistics.source_qualities();
+    }
+
+    // Position in the routing table, assigned when the connection is added.
+    void set_routing_index(unsigned index) { _routing_index = index; }
+    [[nodiscard]] unsigned routing_index() const { return _routing_index; }
+
+    // Signs outgoing and verifies incoming frames from now on.
+    void enable_signing(const MavlinkSigning::Options& options) { _signing.enable(options); }
+    void disable_signing() { _signing.disable(); }
+
     bool should_forward_messages() const;
     static unsigned forwarding_connections_count();
 
@@ -33,12 +59,29 @@ public:
 protected:
     bool start_mavlink_receiver();
     void stop_mavlink_receiver();
-    void receive_message(mavlink_message_t& message, Connection* connection);
+    // Parses everything in the datagram and passes it on in batches.
+    void receive_datagram(char* datagram, unsigned datagram_len);
+    void receive_messages(mavlink_message_t* messages, std::size_t count);
+    // Drops the frames failing verification and moves the rest to the front.
+    // Returns how many are left.
+    std::size_t accept_messages(mavlink_message_t* messages, std::size_t count);
+    // Serializes into a buffer of MAVLINK_MAX_PACKET_LEN, signed if enabled.
+    uint16_t serialize_message(uint8_t* buffer, const mavlink_message_t& message)
+    {
+        return _signing.serialize(buffer, message);
+    }
+
+    Time _time{};
+    LinkStatistics _statistics{_time};
+    MavlinkSigning _signing{_time};
 
     receiver_callback_t _receiver_callback{};
     std::unique_ptr<MAVLinkReceiver> _mavlink_receiver;
+
+    static constexpr std::size_t MAX_MESSAGES_PER_BATCH = 32;
+    std::array<mavlink_message_t, MAX_MESSAGES_PER_BATCH> _received_messages{};
     ForwardingOption _forwarding_option;
-    std::unordered_set<uint8_t> _system_ids;
+    std::atomic<unsigned> _routing_index{UINT_MAX};
 
     static std::atomic<unsigned> _forwarding_connections_count;
 
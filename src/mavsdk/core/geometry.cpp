@@ -6,64 +6,120 @@ namespace mavsdk::geometry {
 
 CoordinateTransformation::CoordinateTransformation(GlobalCoordinate reference) :
     _ref_lat_rad(to_rad_from_deg(reference.latitude_deg)),
-    _ref_lon_rad(to_rad_from_deg(reference.longitude_deg))
+    _ref_lon_rad(to_rad_from_deg(reference.longitude_deg)),
+    _ref_sin_lat(std::sin(_ref_lat_rad)),
+    _ref_cos_lat(std::cos(_ref_lat_rad))
 {}
 
-CoordinateTransformation::LocalCoordinate
-CoordinateTransformation::local_from_global(GlobalCoordinate global_coordinate) const
+// The single and the batch transformations share these, so they give the same results.
+inline CoordinateTransformation::LocalCoordinate
+CoordinateTransformation::project_local(double latitude_deg, double longitude_deg) const
 {
-    const double lat_rad = to_rad_from_deg(global_coordinate.latitude_deg);
-    const double lon_rad = to_rad_from_deg(global_coordinate.longitude_deg);
-
-    const double sin_lat = sin(lat_rad);
-    const double cos_lat = cos(lat_rad);
-
-    const double cos_d_lon = cos(lon_rad - _ref_lon_rad);
+    const double lat_rad = to_rad_from_deg(latitude_deg);
+    const double d_lon_rad = to_rad_from_deg(longitude_deg) - _ref_lon_rad;
 
-    const double ref_sin_lat = sin(_ref_lat_rad);
-    const double ref_cos_lat = cos(_ref_lat_rad);
+    const double sin_lat = std::sin(lat_rad);
+    const double cos_lat = std::cos(lat_rad);
+    const double sin_d_lon = std::sin(d_lon_rad);
+    const double cos_d_lon = std::cos(d_lon_rad);
 
     const double arg =
-        constrain(ref_sin_lat * sin_lat + ref_cos_lat * cos_lat * cos_d_lon, -1.0, 1.0);
-    const double c = acos(arg);
+        constrain(_ref_sin_lat * sin_lat + _ref_cos_lat * cos_lat * cos_d_lon, -1.0, 1.0);
+    const double c = std::acos(arg);
 
-    const double k = (fabs(c) > 0) ? (c / sin(c)) : 1.0;
+    // As c is in [0, pi], sin(c) follows from cos(c) = arg without another sin,
+    // factored to stay accurate for arg close to 1.
+    const double sin_c = std::sqrt((1.0 - arg) * (1.0 + arg));
+    const double k = (sin_c > 0.0) ? (c / sin_c) : 1.0;
 
     return LocalCoordinate{
-        k * (ref_cos_lat * sin_lat - ref_sin_lat * cos_lat * cos_d_lon) * world_radius_m,
-        k * cos_lat * sin(lon_rad - _ref_lon_rad) * world_radius_m};
+        k * (_ref_cos_lat * sin_lat - _ref_sin_lat * cos_lat * cos_d_lon) * world_radius_m,
+        k * cos_lat * sin_d_lon * world_radius_m};
 }
 
-CoordinateTransformation::GlobalCoordinate
-CoordinateTransformation::global_from_local(LocalCoordinate local_coordinate) const
+inline CoordinateTransformation::GlobalCoordinate
+CoordinateTransformation::project_global(double north_m, double east_m) const
 {
-    const double x_rad = local_coordinate.north_m / world_radius_m;
-    const double y_rad = local_coordinate.east_m / world_radius_m;
-    const double c = sqrt(x_rad * x_rad + y_rad * y_rad);
+    const double x_rad = north_m / world_radius_m;
+    const double y_rad = east_m / world_radius_m;
+    const double c = std::sqrt(x_rad * x_rad + y_rad * y_rad);
 
-    GlobalCoordinate global{};
+    if (!(c > 0.0)) {
+        return GlobalCoordinate{to_deg_from_rad(_ref_lat_rad), to_deg_from_rad(_ref_lon_rad)};
+    }
 
-    if (fabs(c) > 0) {
-        const double sin_c = sin(c);
-        const double cos_c = cos(c);
+    const double sin_c = std::sin(c);
+    const double cos_c = std::cos(c);
 
-        const double ref_sin_lat = sin(_ref_lat_rad);
-        const double ref_cos_lat = cos(_ref_lat_rad);
+    const double lat_rad = std::asin(cos_c * _ref_sin_lat + (x_rad * sin_c * _ref_cos_lat) / c);
+    const double lon_rad =
+        (_ref_lon_rad +
+         std::atan2(y_rad * sin_c, c * _ref_cos_lat * cos_c - x_rad * _ref_sin_lat * sin_c));
 
-        const double lat_rad = asin(cos_c * ref_sin_lat + (x_rad * sin_c * ref_cos_lat) / c);
-        const double lon_rad =
-            (_ref_lon_rad +
-             atan2(y_rad * sin_c, c * ref_cos_lat * cos_c - x_rad * ref_sin_lat * sin_c));
+    return GlobalCoordinate{to_deg_from_rad(lat_rad), to_deg_from_rad(lon_rad)};
+}
 
-        global.latitude_deg = to_deg_from_rad(lat_rad);
-        global.longitude_deg = to_deg_from_rad(lon_rad);
+CoordinateTransformation::LocalCoordinate
+CoordinateTransformation::local_from_global(GlobalCoordinate global_coordinate) const
+{
+    return project_local(global_coordinate.latitude_deg, global_coordinate.longitude_deg);
+}
 
-    } else {
-        global.latitude_deg = to_deg_from_rad(_ref_lat_rad);
-        global.longitude_deg = to_deg_from_rad(_ref_lon_rad);
+CoordinateTransformation::GlobalCoordinate
+CoordinateTransformation::global_from_local(LocalCoordinate local_coordinate) const
+{
+    return project_global(local_coordinate.north_m, local_coordinate.east_m);
+}
+
+void CoordinateTransformation::local_from_global(
+    const double* latitude_deg,
+    const double* longitude_deg,
+    double* north_m,
+    double* east_m,
+    std::size_t count) const
+{
+    // Each point is read before it is written, so input and output can be the same.
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto local = project_local(latitude_deg[i], longitude_deg[i]);
+        north_m[i] = local.north_m;
+        east_m[i] = local.east_m;
+    }
+}
+
+void CoordinateTransformation::global_from_local(
+    const double* north_m,
+    const double* east_m,
+    double* latitude_deg,
+    double* longitude_deg,
+    std::size_t count) const
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto global = project_global(north_m[i], east_m[i]);
+        latitude_deg[i] = global.latitude_deg;
+        longitude_deg[i] = global.longitude_deg;
     }
+}
 
-    return global;
+std::vector<CoordinateTransformation::LocalCoordinate> CoordinateTransformation::local_from_global(
+    const std::vector<GlobalCoordinate>& global_coordinates) const
+{
+    std::vector<LocalCoordinate> local_coordinates;
+    local_coordinates.reserve(global_coordinates.size());
+    for (const auto& global : global_coordinates) {
+        local_coordinates.push_back(project_local(global.latitude_deg, global.longitude_deg));
+    }
+    return local_coordinates;
+}
+
+std::vector<CoordinateTransformation::GlobalCoordinate> CoordinateTransformation::global_from_local(
+    const std::vector<LocalCoordinate>& local_coordinates) const
+{
+    std::vector<GlobalCoordinate> global_coordinates;
+    global_coordinates.reserve(local_coordinates.size());
+    for (const auto& local : local_coordinates) {
+        global_coordinates.push_back(project_global(local.north_m, local.east_m));
+    }
+    return global_coordinates;
 }
 
 } // namespace mavsdk::geometry
@@ -1,8 +1,15 @@
 #include "geometry.h"
+#include "mavsdk_math.h"
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <vector>
+
+using namespace mavsdk;
 using namespace mavsdk::geometry;
 
+static constexpr double world_radius_m{6371000.0};
+
 // Note the tests are quite coarse due to lack of better ground
 // truth. This is mostly to get the ballpark and signs right.
 
@@ -48,3 +55,139 @@ TEST(Geoemtry, LocalToGlobalAndBack)
     EXPECT_NEAR(location.north_m, location_again.north_m, 1e-8);
     EXPECT_NEAR(location.east_m, location_again.east_m, 1e-8);
 }
+
+// The transformations as they were implemented before the reference trigonometry
+// was cached and the batch versions were added, to compare against.
+static CoordinateTransformation::LocalCoordinate reference_local_from_global(
+    CoordinateTransformation::GlobalCoordinate reference,
+    CoordinateTransformation::GlobalCoordinate global_coordinate)
+{
+    const double ref_lat_rad = to_rad_from_deg(reference.latitude_deg);
+    const double ref_lon_rad = to_rad_from_deg(reference.longitude_deg);
+    const double lat_rad = to_rad_from_deg(global_coordinate.latitude_deg);
+    const double lon_rad = to_rad_from_deg(global_coordinate.longitude_deg);
+
+    const double sin_lat = sin(lat_rad);
+    const double cos_lat = cos(lat_rad);
+    const double cos_d_lon = cos(lon_rad - ref_lon_rad);
+    const double ref_sin_lat = sin(ref_lat_rad);
+    const double ref_cos_lat = cos(ref_lat_rad);
+
+    const double arg =
+        constrain(ref_sin_lat * sin_lat + ref_cos_lat * cos_lat * cos_d_lon, -1.0, 1.0);
+    const double c = acos(arg);
+    const double k = (fabs(c) > 0) ? (c / sin(c)) : 1.0;
+
+    return CoordinateTransformation::LocalCoordinate{
+        k * (ref_cos_lat * sin_lat - ref_sin_lat * cos_lat * cos_d_lon) * world_radius_m,
+        k * cos_lat * sin(lon_rad - ref_lon_rad) * world_radius_m};
+}
+
+static CoordinateTransformation::GlobalCoordinate reference_global_from_local(
+    CoordinateTransformation::GlobalCoordinate reference,
+    CoordinateTransformation::LocalCoordinate local_coordinate)
+{
+    const double ref_lat_rad = to_rad_from_deg(reference.latitude_deg);
+    const double ref_lon_rad = to_rad_from_deg(reference.longitude_deg);
+    const double x_rad = local_coordinate.north_m / world_radius_m;
+    const double y_rad = local_coordinate.east_m / world_radius_m;
+    const double c = sqrt(x_rad * x_rad + y_rad * y_rad);
+
+    if (!(fabs(c) > 0)) {
+        return {reference.latitude_deg, reference.longitude_deg};
+    }
+
+    const double sin_c = sin(c);
+    const double cos_c = cos(c);
+    const double ref_sin_lat = sin(ref_lat_rad);
+    const double ref_cos_lat = cos(ref_lat_rad);
+
+    const double lat_rad = asin(cos_c * ref_sin_lat + (x_rad * sin_c * ref_cos_lat) / c);
+    const double lon_rad =
+        (ref_lon_rad +
+         atan2(y_rad * sin_c, c * ref_cos_lat * cos_c - x_rad * ref_sin_lat * sin_c));
+
+    return {to_deg_from_rad(lat_rad), to_deg_from_rad(lon_rad)};
+}
+
+TEST(Geometry, BatchMatchesSingleAndReference)
+{
+    const CoordinateTransformation::GlobalCoordinate reference{47.397742, 8.545594};
+    CoordinateTransformation ct(reference);
+
+    // A survey grid around the reference, from centimeters to far away.
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+    std::vector<double> norths;
+    std::vector<double> easts;
+    for (int i = -50; i <= 50; ++i) {
+        for (int j = -50; j <= 50; ++j) {
+            const double scale = (std::abs(i) + std::abs(j) < 10) ? 1e-7 : 2e-3;
+            latitudes.push_back(reference.latitude_deg + i * scale * 0.9);
+            longitudes.push_back(reference.longitude_deg + j * scale * 1.1);
+            norths.push_back(i * scale * 1e5);
+            easts.push_back(j * scale * 1.3e5);
+        }
+    }
+    latitudes.push_back(reference.latitude_deg);
+    longitudes.push_back(reference.longitude_deg);
+    norths.push_back(0.0);
+    easts.push_back(0.0);
+
+    const auto count = latitudes.size();
+    std::vector<double> batch_norths(count);
+    std::vector<double> batch_easts(count);
+    ct.local_from_global(
+        latitudes.data(), longitudes.data(), batch_norths.data(), batch_easts.data(), count);
+
+    std::vector<double> batch_latitudes(count);
+    std::vector<double> batch_longitudes(count);
+    ct.global_from_local(
+        norths.data(), easts.data(), batch_latitudes.data(), batch_longitudes.data(), count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto single = ct.local_from_global({latitudes[i], longitudes[i]});
+        EXPECT_EQ(batch_norths[i], single.north_m);
+        EXPECT_EQ(batch_easts[i], single.east_m);
+
+        const auto expected = reference_local_from_global(reference, {latitudes[i], longitudes[i]});
+        EXPECT_NEAR(batch_norths[i], expected.north_m, 1e-6);
+        EXPECT_NEAR(batch_easts[i], expected.east_m, 1e-6);
+
+        const auto single_global = ct.global_from_local({norths[i], easts[i]});
+        EXPECT_EQ(batch_latitudes[i], single_global.latitude_deg);
+        EXPECT_EQ(batch_longitudes[i], single_global.longitude_deg);
+
+        const auto expected_global = reference_global_from_local(reference, {norths[i], easts[i]});
+        EXPECT_NEAR(batch_latitudes[i], expected_global.latitude_deg, 1e-12);
+        EXPECT_NEAR(batch_longitudes[i], expected_global.longitude_deg, 1e-12);
+    }
+}
+
+TEST(Geometry, BatchInPlaceAndVectors)
+{
+    CoordinateTransformation ct({-38.227562, 176.506076});
+
+    std::vector<CoordinateTransformation::LocalCoordinate> locals{
+        {-140.0, 240.0}, {0.0, 0.0}, {1500.0, -3.5}};
+    const auto globals = ct.global_from_local(locals);
+    ASSERT_EQ(globals.size(), locals.size());
+
+    std::vector<double> first(locals.size());
+    std::vector<double> second(locals.size());
+    for (std::size_t i = 0; i < locals.size(); ++i) {
+        first[i] = globals[i].latitude_deg;
+        second[i] = globals[i].longitude_deg;
+    }
+
+    // Back to local, writing over the input.
+    ct.local_from_global(first.data(), second.data(), first.data(), second.data(), first.size());
+    const auto locals_again = ct.local_from_global(globals);
+
+    for (std::size_t i = 0; i < locals.size(); ++i) {
+        EXPECT_NEAR(first[i], locals[i].north_m, 1e-8);
+        EXPECT_NEAR(second[i], locals[i].east_m, 1e-8);
+        EXPECT_EQ(locals_again[i].north_m, first[i]);
+        EXPECT_EQ(locals_again[i].east_m, second[i]);
+    }
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <vector>
+
 namespace mavsdk::geometry {
 
 /**
@@ -55,14 +58,74 @@ public:
      */
     [[nodiscard]] GlobalCoordinate global_from_local(LocalCoordinate local_coordinate) const;
 
+    /**
+     * @brief Calculate local coordinates from many global coordinates at once.
+     *
+     * The coordinates are passed as separate arrays of `count` values each. The
+     * output arrays can be the same as the input arrays.
+     *
+     * @param latitude_deg Latitudes to project from.
+     * @param longitude_deg Longitudes to project from.
+     * @param north_m Positions in North direction, output.
+     * @param east_m Positions in East direction, output.
+     * @param count Number of coordinates.
+     */
+    void local_from_global(
+        const double* latitude_deg,
+        const double* longitude_deg,
+        double* north_m,
+        double* east_m,
+        std::size_t count) const;
+
+    /**
+     * @brief Calculate global coordinates from many local coordinates at once.
+     *
+     * The coordinates are passed as separate arrays of `count` values each. The
+     * output arrays can be the same as the input arrays.
+     *
+     * @param north_m Positions in North direction to project from.
+     * @param east_m Positions in East direction to project from.
+     * @param latitude_deg Latitudes, output.
+     * @param longitude_deg Longitudes, output.
+     * @param count Number of coordinates.
+     */
+    void global_from_local(
+        const double* north_m,
+        const double* east_m,
+        double* latitude_deg,
+        double* longitude_deg,
+        std::size_t count) const;
+
+    /**
+     * @brief Calculate local coordinates from a list of global coordinates.
+     *
+     * @param global_coordinates The global coordinates to project from.
+     */
+    [[nodiscard]] std::vector<LocalCoordinate>
+    local_from_global(const std::vector<GlobalCoordinate>& global_coordinates) const;
+
+    /**
+     * @brief Calculate global coordinates from a list of local coordinates.
+     *
+     * @param local_coordinates The local coordinates to project from.
+     */
+    [[nodiscard]] std::vector<GlobalCoordinate>
+    global_from_local(const std::vector<LocalCoordinate>& local_coordinates) const;
+
     /**
      * @brief Destructor.
      */
     ~CoordinateTransformation() = default;
 
 private:
+    LocalCoordinate project_local(double latitude_deg, double longitude_deg) const;
+    GlobalCoordinate project_global(double north_m, double east_m) const;
+
     double _ref_lat_rad;
     double _ref_lon_rad;
+    // Needed for every point, so only calculated once.
+    double _ref_sin_lat;
+    double _ref_cos_lat;
     static constexpr double world_radius_m{6371000.0};
 };
 
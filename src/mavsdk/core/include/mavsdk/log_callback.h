@@ -10,6 +10,10 @@ enum class Level : int { Debug = 0, Info = 1, Warn = 2, Err = 3 };
 
 /** @brief User-defined callback for logging. Returning true from this callback
  * prevents default mavsdk`s logging to stdout. Returning false keeps it.
+ *
+ * The callback is called from mavsdk's logging thread, one message at a time,
+ * unless the environment variable MAVSDK_LOG_SYNC is set to 1, in which case
+ * it's called from the thread which logged.
  */
 using Callback =
     std::function<bool(Level level, const std::string& message, const std::string& file, int line)>;
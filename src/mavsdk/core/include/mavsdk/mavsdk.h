@@ -1,7 +1,10 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <string>
 #include <memory>
+#include <utility>
 #include <vector>
 #include <functional>
 
@@ -72,17 +75,22 @@ public:
     /**
      * @brief Adds Connection via URL
      *
-     * Supports connection: Serial, TCP or UDP.
+     * Supports connection: Serial, TCP, UDP or a recorded telemetry log (tlog) file.
      * Connection URL format should be:
      * - UDP:    udp://[host][:bind_port]
      * - TCP:    tcp://[host][:remote_port]
      * - Serial: serial://dev_node[:baudrate]
+     * - File:   file://path[?speed=factor]
      *
      * For UDP, the host can be set to either:
      *   - zero IP: 0.0.0.0 -> behave like a server and listen for heartbeats.
      *   - some IP: 192.168.1.12 -> behave like a client, initiate connection
      *     and start sending heartbeats.
      *
+     * For files, the recorded traffic is played back with its original timing,
+     * scaled by the speed factor (default 1). A speed of 0 plays it back as fast
+     * as possible.
+     *
      * @param connection_url connection URL string.
      * @param forwarding_option message forwarding option (when multiple interfaces are used).
      * @return The result of adding the connection.
@@ -163,6 +171,243 @@ public:
         bool flow_control = false,
         ForwardingOption forwarding_option = ForwardingOption::ForwardingOff);
 
+    /**
+     * @brief Tuning options for serial connections.
+     */
+    struct SerialOptions {
+        /**
+         * @brief Minimum number of bytes a read waits for (VMIN).
+         *
+         * 0 returns as soon as any data is available. Higher values mean fewer
+         * wakeups on busy high baudrate links at the cost of latency.
+         */
+        unsigned read_min_bytes{0};
+        /** @brief Inter-byte read timeout (VTIME) in tenths of a second. */
+        unsigned read_timeout_ds{10};
+        /** @brief Ask the driver to pass on data right away (ASYNC_LOW_LATENCY, Linux only). */
+        bool low_latency{true};
+        /**
+         * @brief Queue outgoing frames and write whatever is queued at once.
+         *
+         * This replaces a write syscall per message by one per batch of messages,
+         * at the cost of a thread and frames being dropped if the queue fills up.
+         */
+        bool coalesce_writes{false};
+    };
+
+    /**
+     * @brief Adds a serial connection with tuning options.
+     *
+     * @param dev_path COM or UART dev node name/path (e.g. "/dev/ttyS0", or "COM3" on Windows).
+     * @param baudrate Baudrate of the serial port.
+     * @param flow_control enable/disable flow control.
+     * @param forwarding_option message forwarding option (when multiple interfaces are used).
+     * @param serial_options read and write tuning options.
+     * @return The result of adding the connection.
+     */
+    ConnectionResult add_serial_connection(
+        const std::string& dev_path,
+        int baudrate,
+        bool flow_control,
+        ForwardingOption forwarding_option,
+        const SerialOptions& serial_options);
+
+    /**
+     * @brief Traffic statistics of a connection.
+     */
+    struct ConnectionStatistics {
+        /** @brief Connection description, e.g. serial:///dev/ttyS0:921600 */
+        std::string connection{};
+        uint64_t bytes_received{0}; /**< @brief Bytes received in total. */
+        uint64_t bytes_sent{0}; /**< @brief Bytes sent in total. */
+        uint64_t frames_received{0}; /**< @brief MAVLink frames received in total. */
+        uint64_t frames_sent{0}; /**< @brief MAVLink frames sent in total. */
+        uint64_t send_errors{0}; /**< @brief Frames which could not be written or were dropped. */
+        uint64_t parse_errors{0}; /**< @brief Frames dropped because of bad CRC or framing. */
+        /** @brief Frames lost according to sequence numbers, the sum of link_quality() losses. */
+        uint64_t dropped_sequence_numbers{0};
+        double bytes_received_per_s{0.0}; /**< @brief Receive rate in bytes/s. */
+        double bytes_sent_per_s{0.0}; /**< @brief Send rate in bytes/s. */
+        double frames_received_per_s{0.0}; /**< @brief Receive rate in frames/s. */
+        double frames_sent_per_s{0.0}; /**< @brief Send rate in frames/s. */
+    };
+
+    /**
+     * @brief Get traffic statistics of all connections.
+     *
+     * The rates are averaged since the previous call, but over at least one second.
+     *
+     * @return The statistics, one entry per connection in the order they were added.
+     */
+    std::vector<ConnectionStatistics> connection_statistics() const;
+
+    /**
+     * @brief How to send messages to a system which is reachable over more than one connection.
+     *
+     * Copies of the same message arriving over redundant connections are only
+     * processed once, regardless of this policy.
+     */
+    enum class RedundantLinkPolicy {
+        SendOnAllLinks, /**< @brief Send on every connection the system was seen on (default). */
+        SendOnBestLink, /**< @brief Send only on the connection which currently works best. */
+    };
+
+    /**
+     * @brief Set how to send messages to systems reachable over redundant connections.
+     *
+     * @param policy The policy to use.
+     */
+    void set_redundant_link_policy(RedundantLinkPolicy policy);
+
+    /**
+     * @brief Quality of the traffic from one component over one connection.
+     *
+     * It is derived from the sequence numbers of the MAVLink frames the
+     * component sends, so it is available without any extra traffic.
+     */
+    struct LinkQuality {
+        std::string connection{}; /**< @brief Connection description, e.g. udp://0.0.0.0:14540 */
+        uint8_t system_id{0}; /**< @brief System the traffic comes from. */
+        uint8_t component_id{0}; /**< @brief Component the traffic comes from. */
+        uint64_t frames_received{0}; /**< @brief Frames received in total. */
+        uint64_t frames_lost{0}; /**< @brief Frames that never arrived in total. */
+        uint64_t frames_reordered{0}; /**< @brief Frames that arrived late in total. */
+        uint64_t frames_duplicate{0}; /**< @brief Frames that arrived twice in total. */
+        float loss_ratio{0.0f}; /**< @brief Share of the frames sent that got lost. */
+        float reorder_ratio{0.0f}; /**< @brief Share of the frames sent that arrived late. */
+        float duplicate_ratio{0.0f}; /**< @brief Share of the frames received twice. */
+        float jitter_s{0.0f}; /**< @brief Variation of the time between frames in seconds. */
+        bool active{false}; /**< @brief Whether frames arrived recently. */
+    };
+
+    /**
+     * @brief Get the quality of the traffic from each component over each connection.
+     *
+     * The ratios are updated once per second and smoothed over a few seconds.
+     *
+     * @return The quality, one entry per component and connection it was seen on.
+     */
+    std::vector<LinkQuality> link_quality() const;
+
+    /**
+     * @brief Callback type for link quality updates.
+     */
+    using LinkQualityCallback = std::function<void(std::vector<LinkQuality>)>;
+
+    /**
+     * @brief Subscribe to link quality updates, delivered once per second.
+     *
+     * @note Only one subscriber is possible at any time. On a second
+     * subscription, the previous one is overwritten. To unsubscribe, pass nullptr.
+     *
+     * @param callback Callback to subscribe.
+     */
+    void subscribe_link_quality(const LinkQualityCallback& callback);
+
+    /**
+     * @brief MAVLink 2 message signing options of a connection.
+     */
+    struct SigningOptions {
+        std::array<uint8_t, 32> secret_key{}; /**< @brief Key shared with the other side. */
+        uint8_t link_id{0}; /**< @brief Link ID sent in the signature of outgoing messages. */
+        bool sign_outgoing{true}; /**< @brief Whether to sign outgoing messages. */
+        bool accept_unsigned{false}; /**< @brief Whether to accept unsigned messages. */
+    };
+
+    /**
+     * @brief Enable MAVLink 2 message signing on a connection.
+     *
+     * Incoming messages with a wrong signature, or a timestamp which was seen
+     * already, are dropped and counted as parse errors. Unsigned RADIO_STATUS
+     * messages are always accepted.
+     *
+     * @param connection Connection description, as in ConnectionStatistics.
+     * @param options The key and what to sign and accept.
+     * @return true if the connection was found.
+     */
+    bool enable_signing(const std::string& connection, const SigningOptions& options);
+
+    /**
+     * @brief Disable MAVLink 2 message signing on a connection.
+     *
+     * @param connection Connection description, as in ConnectionStatistics.
+     * @return true if the connection was found.
+     */
+    bool disable_signing(const std::string& connection);
+
+    /**
+     * @brief Start recording all MAVLink traffic to a telemetry log (tlog) file.
+     *
+     * Received and sent messages are recorded with the time they were received
+     * or sent. The file can be opened with other tools that read tlogs, or played
+     * back using a file:// connection URL.
+     *
+     * @param path Path of the file, an existing file is overwritten.
+     * @return true if recording started.
+     */
+    bool start_tlog_recording(const std::string& path);
+
+    /**
+     * @brief Stop recording and close the tlog file.
+     */
+    void stop_tlog_recording();
+
+    /**
+     * @brief Internal metric of MAVSDK, e.g. the number of messages received of a type.
+     */
+    struct Metric {
+        /**
+         * @brief Kind of metric, as in Prometheus.
+         */
+        enum class Type {
+            Counter, /**< @brief Only ever goes up. */
+            Gauge, /**< @brief Goes up and down. */
+            Histogram, /**< @brief Distribution of observed values. */
+        };
+
+        std::string name{}; /**< @brief Name, e.g. mavsdk_messages_received_total. */
+        std::string help{}; /**< @brief What is measured. */
+        Type type{Type::Counter}; /**< @brief Kind of metric. */
+        /** @brief Labels such as {"msgid", "0"}, telling same named metrics apart. */
+        std::vector<std::pair<std::string, std::string>> labels{};
+        double value{0.0}; /**< @brief Counter or gauge value, or sum of a histogram. */
+        uint64_t count{0}; /**< @brief Number of values observed by a histogram. */
+        /** @brief Histogram upper bounds and number of values up to each. */
+        std::vector<std::pair<double, uint64_t>> buckets{};
+    };
+
+    /**
+     * @brief Get the internal metrics of MAVSDK.
+     *
+     * These are counters of messages by type and by connection, as well as
+     * timeouts and retries of the command, parameter and mission protocols,
+     * and how long callbacks wait and take. Durations are in seconds.
+     *
+     * Except for what belongs to a connection, the metrics are shared by all
+     * Mavsdk instances in the process.
+     *
+     * @return All metrics, with the same named ones next to each other.
+     */
+    std::vector<Metric> metrics() const;
+
+    /**
+     * @brief Get the internal metrics in the Prometheus text format.
+     *
+     * @return The metrics as in metrics(), formatted for Prometheus.
+     */
+    std::string metrics_prometheus() const;
+
+    /**
+     * @brief Write the internal metrics in the Prometheus text format to a file.
+     *
+     * The file is replaced at once, so it can be picked up by e.g. the textfile
+     * collector of the Prometheus node exporter at any time.
+     *
+     * @param path Path of the file, an existing file is overwritten.
+     * @return true if the file was written.
+     */
+    bool write_metrics_prometheus(const std::string& path) const;
+
     /**
      * @brief Get a vector of systems which have been discovered or set-up.
      *
@@ -247,11 +492,28 @@ public:
          */
         void set_usage_type(UsageType usage_type);
 
+        /**
+         * @brief Get the directory in which downloaded metadata is cached.
+         * @return the directory, empty if the cache is disabled
+         */
+        std::string get_metadata_cache_directory() const;
+
+        /**
+         * @brief Set the directory in which downloaded metadata such as camera
+         * definitions is cached, so it is not downloaded again on every connect.
+         *
+         * The cache is disabled by default. It is created if it does not exist.
+         *
+         * @param directory the directory, e.g. ~/.cache/mavsdk, or empty to disable the cache
+         */
+        void set_metadata_cache_directory(const std::string& directory);
+
     private:
         uint8_t _system_id;
         uint8_t _component_id;
         bool _always_send_heartbeats;
         UsageType _usage_type;
+        std::string _metadata_cache_directory{};
 
         static Mavsdk::Configuration::UsageType usage_type_for_component(uint8_t component_id);
     };
@@ -26,6 +26,18 @@ public:
      */
     ~ServerComponent() = default;
 
+    /**
+     * @brief Limit the bandwidth used by the message streams of this component.
+     *
+     * Streams are the messages sent at the rate requested with
+     * MAV_CMD_SET_MESSAGE_INTERVAL. If they don't fit into the budget, the ones of
+     * lowest priority are sent less often. As every link carries all messages,
+     * the budget applies to each link.
+     *
+     * @param bytes_per_second Budget in bytes per second, 0 for no limit (default).
+     */
+    void set_stream_bandwidth_budget(double bytes_per_second);
+
 private:
     std::shared_ptr<ServerComponentImpl> _impl;
 
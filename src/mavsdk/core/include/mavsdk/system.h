@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <array>
+#include <cstdint>
 #include <functional>
 #include <vector>
 
@@ -147,9 +148,54 @@ public:
 
     /**
      * @brief Enable time synchronization using the TIMESYNC messages.
+     *
+     * The offset and drift of the autopilot clock are estimated from the exchanges with
+     * the lowest round trip times. Timestamps sent to the autopilot, e.g. by the Mocap
+     * plugin, are then converted to the autopilot clock.
      */
     void enable_timesync();
 
+    /**
+     * @brief Statistics of the time synchronization, see `enable_timesync()`.
+     */
+    struct TimesyncStatistics {
+        bool converged{false}; /**< @brief Whether the clock model has converged. */
+        double offset_s{0.0}; /**< @brief Autopilot time minus local time. */
+        double skew_ppm{0.0}; /**< @brief How much faster the autopilot clock runs. */
+        double min_round_trip_time_s{0.0}; /**< @brief Lowest recent round trip time. */
+        double residual_s{0.0}; /**< @brief Mean deviation of the samples from the model. */
+        uint64_t samples_accepted{0}; /**< @brief Exchanges used for the model. */
+        uint64_t samples_rejected_rtt{0}; /**< @brief Exchanges with a high round trip time. */
+        uint64_t samples_rejected_outlier{0}; /**< @brief Exchanges not fitting the model. */
+        uint64_t resets{0}; /**< @brief Times the model started over as the clock jumped. */
+        double time_to_converge_s{-1.0}; /**< @brief Time to converge, negative if not yet. */
+    };
+
+    /**
+     * @brief Get the statistics of the time synchronization.
+     *
+     * @return the statistics.
+     */
+    TimesyncStatistics timesync_statistics() const;
+
+    /**
+     * @brief Convert a local time to the autopilot clock.
+     *
+     * Without time synchronization the clocks are assumed to be the same.
+     *
+     * @param local_time_usec Local system time in microseconds since the epoch.
+     * @return the autopilot time in microseconds.
+     */
+    uint64_t autopilot_time_usec(uint64_t local_time_usec) const;
+
+    /**
+     * @brief Convert an autopilot time to the local clock.
+     *
+     * @param autopilot_time_usec Autopilot time in microseconds.
+     * @return the local system time in microseconds since the epoch.
+     */
+    uint64_t local_time_usec(uint64_t autopilot_time_usec) const;
+
     /**
      * @brief Copy constructor (object is not copyable).
      */
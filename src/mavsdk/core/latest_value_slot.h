@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace mavsdk {
+
+// Hands the latest value from exactly one producer to exactly one consumer
+// thread, e.g. samples of which only the newest one matters.
+//
+// It is a triple buffer: the producer writes into a buffer of its own and then
+// swaps it with the one in the middle, the consumer swaps the one in the middle
+// with its own when there is a new value. Neither side ever waits for the other
+// or allocates, and a value which is overwritten before it is taken is reported
+// to the producer.
+template<typename T> class LatestValueSlot {
+public:
+    LatestValueSlot() = default;
+    ~LatestValueSlot() = default;
+
+    // Producer side, returns true if the previous value was never taken.
+    bool store(const T& value)
+    {
+        _buffers[_back] = value;
+        const auto previous = _middle.exchange(_back | FRESH, std::memory_order_acq_rel);
+        _back = previous & INDEX_MASK;
+        return (previous & FRESH) != 0;
+    }
+
+    // Consumer side, returns false if nothing was stored since it last took a value.
+    bool take(T& value)
+    {
+        if ((_middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+            return false;
+        }
+        const auto previous = _middle.exchange(_front, std::memory_order_acq_rel);
+        _front = previous & INDEX_MASK;
+        value = _buffers[_front];
+        return true;
+    }
+
+    [[nodiscard]] bool has_value() const
+    {
+        return (_middle.load(std::memory_order_relaxed) & FRESH) != 0;
+    }
+
+    // Non-copyable
+    LatestValueSlot(const LatestValueSlot&) = delete;
+    const LatestValueSlot& operator=(const LatestValueSlot&) = delete;
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    std::array<T, 3> _buffers{};
+    // Index of the buffer in the middle, and whether it holds a value not taken yet.
+    std::atomic<uint8_t> _middle{1};
+    // Owned by the producer and the consumer respectively.
+    uint8_t _back{0};
+    uint8_t _front{2};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,87 @@
+#include "latest_value_slot.h"
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <thread>
+
+using namespace mavsdk;
+
+TEST(LatestValueSlot, TakesLatestValue)
+{
+    LatestValueSlot<int> slot;
+    int value = 0;
+
+    EXPECT_FALSE(slot.has_value());
+    EXPECT_FALSE(slot.take(value));
+
+    EXPECT_FALSE(slot.store(1));
+    EXPECT_TRUE(slot.has_value());
+    EXPECT_TRUE(slot.take(value));
+    EXPECT_EQ(value, 1);
+
+    // Taken already
+    EXPECT_FALSE(slot.take(value));
+    EXPECT_EQ(value, 1);
+}
+
+TEST(LatestValueSlot, ReportsOverwrittenValues)
+{
+    LatestValueSlot<int> slot;
+    int value = 0;
+
+    EXPECT_FALSE(slot.store(1));
+    EXPECT_TRUE(slot.store(2));
+    EXPECT_TRUE(slot.store(3));
+    EXPECT_TRUE(slot.take(value));
+    EXPECT_EQ(value, 3);
+
+    EXPECT_FALSE(slot.store(4));
+    EXPECT_TRUE(slot.take(value));
+    EXPECT_EQ(value, 4);
+}
+
+TEST(LatestValueSlot, NeverTearsValuesAcrossThreads)
+{
+    // All elements are the same, a mix of two values would show up as a difference.
+    using Sample = std::array<unsigned, 32>;
+    LatestValueSlot<Sample> slot;
+    constexpr unsigned num_values = 100000;
+    std::atomic<bool> done{false};
+
+    unsigned num_overwritten = 0;
+    std::thread producer([&]() {
+        Sample sample;
+        for (unsigned i = 1; i <= num_values; ++i) {
+            sample.fill(i);
+            if (slot.store(sample)) {
+                ++num_overwritten;
+            }
+        }
+        done = true;
+    });
+
+    unsigned num_taken = 0;
+    unsigned last = 0;
+    bool consistent = true;
+    bool increasing = true;
+    Sample sample;
+    while (!done || slot.has_value()) {
+        if (!slot.take(sample)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ++num_taken;
+        for (const auto element : sample) {
+            consistent = consistent && (element == sample[0]);
+        }
+        increasing = increasing && (sample[0] > last);
+        last = sample[0];
+    }
+    producer.join();
+
+    EXPECT_TRUE(consistent);
+    EXPECT_TRUE(increasing);
+    EXPECT_EQ(last, num_values);
+    EXPECT_EQ(num_taken + num_overwritten, num_values);
+}
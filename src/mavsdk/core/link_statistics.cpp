@@ -0,0 +1,85 @@
+#include "link_statistics.h"
+#include "metrics.h"
+
+namespace mavsdk {
+
+LinkStatistics::LinkStatistics(Time& time) : _time(time)
+{
+    _rates_since = _time.steady_time();
+}
+
+void LinkStatistics::add_received_bytes(std::size_t num_bytes)
+{
+    _bytes_received.fetch_add(num_bytes, std::memory_order_relaxed);
+}
+
+void LinkStatistics::add_received_frame(const mavlink_message_t& message)
+{
+    _frames_received.fetch_add(1, std::memory_order_relaxed);
+
+    const auto result = _sequence_tracker.add_frame(message, _time.steady_time());
+    if (result.gap > 0) {
+        const auto source = static_cast<uint32_t>((message.sysid << 8) | message.compid);
+        Metrics::instance().sequence_gaps.add(source, result.gap);
+    }
+}
+
+void LinkStatistics::add_parse_errors(unsigned num_errors)
+{
+    _parse_errors.fetch_add(num_errors, std::memory_order_relaxed);
+}
+
+void LinkStatistics::add_sent_frame(std::size_t num_bytes)
+{
+    add_sent_frames(1, num_bytes);
+}
+
+void LinkStatistics::add_sent_frames(unsigned num_frames, std::size_t num_bytes)
+{
+    _bytes_sent.fetch_add(num_bytes, std::memory_order_relaxed);
+    _frames_sent.fetch_add(num_frames, std::memory_order_relaxed);
+}
+
+void LinkStatistics::add_send_errors(unsigned num_frames)
+{
+    _send_errors.fetch_add(num_frames, std::memory_order_relaxed);
+}
+
+LinkStatistics::Snapshot LinkStatistics::snapshot()
+{
+    Snapshot snapshot;
+    snapshot.bytes_received = _bytes_received.load(std::memory_order_relaxed);
+    snapshot.bytes_sent = _bytes_sent.load(std::memory_order_relaxed);
+    snapshot.frames_received = _frames_received.load(std::memory_order_relaxed);
+    snapshot.frames_sent = _frames_sent.load(std::memory_order_relaxed);
+    snapshot.send_errors = _send_errors.load(std::memory_order_relaxed);
+    snapshot.parse_errors = _parse_errors.load(std::memory_order_relaxed);
+    snapshot.dropped_sequence_numbers = _sequence_tracker.frames_lost();
+
+    std::lock_guard<std::mutex> lock(_rates_mutex);
+
+    const double elapsed_s = _time.elapsed_since_s(_rates_since);
+    if (elapsed_s >= 1.0) {
+        _last_rates.bytes_received_per_s =
+            static_cast<double>(snapshot.bytes_received - _rates_base.bytes_received) / elapsed_s;
+        _last_rates.bytes_sent_per_s =
+            static_cast<double>(snapshot.bytes_sent - _rates_base.bytes_sent) / elapsed_s;
+        _last_rates.frames_received_per_s =
+            static_cast<double>(snapshot.frames_received - _rates_base.frames_received) /
+            elapsed_s;
+        _last_rates.frames_sent_per_s =
+            static_cast<double>(snapshot.frames_sent - _rates_base.frames_sent) / elapsed_s;
+
+        _rates_base = snapshot;
+        _rates_since = _time.steady_time();
+    }
+
+    snapshot.bytes_received_per_s = _last_rates.bytes_received_per_s;
+    snapshot.bytes_sent_per_s = _last_rates.bytes_sent_per_s;
+    snapshot.frames_received_per_s = _last_rates.frames_received_per_s;
+    snapshot.frames_sent_per_s = _last_rates.frames_sent_per_s;
+
+    return snapshot;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include "mavlink_sequence_tracker.h"
+#include "mavsdk_time.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace mavsdk {
+
+// Traffic counters of one connection. The receive side is only ever updated
+// from the connection's receive thread, the send side from any thread.
+class LinkStatistics {
+public:
+    struct Snapshot {
+        uint64_t bytes_received{0};
+        uint64_t bytes_sent{0};
+        uint64_t frames_received{0};
+        uint64_t frames_sent{0};
+        uint64_t send_errors{0};
+        uint64_t parse_errors{0};
+        // Taken from the sequence tracker, so late frames are not counted as lost.
+        uint64_t dropped_sequence_numbers{0};
+        double bytes_received_per_s{0.0};
+        double bytes_sent_per_s{0.0};
+        double frames_received_per_s{0.0};
+        double frames_sent_per_s{0.0};
+    };
+
+    explicit LinkStatistics(Time& time);
+    ~LinkStatistics() = default;
+
+    void add_received_bytes(std::size_t num_bytes);
+    void add_received_frame(const mavlink_message_t& message);
+    void add_parse_errors(unsigned num_errors);
+    void add_sent_frame(std::size_t num_bytes);
+    void add_sent_frames(unsigned num_frames, std::size_t num_bytes);
+    void add_send_errors(unsigned num_frames);
+
+    // Rates are averaged since the previous snapshot, but over at least a second.
+    Snapshot snapshot();
+
+    // Loss, reorder and duplicate ratios and jitter per source, see MavlinkSequenceTracker.
+    void evaluate_sources() { _sequence_tracker.evaluate(); }
+    std::vector<MavlinkSequenceTracker::SourceQuality> source_qualities() const
+    {
+        return _sequence_tracker.source_qualities();
+    }
+
+    // Non-copyable
+    LinkStatistics(const LinkStatistics&) = delete;
+    const LinkStatistics& operator=(const LinkStatistics&) = delete;
+
+private:
+    std::atomic<uint64_t> _bytes_received{0};
+    std::atomic<uint64_t> _bytes_sent{0};
+    std::atomic<uint64_t> _frames_received{0};
+    std::atomic<uint64_t> _frames_sent{0};
+    std::atomic<uint64_t> _send_errors{0};
+    std::atomic<uint64_t> _parse_errors{0};
+
+    MavlinkSequenceTracker _sequence_tracker{};
+
+    Time& _time;
+
+    std::mutex _rates_mutex{};
+    dl_time_t _rates_since{};
+    Snapshot _rates_base{};
+    Snapshot _last_rates{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,103 @@
+#include "link_statistics.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+static mavlink_message_t make_message(uint8_t sysid, uint8_t compid, uint8_t seq)
+{
+    mavlink_message_t message{};
+    message.sysid = sysid;
+    message.compid = compid;
+    message.seq = seq;
+    return message;
+}
+
+TEST(LinkStatistics, CountsDroppedSequenceNumbersPerSource)
+{
+    FakeTime time;
+    LinkStatistics statistics(time);
+
+    statistics.add_received_frame(make_message(1, 1, 10));
+    statistics.add_received_frame(make_message(1, 1, 11));
+    // Another source with its own sequence.
+    statistics.add_received_frame(make_message(1, 100, 200));
+    statistics.add_received_frame(make_message(1, 1, 14));
+    statistics.add_received_frame(make_message(1, 100, 201));
+
+    const auto snapshot = statistics.snapshot();
+    EXPECT_EQ(snapshot.frames_received, 5);
+    EXPECT_EQ(snapshot.dropped_sequence_numbers, 2);
+}
+
+TEST(LinkStatistics, HandlesSequenceWrapAndDuplicates)
+{
+    FakeTime time;
+    LinkStatistics statistics(time);
+
+    statistics.add_received_frame(make_message(1, 1, 254));
+    statistics.add_received_frame(make_message(1, 1, 255));
+    statistics.add_received_frame(make_message(1, 1, 1));
+    // A duplicate is not counted as loss of a whole sequence cycle.
+    statistics.add_received_frame(make_message(1, 1, 1));
+    statistics.add_received_frame(make_message(1, 1, 2));
+
+    EXPECT_EQ(statistics.snapshot().dropped_sequence_numbers, 1);
+}
+
+TEST(LinkStatistics, ComputesRates)
+{
+    FakeTime time;
+    LinkStatistics statistics(time);
+
+    statistics.add_received_bytes(1000);
+    statistics.add_sent_frame(50);
+    statistics.add_sent_frame(50);
+
+    // Not a second yet, so no rates.
+    auto snapshot = statistics.snapshot();
+    EXPECT_EQ(snapshot.bytes_received, 1000);
+    EXPECT_EQ(snapshot.bytes_sent, 100);
+    EXPECT_EQ(snapshot.frames_sent, 2);
+    EXPECT_DOUBLE_EQ(snapshot.bytes_received_per_s, 0.0);
+
+    time.sleep_for(std::chrono::seconds(2));
+
+    snapshot = statistics.snapshot();
+    EXPECT_NEAR(snapshot.bytes_received_per_s, 500.0, 1.0);
+    EXPECT_NEAR(snapshot.frames_sent_per_s, 1.0, 0.01);
+}
+
+TEST(LinkStatistics, CountsBatchesAndSendErrors)
+{
+    FakeTime time;
+    LinkStatistics statistics(time);
+
+    statistics.add_sent_frames(3, 120);
+    statistics.add_send_errors(2);
+
+    const auto snapshot = statistics.snapshot();
+    EXPECT_EQ(snapshot.frames_sent, 3);
+    EXPECT_EQ(snapshot.bytes_sent, 120);
+    EXPECT_EQ(snapshot.send_errors, 2);
+}
+
+TEST(LinkStatistics, AgreesWithSourceQualities)
+{
+    FakeTime time;
+    LinkStatistics statistics(time);
+
+    statistics.add_received_frame(make_message(1, 1, 10));
+    statistics.add_received_frame(make_message(1, 1, 13));
+    statistics.add_received_frame(make_message(1, 100, 50));
+    statistics.add_received_frame(make_message(1, 100, 52));
+    // Arrives late, so it was not lost after all.
+    statistics.add_received_frame(make_message(1, 1, 11));
+    statistics.evaluate_sources();
+
+    uint64_t frames_lost = 0;
+    for (const auto& source : statistics.source_qualities()) {
+        frames_lost += source.frames_lost;
+    }
+    EXPECT_EQ(frames_lost, 2);
+    EXPECT_EQ(statistics.snapshot().dropped_sequence_numbers, frames_lost);
+}
@@ -1,4 +1,5 @@
 #include "log.h"
+#include "async_log_writer.h"
 #include "unused.h"
 
 #if defined(WINDOWS)
@@ -32,6 +33,94 @@ void log::subscribe(const log::Callback& callback)
     callback_ = callback;
 }
 
+// Appends to a string which keeps its capacity from one log line to the next.
+class LogStringBuf : public std::streambuf {
+public:
+    std::string text{};
+
+protected:
+    int_type overflow(int_type c) override
+    {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            text.push_back(traits_type::to_char_type(c));
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override
+    {
+        text.append(s, static_cast<std::size_t>(n));
+        return n;
+    }
+};
+
+class LogBuffer {
+public:
+    LogBuffer() : stream(&string_buf) { string_buf.text.reserve(256); }
+
+    void reset()
+    {
+        string_buf.text.clear();
+        // Like a new stream, so manipulators don't leak from the previous line.
+        stream.clear();
+        stream.flags(std::ios_base::dec | std::ios_base::skipws);
+        stream.precision(6);
+        stream.width(0);
+        stream.fill(' ');
+    }
+
+    LogStringBuf string_buf{};
+    std::ostream stream;
+};
+
+namespace {
+
+struct ThreadLogBuffer {
+    LogBuffer buffer{};
+    bool in_use{false};
+};
+
+thread_local ThreadLogBuffer thread_log_buffer{};
+
+LogBuffer* acquire_log_buffer(std::unique_ptr<LogBuffer>& own_buffer)
+{
+    if (thread_log_buffer.in_use) {
+        own_buffer = std::make_unique<LogBuffer>();
+        return own_buffer.get();
+    }
+    thread_log_buffer.in_use = true;
+    thread_log_buffer.buffer.reset();
+    return &thread_log_buffer.buffer;
+}
+
+} // namespace
+
+LogDetailed::LogDetailed(const char* filename, int filenumber) :
+    _own_buffer(),
+    _buffer(acquire_log_buffer(_own_buffer)),
+    _stream(_buffer->stream),
+    _caller_filename(filename),
+    _caller_filenumber(filenumber)
+{}
+
+LogDetailed::~LogDetailed()
+{
+    const std::string& message = _buffer->string_buf.text;
+
+    if (AsyncLogWriter::instance_available()) {
+        AsyncLogWriter::instance().push(
+            _log_level, _caller_filename, _caller_filenumber, message);
+    } else {
+        // Too late for the background thread during static destruction.
+        AsyncLogWriter::write(AsyncLogWriter::Record{
+            _log_level, std::time(nullptr), _caller_filename, _caller_filenumber, message});
+    }
+
+    if (!_own_buffer) {
+        thread_log_buffer.in_use = false;
+    }
+}
+
 void set_color(Color color)
 {
 #if defined(WINDOWS)
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <sstream>
 #include "log_callback.h"
 
@@ -20,10 +21,21 @@
 
 #define call_user_callback(...) call_user_callback_located(FILENAME, __LINE__, __VA_ARGS__)
 
-#define LogDebug() LogDebugDetailed(FILENAME, __LINE__)
-#define LogInfo() LogInfoDetailed(FILENAME, __LINE__)
-#define LogWarn() LogWarnDetailed(FILENAME, __LINE__)
-#define LogErr() LogErrDetailed(FILENAME, __LINE__)
+#ifndef MAVSDK_LOG_MIN_LEVEL
+// Levels below this are compiled out: 0 Debug, 1 Info, 2 Warn, 3 Err.
+#define MAVSDK_LOG_MIN_LEVEL 0
+#endif
+
+// The stream arguments are not evaluated at all if the level is compiled out.
+#define MAVSDK_LOG_IF_COMPILED_IN(level, detailed) \
+    !mavsdk::log_level_compiled_in(mavsdk::log::Level::level) ? \
+        (void)0 : \
+        mavsdk::LogVoidify() & mavsdk::detailed(FILENAME, __LINE__)
+
+#define LogDebug() MAVSDK_LOG_IF_COMPILED_IN(Debug, LogDebugDetailed)
+#define LogInfo() MAVSDK_LOG_IF_COMPILED_IN(Info, LogInfoDetailed)
+#define LogWarn() MAVSDK_LOG_IF_COMPILED_IN(Warn, LogWarnDetailed)
+#define LogErr() MAVSDK_LOG_IF_COMPILED_IN(Err, LogErrDetailed)
 
 namespace mavsdk {
 
@@ -31,94 +43,28 @@ enum class Color { Red, Green, Yellow, Blue, Gray, Reset };
 
 void set_color(Color color);
 
+constexpr bool log_level_compiled_in(log::Level level)
+{
+    return static_cast<int>(level) >= MAVSDK_LOG_MIN_LEVEL;
+}
+
+class LogBuffer;
+
+// Formats one log line and hands it to the AsyncLogWriter when it goes out of scope.
+//
+// The line is formatted into a buffer which is kept per thread, so logging
+// doesn't allocate once the buffer has grown to fit.
 class LogDetailed {
 public:
-    LogDetailed(const char* filename, int filenumber) :
-        _s(),
-        _caller_filename(filename),
-        _caller_filenumber(filenumber)
-    {}
+    LogDetailed(const char* filename, int filenumber);
 
     template<typename T> LogDetailed& operator<<(const T& x)
     {
-        _s << x;
+        _stream << x;
         return *this;
     }
 
-    virtual ~LogDetailed()
-    {
-        if (log::get_callback() &&
-            log::get_callback()(_log_level, _s.str(), _caller_filename, _caller_filenumber)) {
-            return;
-        }
-
-#if ANDROID
-        switch (_log_level) {
-            case log::Level::Debug:
-                __android_log_print(ANDROID_LOG_DEBUG, "Mavsdk", "%s", _s.str().c_str());
-                break;
-            case log::Level::Info:
-                __android_log_print(ANDROID_LOG_INFO, "Mavsdk", "%s", _s.str().c_str());
-                break;
-            case log::Level::Warn:
-                __android_log_print(ANDROID_LOG_WARN, "Mavsdk", "%s", _s.str().c_str());
-                break;
-            case log::Level::Err:
-                __android_log_print(ANDROID_LOG_ERROR, "Mavsdk", "%s", _s.str().c_str());
-                break;
-        }
-        // Unused:
-        (void)_caller_filename;
-        (void)_caller_filenumber;
-#else
-
-        switch (_log_level) {
-            case log::Level::Debug:
-                set_color(Color::Green);
-                break;
-            case log::Level::Info:
-                set_color(Color::Blue);
-                break;
-            case log::Level::Warn:
-                set_color(Color::Yellow);
-                break;
-            case log::Level::Err:
-                set_color(Color::Red);
-                break;
-        }
-
-        // Time output taken from:
-        // https://stackoverflow.com/questions/16357999#answer-16358264
-        time_t rawtime;
-        time(&rawtime);
-        struct tm* timeinfo = localtime(&rawtime);
-        char time_buffer[10]{}; // We need 8 characters + \0
-        strftime(time_buffer, sizeof(time_buffer), "%I:%M:%S", timeinfo);
-        std::cout << "[" << time_buffer;
-
-        switch (_log_level) {
-            case log::Level::Debug:
-                std::cout << "|Debug] ";
-                break;
-            case log::Level::Info:
-                std::cout << "|Info ] ";
-                break;
-            case log::Level::Warn:
-                std::cout << "|Warn ] ";
-                break;
-            case log::Level::Err:
-                std::cout << "|Error] ";
-                break;
-        }
-
-        set_color(Color::Reset);
-
-        std::cout << _s.str();
-        std::cout << " (" << _caller_filename << ":" << std::dec << _caller_filenumber << ")";
-
-        std::cout << '\n';
-#endif
-    }
+    virtual ~LogDetailed();
 
     LogDetailed(const mavsdk::LogDetailed&) = delete;
     void operator=(const mavsdk::LogDetailed&) = delete;
@@ -127,11 +73,20 @@ protected:
     log::Level _log_level = log::Level::Debug;
 
 private:
-    std::stringstream _s;
+    // Only used if the thread's buffer is taken already, e.g. when logging
+    // while formatting another log line.
+    std::unique_ptr<LogBuffer> _own_buffer;
+    LogBuffer* _buffer;
+    std::ostream& _stream;
     const char* _caller_filename;
     int _caller_filenumber;
 };
 
+// Turns the log expression into void, so it fits into the conditional operator.
+struct LogVoidify {
+    void operator&(const LogDetailed&) {}
+};
+
 class LogDebugDetailed : public LogDetailed {
 public:
     LogDebugDetailed(const char* filename, int filenumber) : LogDetailed(filename, filenumber)
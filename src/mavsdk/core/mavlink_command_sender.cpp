@@ -1,13 +1,28 @@
 #include "mavlink_command_sender.h"
-#include "system_impl.h"
+#include "log.h"
+#include "metrics.h"
+#include <algorithm>
 #include <cmath>
 #include <future>
 #include <memory>
+#include <utility>
 #include <unused.h>
 
 namespace mavsdk {
 
-MavlinkCommandSender::MavlinkCommandSender(SystemImpl& system_impl) : _parent(system_impl)
+MavlinkCommandSender::MavlinkCommandSender(
+    Sender& sender,
+    MavlinkMessageHandler& message_handler,
+    TimeoutHandler& timeout_handler,
+    TimeoutSCallback timeout_s_callback,
+    Time& time,
+    CallUserCallback call_user_callback) :
+    _sender(sender),
+    _message_handler(message_handler),
+    _timeout_handler(timeout_handler),
+    _timeout_s_callback(std::move(timeout_s_callback)),
+    _time(time),
+    _call_user_callback(std::move(call_user_callback))
 {
     if (const char* env_p = std::getenv("MAVSDK_COMMAND_DEBUGGING")) {
         if (std::string(env_p) == "1") {
@@ -15,9 +30,8 @@ MavlinkCommandSender::MavlinkCommandSender(SystemImpl& system_impl) : _parent(sy
             _command_debugging = true;
         }
     }
-    _command_debugging=true;
 
-    _parent.register_mavlink_message_handler(
+    _message_handler.register_one(
         MAVLINK_MSG_ID_COMMAND_ACK,
         [this](const mavlink_message_t& message) { receive_command_ack(message); },
         this);
@@ -25,7 +39,12 @@ MavlinkCommandSender::MavlinkCommandSender(SystemImpl& system_impl) : _parent(sy
 
 MavlinkCommandSender::~MavlinkCommandSender()
 {
-    _parent.unregister_all_mavlink_message_handlers(this);
+    _message_handler.unregister_all(this);
+
+    std::lock_guard<std::mutex> lock(_work_mutex);
+    for (const auto& in_flight : _in_flight_work) {
+        _timeout_handler.remove(in_flight.second->timeout_cookie);
+    }
 }
 
 MavlinkCommandSender::Result
@@ -77,26 +96,7 @@ void MavlinkCommandSender::queue_command_async(
                    << (int)(command.target_system_id) << ", " << (int)(command.target_component_id);
     }
 
-    CommandIdentification identification = identification_from_command(command);
-
-    for (const auto& work : _work_queue) {
-        if (work->identification == identification) {
-            if (_command_debugging) {
-                LogDebug() << "Dropping command " << static_cast<int>(identification.command)
-                           << " that is already being sent";
-            }
-            auto temp_callback = callback;
-            call_callback(temp_callback, Result::CommandDenied, NAN);
-            return;
-        }
-    }
-
-    auto new_work = std::make_shared<Work>();
-    new_work->timeout_s = _parent.timeout_s();
-    new_work->command = command;
-    new_work->identification = identification;
-    new_work->callback = callback;
-    _work_queue.push_back(new_work);
+    queue_work(command, callback);
 }
 
 void MavlinkCommandSender::queue_command_async(
@@ -107,27 +107,53 @@ void MavlinkCommandSender::queue_command_async(
                    << (int)(command.target_system_id) << ", " << (int)(command.target_component_id);
     }
 
+    queue_work(command, callback);
+}
+
+bool MavlinkCommandSender::send_command_untracked(
+    const CommandLong& command, const CommandResultCallback& callback)
+{
+    std::lock_guard<std::mutex> lock(_work_mutex);
+
+    UntrackedWork work;
+    work.command = command;
+    work.callback = callback;
+    work.timeout_s = _timeout_s_callback();
+
+    // Otherwise it is sent once the tracked command is done.
+    if (!collides_with_in_flight(command.command, command.target_component_id) &&
+        !send_untracked_work(work)) {
+        return false;
+    }
+
+    _untracked_work.push_back(std::move(work));
+    return true;
+}
+
+template<typename CommandType>
+void MavlinkCommandSender::queue_work(
+    const CommandType& command, const CommandResultCallback& callback)
+{
     CommandIdentification identification = identification_from_command(command);
 
-    for (const auto& work : _work_queue) {
-        if (work->identification == identification) {
-            if (_command_debugging) {
-                LogDebug() << "Dropping command " << static_cast<int>(identification.command)
-                           << " that is already being sent";
-            }
-            auto temp_callback = callback;
-            call_callback(temp_callback, Result::CommandDenied, NAN);
-            return;
+    std::lock_guard<std::mutex> lock(_work_mutex);
+
+    if (!_queued_identifications.insert(identification).second) {
+        if (_command_debugging) {
+            LogDebug() << "Dropping command " << static_cast<int>(identification.command)
+                       << " that is already being sent";
         }
+        call_callback(callback, Result::CommandDenied, NAN);
+        return;
     }
 
-    auto new_work = std::make_shared<Work>();
-    new_work->timeout_s = _parent.timeout_s();
+    auto new_work = acquire_work();
+    new_work->timeout_s = _timeout_s_callback();
     new_work->command = command;
     new_work->identification = identification;
     new_work->callback = callback;
-    new_work->time_started = _parent.get_time().steady_time();
-    _work_queue.push_back(new_work);
+    new_work->time_started = _time.steady_time();
+    _pending_work.push_back(std::move(new_work));
 }
 
 void MavlinkCommandSender::receive_command_ack(mavlink_message_t message)
@@ -135,9 +161,9 @@ void MavlinkCommandSender::receive_command_ack(mavlink_message_t message)
     mavlink_command_ack_t command_ack;
     mavlink_msg_command_ack_decode(&message, &command_ack);
 
-    if ((command_ack.target_system && command_ack.target_system != _parent.get_own_system_id()) ||
+    if ((command_ack.target_system && command_ack.target_system != _sender.get_own_system_id()) ||
         (command_ack.target_component &&
-         command_ack.target_component != _parent.get_own_component_id())) {
+         command_ack.target_component != _sender.get_own_component_id())) {
         if (_command_debugging) {
             LogDebug() << "Ignoring command ack for command "
                        << static_cast<int>(command_ack.command) << " from "
@@ -148,239 +174,361 @@ void MavlinkCommandSender::receive_command_ack(mavlink_message_t message)
         return;
     }
 
-    LockedQueue<Work>::Guard work_queue_guard(_work_queue);
+    std::lock_guard<std::mutex> lock(_work_mutex);
 
-    for (auto it = _work_queue.begin(); it != _work_queue.end(); ++it) {
-        auto work = *it;
-
-        if (!work) {
-            LogErr() << "No work available! (should not happen #1)";
+    auto it = find_in_flight(message, command_ack.command);
+    if (it == _in_flight_work.end()) {
+        if (receive_untracked_ack(message, command_ack)) {
             return;
         }
 
-        if (work->identification.command != command_ack.command ||
-            (work->identification.target_system_id != 0 &&
-             work->identification.target_system_id != message.sysid) ||
-            (work->identification.target_component_id != 0 &&
-             work->identification.target_component_id != message.compid)) {
-            if (_command_debugging) {
-                LogDebug() << "Command ack for " << command_ack.command
-                           << " (from: " << std::to_string(message.sysid) << "/"
-                           << std::to_string(message.compid) << ")"
-                           << " does not match command " << work->identification.command
-                           << " (to: " << std::to_string(work->identification.target_system_id)
-                           << "/" << std::to_string(work->identification.target_component_id) << ")"
-                           << " after " << _parent.get_time().elapsed_since_s(work->time_started)
-                           << " s";
-            }
-            continue;
-        }
-
         if (_command_debugging) {
-            LogDebug() << "Received command ack for " << command_ack.command << " with result "
-                       << static_cast<int>(command_ack.result) << " after "
-                       << _parent.get_time().elapsed_since_s(work->time_started) << " s";
-        }
-
-        CommandResultCallback temp_callback = work->callback;
-        std::pair<Result, float> temp_result{Result::UnknownError, NAN};
-
-        switch (command_ack.result) {
-            case MAV_RESULT_ACCEPTED:
-                _parent.unregister_timeout_handler(work->timeout_cookie);
-                temp_result = {Result::Success, 1.0f};
-                _work_queue.erase(it);
-                break;
-
-            case MAV_RESULT_DENIED:
-                LogWarn() << "command denied (" << work->identification.command << ").";
-                _parent.unregister_timeout_handler(work->timeout_cookie);
-                temp_result = {Result::CommandDenied, NAN};
-                _work_queue.erase(it);
-                break;
-
-            case MAV_RESULT_UNSUPPORTED:
-                LogWarn() << "command unsupported (" << work->identification.command << ").";
-                _parent.unregister_timeout_handler(work->timeout_cookie);
-                temp_result = {Result::Unsupported, NAN};
-                _work_queue.erase(it);
-                break;
-
-            case MAV_RESULT_TEMPORARILY_REJECTED:
-                LogWarn() << "command temporarily rejected (" << work->identification.command
-                          << ").";
-                _parent.unregister_timeout_handler(work->timeout_cookie);
-                temp_result = {Result::CommandDenied, NAN};
-                _work_queue.erase(it);
-                break;
-
-            case MAV_RESULT_FAILED:
-                _parent.unregister_timeout_handler(work->timeout_cookie);
-                temp_result = {Result::CommandDenied, NAN};
-                _work_queue.erase(it);
-                break;
-
-            case MAV_RESULT_IN_PROGRESS:
-                if (static_cast<int>(command_ack.progress) != 255) {
-                    LogInfo() << "progress: " << static_cast<int>(command_ack.progress) << " % ("
-                              << work->identification.command << ").";
-                }
-                // If we get a progress update, we can raise the timeout
-                // to something higher because we know the initial command
-                // has arrived. A possible timeout for this case is the initial
-                // timeout * the possible retries because this should match the
-                // case where there is no progress update, and we keep trying.
-                _parent.unregister_timeout_handler(work->timeout_cookie);
-                _parent.register_timeout_handler(
-                    [this, identification = work->identification] {
-                        receive_timeout(identification);
-                    },
-                    work->retries_to_do * work->timeout_s,
-                    &work->timeout_cookie);
-
-                temp_result = {
-                    Result::InProgress, static_cast<float>(command_ack.progress) / 100.0f};
-                break;
-
-            default:
-                LogWarn() << "Received unknown ack.";
-                break;
-        }
-
-        if (temp_callback != nullptr) {
-            call_callback(temp_callback, temp_result.first, temp_result.second);
+            LogDebug() << "Received ack from " << static_cast<int>(message.sysid) << '/'
+                       << static_cast<int>(message.compid)
+                       << " for not-existing command: " << static_cast<int>(command_ack.command)
+                       << "! Ignoring...";
+        } else {
+            LogWarn() << "Received ack for not-existing command: "
+                      << static_cast<int>(command_ack.command) << "! Ignoring...";
         }
-
         return;
     }
 
+    auto& work = *it->second;
+
     if (_command_debugging) {
-        LogDebug() << "Received ack from " << static_cast<int>(message.sysid) << '/'
-                   << static_cast<int>(message.compid)
-                   << " for not-existing command: " << static_cast<int>(command_ack.command)
-                   << "! Ignoring...";
-    } else {
-        LogWarn() << "Received ack for not-existing command: "
-                  << static_cast<int>(command_ack.command) << "! Ignoring...";
+        LogDebug() << "Received command ack for " << command_ack.command << " with result "
+                   << static_cast<int>(command_ack.result) << " after "
+                   << _time.elapsed_since_s(work.time_started) << " s";
     }
-}
 
-void MavlinkCommandSender::receive_timeout(const CommandIdentification& identification)
-{
-    bool found_command = false;
     CommandResultCallback temp_callback = nullptr;
     std::pair<Result, float> temp_result{Result::UnknownError, NAN};
 
-    LockedQueue<Work>::Guard work_queue_guard(_work_queue);
+    switch (command_ack.result) {
+        case MAV_RESULT_ACCEPTED:
+            temp_result = {Result::Success, 1.0f};
+            temp_callback = finish_work(it);
+            break;
+
+        case MAV_RESULT_DENIED:
+            LogWarn() << "command denied (" << work.identification.command << ").";
+            temp_result = {Result::CommandDenied, NAN};
+            temp_callback = finish_work(it);
+            break;
 
-    for (auto it = _work_queue.begin(); it != _work_queue.end(); ++it) {
-        auto work = *it;
+        case MAV_RESULT_UNSUPPORTED:
+            LogWarn() << "command unsupported (" << work.identification.command << ").";
+            temp_result = {Result::Unsupported, NAN};
+            temp_callback = finish_work(it);
+            break;
 
-        if (!work) {
-            LogErr() << "No work available! (should not happen #2)";
-            return;
-        }
+        case MAV_RESULT_TEMPORARILY_REJECTED:
+            LogWarn() << "command temporarily rejected (" << work.identification.command << ").";
+            temp_result = {Result::CommandDenied, NAN};
+            temp_callback = finish_work(it);
+            break;
 
-        if (work->identification != identification) {
-            continue;
-        }
+        case MAV_RESULT_FAILED:
+            temp_result = {Result::CommandDenied, NAN};
+            temp_callback = finish_work(it);
+            break;
 
-        found_command = true;
-
-        if (work->retries_to_do > 0) {
-            // We're not sure the command arrived, let's retransmit.
-            LogWarn() << "sending again after "
-                      << _parent.get_time().elapsed_since_s(work->time_started)
-                      << " s, retries to do: " << work->retries_to_do << "  ("
-                      << work->identification.command << ").";
-
-            mavlink_message_t message = create_mavlink_message(work->command);
-            if (!_parent.send_message(message)) {
-                LogErr() << "connection send error in retransmit (" << work->identification.command
-                         << ").";
-                temp_callback = work->callback;
-                temp_result = {Result::ConnectionError, NAN};
+        case MAV_RESULT_IN_PROGRESS:
+            if (static_cast<int>(command_ack.progress) != 255) {
+                LogInfo() << "progress: " << static_cast<int>(command_ack.progress) << " % ("
+                          << work.identification.command << ").";
             }
-            --work->retries_to_do;
-            _parent.register_timeout_handler(
-                [this, identification = work->identification] { receive_timeout(identification); },
-                work->timeout_s,
-                &work->timeout_cookie);
-
-        } else {
-            // We have tried retransmitting, giving up now.
-            LogErr() << "Retrying failed (" << work->identification.command << ")";
+            // If we get a progress update, we can raise the timeout
+            // to something higher because we know the initial command
+            // has arrived. A possible timeout for this case is the initial
+            // timeout * the possible retries because this should match the
+            // case where there is no progress update, and we keep trying.
+            _timeout_handler.remove(work.timeout_cookie);
+            _timeout_handler.add(
+                [this, identification = work.identification] { receive_timeout(identification); },
+                work.retries_to_do * work.timeout_s,
+                &work.timeout_cookie);
+
+            temp_callback = work.callback;
+            temp_result = {Result::InProgress, static_cast<float>(command_ack.progress) / 100.0f};
+            break;
 
-            temp_callback = work->callback;
-            temp_result = {Result::Timeout, NAN};
-            _work_queue.erase(it);
+        default:
+            LogWarn() << "Received unknown ack.";
+            temp_callback = work.callback;
             break;
-        }
     }
 
     if (temp_callback != nullptr) {
         call_callback(temp_callback, temp_result.first, temp_result.second);
     }
+}
+
+void MavlinkCommandSender::receive_timeout(const CommandIdentification& identification)
+{
+    CommandResultCallback temp_callback = nullptr;
+    std::pair<Result, float> temp_result{Result::UnknownError, NAN};
+
+    std::lock_guard<std::mutex> lock(_work_mutex);
+
+    auto it = _in_flight_work.find(
+        in_flight_key(identification.command, identification.target_component_id));
 
-    if (!found_command) {
+    if (it == _in_flight_work.end() || it->second->identification != identification) {
         LogWarn() << "Timeout for not-existing command: "
                   << static_cast<int>(identification.command) << "! Ignoring...";
+        return;
+    }
+
+    auto& work = *it->second;
+
+    Metrics::instance().command_timeouts.add();
+
+    if (work.retries_to_do > 0) {
+        // We're not sure the command arrived, let's retransmit.
+        Metrics::instance().command_retries.add();
+        LogWarn() << "sending again after " << _time.elapsed_since_s(work.time_started)
+                  << " s, retries to do: " << work.retries_to_do << "  ("
+                  << work.identification.command << ").";
+
+        mavlink_message_t message = create_mavlink_message(work.command);
+        if (!_sender.send_message(message)) {
+            LogErr() << "connection send error in retransmit (" << work.identification.command
+                     << ").";
+            temp_callback = work.callback;
+            temp_result = {Result::ConnectionError, NAN};
+        }
+        --work.retries_to_do;
+        _timeout_handler.add(
+            [this, identification = work.identification] { receive_timeout(identification); },
+            work.timeout_s,
+            &work.timeout_cookie);
+
+    } else {
+        // We have tried retransmitting, giving up now.
+        LogErr() << "Retrying failed (" << work.identification.command << ")";
+
+        // The timeout handler has already removed this timeout, and the cookie
+        // might be handed out again by now.
+        work.timeout_cookie = nullptr;
+        temp_callback = finish_work(it);
+        temp_result = {Result::Timeout, NAN};
+    }
+
+    if (temp_callback != nullptr) {
+        call_callback(temp_callback, temp_result.first, temp_result.second);
     }
 }
 
 void MavlinkCommandSender::do_work()
 {
-    LockedQueue<Work>::Guard work_queue_guard(_work_queue);
+    std::lock_guard<std::mutex> lock(_work_mutex);
+
+    // Untracked commands go first, they are not retried and would otherwise
+    // keep waiting behind the tracked ones.
+    process_untracked_work();
 
-    for (const auto& work : _work_queue) {
-        if (work->already_sent) {
+    // Commands are sent in the order they were queued, however, a command only
+    // has to wait for another one if their acks could not be told apart.
+    for (auto it = _pending_work.begin(); it != _pending_work.end(); /* ++it */) {
+        auto& work = *it;
+
+        if (!can_send_now(*work)) {
+            if (_command_debugging) {
+                LogDebug() << "Command " << static_cast<int>(work->identification.command)
+                           << " is already being sent, waiting...";
+            }
+            ++it;
             continue;
         }
 
-        bool already_being_sent = false;
-        for (const auto& other_work : _work_queue) {
-            // Ignore itself:
-            if (other_work == work) {
-                continue;
-            }
+        send_work(*work);
 
-            // Check if command with same command ID is already being sent.
-            if (other_work->already_sent &&
-                other_work->identification.command == work->identification.command) {
-                if (_command_debugging) {
-                    LogDebug() << "Command " << static_cast<int>(work->identification.command)
-                               << " is already being sent, waiting...";
-                }
-                already_being_sent = true;
-                break;
+        const auto key =
+            in_flight_key(work->identification.command, work->identification.target_component_id);
+        _in_flight_work.emplace(key, std::move(work));
+        it = _pending_work.erase(it);
+    }
+}
+
+bool MavlinkCommandSender::can_send_now(const Work& work) const
+{
+    const auto command = work.identification.command;
+    const auto component_id = work.identification.target_component_id;
+
+    return !collides_with_in_flight(command, component_id) &&
+           !collides_with_untracked(command, component_id);
+}
+
+bool MavlinkCommandSender::collides_with_in_flight(uint16_t command, uint8_t component_id) const
+{
+    if (component_id == 0) {
+        // Any component can ack a broadcast command, so we need to wait until
+        // no command with this ID is in flight.
+        for (const auto& in_flight : _in_flight_work) {
+            if (in_flight.second->identification.command == command) {
+                return true;
             }
         }
+        return false;
+    }
 
-        if (already_being_sent) {
-            continue;
+    return _in_flight_work.find(in_flight_key(command, component_id)) != _in_flight_work.end() ||
+           _in_flight_work.find(in_flight_key(command, 0)) != _in_flight_work.end();
+}
+
+bool MavlinkCommandSender::collides_with_untracked(uint16_t command, uint8_t component_id) const
+{
+    for (const auto& untracked : _untracked_work) {
+        if (untracked.sent && untracked.command.command == command &&
+            (component_id == 0 || untracked.command.target_component_id == 0 ||
+             untracked.command.target_component_id == component_id)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MavlinkCommandSender::send_work(Work& work)
+{
+    work.time_started = _time.steady_time();
+
+    mavlink_message_t message = create_mavlink_message(work.command);
+    if (!_sender.send_message(message)) {
+        LogErr() << "connection send error (" << work.identification.command << ")";
+    } else {
+        if (_command_debugging) {
+            LogDebug() << "Sent command " << static_cast<int>(work.identification.command);
         }
+    }
+
+    _timeout_handler.add(
+        [this, identification = work.identification] { receive_timeout(identification); },
+        work.timeout_s,
+        &work.timeout_cookie);
+}
 
-        // LogDebug() << "sending it the first time (" << work->mavlink_command << ")";
-        work->time_started = _parent.get_time().steady_time();
+bool MavlinkCommandSender::send_untracked_work(UntrackedWork& work)
+{
+    mavlink_message_t message = create_mavlink_message(work.command);
+    if (!_sender.send_message(message)) {
+        LogErr() << "connection send error (" << work.command.command << ")";
+        return false;
+    }
+
+    work.sent = true;
+    work.time_sent = _time.steady_time();
+    return true;
+}
 
-        {
-            mavlink_message_t message = create_mavlink_message(work->command);
-            if (!_parent.send_message(message)) {
-                LogErr() << "connection send error (" << work->identification.command << ")";
-            } else {
+void MavlinkCommandSender::process_untracked_work()
+{
+    for (auto it = _untracked_work.begin(); it != _untracked_work.end(); /* ++it */) {
+        auto& work = *it;
+
+        if (work.sent) {
+            if (_time.elapsed_since_s(work.time_sent) > work.timeout_s) {
                 if (_command_debugging) {
-                    LogDebug() << "Sent command " << static_cast<int>(work->identification.command);
+                    LogDebug() << "No ack for untracked command "
+                               << static_cast<int>(work.command.command);
                 }
+                call_callback(work.callback, Result::Timeout, NAN);
+                it = _untracked_work.erase(it);
+                continue;
+            }
+
+        } else if (!collides_with_in_flight(
+                       work.command.command, work.command.target_component_id)) {
+            if (!send_untracked_work(work)) {
+                call_callback(work.callback, Result::ConnectionError, NAN);
+                it = _untracked_work.erase(it);
+                continue;
             }
         }
+        ++it;
+    }
+}
+
+bool MavlinkCommandSender::receive_untracked_ack(
+    const mavlink_message_t& message, const mavlink_command_ack_t& command_ack)
+{
+    // The oldest matching command is the one most likely acked.
+    auto it = std::find_if(
+        _untracked_work.begin(), _untracked_work.end(), [&](const UntrackedWork& work) {
+            return work.sent && work.command.command == command_ack.command &&
+                   (work.command.target_system_id == 0 ||
+                    work.command.target_system_id == message.sysid) &&
+                   (work.command.target_component_id == 0 ||
+                    work.command.target_component_id == message.compid);
+        });
+
+    if (it == _untracked_work.end()) {
+        return false;
+    }
+
+    if (command_ack.result == MAV_RESULT_IN_PROGRESS) {
+        // It arrived, give it more time.
+        it->time_sent = _time.steady_time();
+        return true;
+    }
+
+    const auto result = result_from_ack(command_ack.result);
+    call_callback(it->callback, result, result == Result::Success ? 1.0f : NAN);
+    _untracked_work.erase(it);
+    return true;
+}
 
-        work->already_sent = true;
+MavlinkCommandSender::InFlightMap::iterator
+MavlinkCommandSender::find_in_flight(const mavlink_message_t& message, uint16_t command)
+{
+    auto it = _in_flight_work.find(in_flight_key(command, message.compid));
+
+    if (it == _in_flight_work.end()) {
+        it = _in_flight_work.find(in_flight_key(command, 0));
+    }
 
-        _parent.register_timeout_handler(
-            [this, identification = work->identification] { receive_timeout(identification); },
-            work->timeout_s,
-            &work->timeout_cookie);
+    if (it != _in_flight_work.end() && it->second->identification.target_system_id != 0 &&
+        it->second->identification.target_system_id != message.sysid) {
+        return _in_flight_work.end();
     }
+
+    return it;
+}
+
+MavlinkCommandSender::CommandResultCallback
+MavlinkCommandSender::finish_work(InFlightMap::iterator it)
+{
+    auto work = std::move(it->second);
+    _in_flight_work.erase(it);
+
+    _timeout_handler.remove(work->timeout_cookie);
+    _queued_identifications.erase(work->identification);
+
+    auto callback = std::move(work->callback);
+    release_work(std::move(work));
+    return callback;
+}
+
+std::unique_ptr<MavlinkCommandSender::Work> MavlinkCommandSender::acquire_work()
+{
+    if (_work_pool.empty()) {
+        return std::make_unique<Work>();
+    }
+
+    auto work = std::move(_work_pool.back());
+    _work_pool.pop_back();
+    return work;
+}
+
+void MavlinkCommandSender::release_work(std::unique_ptr<Work> work)
+{
+    if (_work_pool.size() >= MAX_POOLED_WORK) {
+        return;
+    }
+
+    *work = Work{};
+    _work_pool.push_back(std::move(work));
 }
 
 void MavlinkCommandSender::call_callback(
@@ -393,8 +541,23 @@ void MavlinkCommandSender::call_callback(
     // It seems that we need to queue the callback on the thread pool otherwise
     // we lock ourselves out when we send a command in the callback receiving a command result.
     auto temp_callback = callback;
-    _parent.call_user_callback(
-        [temp_callback, result, progress]() { temp_callback(result, progress); });
+    _call_user_callback([temp_callback, result, progress]() { temp_callback(result, progress); });
+}
+
+MavlinkCommandSender::Result MavlinkCommandSender::result_from_ack(uint8_t mav_result)
+{
+    switch (mav_result) {
+        case MAV_RESULT_ACCEPTED:
+            return Result::Success;
+        case MAV_RESULT_DENIED:
+        case MAV_RESULT_TEMPORARILY_REJECTED:
+        case MAV_RESULT_FAILED:
+            return Result::CommandDenied;
+        case MAV_RESULT_UNSUPPORTED:
+            return Result::Unsupported;
+        default:
+            return Result::UnknownError;
+    }
 }
 
 mavlink_message_t MavlinkCommandSender::create_mavlink_message(const Command& command)
@@ -403,8 +566,8 @@ mavlink_message_t MavlinkCommandSender::create_mavlink_message(const Command& co
 
     if (auto command_int = std::get_if<CommandInt>(&command)) {
         mavlink_msg_command_int_pack(
-            _parent.get_own_system_id(),
-            _parent.get_own_component_id(),
+            _sender.get_own_system_id(),
+            _sender.get_own_component_id(),
             &message,
             command_int->target_system_id,
             command_int->target_component_id,
@@ -422,8 +585,8 @@ mavlink_message_t MavlinkCommandSender::create_mavlink_message(const Command& co
 
     } else if (auto command_long = std::get_if<CommandLong>(&command)) {
         mavlink_msg_command_long_pack(
-            _parent.get_own_system_id(),
-            _parent.get_own_component_id(),
+            _sender.get_own_system_id(),
+            _sender.get_own_component_id(),
             &message,
             command_long->target_system_id,
             command_long->target_component_id,
@@ -446,7 +609,7 @@ float MavlinkCommandSender::maybe_reserved(const std::optional<float>& maybe_par
         return maybe_param.value();
 
     } else {
-        if (_parent.autopilot() == SystemImpl::Autopilot::ArduPilot) {
+        if (_sender.autopilot() == Sender::Autopilot::ArduPilot) {
             return 0.0f;
         } else {
             return NAN;
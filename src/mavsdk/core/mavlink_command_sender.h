@@ -1,24 +1,38 @@
 #pragma once
 
 #include "mavlink_include.h"
-#include "locked_queue.h"
+#include "mavlink_message_handler.h"
 #include "mavsdk_time.h"
+#include "sender.h"
+#include "timeout_handler.h"
+#include "timeout_s_callback.h"
 #include <cmath>
 #include <cstdint>
+#include <deque>
 #include <string>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <unordered_map>
+#include <unordered_set>
 #include <variant>
+#include <vector>
 
 namespace mavsdk {
 
-class SystemImpl;
-
 class MavlinkCommandSender {
 public:
-    explicit MavlinkCommandSender(SystemImpl& system_impl);
+    // Queues a callback to be called on the user callback thread.
+    using CallUserCallback = std::function<void(const std::function<void()>&)>;
+
+    MavlinkCommandSender(
+        Sender& sender,
+        MavlinkMessageHandler& message_handler,
+        TimeoutHandler& timeout_handler,
+        TimeoutSCallback timeout_s_callback,
+        Time& time,
+        CallUserCallback call_user_callback);
     ~MavlinkCommandSender();
 
     enum class Result {
@@ -76,6 +90,14 @@ public:
     void queue_command_async(const CommandInt& command, const CommandResultCallback& callback);
     void queue_command_async(const CommandLong& command, const CommandResultCallback& callback);
 
+    // Sends the command without retrying it, for callers which send many commands
+    // at once and confirm them some other way. The callback gets the result of its
+    // ack, or Timeout if there is none. Acks for the same command from the same
+    // component can't be told apart, so they are matched in the order the commands
+    // were sent, and a command waits while a tracked one could take its ack.
+    bool send_command_untracked(
+        const CommandLong& command, const CommandResultCallback& callback = nullptr);
+
     void do_work();
 
     static const int DEFAULT_COMPONENT_ID_AUTOPILOT = MAV_COMP_ID_AUTOPILOT1;
@@ -104,6 +126,18 @@ private:
         }
 
         bool operator!=(const CommandIdentification& other) const { return !(*this == other); }
+
+        struct Hash {
+            std::size_t operator()(const CommandIdentification& identification) const
+            {
+                return std::hash<uint64_t>()(
+                           (static_cast<uint64_t>(identification.maybe_param1) << 32) |
+                           identification.maybe_param2) ^
+                       (static_cast<std::size_t>(identification.command) << 16) ^
+                       (static_cast<std::size_t>(identification.target_system_id) << 8) ^
+                       identification.target_component_id;
+            }
+        };
     };
 
     struct Work {
@@ -114,7 +148,25 @@ private:
         void* timeout_cookie = nullptr;
         double timeout_s{0.5};
         int retries_to_do{3};
-        bool already_sent{false};
+    };
+
+    // Commands in flight are keyed by command ID and target component, as that
+    // is all a COMMAND_ACK tells us about the command it acknowledges.
+    using InFlightKey = uint32_t;
+
+    static InFlightKey in_flight_key(uint16_t command, uint8_t component_id)
+    {
+        return (static_cast<uint32_t>(command) << 8) | component_id;
+    }
+
+    using InFlightMap = std::unordered_map<InFlightKey, std::unique_ptr<Work>>;
+
+    struct UntrackedWork {
+        CommandLong command{};
+        CommandResultCallback callback{};
+        dl_time_t time_sent{};
+        double timeout_s{0.5};
+        bool sent{false};
     };
 
     template<typename CommandType>
@@ -143,17 +195,53 @@ private:
         return identification;
     }
 
+    template<typename CommandType>
+    void queue_work(const CommandType& command, const CommandResultCallback& callback);
+
     void receive_command_ack(mavlink_message_t message);
     void receive_timeout(const CommandIdentification& identification);
 
+    // The following need to be called with _work_mutex held.
+    bool can_send_now(const Work& work) const;
+    bool collides_with_in_flight(uint16_t command, uint8_t component_id) const;
+    bool collides_with_untracked(uint16_t command, uint8_t component_id) const;
+    void send_work(Work& work);
+    bool send_untracked_work(UntrackedWork& work);
+    void process_untracked_work();
+    bool receive_untracked_ack(
+        const mavlink_message_t& message, const mavlink_command_ack_t& command_ack);
+    InFlightMap::iterator find_in_flight(const mavlink_message_t& message, uint16_t command);
+    CommandResultCallback finish_work(InFlightMap::iterator it);
+    std::unique_ptr<Work> acquire_work();
+    void release_work(std::unique_ptr<Work> work);
+
     void call_callback(const CommandResultCallback& callback, Result result, float progress);
 
+    static Result result_from_ack(uint8_t mav_result);
+
     mavlink_message_t create_mavlink_message(const Command& command);
 
     float maybe_reserved(const std::optional<float>& maybe_param) const;
 
-    SystemImpl& _parent;
-    LockedQueue<Work> _work_queue{};
+    Sender& _sender;
+    MavlinkMessageHandler& _message_handler;
+    TimeoutHandler& _timeout_handler;
+    TimeoutSCallback _timeout_s_callback;
+    Time& _time;
+    CallUserCallback _call_user_callback;
+
+    std::mutex _work_mutex{};
+    // Commands waiting until no command with the same key is in flight anymore.
+    std::deque<std::unique_ptr<Work>> _pending_work{};
+    InFlightMap _in_flight_work{};
+    // All pending and in-flight commands, to drop duplicates.
+    std::unordered_set<CommandIdentification, CommandIdentification::Hash>
+        _queued_identifications{};
+    // Commands sent without tracking, oldest first, until acked or timed out.
+    std::deque<UntrackedWork> _untracked_work{};
+    // Finished work items are kept around to be reused for the next commands.
+    std::vector<std::unique_ptr<Work>> _work_pool{};
+    static constexpr std::size_t MAX_POOLED_WORK = 32;
 
     bool _command_debugging{false};
 };
@@ -0,0 +1,370 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <optional>
+#include <vector>
+
+#include "mavlink_command_sender.h"
+#include "mocks/sender_mock.h"
+
+using namespace mavsdk;
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+using MockSender = NiceMock<mavsdk::testing::MockSender>;
+
+using Result = MavlinkCommandSender::Result;
+using CommandLong = MavlinkCommandSender::CommandLong;
+
+static constexpr uint8_t own_system_id = 245;
+static constexpr uint8_t own_component_id = MAV_COMP_ID_MISSIONPLANNER;
+static constexpr uint8_t target_system_id = 1;
+
+static constexpr double timeout_s = 0.5;
+
+class MavlinkCommandSenderTest : public ::testing::Test {
+protected:
+    MavlinkCommandSenderTest() :
+        ::testing::Test(),
+        timeout_handler(time),
+        command_sender(
+            mock_sender,
+            message_handler,
+            timeout_handler,
+            []() { return timeout_s; },
+            time,
+            [](const std::function<void()>& func) { func(); })
+    {}
+
+    void SetUp() override
+    {
+        ON_CALL(mock_sender, get_own_system_id()).WillByDefault(Return(own_system_id));
+        ON_CALL(mock_sender, get_own_component_id()).WillByDefault(Return(own_component_id));
+        ON_CALL(mock_sender, get_system_id()).WillByDefault(Return(target_system_id));
+        ON_CALL(mock_sender, autopilot()).WillByDefault(Return(Sender::Autopilot::Px4));
+        ON_CALL(mock_sender, send_message(_)).WillByDefault(Invoke([this](mavlink_message_t&) {
+            ++num_sent;
+            return true;
+        }));
+    }
+
+    void queue(
+        uint16_t command,
+        uint8_t component_id,
+        std::vector<Result>& results,
+        std::optional<float> maybe_param1 = {})
+    {
+        CommandLong command_long{};
+        command_long.target_system_id = target_system_id;
+        command_long.target_component_id = component_id;
+        command_long.command = command;
+        command_long.params.maybe_param1 = maybe_param1;
+        command_sender.queue_command_async(
+            command_long, [&results](Result result, float) { results.push_back(result); });
+    }
+
+    void ack(uint16_t command, uint8_t component_id, MAV_RESULT result)
+    {
+        mavlink_message_t message;
+        mavlink_msg_command_ack_pack(
+            target_system_id,
+            component_id,
+            &message,
+            command,
+            result,
+            0,
+            0,
+            own_system_id,
+            own_component_id);
+        message_handler.process_message(message);
+    }
+
+    void let_time_out()
+    {
+        time.sleep_for(std::chrono::milliseconds(static_cast<int>(timeout_s * 1000.0) + 10));
+        timeout_handler.run_once();
+    }
+
+    MockSender mock_sender;
+    MavlinkMessageHandler message_handler;
+    FakeTime time;
+    TimeoutHandler timeout_handler;
+    MavlinkCommandSender command_sender;
+    unsigned num_sent{0};
+};
+
+TEST_F(MavlinkCommandSenderTest, SendsCommandsToDifferentComponentsConcurrently)
+{
+    std::vector<Result> autopilot_results;
+    std::vector<Result> camera_results;
+    queue(MAV_CMD_REQUEST_MESSAGE, MAV_COMP_ID_AUTOPILOT1, autopilot_results);
+    queue(MAV_CMD_REQUEST_MESSAGE, MAV_COMP_ID_CAMERA, camera_results);
+
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 2);
+
+    // The acks arrive in the other order and go to the right command each.
+    ack(MAV_CMD_REQUEST_MESSAGE, MAV_COMP_ID_CAMERA, MAV_RESULT_DENIED);
+    EXPECT_TRUE(autopilot_results.empty());
+    ASSERT_EQ(camera_results.size(), 1);
+    EXPECT_EQ(camera_results[0], Result::CommandDenied);
+
+    ack(MAV_CMD_REQUEST_MESSAGE, MAV_COMP_ID_AUTOPILOT1, MAV_RESULT_ACCEPTED);
+    ASSERT_EQ(autopilot_results.size(), 1);
+    EXPECT_EQ(autopilot_results[0], Result::Success);
+    EXPECT_EQ(camera_results.size(), 1);
+}
+
+TEST_F(MavlinkCommandSenderTest, SendsDifferentCommandsConcurrently)
+{
+    std::vector<Result> arm_results;
+    std::vector<Result> mode_results;
+    queue(MAV_CMD_COMPONENT_ARM_DISARM, MAV_COMP_ID_AUTOPILOT1, arm_results);
+    queue(MAV_CMD_DO_SET_MODE, MAV_COMP_ID_AUTOPILOT1, mode_results);
+
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 2);
+
+    ack(MAV_CMD_DO_SET_MODE, MAV_COMP_ID_AUTOPILOT1, MAV_RESULT_ACCEPTED);
+    ack(MAV_CMD_COMPONENT_ARM_DISARM, MAV_COMP_ID_AUTOPILOT1, MAV_RESULT_ACCEPTED);
+    ASSERT_EQ(arm_results.size(), 1);
+    EXPECT_EQ(arm_results[0], Result::Success);
+    ASSERT_EQ(mode_results.size(), 1);
+    EXPECT_EQ(mode_results[0], Result::Success);
+}
+
+TEST_F(MavlinkCommandSenderTest, SerializesCommandsWhoseAcksCantBeToldApart)
+{
+    std::vector<Result> first_results;
+    std::vector<Result> second_results;
+    queue(MAV_CMD_REQUEST_MESSAGE, MAV_COMP_ID_AUTOPILOT1, first_results, 148.0f);
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 1);
+
+    // Same command to the same component, but for another message.
+    queue(MAV_CMD_REQUEST_MESSAGE, MAV_COMP_ID_AUTOPILOT1, second_results, 259.0f);
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 1);
+
+    ack(MAV_CMD_REQUEST_MESSAGE, MAV_COMP_ID_AUTOPILOT1, MAV_RESULT_ACCEPTED);
+    ASSERT_EQ(first_results.size(), 1);
+    EXPECT_TRUE(second_results.empty());
+
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 2);
+    ack(MAV_CMD_REQUEST_MESSAGE, MAV_COMP_ID_AUTOPILOT1, MAV_RESULT_ACCEPTED);
+    ASSERT_EQ(second_results.size(), 1);
+    EXPECT_EQ(second_results[0], Result::Success);
+}
+
+TEST_F(MavlinkCommandSenderTest, MatchesBroadcastCommandToAckFromAnyComponent)
+{
+    std::vector<Result> results;
+    queue(MAV_CMD_REQUEST_MESSAGE, MAV_COMP_ID_ALL, results);
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 1);
+
+    ack(MAV_CMD_REQUEST_MESSAGE, MAV_COMP_ID_CAMERA, MAV_RESULT_ACCEPTED);
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0], Result::Success);
+}
+
+TEST_F(MavlinkCommandSenderTest, KeepsBroadcastAndTargetedCommandApart)
+{
+    std::vector<Result> targeted_results;
+    std::vector<Result> broadcast_results;
+    queue(MAV_CMD_REQUEST_MESSAGE, MAV_COMP_ID_CAMERA, targeted_results);
+    queue(MAV_CMD_REQUEST_MESSAGE, MAV_COMP_ID_ALL, broadcast_results);
+
+    // The broadcast one has to wait, an ack from the camera could be for either.
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 1);
+
+    ack(MAV_CMD_REQUEST_MESSAGE, MAV_COMP_ID_CAMERA, MAV_RESULT_ACCEPTED);
+    ASSERT_EQ(targeted_results.size(), 1);
+    EXPECT_TRUE(broadcast_results.empty());
+
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 2);
+
+    // A targeted command queued now waits for the broadcast one in turn.
+    std::vector<Result> later_results;
+    queue(MAV_CMD_REQUEST_MESSAGE, MAV_COMP_ID_AUTOPILOT1, later_results);
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 2);
+
+    ack(MAV_CMD_REQUEST_MESSAGE, MAV_COMP_ID_AUTOPILOT1, MAV_RESULT_UNSUPPORTED);
+    ASSERT_EQ(broadcast_results.size(), 1);
+    EXPECT_EQ(broadcast_results[0], Result::Unsupported);
+    EXPECT_TRUE(later_results.empty());
+
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 3);
+}
+
+TEST_F(MavlinkCommandSenderTest, IgnoresAckFromOtherSystem)
+{
+    std::vector<Result> results;
+    queue(MAV_CMD_REQUEST_MESSAGE, MAV_COMP_ID_ALL, results);
+    command_sender.do_work();
+
+    mavlink_message_t message;
+    mavlink_msg_command_ack_pack(
+        target_system_id + 1,
+        MAV_COMP_ID_AUTOPILOT1,
+        &message,
+        MAV_CMD_REQUEST_MESSAGE,
+        MAV_RESULT_ACCEPTED,
+        0,
+        0,
+        own_system_id,
+        own_component_id);
+    message_handler.process_message(message);
+    EXPECT_TRUE(results.empty());
+
+    ack(MAV_CMD_REQUEST_MESSAGE, MAV_COMP_ID_AUTOPILOT1, MAV_RESULT_ACCEPTED);
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0], Result::Success);
+}
+
+TEST_F(MavlinkCommandSenderTest, RetriesAndTimesOut)
+{
+    std::vector<Result> results;
+    queue(MAV_CMD_COMPONENT_ARM_DISARM, MAV_COMP_ID_AUTOPILOT1, results);
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 1);
+
+    for (unsigned i = 0; i < 3; ++i) {
+        let_time_out();
+        EXPECT_EQ(num_sent, 2 + i);
+        EXPECT_TRUE(results.empty());
+    }
+
+    let_time_out();
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0], Result::Timeout);
+
+    // It can be sent again.
+    queue(MAV_CMD_COMPONENT_ARM_DISARM, MAV_COMP_ID_AUTOPILOT1, results);
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 5);
+}
+
+TEST_F(MavlinkCommandSenderTest, MatchesUntrackedCommandToAckFromAnyComponent)
+{
+    std::vector<Result> results;
+    CommandLong command{};
+    command.target_system_id = target_system_id;
+    command.target_component_id = MAV_COMP_ID_ALL;
+    command.command = MAV_CMD_SET_MESSAGE_INTERVAL;
+    EXPECT_TRUE(command_sender.send_command_untracked(
+        command, [&results](Result result, float) { results.push_back(result); }));
+    EXPECT_EQ(num_sent, 1);
+
+    ack(MAV_CMD_SET_MESSAGE_INTERVAL, MAV_COMP_ID_AUTOPILOT1, MAV_RESULT_ACCEPTED);
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0], Result::Success);
+
+    // Nothing is left over to swallow the ack of the next command.
+    std::vector<Result> tracked_results;
+    queue(MAV_CMD_SET_MESSAGE_INTERVAL, MAV_COMP_ID_AUTOPILOT1, tracked_results);
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 2);
+    ack(MAV_CMD_SET_MESSAGE_INTERVAL, MAV_COMP_ID_AUTOPILOT1, MAV_RESULT_UNSUPPORTED);
+    ASSERT_EQ(tracked_results.size(), 1);
+    EXPECT_EQ(tracked_results[0], Result::Unsupported);
+    EXPECT_EQ(results.size(), 1);
+}
+
+TEST_F(MavlinkCommandSenderTest, ReportsUntrackedResultsInOrder)
+{
+    std::vector<Result> results;
+    CommandLong command{};
+    command.target_system_id = target_system_id;
+    command.target_component_id = MAV_COMP_ID_AUTOPILOT1;
+    command.command = MAV_CMD_SET_MESSAGE_INTERVAL;
+    for (unsigned i = 0; i < 3; ++i) {
+        EXPECT_TRUE(command_sender.send_command_untracked(
+            command, [&results](Result result, float) { results.push_back(result); }));
+    }
+    EXPECT_EQ(num_sent, 3);
+
+    ack(MAV_CMD_SET_MESSAGE_INTERVAL, MAV_COMP_ID_AUTOPILOT1, MAV_RESULT_DENIED);
+    ack(MAV_CMD_SET_MESSAGE_INTERVAL, MAV_COMP_ID_AUTOPILOT1, MAV_RESULT_IN_PROGRESS);
+    ack(MAV_CMD_SET_MESSAGE_INTERVAL, MAV_COMP_ID_AUTOPILOT1, MAV_RESULT_ACCEPTED);
+    ack(MAV_CMD_SET_MESSAGE_INTERVAL, MAV_COMP_ID_AUTOPILOT1, MAV_RESULT_UNSUPPORTED);
+
+    ASSERT_EQ(results.size(), 3);
+    EXPECT_EQ(results[0], Result::CommandDenied);
+    EXPECT_EQ(results[1], Result::Success);
+    EXPECT_EQ(results[2], Result::Unsupported);
+}
+
+TEST_F(MavlinkCommandSenderTest, KeepsUntrackedAndTrackedCommandApart)
+{
+    std::vector<Result> tracked_results;
+    std::vector<Result> untracked_results;
+    queue(MAV_CMD_SET_MESSAGE_INTERVAL, MAV_COMP_ID_AUTOPILOT1, tracked_results);
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 1);
+
+    // Its ack could complete the tracked one, so it has to wait.
+    CommandLong command{};
+    command.target_system_id = target_system_id;
+    command.target_component_id = MAV_COMP_ID_AUTOPILOT1;
+    command.command = MAV_CMD_SET_MESSAGE_INTERVAL;
+    EXPECT_TRUE(command_sender.send_command_untracked(
+        command, [&untracked_results](Result result, float) {
+            untracked_results.push_back(result);
+        }));
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 1);
+
+    ack(MAV_CMD_SET_MESSAGE_INTERVAL, MAV_COMP_ID_AUTOPILOT1, MAV_RESULT_ACCEPTED);
+    ASSERT_EQ(tracked_results.size(), 1);
+    EXPECT_EQ(tracked_results[0], Result::Success);
+    EXPECT_TRUE(untracked_results.empty());
+
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 2);
+
+    // And now a tracked one waits for the untracked one.
+    std::vector<Result> later_results;
+    queue(MAV_CMD_SET_MESSAGE_INTERVAL, MAV_COMP_ID_ALL, later_results);
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 2);
+
+    ack(MAV_CMD_SET_MESSAGE_INTERVAL, MAV_COMP_ID_AUTOPILOT1, MAV_RESULT_DENIED);
+    ASSERT_EQ(untracked_results.size(), 1);
+    EXPECT_EQ(untracked_results[0], Result::CommandDenied);
+    EXPECT_TRUE(later_results.empty());
+
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 3);
+}
+
+TEST_F(MavlinkCommandSenderTest, ExpiresUntrackedCommandWithoutAck)
+{
+    std::vector<Result> results;
+    CommandLong command{};
+    command.target_system_id = target_system_id;
+    command.target_component_id = MAV_COMP_ID_AUTOPILOT1;
+    command.command = MAV_CMD_SET_MESSAGE_INTERVAL;
+    EXPECT_TRUE(command_sender.send_command_untracked(
+        command, [&results](Result result, float) { results.push_back(result); }));
+
+    command_sender.do_work();
+    EXPECT_TRUE(results.empty());
+
+    time.sleep_for(std::chrono::milliseconds(static_cast<int>(timeout_s * 1000.0) + 10));
+    command_sender.do_work();
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0], Result::Timeout);
+
+    // A tracked command is no longer held up by it.
+    std::vector<Result> tracked_results;
+    queue(MAV_CMD_SET_MESSAGE_INTERVAL, MAV_COMP_ID_AUTOPILOT1, tracked_results);
+    command_sender.do_work();
+    EXPECT_EQ(num_sent, 2);
+}
@@ -0,0 +1,94 @@
+#include "mavlink_frame_batcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace mavsdk {
+
+MavlinkFrameBatcher::MavlinkFrameBatcher(
+    const Filter& filter,
+    unsigned max_frames_per_batch,
+    double max_batch_latency_s,
+    BatchCallback callback) :
+    _message_ids(filter.message_ids),
+    _max_frames_per_batch(std::max(max_frames_per_batch, 1u)),
+    _max_batch_latency_s(max_batch_latency_s),
+    _callback(std::move(callback))
+{
+    // Sorted, so we can do a binary search on the receive path.
+    std::sort(_message_ids.begin(), _message_ids.end());
+    _message_ids.erase(std::unique(_message_ids.begin(), _message_ids.end()), _message_ids.end());
+
+    for (const auto system_id : filter.system_ids) {
+        _system_ids.set(system_id);
+        _all_system_ids = false;
+    }
+
+    start_new_batch();
+}
+
+bool MavlinkFrameBatcher::accepts(const mavlink_message_t& message) const
+{
+    if (!_all_system_ids && !_system_ids.test(message.sysid)) {
+        return false;
+    }
+
+    return _message_ids.empty() ||
+           std::binary_search(_message_ids.begin(), _message_ids.end(), message.msgid);
+}
+
+void MavlinkFrameBatcher::add_frame(
+    const uint8_t* frame, uint16_t frame_len, uint64_t timestamp_us, const dl_time_t& now)
+{
+    if (_batch.frame_lengths.empty()) {
+        _batch_started = now;
+    }
+
+    _batch.data.insert(_batch.data.end(), frame, frame + frame_len);
+    _batch.frame_lengths.push_back(frame_len);
+    _batch.timestamps_us.push_back(timestamp_us);
+
+    if (_batch.frame_lengths.size() >= _max_frames_per_batch) {
+        flush();
+    }
+}
+
+void MavlinkFrameBatcher::flush_if_due(const dl_time_t& now)
+{
+    if (_batch.frame_lengths.empty()) {
+        return;
+    }
+
+    const auto batch_age_s =
+        std::chrono::duration_cast<std::chrono::duration<double>>(now - _batch_started).count();
+
+    if (batch_age_s >= _max_batch_latency_s) {
+        flush();
+    }
+}
+
+void MavlinkFrameBatcher::flush()
+{
+    if (_batch.frame_lengths.empty()) {
+        return;
+    }
+
+    if (_callback) {
+        _callback(std::move(_batch));
+    }
+
+    start_new_batch();
+}
+
+void MavlinkFrameBatcher::start_new_batch()
+{
+    _batch = Batch{};
+    _batch.frame_lengths.reserve(_max_frames_per_batch);
+    _batch.timestamps_us.reserve(_max_frames_per_batch);
+    // Most frames are well below the maximum length, so this usually avoids
+    // reallocations while the batch is filled.
+    _batch.data.reserve(_max_frames_per_batch * (MAVLINK_MAX_PACKET_LEN / 4));
+}
+
+} // namespace mavsdk
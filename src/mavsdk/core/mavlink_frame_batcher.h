@@ -0,0 +1,69 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include "mavsdk_time.h"
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace mavsdk {
+
+// Collects raw serialized MAVLink frames into batches, so that consumers
+// which need every frame (recorders, bridges) pay the callback overhead
+// once per batch instead of once per message.
+class MavlinkFrameBatcher {
+public:
+    struct Filter {
+        // Empty means all message IDs are accepted.
+        std::vector<uint32_t> message_ids{};
+        // Empty means all system IDs are accepted.
+        std::vector<uint8_t> system_ids{};
+    };
+
+    struct Batch {
+        // Frames are stored back to back as they would appear on the wire.
+        std::vector<uint8_t> data{};
+        std::vector<uint32_t> frame_lengths{};
+        std::vector<uint64_t> timestamps_us{};
+    };
+
+    using BatchCallback = std::function<void(Batch)>;
+
+    MavlinkFrameBatcher(
+        const Filter& filter,
+        unsigned max_frames_per_batch,
+        double max_batch_latency_s,
+        BatchCallback callback);
+    ~MavlinkFrameBatcher() = default;
+
+    [[nodiscard]] bool accepts(const mavlink_message_t& message) const;
+
+    // The frame needs to be serialized already, so it can be shared between
+    // several batchers.
+    void add_frame(
+        const uint8_t* frame, uint16_t frame_len, uint64_t timestamp_us, const dl_time_t& now);
+
+    void flush_if_due(const dl_time_t& now);
+    void flush();
+
+    // Non-copyable
+    MavlinkFrameBatcher(const MavlinkFrameBatcher&) = delete;
+    const MavlinkFrameBatcher& operator=(const MavlinkFrameBatcher&) = delete;
+
+private:
+    void start_new_batch();
+
+    std::vector<uint32_t> _message_ids{};
+    std::bitset<256> _system_ids{};
+    bool _all_system_ids{true};
+
+    const unsigned _max_frames_per_batch;
+    const double _max_batch_latency_s;
+    BatchCallback _callback;
+
+    Batch _batch{};
+    dl_time_t _batch_started{};
+};
+
+} // namespace mavsdk
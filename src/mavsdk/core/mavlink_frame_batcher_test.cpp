@@ -0,0 +1,92 @@
+#include "mavlink_frame_batcher.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace mavsdk;
+
+static mavlink_message_t make_message(uint8_t sysid, uint32_t msgid)
+{
+    mavlink_message_t message{};
+    message.sysid = sysid;
+    message.compid = 1;
+    message.msgid = msgid;
+    return message;
+}
+
+TEST(MavlinkFrameBatcher, AcceptsEverythingWithoutFilter)
+{
+    MavlinkFrameBatcher batcher({}, 10, 1.0, nullptr);
+
+    EXPECT_TRUE(batcher.accepts(make_message(1, 0)));
+    EXPECT_TRUE(batcher.accepts(make_message(42, 33)));
+    EXPECT_TRUE(batcher.accepts(make_message(255, 12345)));
+}
+
+TEST(MavlinkFrameBatcher, FiltersByMessageAndSystemId)
+{
+    MavlinkFrameBatcher::Filter filter{};
+    filter.message_ids = {33, 0, 30};
+    filter.system_ids = {1, 2};
+    MavlinkFrameBatcher batcher(filter, 10, 1.0, nullptr);
+
+    EXPECT_TRUE(batcher.accepts(make_message(1, 0)));
+    EXPECT_TRUE(batcher.accepts(make_message(2, 33)));
+    EXPECT_TRUE(batcher.accepts(make_message(1, 30)));
+    EXPECT_FALSE(batcher.accepts(make_message(3, 33)));
+    EXPECT_FALSE(batcher.accepts(make_message(1, 31)));
+}
+
+TEST(MavlinkFrameBatcher, FlushesWhenBatchIsFull)
+{
+    std::vector<MavlinkFrameBatcher::Batch> batches;
+    MavlinkFrameBatcher batcher({}, 3, 10.0, [&batches](MavlinkFrameBatcher::Batch batch) {
+        batches.push_back(std::move(batch));
+    });
+
+    Time time;
+    const auto now = time.steady_time();
+    const uint8_t frame_a[] = {1, 2, 3};
+    const uint8_t frame_b[] = {4, 5};
+
+    batcher.add_frame(frame_a, sizeof(frame_a), 100, now);
+    batcher.add_frame(frame_b, sizeof(frame_b), 200, now);
+    EXPECT_TRUE(batches.empty());
+
+    batcher.add_frame(frame_a, sizeof(frame_a), 300, now);
+    ASSERT_EQ(batches.size(), 1);
+
+    const std::vector<uint8_t> expected_data{1, 2, 3, 4, 5, 1, 2, 3};
+    const std::vector<uint32_t> expected_lengths{3, 2, 3};
+    const std::vector<uint64_t> expected_timestamps{100, 200, 300};
+    EXPECT_EQ(batches[0].data, expected_data);
+    EXPECT_EQ(batches[0].frame_lengths, expected_lengths);
+    EXPECT_EQ(batches[0].timestamps_us, expected_timestamps);
+
+    // The next batch starts empty.
+    batcher.add_frame(frame_b, sizeof(frame_b), 400, now);
+    batcher.flush();
+    ASSERT_EQ(batches.size(), 2);
+    EXPECT_EQ(batches[1].frame_lengths.size(), 1);
+}
+
+TEST(MavlinkFrameBatcher, FlushesAfterLatency)
+{
+    unsigned num_batches = 0;
+    MavlinkFrameBatcher batcher(
+        {}, 100, 0.05, [&num_batches](MavlinkFrameBatcher::Batch) { ++num_batches; });
+
+    Time time;
+    const auto start = time.steady_time();
+    const uint8_t frame[] = {1, 2, 3};
+
+    // Nothing to flush yet.
+    batcher.flush_if_due(start + std::chrono::seconds(1));
+    EXPECT_EQ(num_batches, 0);
+
+    batcher.add_frame(frame, sizeof(frame), 0, start);
+    batcher.flush_if_due(start + std::chrono::milliseconds(10));
+    EXPECT_EQ(num_batches, 0);
+
+    batcher.flush_if_due(start + std::chrono::milliseconds(60));
+    EXPECT_EQ(num_batches, 1);
+}
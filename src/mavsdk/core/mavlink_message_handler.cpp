@@ -1,5 +1,6 @@
 #include <mutex>
 #include "mavlink_message_handler.h"
+#include "metrics.h"
 
 namespace mavsdk {
 
@@ -55,6 +56,21 @@ void MavlinkMessageHandler::unregister_all(const void* cookie)
 void MavlinkMessageHandler::process_message(const mavlink_message_t& message)
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    process_message_locked(message);
+}
+
+void MavlinkMessageHandler::process_messages(const mavlink_message_t* messages, std::size_t count)
+{
+    // One lock for the whole batch.
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (std::size_t i = 0; i < count; ++i) {
+        process_message_locked(messages[i]);
+    }
+}
+
+void MavlinkMessageHandler::process_message_locked(const mavlink_message_t& message)
+{
+    MetricsTimer timer(Metrics::instance().message_handler_execution);
 
 #if MESSAGE_DEBUGGING == 1
     bool forwarded = false;
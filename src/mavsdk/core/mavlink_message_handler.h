@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <mutex>
@@ -29,9 +30,12 @@ public:
     void unregister_one(uint16_t msg_id, const void* cookie);
     void unregister_all(const void* cookie);
     void process_message(const mavlink_message_t& message);
+    void process_messages(const mavlink_message_t* messages, std::size_t count);
     void update_component_id(uint16_t msg_id, uint8_t cmp_id, const void* cookie);
 
 private:
+    void process_message_locked(const mavlink_message_t& message);
+
     std::mutex _mutex{};
     std::vector<Entry> _table{};
 };
@@ -1,6 +1,7 @@
 #include <algorithm>
 #include "mavlink_mission_transfer.h"
 #include "log.h"
+#include "metrics.h"
 #include "unused.h"
 
 namespace mavsdk {
@@ -21,6 +22,30 @@ MavlinkMissionTransfer::MavlinkMissionTransfer(
             _debugging = true;
         }
     }
+
+    if (const char* env_p = std::getenv("MAVSDK_MISSION_DOWNLOAD_WINDOW")) {
+        set_download_window(static_cast<std::size_t>(std::max(1, std::atoi(env_p))));
+        LogDebug() << "Mission download window: " << _download_window;
+    }
+
+    // To notice when someone else changes the mission on the vehicle.
+    _message_handler.register_one(
+        MAVLINK_MSG_ID_MISSION_ACK,
+        [this](const mavlink_message_t& message) { process_mission_ack(message); },
+        this);
+    _message_handler.register_one(
+        MAVLINK_MSG_ID_MISSION_CURRENT,
+        [this](const mavlink_message_t& message) { process_mission_current(message); },
+        this);
+    _message_handler.register_one(
+        MAVLINK_MSG_ID_MISSION_COUNT,
+        [this](const mavlink_message_t& message) { process_mission_count(message); },
+        this);
+}
+
+MavlinkMissionTransfer::~MavlinkMissionTransfer()
+{
+    _message_handler.unregister_all(this);
 }
 
 std::weak_ptr<MavlinkMissionTransfer::WorkItem> MavlinkMissionTransfer::upload_items_async(
@@ -28,6 +53,51 @@ std::weak_ptr<MavlinkMissionTransfer::WorkItem> MavlinkMissionTransfer::upload_i
     const std::vector<ItemInt>& items,
     const ResultCallback& callback,
     const ProgressCallback& progress_callback)
+{
+    return queue_upload(type, items, {}, callback, progress_callback);
+}
+
+std::weak_ptr<MavlinkMissionTransfer::WorkItem> MavlinkMissionTransfer::update_items_async(
+    uint8_t type,
+    const std::vector<ItemInt>& items,
+    const ResultCallback& callback,
+    const ProgressCallback& progress_callback)
+{
+    std::vector<Range> partial_ranges;
+    bool unchanged = false;
+    {
+        std::lock_guard<std::mutex> lock(_vehicle_items_mutex);
+        auto it = _vehicle_items.find(type);
+        // Partial writes can only replace items, not add or remove any.
+        if (_partial_writes_supported && it != _vehicle_items.end() && !items.empty() &&
+            it->second.size() == items.size()) {
+            partial_ranges = changed_ranges(it->second, items);
+            unchanged = partial_ranges.empty();
+        }
+    }
+
+    if (unchanged) {
+        if (_debugging) {
+            LogDebug() << "Mission unchanged, nothing to upload";
+        }
+        if (progress_callback) {
+            progress_callback(1.0f);
+        }
+        if (callback) {
+            callback(Result::Success);
+        }
+        return {};
+    }
+
+    return queue_upload(type, items, std::move(partial_ranges), callback, progress_callback);
+}
+
+std::weak_ptr<MavlinkMissionTransfer::WorkItem> MavlinkMissionTransfer::queue_upload(
+    uint8_t type,
+    const std::vector<ItemInt>& items,
+    std::vector<Range> partial_ranges,
+    const ResultCallback& callback,
+    const ProgressCallback& progress_callback)
 {
     if (!_int_messages_supported) {
         if (callback) {
@@ -44,9 +114,21 @@ std::weak_ptr<MavlinkMissionTransfer::WorkItem> MavlinkMissionTransfer::upload_i
         type,
         items,
         _timeout_s_callback(),
-        callback,
+        [this, type, items, callback](Result result) {
+            // After anything but success we can't tell what the vehicle has.
+            if (result == Result::Success) {
+                remember_vehicle_items(type, items);
+            } else {
+                forget_vehicle_items(type);
+            }
+            if (callback) {
+                callback(result);
+            }
+        },
         progress_callback,
-        _debugging);
+        _debugging,
+        std::move(partial_ranges),
+        [this]() { _partial_writes_supported = false; });
 
     _work_queue.push_back(ptr);
 
@@ -70,9 +152,17 @@ std::weak_ptr<MavlinkMissionTransfer::WorkItem> MavlinkMissionTransfer::download
         _timeout_handler,
         type,
         _timeout_s_callback(),
-        callback,
+        [this, type, callback](Result result, std::vector<ItemInt> items) {
+            if (result == Result::Success) {
+                remember_vehicle_items(type, items);
+            }
+            if (callback) {
+                callback(result, std::move(items));
+            }
+        },
         progress_callback,
-        _debugging);
+        _debugging,
+        _download_window);
 
     _work_queue.push_back(ptr);
 
@@ -115,7 +205,12 @@ void MavlinkMissionTransfer::clear_items_async(uint8_t type, ResultCallback call
         _timeout_handler,
         type,
         _timeout_s_callback(),
-        callback,
+        [this, type, callback](Result result) {
+            forget_vehicle_items(type);
+            if (callback) {
+                callback(result);
+            }
+        },
         _debugging);
 
     _work_queue.push_back(ptr);
@@ -158,6 +253,108 @@ bool MavlinkMissionTransfer::is_idle()
     return (work_queue_guard.get_front() == nullptr);
 }
 
+std::optional<std::vector<MavlinkMissionTransfer::ItemInt>>
+MavlinkMissionTransfer::vehicle_items(uint8_t type)
+{
+    std::lock_guard<std::mutex> lock(_vehicle_items_mutex);
+    auto it = _vehicle_items.find(type);
+    if (it == _vehicle_items.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+std::vector<MavlinkMissionTransfer::Range> MavlinkMissionTransfer::changed_ranges(
+    const std::vector<ItemInt>& before, const std::vector<ItemInt>& after)
+{
+    std::vector<Range> ranges;
+
+    const auto size = std::min(before.size(), after.size());
+    for (std::size_t i = 0; i < size; ++i) {
+        if (before[i] == after[i]) {
+            continue;
+        }
+        const auto seq = static_cast<uint16_t>(i);
+        if (!ranges.empty() &&
+            static_cast<std::size_t>(seq - ranges.back().end) <= max_merge_gap + 1) {
+            ranges.back().end = seq;
+        } else {
+            ranges.push_back(Range{seq, seq});
+        }
+    }
+
+    return ranges;
+}
+
+void MavlinkMissionTransfer::remember_vehicle_items(
+    uint8_t type, const std::vector<ItemInt>& items)
+{
+    std::lock_guard<std::mutex> lock(_vehicle_items_mutex);
+    _vehicle_items[type] = items;
+}
+
+void MavlinkMissionTransfer::forget_vehicle_items(uint8_t type)
+{
+    std::lock_guard<std::mutex> lock(_vehicle_items_mutex);
+    if (type == MAV_MISSION_TYPE_ALL) {
+        _vehicle_items.clear();
+    } else {
+        _vehicle_items.erase(type);
+    }
+}
+
+void MavlinkMissionTransfer::process_mission_ack(const mavlink_message_t& message)
+{
+    if (message.sysid != _sender.get_system_id()) {
+        return;
+    }
+
+    mavlink_mission_ack_t mission_ack;
+    mavlink_msg_mission_ack_decode(&message, &mission_ack);
+
+    // Our own transfers are acked to us, an accepted one to anyone else means
+    // the items on the vehicle were replaced.
+    if (mission_ack.type == MAV_MISSION_ACCEPTED &&
+        (mission_ack.target_system != _sender.get_own_system_id() ||
+         mission_ack.target_component != _sender.get_own_component_id())) {
+        forget_vehicle_items(mission_ack.mission_type);
+    }
+}
+
+void MavlinkMissionTransfer::process_mission_current(const mavlink_message_t& message)
+{
+    if (message.sysid != _sender.get_system_id()) {
+        return;
+    }
+
+    mavlink_mission_current_t mission_current;
+    mavlink_msg_mission_current_decode(&message, &mission_current);
+
+    // Past the end of the items we know, so they must have been replaced.
+    std::lock_guard<std::mutex> lock(_vehicle_items_mutex);
+    const auto it = _vehicle_items.find(MAV_MISSION_TYPE_MISSION);
+    if (it != _vehicle_items.end() && mission_current.seq > it->second.size()) {
+        _vehicle_items.erase(it);
+    }
+}
+
+void MavlinkMissionTransfer::process_mission_count(const mavlink_message_t& message)
+{
+    if (message.sysid != _sender.get_system_id()) {
+        return;
+    }
+
+    mavlink_mission_count_t mission_count;
+    mavlink_msg_mission_count_decode(&message, &mission_count);
+
+    // Sent by the vehicle when its items are downloaded, by us or anyone else.
+    std::lock_guard<std::mutex> lock(_vehicle_items_mutex);
+    const auto it = _vehicle_items.find(mission_count.mission_type);
+    if (it != _vehicle_items.end() && mission_count.count != it->second.size()) {
+        _vehicle_items.erase(it);
+    }
+}
+
 MavlinkMissionTransfer::WorkItem::WorkItem(
     Sender& sender,
     MavlinkMessageHandler& message_handler,
@@ -196,12 +393,24 @@ MavlinkMissionTransfer::UploadWorkItem::UploadWorkItem(
     double timeout_s,
     ResultCallback callback,
     ProgressCallback progress_callback,
-    bool debugging) :
+    bool debugging,
+    std::vector<Range> partial_ranges,
+    std::function<void()> partial_rejected_callback) :
     WorkItem(sender, message_handler, timeout_handler, type, timeout_s, debugging),
     _items(items),
     _callback(callback),
-    _progress_callback(progress_callback)
+    _progress_callback(progress_callback),
+    _partial_ranges(std::move(partial_ranges)),
+    _partial_rejected_callback(std::move(partial_rejected_callback)),
+    _num_items_to_send(items.size())
 {
+    if (!_partial_ranges.empty()) {
+        _num_items_to_send = 0;
+        for (const auto& range : _partial_ranges) {
+            _num_items_to_send += range.end - range.start + 1;
+        }
+    }
+
     std::lock_guard<std::mutex> lock(_mutex);
 
     _message_handler.register_one(
@@ -264,9 +473,17 @@ void MavlinkMissionTransfer::UploadWorkItem::start()
     update_progress(0.0f);
 
     _retries_done = 0;
-    _step = Step::SendCount;
     _timeout_handler.add([this]() { process_timeout(); }, _timeout_s, &_cookie);
 
+    if (!_partial_ranges.empty()) {
+        _step = Step::SendPartialList;
+        _current_range = 0;
+        _next_sequence = _partial_ranges[0].start;
+        send_partial_list();
+        return;
+    }
+
+    _step = Step::SendCount;
     _next_sequence = 0;
 
     send_count();
@@ -306,6 +523,57 @@ void MavlinkMissionTransfer::UploadWorkItem::send_count()
     ++_retries_done;
 }
 
+void MavlinkMissionTransfer::UploadWorkItem::send_partial_list()
+{
+    const auto& range = _partial_ranges[_current_range];
+
+    mavlink_message_t message;
+    mavlink_msg_mission_write_partial_list_pack(
+        _sender.get_own_system_id(),
+        _sender.get_own_component_id(),
+        &message,
+        _sender.get_system_id(),
+        MAV_COMP_ID_AUTOPILOT1,
+        range.start,
+        range.end,
+        _type);
+
+    if (!_sender.send_message(message)) {
+        _timeout_handler.remove(_cookie);
+        callback_and_reset(Result::ConnectionError);
+        return;
+    }
+
+    if (_debugging) {
+        LogDebug() << "Sending write_partial_list, start: " << range.start
+                   << ", end: " << range.end << ", retries: " << _retries_done;
+    }
+
+    ++_retries_done;
+}
+
+void MavlinkMissionTransfer::UploadWorkItem::fall_back_to_full_upload()
+{
+    LogWarn() << "Partial mission upload not accepted, uploading all items";
+
+    if (_partial_rejected_callback) {
+        _partial_rejected_callback();
+    }
+
+    _partial_ranges.clear();
+    _num_items_to_send = _items.size();
+    _num_items_sent_before = 0;
+
+    _retries_done = 0;
+    _step = Step::SendCount;
+    _timeout_handler.remove(_cookie);
+    _timeout_handler.add([this]() { process_timeout(); }, _timeout_s, &_cookie);
+
+    _next_sequence = 0;
+
+    send_count();
+}
+
 void MavlinkMissionTransfer::UploadWorkItem::send_cancel_and_finish()
 {
     mavlink_message_t message;
@@ -380,13 +648,23 @@ void MavlinkMissionTransfer::UploadWorkItem::process_mission_request_int(
     mavlink_mission_request_int_t request_int;
     mavlink_msg_mission_request_int_decode(&message, &request_int);
 
-    _step = Step::SendItems;
-
     if (_debugging) {
         LogDebug() << "Process mission_request_int, seq: " << request_int.seq
                    << ", next expected sequence: " << _next_sequence;
     }
 
+    // In a partial upload only the items of the current range are requested.
+    const std::size_t first_sequence =
+        _partial_ranges.empty() ? 0 : _partial_ranges[_current_range].start;
+    const std::size_t last_sequence =
+        _partial_ranges.empty() ? _items.size() - 1 : _partial_ranges[_current_range].end;
+    if (request_int.seq < first_sequence || request_int.seq > last_sequence) {
+        LogWarn() << "mission_request_int: sequence out of range";
+        return;
+    }
+
+    _step = Step::SendItems;
+
     if (_next_sequence < request_int.seq) {
         // We should not go back to a previous one.
         // TODO: figure out if we should error here.
@@ -412,7 +690,9 @@ void MavlinkMissionTransfer::UploadWorkItem::process_mission_request_int(
     _next_sequence = request_int.seq;
 
     // We add in a step for the final ack, so plus one.
-    update_progress(static_cast<float>(_next_sequence + 1) / static_cast<float>(_items.size() + 1));
+    update_progress(
+        static_cast<float>(_num_items_sent_before + _next_sequence - first_sequence + 1) /
+        static_cast<float>(_num_items_to_send + 1));
 
     send_mission_item();
 }
@@ -472,6 +752,13 @@ void MavlinkMissionTransfer::UploadWorkItem::process_mission_ack(const mavlink_m
         LogDebug() << "Received mission_ack type: " << static_cast<int>(mission_ack.type);
     }
 
+    // Whatever the reason, a full upload still works if partial writes are rejected.
+    if (!_partial_ranges.empty() && mission_ack.type != MAV_MISSION_ACCEPTED &&
+        mission_ack.type != MAV_MISSION_OPERATION_CANCELLED) {
+        fall_back_to_full_upload();
+        return;
+    }
+
     _timeout_handler.remove(_cookie);
 
     switch (mission_ack.type) {
@@ -515,6 +802,28 @@ void MavlinkMissionTransfer::UploadWorkItem::process_mission_ack(const mavlink_m
             return;
     }
 
+    if (!_partial_ranges.empty()) {
+        const auto& range = _partial_ranges[_current_range];
+        if (_next_sequence != range.end + 1u) {
+            callback_and_reset(Result::ProtocolError);
+            return;
+        }
+
+        _num_items_sent_before += range.end - range.start + 1;
+        if (++_current_range < _partial_ranges.size()) {
+            _retries_done = 0;
+            _step = Step::SendPartialList;
+            _next_sequence = _partial_ranges[_current_range].start;
+            _timeout_handler.add([this]() { process_timeout(); }, _timeout_s, &_cookie);
+            send_partial_list();
+            return;
+        }
+
+        update_progress(1.0f);
+        callback_and_reset(Result::Success);
+        return;
+    }
+
     if (_next_sequence == _items.size()) {
         update_progress(1.0f);
         callback_and_reset(Result::Success);
@@ -527,6 +836,8 @@ void MavlinkMissionTransfer::UploadWorkItem::process_timeout()
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
+    Metrics::instance().mission_timeouts.add();
+
     if (_debugging) {
         LogDebug() << "Timeout triggered, retries: " << _retries_done;
     }
@@ -537,12 +848,23 @@ void MavlinkMissionTransfer::UploadWorkItem::process_timeout()
         return;
     }
 
+    Metrics::instance().mission_retries.add();
+
     switch (_step) {
         case Step::SendCount:
             _timeout_handler.add([this]() { process_timeout(); }, _timeout_s, &_cookie);
             send_count();
             break;
 
+        case Step::SendPartialList:
+            if (_retries_done >= partial_list_retries) {
+                fall_back_to_full_upload();
+                break;
+            }
+            _timeout_handler.add([this]() { process_timeout(); }, _timeout_s, &_cookie);
+            send_partial_list();
+            break;
+
         case Step::SendItems:
             // When waiting for items requested we should wait longer than
             // just our timeout, otherwise we give up too quickly.
@@ -576,10 +898,12 @@ MavlinkMissionTransfer::DownloadWorkItem::DownloadWorkItem(
     double timeout_s,
     ResultAndItemsCallback callback,
     ProgressCallback progress_callback,
-    bool debugging) :
+    bool debugging,
+    std::size_t window) :
     WorkItem(sender, message_handler, timeout_handler, type, timeout_s, debugging),
     _callback(callback),
-    _progress_callback(progress_callback)
+    _progress_callback(progress_callback),
+    _window(std::max<std::size_t>(window, 1))
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
@@ -644,6 +968,15 @@ void MavlinkMissionTransfer::DownloadWorkItem::request_list()
 }
 
 void MavlinkMissionTransfer::DownloadWorkItem::request_item()
+{
+    if (!send_request_int(_next_sequence)) {
+        return;
+    }
+
+    ++_retries_done;
+}
+
+bool MavlinkMissionTransfer::DownloadWorkItem::send_request_int(std::size_t sequence)
 {
     mavlink_message_t message;
     mavlink_msg_mission_request_int_pack(
@@ -652,13 +985,30 @@ void MavlinkMissionTransfer::DownloadWorkItem::request_item()
         &message,
         _sender.get_system_id(),
         MAV_COMP_ID_AUTOPILOT1,
-        _next_sequence,
+        static_cast<uint16_t>(sequence),
         _type);
 
     if (!_sender.send_message(message)) {
         _timeout_handler.remove(_cookie);
         callback_and_reset(Result::ConnectionError);
-        return;
+        return false;
+    }
+
+    return true;
+}
+
+void MavlinkMissionTransfer::DownloadWorkItem::request_missing_items()
+{
+    // Everything requested so far which didn't arrive, at most a window full.
+    for (std::size_t sequence = 0; sequence < _next_sequence; ++sequence) {
+        if (!_received[sequence]) {
+            if (_debugging) {
+                LogDebug() << "Requesting missing item " << sequence << " again";
+            }
+            if (!send_request_int(sequence)) {
+                return;
+            }
+        }
     }
 
     ++_retries_done;
@@ -725,7 +1075,24 @@ void MavlinkMissionTransfer::DownloadWorkItem::process_mission_count(
     _step = Step::RequestItem;
     _retries_done = 0;
     _expected_count = count.count;
-    request_item();
+
+    if (!is_pipelined()) {
+        request_item();
+        return;
+    }
+
+    // Items can arrive in any order, so they go straight into their place.
+    _items.assign(_expected_count, ItemInt{});
+    _received.assign(_expected_count, false);
+    _num_received = 0;
+
+    while (_next_sequence < std::min(_window, _expected_count)) {
+        if (!send_request_int(_next_sequence)) {
+            return;
+        }
+        ++_next_sequence;
+    }
+    ++_retries_done;
 }
 
 void MavlinkMissionTransfer::DownloadWorkItem::process_mission_item_int(
@@ -738,6 +1105,11 @@ void MavlinkMissionTransfer::DownloadWorkItem::process_mission_item_int(
     mavlink_mission_item_int_t item_int;
     mavlink_msg_mission_item_int_decode(&message, &item_int);
 
+    if (is_pipelined()) {
+        process_pipelined_item_int(item_int);
+        return;
+    }
+
     // If we have already received the item previously, we have to ignore it.
     if (_next_sequence == item_int.seq) {
         _items.push_back(ItemInt{
@@ -770,15 +1142,64 @@ void MavlinkMissionTransfer::DownloadWorkItem::process_mission_item_int(
     }
 }
 
+void MavlinkMissionTransfer::DownloadWorkItem::process_pipelined_item_int(
+    const mavlink_mission_item_int_t& item_int)
+{
+    // Unrequested and duplicate items are ignored.
+    if (_step != Step::RequestItem || item_int.seq >= _next_sequence || _received[item_int.seq]) {
+        return;
+    }
+
+    _items[item_int.seq] = ItemInt{
+        item_int.seq,
+        item_int.frame,
+        item_int.command,
+        item_int.current,
+        item_int.autocontinue,
+        item_int.param1,
+        item_int.param2,
+        item_int.param3,
+        item_int.param4,
+        item_int.x,
+        item_int.y,
+        item_int.z,
+        item_int.mission_type};
+    _received[item_int.seq] = true;
+    ++_num_received;
+    // Progress was made, the outstanding requests count as the first try again.
+    _retries_done = 1;
+
+    if (_num_received == _expected_count) {
+        _timeout_handler.remove(_cookie);
+        update_progress(1.0f);
+        send_ack_and_finish();
+        return;
+    }
+
+    update_progress(static_cast<float>(_num_received) / static_cast<float>(_expected_count));
+
+    // Every item which arrives makes room for the next request.
+    if (_next_sequence < _expected_count) {
+        if (!send_request_int(_next_sequence)) {
+            return;
+        }
+        ++_next_sequence;
+    }
+}
+
 void MavlinkMissionTransfer::DownloadWorkItem::process_timeout()
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
+    Metrics::instance().mission_timeouts.add();
+
     if (_retries_done >= retries) {
         callback_and_reset(Result::Timeout);
         return;
     }
 
+    Metrics::instance().mission_retries.add();
+
     switch (_step) {
         case Step::RequestList:
             _timeout_handler.add([this]() { process_timeout(); }, _timeout_s, &_cookie);
@@ -787,7 +1208,11 @@ void MavlinkMissionTransfer::DownloadWorkItem::process_timeout()
 
         case Step::RequestItem:
             _timeout_handler.add([this]() { process_timeout(); }, _timeout_s, &_cookie);
-            request_item();
+            if (is_pipelined()) {
+                request_missing_items();
+            } else {
+                request_item();
+            }
             break;
     }
 }
@@ -975,11 +1400,15 @@ void MavlinkMissionTransfer::ReceiveIncomingMission::process_timeout()
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
+    Metrics::instance().mission_timeouts.add();
+
     if (_retries_done >= retries) {
         callback_and_reset(Result::Timeout);
         return;
     }
 
+    Metrics::instance().mission_retries.add();
+
     _timeout_handler.add([this]() { process_timeout(); }, _timeout_s, &_cookie);
     request_item();
 }
@@ -1062,11 +1491,15 @@ void MavlinkMissionTransfer::ClearWorkItem::process_timeout()
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
+    Metrics::instance().mission_timeouts.add();
+
     if (_retries_done >= retries) {
         callback_and_reset(Result::Timeout);
         return;
     }
 
+    Metrics::instance().mission_retries.add();
+
     _timeout_handler.add([this]() { process_timeout(); }, _timeout_s, &_cookie);
     send_clear();
 }
@@ -1139,6 +1572,11 @@ void MavlinkMissionTransfer::set_int_messages_supported(bool supported)
     _int_messages_supported = supported;
 }
 
+void MavlinkMissionTransfer::set_download_window(std::size_t window)
+{
+    _download_window = std::clamp<std::size_t>(window, 1, max_download_window);
+}
+
 MavlinkMissionTransfer::SetCurrentWorkItem::SetCurrentWorkItem(
     Sender& sender,
     MavlinkMessageHandler& message_handler,
@@ -1237,11 +1675,15 @@ void MavlinkMissionTransfer::SetCurrentWorkItem::process_timeout()
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
+    Metrics::instance().mission_timeouts.add();
+
     if (_retries_done >= retries) {
         callback_and_reset(Result::Timeout);
         return;
     }
 
+    Metrics::instance().mission_retries.add();
+
     _timeout_handler.add([this]() { process_timeout(); }, _timeout_s, &_cookie);
     send_current_mission_item();
 }
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <unordered_map>
 #include <vector>
 #include "mavlink_address.h"
 #include "mavlink_include.h"
@@ -62,6 +65,17 @@ public:
         }
     };
 
+    // Inclusive range of sequence numbers, as used by MISSION_WRITE_PARTIAL_LIST.
+    struct Range {
+        uint16_t start;
+        uint16_t end;
+
+        bool operator==(const Range& other) const
+        {
+            return start == other.start && end == other.end;
+        }
+    };
+
     using ResultCallback = std::function<void(Result result)>;
     using ResultAndItemsCallback = std::function<void(Result result, std::vector<ItemInt> items)>;
     using ProgressCallback = std::function<void(float progress)>;
@@ -109,7 +123,9 @@ public:
             double timeout_s,
             ResultCallback callback,
             ProgressCallback progress_callback,
-            bool debugging);
+            bool debugging,
+            std::vector<Range> partial_ranges = {},
+            std::function<void()> partial_rejected_callback = nullptr);
 
         ~UploadWorkItem() override;
         void start() override;
@@ -122,8 +138,10 @@ public:
 
     private:
         void send_count();
+        void send_partial_list();
         void send_mission_item();
         void send_cancel_and_finish();
+        void fall_back_to_full_upload();
 
         void process_mission_request(const mavlink_message_t& message);
         void process_mission_request_int(const mavlink_message_t& message);
@@ -135,6 +153,7 @@ public:
 
         enum class Step {
             SendCount,
+            SendPartialList,
             SendItems,
         } _step{Step::SendCount};
 
@@ -144,6 +163,13 @@ public:
         std::size_t _next_sequence{0};
         void* _cookie{nullptr};
         unsigned _retries_done{0};
+
+        // Empty for a full upload.
+        std::vector<Range> _partial_ranges{};
+        std::function<void()> _partial_rejected_callback{nullptr};
+        std::size_t _current_range{0};
+        std::size_t _num_items_to_send{0};
+        std::size_t _num_items_sent_before{0};
     };
 
     class ReceiveIncomingMission : public WorkItem {
@@ -202,7 +228,8 @@ public:
             double timeout_s,
             ResultAndItemsCallback callback,
             ProgressCallback progress_callback,
-            bool debugging);
+            bool debugging,
+            std::size_t window = 1);
 
         ~DownloadWorkItem() override;
         void start() override;
@@ -216,15 +243,20 @@ public:
     private:
         void request_list();
         void request_item();
+        bool send_request_int(std::size_t sequence);
+        void request_missing_items();
         void send_ack_and_finish();
         void send_cancel_and_finish();
         void process_mission_count(const mavlink_message_t& message);
         void process_mission_item_int(const mavlink_message_t& message);
+        void process_pipelined_item_int(const mavlink_mission_item_int_t& item_int);
         void process_timeout();
         void callback_and_reset(Result result);
 
         void update_progress(float progress);
 
+        bool is_pipelined() const { return _window > 1; }
+
         enum class Step {
             RequestList,
             RequestItem,
@@ -234,9 +266,15 @@ public:
         ResultAndItemsCallback _callback{nullptr};
         ProgressCallback _progress_callback{nullptr};
         void* _cookie{nullptr};
+        // When pipelined, the next sequence which has not been requested yet.
         std::size_t _next_sequence{0};
         std::size_t _expected_count{0};
         unsigned _retries_done{0};
+
+        // How many item requests can be outstanding at once, 1 requests one after the other.
+        const std::size_t _window;
+        std::vector<bool> _received{};
+        std::size_t _num_received{0};
     };
 
     class ClearWorkItem : public WorkItem {
@@ -304,6 +342,14 @@ public:
     };
 
     static constexpr unsigned retries = 5;
+    // Autopilots which don't support partial writes might not answer at all,
+    // so we don't insist as long before uploading everything.
+    static constexpr unsigned partial_list_retries = 2;
+    // Unchanged items between two changed ranges are sent along if there are at
+    // most this many, which is cheaper than another partial list handshake.
+    static constexpr std::size_t max_merge_gap = 4;
+    // More outstanding item requests than this would only overrun radio buffers.
+    static constexpr std::size_t max_download_window = 32;
 
     explicit MavlinkMissionTransfer(
         Sender& sender,
@@ -311,7 +357,7 @@ public:
         TimeoutHandler& timeout_handler,
         TimeoutSCallback get_timeout_s_callback);
 
-    ~MavlinkMissionTransfer() = default;
+    ~MavlinkMissionTransfer();
 
     std::weak_ptr<WorkItem> upload_items_async(
         uint8_t type,
@@ -319,6 +365,15 @@ public:
         const ResultCallback& callback,
         const ProgressCallback& progress_callback = nullptr);
 
+    // Uploads only the items which differ from the last known copy on the vehicle,
+    // using MISSION_WRITE_PARTIAL_LIST. Everything is uploaded if there is no known
+    // copy, the number of items changed, or the autopilot rejects partial writes.
+    std::weak_ptr<WorkItem> update_items_async(
+        uint8_t type,
+        const std::vector<ItemInt>& items,
+        const ResultCallback& callback,
+        const ProgressCallback& progress_callback = nullptr);
+
     std::weak_ptr<WorkItem> download_items_async(
         uint8_t type,
         ResultAndItemsCallback callback,
@@ -340,11 +395,38 @@ public:
 
     void set_int_messages_supported(bool supported);
 
+    // Number of item requests kept outstanding during downloads. With more than one,
+    // items can arrive out of order and only missing ones are requested again on
+    // timeout. This saves a round trip per item but needs an autopilot which answers
+    // requests for any sequence, so the default is 1, one item after the other.
+    void set_download_window(std::size_t window);
+
+    // The items on the vehicle as last uploaded or downloaded, if known. They
+    // are forgotten when the vehicle reports a mission that doesn't match.
+    std::optional<std::vector<ItemInt>> vehicle_items(uint8_t type);
+    // E.g. when the connection was lost, as the mission could be changed meanwhile.
+    void forget_vehicle_items(uint8_t type);
+
+    static std::vector<Range>
+    changed_ranges(const std::vector<ItemInt>& before, const std::vector<ItemInt>& after);
+
     // Non-copyable
     MavlinkMissionTransfer(const MavlinkMissionTransfer&) = delete;
     const MavlinkMissionTransfer& operator=(const MavlinkMissionTransfer&) = delete;
 
 private:
+    std::weak_ptr<WorkItem> queue_upload(
+        uint8_t type,
+        const std::vector<ItemInt>& items,
+        std::vector<Range> partial_ranges,
+        const ResultCallback& callback,
+        const ProgressCallback& progress_callback);
+
+    void remember_vehicle_items(uint8_t type, const std::vector<ItemInt>& items);
+    void process_mission_ack(const mavlink_message_t& message);
+    void process_mission_current(const mavlink_message_t& message);
+    void process_mission_count(const mavlink_message_t& message);
+
     Sender& _sender;
     MavlinkMessageHandler& _message_handler;
     TimeoutHandler& _timeout_handler;
@@ -354,6 +436,11 @@ private:
 
     bool _int_messages_supported{true};
     bool _debugging{false};
+
+    std::mutex _vehicle_items_mutex{};
+    std::unordered_map<uint8_t, std::vector<ItemInt>> _vehicle_items{};
+    std::atomic<bool> _partial_writes_supported{true};
+    std::atomic<std::size_t> _download_window{1};
 };
 
 } // namespace mavsdk
@@ -1756,6 +1756,117 @@ TEST_F(MavlinkMissionTransferTest, DownloadMissionWithProgress)
     EXPECT_TRUE(mmt.is_idle());
 }
 
+static void expect_mission_request_int(MockSender& mock_sender, uint16_t sequence)
+{
+    EXPECT_CALL(mock_sender, send_message(Truly([sequence](const mavlink_message_t& message) {
+                    return is_correct_mission_request_int(
+                        MAV_MISSION_TYPE_MISSION, sequence, message);
+                })));
+}
+
+TEST_F(MavlinkMissionTransferTest, DownloadMissionPipelinedAcceptsItemsOutOfOrder)
+{
+    ON_CALL(mock_sender, send_message(_)).WillByDefault(Return(true));
+
+    std::vector<ItemInt> real_items;
+    for (uint16_t i = 0; i < 5; ++i) {
+        real_items.push_back(make_item(MAV_MISSION_TYPE_MISSION, i));
+    }
+
+    mmt.set_download_window(3);
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+    mmt.download_items_async(
+        MAV_MISSION_TYPE_MISSION,
+        [&prom, &real_items](Result result, const std::vector<ItemInt>& items) {
+            EXPECT_EQ(result, Result::Success);
+            EXPECT_EQ(items, real_items);
+            prom.set_value();
+        });
+    mmt.do_work();
+
+    // A whole window is requested at once.
+    expect_mission_request_int(mock_sender, 0);
+    expect_mission_request_int(mock_sender, 1);
+    expect_mission_request_int(mock_sender, 2);
+    message_handler.process_message(make_mission_count(real_items.size()));
+
+    // Items which weren't requested yet are ignored.
+    message_handler.process_message(make_mission_item(real_items, 4));
+
+    // Every item which arrives, in whatever order, makes room for another request.
+    expect_mission_request_int(mock_sender, 3);
+    message_handler.process_message(make_mission_item(real_items, 2));
+
+    expect_mission_request_int(mock_sender, 4);
+    message_handler.process_message(make_mission_item(real_items, 0));
+
+    // And so are duplicates.
+    message_handler.process_message(make_mission_item(real_items, 0));
+    message_handler.process_message(make_mission_item(real_items, 4));
+    message_handler.process_message(make_mission_item(real_items, 1));
+
+    EXPECT_CALL(mock_sender, send_message(Truly([](const mavlink_message_t& message) {
+                    return is_correct_mission_ack(
+                        MAV_MISSION_TYPE_MISSION, MAV_MISSION_ACCEPTED, message);
+                })));
+    message_handler.process_message(make_mission_item(real_items, 3));
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
+TEST_F(MavlinkMissionTransferTest, DownloadMissionPipelinedRequestsOnlyMissingItemsAgain)
+{
+    ON_CALL(mock_sender, send_message(_)).WillByDefault(Return(true));
+
+    std::vector<ItemInt> real_items;
+    for (uint16_t i = 0; i < 4; ++i) {
+        real_items.push_back(make_item(MAV_MISSION_TYPE_MISSION, i));
+    }
+
+    mmt.set_download_window(4);
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+    mmt.download_items_async(
+        MAV_MISSION_TYPE_MISSION,
+        [&prom, &real_items](Result result, const std::vector<ItemInt>& items) {
+            EXPECT_EQ(result, Result::Success);
+            EXPECT_EQ(items, real_items);
+            prom.set_value();
+        });
+    mmt.do_work();
+
+    for (uint16_t i = 0; i < 4; ++i) {
+        expect_mission_request_int(mock_sender, i);
+    }
+    message_handler.process_message(make_mission_count(real_items.size()));
+
+    message_handler.process_message(make_mission_item(real_items, 0));
+    message_handler.process_message(make_mission_item(real_items, 2));
+    message_handler.process_message(make_mission_item(real_items, 3));
+
+    // Item 1 got lost, it is the only one requested again.
+    expect_mission_request_int(mock_sender, 1);
+    time.sleep_for(std::chrono::milliseconds(static_cast<int>(timeout_s * 1.1 * 1000.)));
+    timeout_handler.run_once();
+
+    EXPECT_CALL(mock_sender, send_message(Truly([](const mavlink_message_t& message) {
+                    return is_correct_mission_ack(
+                        MAV_MISSION_TYPE_MISSION, MAV_MISSION_ACCEPTED, message);
+                })));
+    message_handler.process_message(make_mission_item(real_items, 1));
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
 bool is_correct_mission_clear_all(uint8_t type, const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_MISSION_CLEAR_ALL) {
@@ -1996,3 +2107,252 @@ TEST_F(MavlinkMissionTransferTest, IntMessagesNotSupported)
     mmt.do_work();
     EXPECT_TRUE(mmt.is_idle());
 }
+
+TEST(MavlinkMissionTransferRanges, ChangedRangesMergesCloseChanges)
+{
+    std::vector<ItemInt> before;
+    for (uint16_t i = 0; i < 30; ++i) {
+        before.push_back(make_item(MAV_MISSION_TYPE_MISSION, i));
+    }
+
+    EXPECT_TRUE(MavlinkMissionTransfer::changed_ranges(before, before).empty());
+
+    auto after = before;
+    after[2].x = 100;
+    after[3].x = 100;
+    // Only a few unchanged items in between, so it is sent along.
+    after[8].y = 100;
+    // Too far away.
+    after[20].z = 100.0f;
+
+    const std::vector<MavlinkMissionTransfer::Range> expected{{2, 8}, {20, 20}};
+    EXPECT_EQ(MavlinkMissionTransfer::changed_ranges(before, after), expected);
+}
+
+bool is_correct_mission_write_partial_list(
+    uint8_t type, int16_t start, int16_t end, const mavlink_message_t& message)
+{
+    if (message.msgid != MAVLINK_MSG_ID_MISSION_WRITE_PARTIAL_LIST) {
+        return false;
+    }
+
+    mavlink_mission_write_partial_list_t partial_list;
+    mavlink_msg_mission_write_partial_list_decode(&message, &partial_list);
+    return (
+        message.sysid == own_address.system_id && message.compid == own_address.component_id &&
+        partial_list.target_system == target_address.system_id &&
+        partial_list.target_component == target_address.component_id &&
+        partial_list.start_index == start && partial_list.end_index == end &&
+        partial_list.mission_type == type);
+}
+
+class MavlinkMissionTransferUpdateTest : public MavlinkMissionTransferTest {
+protected:
+    void SetUp() override
+    {
+        MavlinkMissionTransferTest::SetUp();
+        ON_CALL(mock_sender, send_message(_)).WillByDefault(Return(true));
+
+        for (uint16_t i = 0; i < 20; ++i) {
+            vehicle_items.push_back(make_item(MAV_MISSION_TYPE_MISSION, i));
+        }
+
+        // A full upload first, so that the items on the vehicle are known.
+        std::promise<void> prom;
+        auto fut = prom.get_future();
+        mmt.update_items_async(MAV_MISSION_TYPE_MISSION, vehicle_items, [&prom](Result result) {
+            EXPECT_EQ(result, Result::Success);
+            prom.set_value();
+        });
+        mmt.do_work();
+
+        for (uint16_t i = 0; i < vehicle_items.size(); ++i) {
+            message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, i));
+        }
+        message_handler.process_message(
+            make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_ACCEPTED));
+
+        EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+        mmt.do_work();
+        EXPECT_TRUE(mmt.is_idle());
+        EXPECT_EQ(mmt.vehicle_items(MAV_MISSION_TYPE_MISSION), vehicle_items);
+    }
+
+    std::vector<ItemInt> vehicle_items;
+};
+
+TEST_F(MavlinkMissionTransferUpdateTest, UpdateMissionSendsOnlyChangedItems)
+{
+    auto items = vehicle_items;
+    items[5].x = 100;
+    items[15].y = 100;
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+    mmt.update_items_async(MAV_MISSION_TYPE_MISSION, items, [&prom](Result result) {
+        EXPECT_EQ(result, Result::Success);
+        ONCE_ONLY;
+        prom.set_value();
+    });
+
+    EXPECT_CALL(mock_sender, send_message(Truly([](const mavlink_message_t& message) {
+                    return is_correct_mission_write_partial_list(
+                        MAV_MISSION_TYPE_MISSION, 5, 5, message);
+                })));
+    mmt.do_work();
+
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_the_same_mission_item_int(items[5], message);
+                })));
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 5));
+
+    EXPECT_CALL(mock_sender, send_message(Truly([](const mavlink_message_t& message) {
+                    return is_correct_mission_write_partial_list(
+                        MAV_MISSION_TYPE_MISSION, 15, 15, message);
+                })));
+    message_handler.process_message(
+        make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_ACCEPTED));
+
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_the_same_mission_item_int(items[15], message);
+                })));
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 15));
+
+    message_handler.process_message(
+        make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_ACCEPTED));
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    EXPECT_EQ(mmt.vehicle_items(MAV_MISSION_TYPE_MISSION), items);
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
+TEST_F(MavlinkMissionTransferUpdateTest, UpdateMissionWithoutChangesSendsNothing)
+{
+    EXPECT_CALL(mock_sender, send_message(_)).Times(0);
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+    mmt.update_items_async(MAV_MISSION_TYPE_MISSION, vehicle_items, [&prom](Result result) {
+        EXPECT_EQ(result, Result::Success);
+        ONCE_ONLY;
+        prom.set_value();
+    });
+    mmt.do_work();
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_TRUE(mmt.is_idle());
+}
+
+TEST_F(MavlinkMissionTransferUpdateTest, UpdateMissionFallsBackToFullUpload)
+{
+    auto items = vehicle_items;
+    items[5].x = 100;
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+    mmt.update_items_async(MAV_MISSION_TYPE_MISSION, items, [&prom](Result result) {
+        EXPECT_EQ(result, Result::Success);
+        ONCE_ONLY;
+        prom.set_value();
+    });
+    mmt.do_work();
+
+    // The autopilot doesn't do partial writes, so we upload everything instead.
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_correct_mission_send_count(
+                        MAV_MISSION_TYPE_MISSION, items.size(), message);
+                })));
+    message_handler.process_message(
+        make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_UNSUPPORTED));
+
+    EXPECT_CALL(mock_sender, send_message(_)).Times(::testing::AnyNumber());
+    for (uint16_t i = 0; i < items.size(); ++i) {
+        message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, i));
+    }
+    message_handler.process_message(
+        make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_ACCEPTED));
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    EXPECT_EQ(mmt.vehicle_items(MAV_MISSION_TYPE_MISSION), items);
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+
+    // From now on we don't try partial writes anymore.
+    items[6].x = 100;
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_correct_mission_send_count(
+                        MAV_MISSION_TYPE_MISSION, items.size(), message);
+                })));
+    mmt.update_items_async(MAV_MISSION_TYPE_MISSION, items, nullptr);
+    mmt.do_work();
+}
+
+TEST_F(MavlinkMissionTransferUpdateTest, UpdateMissionAfterSomeoneElseChangedItUploadsAll)
+{
+    // The vehicle accepted a mission from another ground station.
+    mavlink_message_t ack;
+    mavlink_msg_mission_ack_pack(
+        target_address.system_id,
+        target_address.component_id,
+        &ack,
+        own_address.system_id + 1,
+        own_address.component_id,
+        MAV_MISSION_ACCEPTED,
+        MAV_MISSION_TYPE_MISSION);
+    message_handler.process_message(ack);
+
+    EXPECT_FALSE(mmt.vehicle_items(MAV_MISSION_TYPE_MISSION));
+
+    auto items = vehicle_items;
+    items[5].x = 100;
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_correct_mission_send_count(
+                        MAV_MISSION_TYPE_MISSION, items.size(), message);
+                })));
+    mmt.update_items_async(MAV_MISSION_TYPE_MISSION, items, nullptr);
+    mmt.do_work();
+}
+
+TEST_F(MavlinkMissionTransferUpdateTest, ForgetsVehicleItemsWhenMissionCurrentIsPastTheEnd)
+{
+    mavlink_message_t message;
+    mavlink_msg_mission_current_pack(
+        target_address.system_id, target_address.component_id, &message, 12, 0, 0, 0);
+    message_handler.process_message(message);
+    EXPECT_TRUE(mmt.vehicle_items(MAV_MISSION_TYPE_MISSION));
+
+    mavlink_msg_mission_current_pack(
+        target_address.system_id, target_address.component_id, &message, 21, 0, 0, 0);
+    message_handler.process_message(message);
+    EXPECT_FALSE(mmt.vehicle_items(MAV_MISSION_TYPE_MISSION));
+}
+
+TEST_F(MavlinkMissionTransferUpdateTest, ForgetsVehicleItemsWhenMissionCountChanges)
+{
+    // The vehicle telling another ground station about its mission.
+    mavlink_message_t message;
+    mavlink_msg_mission_count_pack(
+        target_address.system_id,
+        target_address.component_id,
+        &message,
+        own_address.system_id + 1,
+        own_address.component_id,
+        vehicle_items.size(),
+        MAV_MISSION_TYPE_MISSION);
+    message_handler.process_message(message);
+    EXPECT_TRUE(mmt.vehicle_items(MAV_MISSION_TYPE_MISSION));
+
+    mavlink_msg_mission_count_pack(
+        target_address.system_id,
+        target_address.component_id,
+        &message,
+        own_address.system_id + 1,
+        own_address.component_id,
+        vehicle_items.size() + 1,
+        MAV_MISSION_TYPE_MISSION);
+    message_handler.process_message(message);
+    EXPECT_FALSE(mmt.vehicle_items(MAV_MISSION_TYPE_MISSION));
+}
@@ -1,5 +1,6 @@
 #include "mavlink_parameter_sender.h"
 #include "mavlink_message_handler.h"
+#include "metrics.h"
 #include "timeout_handler.h"
 #include "system_impl.h"
 #include <algorithm>
@@ -393,6 +394,40 @@ MavlinkParameterSender::get_param_custom(const std::string& name)
     return res.get();
 }
 
+void MavlinkParameterSender::get_params_async(
+    const std::vector<std::string>& names,
+    const GetParamsCallback& callback,
+    const void* cookie)
+{
+    std::vector<std::string> unique_names;
+    for (const auto& name : names) {
+        if (name.size() > MavlinkParameterSet::PARAM_ID_LEN) {
+            LogErr() << "Error: param name too long";
+            if (callback) {
+                callback(Result::ParamNameTooLong, {});
+            }
+            return;
+        }
+        if (std::find(unique_names.begin(), unique_names.end(), name) == unique_names.end()) {
+            unique_names.push_back(name);
+        }
+    }
+    if (unique_names.empty()) {
+        if (callback) {
+            callback(Result::Success, {});
+        }
+        return;
+    }
+    if (_parameter_debugging) {
+        LogDebug() << "getting " << unique_names.size()
+                   << " params, extended: " << (_use_extended ? "yes" : "no");
+    }
+    auto new_work = std::make_shared<WorkItem>(
+        get_current_timeout_seconds(), WorkItemGetBatch{std::move(unique_names), callback}, cookie);
+    new_work->retries_to_do = get_current_n_retransmissions();
+    _work_queue.push_back(new_work);
+}
+
 void MavlinkParameterSender::get_all_params_async(GetAllParamsCallback callback,const bool clear_cache)
 {
     std::lock_guard<std::mutex> lock(_all_params_mutex);
@@ -579,6 +614,22 @@ void MavlinkParameterSender::do_work()
             // We want to get notified if a timeout happens
             _timeout_handler.add([this] { receive_timeout(); }, work->timeout_s, &_timeout_cookie);
         } break;
+        case WorkItem::Type::GetBatch: {
+            auto& specific=std::get<WorkItemGetBatch>(work->work_item_variant);
+            if (!send_batch_requests(specific)) {
+                LogErr() << "Error: Send message failed";
+                const auto callback = specific.callback;
+                auto received = std::move(specific.received);
+                work_queue_guard->pop_front();
+                work_queue_guard.reset();
+                if (callback) {
+                    callback(Result::ConnectionError, std::move(received));
+                }
+                return;
+            }
+            work->already_requested = true;
+            _timeout_handler.add([this] { receive_timeout(); }, work->timeout_s, &_timeout_cookie);
+        } break;
         default:
             LogWarn()<<"Unknown work item";
             break;
@@ -640,6 +691,9 @@ void MavlinkParameterSender::process_param_value(const mavlink_message_t& messag
                 specific.callback(Result::Success, received_value);
             }
         } break;
+        case WorkItem::Type::GetBatch: {
+            process_batch_response(std::move(work_queue_guard), *work, safe_param_id, received_value);
+        } break;
         case WorkItem::Type::Set: {
             const auto& specific=std::get<WorkItemSet>(work->work_item_variant);
             if (specific.param_name != safe_param_id) {
@@ -716,6 +770,9 @@ void MavlinkParameterSender::process_param_ext_value(const mavlink_message_t& me
                 specific.callback(Result::Success,received_value);
             }
         } break;
+        case WorkItem::Type::GetBatch: {
+            process_batch_response(std::move(work_queue_guard), *work, safe_param_id, received_value);
+        } break;
         // According to the mavlink spec, PARAM_EXT_VALUE is only emitted in response to a PARAM_EXT_REQUEST_LIST or PARAM_EXT_REQUEST_READ.
         default:
             LogWarn() << "Unexpected ParamExtValue response";
@@ -807,6 +864,12 @@ void MavlinkParameterSender::receive_timeout()
     if (!work->already_requested) {
         return;
     }
+
+    Metrics::instance().parameter_timeouts.add();
+    if (work->retries_to_do > 0) {
+        Metrics::instance().parameter_retries.add();
+    }
+
     switch (work->get_type()) {
         case WorkItem::Type::Get: {
             const auto& specific=std::get<WorkItemGet>(work->work_item_variant);
@@ -835,6 +898,46 @@ void MavlinkParameterSender::receive_timeout()
                 }
             }
         } break;
+        case WorkItem::Type::GetBatch: {
+            auto& specific=std::get<WorkItemGetBatch>(work->work_item_variant);
+            if (work->retries_to_do > 0) {
+                // Retransmit the requests we didn't get a response for yet.
+                LogWarn() << "sending again, retries to do: " << work->retries_to_do << "  ("
+                          << specific.param_names.size() - specific.received.size()
+                          << " params missing) timeout:" << work->timeout_s;
+                bool send_failed = false;
+                for (std::size_t i = 0; i < specific.requests.size() && !send_failed; ++i) {
+                    if (specific.received.count(specific.param_names[i]) == 0) {
+                        send_failed = !_sender.send_message(specific.requests[i]);
+                    }
+                }
+                if (send_failed) {
+                    LogErr() << "connection send error in retransmit";
+                    const auto callback = specific.callback;
+                    auto received = std::move(specific.received);
+                    work_queue_guard->pop_front();
+                    work_queue_guard.reset();
+                    if (callback) {
+                        callback(Result::ConnectionError, std::move(received));
+                    }
+                } else {
+                    --work->retries_to_do;
+                    _timeout_handler.add(
+                        [this] { receive_timeout(); }, work->timeout_s, &_timeout_cookie);
+                }
+            } else {
+                LogErr() << "Error: Retrying failed get params timeout: "
+                         << specific.param_names.size() - specific.received.size()
+                         << " params missing";
+                const auto callback = specific.callback;
+                auto received = std::move(specific.received);
+                work_queue_guard->pop_front();
+                work_queue_guard.reset();
+                if (callback) {
+                    callback(Result::Timeout, std::move(received));
+                }
+            }
+        } break;
         case WorkItem::Type::Set: {
             const auto& specific=std::get<WorkItemSet>(work->work_item_variant);
             if (work->retries_to_do > 0) {
@@ -868,6 +971,91 @@ void MavlinkParameterSender::receive_timeout()
     }
 }
 
+void MavlinkParameterSender::pack_param_request_read(
+    const std::string& name, mavlink_message_t& message)
+{
+    const auto param_id = MavlinkParameterSet::param_id_to_message_buffer(name);
+    if (_use_extended) {
+        mavlink_msg_param_ext_request_read_pack(
+            _sender.get_own_system_id(),
+            _sender.get_own_component_id(),
+            &message,
+            _sender.get_system_id(),
+            _target_component_id,
+            param_id.data(),
+            -1);
+    } else {
+        mavlink_msg_param_request_read_pack(
+            _sender.get_own_system_id(),
+            _sender.get_own_component_id(),
+            &message,
+            _sender.get_system_id(),
+            _target_component_id,
+            param_id.data(),
+            -1);
+    }
+}
+
+bool MavlinkParameterSender::send_batch_requests(WorkItemGetBatch& batch)
+{
+    std::size_t in_flight = 0;
+    for (std::size_t i = 0; i < batch.requests.size(); ++i) {
+        if (batch.received.count(batch.param_names[i]) == 0) {
+            ++in_flight;
+        }
+    }
+
+    while (in_flight < MAX_BATCH_REQUESTS_IN_FLIGHT &&
+           batch.requests.size() < batch.param_names.size()) {
+        const auto& name = batch.param_names[batch.requests.size()];
+        batch.requests.emplace_back();
+        if (batch.received.count(name) != 0) {
+            // Already got it without asking, e.g. as a broadcast after a change.
+            continue;
+        }
+        pack_param_request_read(name, batch.requests.back());
+        if (!_sender.send_message(batch.requests.back())) {
+            return false;
+        }
+        ++in_flight;
+    }
+    return true;
+}
+
+void MavlinkParameterSender::process_batch_response(
+    std::unique_ptr<LockedQueue<WorkItem>::Guard> work_queue_guard,
+    WorkItem& work,
+    const std::string& param_id,
+    const ParamValue& value)
+{
+    auto& batch = std::get<WorkItemGetBatch>(work.work_item_variant);
+    if (std::find(batch.param_names.begin(), batch.param_names.end(), param_id) ==
+        batch.param_names.end()) {
+        return;
+    }
+    batch.received[param_id] = value;
+
+    Result result = Result::Success;
+    if (batch.received.size() != batch.param_names.size()) {
+        if (send_batch_requests(batch)) {
+            // Responses are still coming in, so the missing ones get the full timeout again.
+            _timeout_handler.refresh(_timeout_cookie);
+            return;
+        }
+        LogErr() << "Error: Send message failed";
+        result = Result::ConnectionError;
+    }
+
+    _timeout_handler.remove(_timeout_cookie);
+    const auto callback = batch.callback;
+    auto received = std::move(batch.received);
+    work_queue_guard->pop_front();
+    work_queue_guard.reset();
+    if (callback) {
+        callback(result, std::move(received));
+    }
+}
+
 std::ostream& operator<<(std::ostream& str, const MavlinkParameterSender::Result& result)
 {
     switch (result) {
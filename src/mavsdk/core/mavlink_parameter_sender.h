@@ -16,6 +16,7 @@
 #include <utility>
 #include <vector>
 #include <map>
+#include <memory>
 #include <optional>
 #include <variant>
 #include <atomic>
@@ -152,6 +153,21 @@ public:
         GetParamTypesafeCallback<T> callback,
         const void* cookie);
 
+    using GetParamsCallback = std::function<void(Result, std::map<std::string, ParamValue>)>;
+    /**
+     * Get several parameters at once. Instead of waiting for each response before sending the next
+     * request, up to MAX_BATCH_REQUESTS_IN_FLIGHT requests are outstanding at the same time, which
+     * cuts the time to fetch many parameters over a high-latency link considerably.
+     * The callback is called once, with Result::Success if all parameters were received. Otherwise
+     * it gets the error and the parameters that were received until then.
+     */
+    void get_params_async(
+        const std::vector<std::string>& names,
+        const GetParamsCallback& callback,
+        const void* cookie);
+
+    static constexpr std::size_t MAX_BATCH_REQUESTS_IN_FLIGHT = 8;
+
     std::pair<Result, float> get_param_float(const std::string& name);
 
     using GetParamFloatCallback = std::function<void(Result, float)>;
@@ -241,10 +257,18 @@ private:
         const std::variant<std::string,int16_t> param_identifier;
         const GetParamAnyCallback callback;
     };
+    struct WorkItemGetBatch{
+        const std::vector<std::string> param_names;
+        const GetParamsCallback callback;
+        // Responses can come back in any order.
+        std::map<std::string, ParamValue> received{};
+        // Request messages of the parameters sent so far, in the order of param_names.
+        std::vector<mavlink_message_t> requests{};
+    };
     struct WorkItem {
-        enum class Type { Get, Set};
+        enum class Type { Get, Set, GetBatch};
         const double timeout_s;
-        using WorkItemVariant=std::variant<WorkItemGet,WorkItemSet>;
+        using WorkItemVariant=std::variant<WorkItemGet,WorkItemSet,WorkItemGetBatch>;
         WorkItemVariant work_item_variant;
         bool already_requested{false};
         const void* cookie{nullptr};
@@ -261,11 +285,25 @@ private:
             if(std::holds_alternative<WorkItemGet>(work_item_variant)) {
                 return Type::Get;
             }
+            if(std::holds_alternative<WorkItemGetBatch>(work_item_variant)) {
+                return Type::GetBatch;
+            }
             return Type::Set;
         }
     };
     LockedQueue<WorkItem> _work_queue{};
 
+    // Packs the read request for the given parameter into message.
+    void pack_param_request_read(const std::string& name, mavlink_message_t& message);
+    // Sends further requests of a batch until the window is full, returns false on send errors.
+    bool send_batch_requests(WorkItemGetBatch& batch);
+    // Records a parameter received for the batch at the front of the queue.
+    void process_batch_response(
+        std::unique_ptr<LockedQueue<WorkItem>::Guard> work_queue_guard,
+        WorkItem& work,
+        const std::string& param_id,
+        const ParamValue& value);
+
     void* _timeout_cookie = nullptr;
 
     std::mutex _all_params_mutex{};
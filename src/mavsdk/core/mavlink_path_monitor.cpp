@@ -0,0 +1,141 @@
+#include "mavlink_path_monitor.h"
+
+#include <algorithm>
+
+namespace mavsdk {
+
+MavlinkPathMonitor::MavlinkPathMonitor() :
+    _num_first(new std::atomic<uint32_t>[256 * NUM_CONNECTIONS]{}),
+    _evaluations(new PathEvaluation[256 * NUM_CONNECTIONS])
+{}
+
+void MavlinkPathMonitor::add_first_copy(uint8_t system_id, unsigned connection_index)
+{
+    if (connection_index >= NUM_CONNECTIONS) {
+        return;
+    }
+
+    _num_first[path_index(system_id, connection_index)].fetch_add(1, std::memory_order_relaxed);
+    _num_unique[system_id].fetch_add(1, std::memory_order_relaxed);
+}
+
+void MavlinkPathMonitor::evaluate(const ConnectionSources& sources)
+{
+    std::lock_guard<std::mutex> lock(_evaluation_mutex);
+
+    std::array<uint32_t, 256> unique_deltas{};
+    for (unsigned system_id = 0; system_id < 256; ++system_id) {
+        const auto num_unique = _num_unique[system_id].load(std::memory_order_relaxed);
+        // Counters wrap around, the difference is still right.
+        unique_deltas[system_id] = num_unique - _last_num_unique[system_id];
+        _last_num_unique[system_id] = num_unique;
+    }
+
+    for (unsigned connection_index = 0; connection_index < NUM_CONNECTIONS; ++connection_index) {
+        // Loss of all components of a system, weighted by how much they send.
+        std::array<double, 256> weighted_loss{};
+        std::array<double, 256> weights{};
+        std::array<bool, 256> active{};
+        for (const auto& source : sources[connection_index]) {
+            if (!source.active) {
+                continue;
+            }
+            const auto weight = static_cast<double>(source.frames_received);
+            weighted_loss[source.system_id] += weight * static_cast<double>(source.loss_ratio);
+            weights[source.system_id] += weight;
+            active[source.system_id] = true;
+        }
+
+        for (unsigned system_id = 0; system_id < 256; ++system_id) {
+            const auto index = path_index(static_cast<uint8_t>(system_id), connection_index);
+            auto& evaluation = _evaluations[index];
+
+            const auto num_first = _num_first[index].load(std::memory_order_relaxed);
+            const auto first_delta = num_first - evaluation.last_num_first;
+            evaluation.last_num_first = num_first;
+
+            evaluation.active = active[system_id];
+            if (!evaluation.active) {
+                continue;
+            }
+
+            evaluation.delivery_ratio =
+                1.0f - static_cast<float>(weighted_loss[system_id] / weights[system_id]);
+
+            const auto unique_delta = unique_deltas[system_id];
+            const float first_arrival_ratio =
+                (unique_delta == 0) ?
+                    0.0f :
+                    static_cast<float>(first_delta) / static_cast<float>(unique_delta);
+
+            if (evaluation.evaluated) {
+                evaluation.first_arrival_ratio =
+                    SMOOTHING * first_arrival_ratio +
+                    (1.0f - SMOOTHING) * evaluation.first_arrival_ratio;
+            } else {
+                evaluation.first_arrival_ratio = first_arrival_ratio;
+                evaluation.evaluated = true;
+            }
+        }
+    }
+}
+
+MavlinkRoutingTable::ConnectionMask MavlinkPathMonitor::best_path(
+    uint8_t system_id, MavlinkRoutingTable::ConnectionMask candidates) const
+{
+    std::lock_guard<std::mutex> lock(_evaluation_mutex);
+
+    const PathEvaluation* best = nullptr;
+    unsigned best_index = 0;
+    for (unsigned connection_index = 0; connection_index < NUM_CONNECTIONS; ++connection_index) {
+        if ((candidates & (1U << connection_index)) == 0) {
+            continue;
+        }
+        const auto& evaluation = _evaluations[path_index(system_id, connection_index)];
+        if (!evaluation.active || !evaluation.evaluated) {
+            continue;
+        }
+
+        const bool better =
+            (best == nullptr) ||
+            (evaluation.delivery_ratio > best->delivery_ratio + DELIVERY_TOLERANCE) ||
+            (evaluation.delivery_ratio > best->delivery_ratio - DELIVERY_TOLERANCE &&
+             evaluation.first_arrival_ratio > best->first_arrival_ratio);
+        if (better) {
+            best = &evaluation;
+            best_index = connection_index;
+        }
+    }
+
+    if (best == nullptr) {
+        return candidates;
+    }
+    return 1U << best_index;
+}
+
+std::vector<MavlinkPathMonitor::PathQuality> MavlinkPathMonitor::path_qualities() const
+{
+    std::lock_guard<std::mutex> lock(_evaluation_mutex);
+
+    std::vector<PathQuality> result;
+    for (unsigned system_id = 0; system_id < 256; ++system_id) {
+        for (unsigned connection_index = 0; connection_index < NUM_CONNECTIONS;
+             ++connection_index) {
+            const auto& evaluation =
+                _evaluations[path_index(static_cast<uint8_t>(system_id), connection_index)];
+            if (!evaluation.evaluated) {
+                continue;
+            }
+            PathQuality quality;
+            quality.system_id = static_cast<uint8_t>(system_id);
+            quality.connection_index = connection_index;
+            quality.delivery_ratio = evaluation.delivery_ratio;
+            quality.first_arrival_ratio = evaluation.first_arrival_ratio;
+            quality.active = evaluation.active;
+            result.push_back(quality);
+        }
+    }
+    return result;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "mavlink_routing_table.h"
+#include "mavlink_sequence_tracker.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mavsdk {
+
+// Tracks how well each connection delivers the traffic of each system, to
+// pick the best one when a system is reachable over redundant links.
+//
+// How many of the system's frames make it over a path is taken from the
+// sequence trackers of the connections. On top of that, the receive path
+// counts which connection delivered each frame first, which tells apart
+// links that deliver everything, but with different latency.
+class MavlinkPathMonitor {
+public:
+    // The sources seen on each connection, by routing index.
+    using ConnectionSources = std::array<
+        std::vector<MavlinkSequenceTracker::SourceQuality>,
+        MavlinkRoutingTable::MAX_CONNECTIONS>;
+
+    struct PathQuality {
+        uint8_t system_id{0};
+        unsigned connection_index{0};
+        float delivery_ratio{0.0f};
+        float first_arrival_ratio{0.0f};
+        // Whether any frame arrived in the last interval.
+        bool active{false};
+    };
+
+    MavlinkPathMonitor();
+    ~MavlinkPathMonitor() = default;
+
+    // To be called for every frame which did not arrive on another connection before.
+    void add_first_copy(uint8_t system_id, unsigned connection_index);
+
+    // To be called periodically, right after the sequence trackers were evaluated.
+    // The first arrival ratios are smoothed over a few calls.
+    void evaluate(const ConnectionSources& sources);
+
+    // Out of the candidates, returns the active connection with the best
+    // delivery, preferring the faster one if they are about equal. Returns all
+    // candidates if none of them is known to work.
+    [[nodiscard]] MavlinkRoutingTable::ConnectionMask
+    best_path(uint8_t system_id, MavlinkRoutingTable::ConnectionMask candidates) const;
+
+    [[nodiscard]] std::vector<PathQuality> path_qualities() const;
+
+    // Non-copyable
+    MavlinkPathMonitor(const MavlinkPathMonitor&) = delete;
+    const MavlinkPathMonitor& operator=(const MavlinkPathMonitor&) = delete;
+
+private:
+    static constexpr unsigned NUM_CONNECTIONS = MavlinkRoutingTable::MAX_CONNECTIONS;
+    // Weight of the latest interval in the smoothed ratios.
+    static constexpr float SMOOTHING = 0.5f;
+    // Paths with about the same delivery are compared by latency instead.
+    static constexpr float DELIVERY_TOLERANCE = 0.05f;
+
+    struct PathEvaluation {
+        uint32_t last_num_first{0};
+        float delivery_ratio{0.0f};
+        float first_arrival_ratio{0.0f};
+        bool active{false};
+        bool evaluated{false};
+    };
+
+    static std::size_t path_index(uint8_t system_id, unsigned connection_index)
+    {
+        return static_cast<std::size_t>(system_id) * NUM_CONNECTIONS + connection_index;
+    }
+
+    std::array<std::atomic<uint32_t>, 256> _num_unique{};
+    std::unique_ptr<std::atomic<uint32_t>[]> _num_first;
+
+    mutable std::mutex _evaluation_mutex{};
+    std::array<uint32_t, 256> _last_num_unique{};
+    std::unique_ptr<PathEvaluation[]> _evaluations;
+};
+
+} // namespace mavsdk
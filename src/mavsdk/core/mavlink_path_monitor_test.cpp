@@ -0,0 +1,102 @@
+#include "mavlink_path_monitor.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+static MavlinkSequenceTracker::SourceQuality
+make_source(uint8_t system_id, uint8_t component_id, uint64_t frames_received, float loss_ratio)
+{
+    MavlinkSequenceTracker::SourceQuality source;
+    source.system_id = system_id;
+    source.component_id = component_id;
+    source.frames_received = frames_received;
+    source.loss_ratio = loss_ratio;
+    source.active = true;
+    return source;
+}
+
+TEST(MavlinkPathMonitor, PrefersPathWithBetterDelivery)
+{
+    MavlinkPathMonitor monitor;
+
+    // Nothing known yet.
+    EXPECT_EQ(monitor.best_path(1, 0b11), 0b11);
+
+    // Connection 0 is first, but loses every other frame. Connection 1 gets all.
+    for (unsigned i = 0; i < 100; ++i) {
+        monitor.add_first_copy(1, (i % 2 == 0) ? 0 : 1);
+    }
+    MavlinkPathMonitor::ConnectionSources sources;
+    sources[0] = {make_source(1, 1, 50, 0.5f)};
+    sources[1] = {make_source(1, 1, 100, 0.0f)};
+    monitor.evaluate(sources);
+
+    EXPECT_EQ(monitor.best_path(1, 0b11), 0b10);
+    // Only candidates are returned.
+    EXPECT_EQ(monitor.best_path(1, 0b01), 0b01);
+
+    const auto qualities = monitor.path_qualities();
+    ASSERT_EQ(qualities.size(), 2);
+    EXPECT_EQ(qualities[0].connection_index, 0);
+    EXPECT_FLOAT_EQ(qualities[0].delivery_ratio, 0.5f);
+    EXPECT_FLOAT_EQ(qualities[0].first_arrival_ratio, 0.5f);
+    EXPECT_TRUE(qualities[0].active);
+    EXPECT_FLOAT_EQ(qualities[1].delivery_ratio, 1.0f);
+}
+
+TEST(MavlinkPathMonitor, WeighsComponentsByTraffic)
+{
+    MavlinkPathMonitor monitor;
+
+    // The camera loses a lot, but sends little compared to the autopilot.
+    MavlinkPathMonitor::ConnectionSources sources;
+    sources[0] = {make_source(1, 1, 900, 0.0f), make_source(1, 100, 100, 0.5f)};
+    monitor.evaluate(sources);
+
+    const auto qualities = monitor.path_qualities();
+    ASSERT_EQ(qualities.size(), 1);
+    EXPECT_FLOAT_EQ(qualities[0].delivery_ratio, 0.95f);
+}
+
+TEST(MavlinkPathMonitor, PrefersFasterPathIfBothDeliver)
+{
+    MavlinkPathMonitor monitor;
+
+    for (unsigned i = 0; i < 100; ++i) {
+        monitor.add_first_copy(1, 1);
+    }
+    MavlinkPathMonitor::ConnectionSources sources;
+    sources[0] = {make_source(1, 1, 100, 0.0f)};
+    sources[1] = {make_source(1, 1, 100, 0.0f)};
+    monitor.evaluate(sources);
+
+    EXPECT_EQ(monitor.best_path(1, 0b11), 0b10);
+}
+
+TEST(MavlinkPathMonitor, SkipsSilentPath)
+{
+    MavlinkPathMonitor monitor;
+
+    for (unsigned i = 0; i < 100; ++i) {
+        monitor.add_first_copy(1, 1);
+    }
+    MavlinkPathMonitor::ConnectionSources sources;
+    sources[0] = {make_source(1, 1, 100, 0.0f)};
+    sources[1] = {make_source(1, 1, 100, 0.0f)};
+    monitor.evaluate(sources);
+    EXPECT_EQ(monitor.best_path(1, 0b11), 0b10);
+
+    // Connection 1 goes down.
+    for (unsigned i = 0; i < 100; ++i) {
+        monitor.add_first_copy(1, 0);
+    }
+    sources[0] = {make_source(1, 1, 200, 0.0f)};
+    sources[1][0].active = false;
+    monitor.evaluate(sources);
+    EXPECT_EQ(monitor.best_path(1, 0b11), 0b01);
+
+    // And if neither works, we try both.
+    sources[0][0].active = false;
+    monitor.evaluate(sources);
+    EXPECT_EQ(monitor.best_path(1, 0b11), 0b11);
+}
@@ -28,7 +28,10 @@ bool MAVLinkReceiver::parse_message()
 {
     // Note that one datagram can contain multiple mavlink messages.
     for (unsigned i = 0; i < _datagram_len; ++i) {
-        if (mavlink_parse_char(_channel, _datagram[i], &_last_message, &_status) == 1) {
+        const auto result = mavlink_parse_char(_channel, _datagram[i], &_last_message, &_status);
+        // The parser reports the errors since its previous call in packet_rx_drop_count.
+        _parse_errors += _status.packet_rx_drop_count;
+        if (result == 1) {
             // Move the pointer to the datagram forward by the amount parsed.
             _datagram += (i + 1);
             // And decrease the length, so we don't overshoot in the next round.
@@ -49,6 +52,43 @@ bool MAVLinkReceiver::parse_message()
     return false;
 }
 
+std::size_t MAVLinkReceiver::parse_messages(mavlink_message_t* messages, std::size_t max_messages)
+{
+    std::size_t num_parsed = 0;
+    unsigned i = 0;
+
+    // The messages are parsed straight into the caller's array, and not into
+    // _last_message, so nothing needs to be copied afterwards.
+    while (i < _datagram_len && num_parsed < max_messages) {
+        const auto result =
+            mavlink_parse_char(_channel, _datagram[i++], &messages[num_parsed], &_status);
+        _parse_errors += _status.packet_rx_drop_count;
+        if (result == 1) {
+            if (_drop_debugging_on) {
+                _last_message = messages[num_parsed];
+                debug_drop_rate();
+            }
+            ++num_parsed;
+        }
+    }
+
+    _datagram += i;
+    _datagram_len -= i;
+
+    if (_datagram_len == 0) {
+        _datagram = nullptr;
+    }
+
+    return num_parsed;
+}
+
+unsigned MAVLinkReceiver::take_parse_errors()
+{
+    const unsigned parse_errors = _parse_errors;
+    _parse_errors = 0;
+    return parse_errors;
+}
+
 void MAVLinkReceiver::debug_drop_rate()
 {
     if (_last_message.msgid == MAVLINK_MSG_ID_SYS_STATUS) {
@@ -2,6 +2,7 @@
 
 #include "mavlink_include.h"
 #include "mavsdk_time.h"
+#include <cstddef>
 #include <cstdint>
 
 namespace mavsdk {
@@ -20,6 +21,15 @@ public:
 
     bool parse_message();
 
+    // Parses as many messages of the datagram as fit into the given array and
+    // returns how many were parsed. Anything left over is parsed in the next call,
+    // so this needs to be called until it returns 0.
+    std::size_t parse_messages(mavlink_message_t* messages, std::size_t max_messages);
+
+    // Returns the number of frames dropped because of bad CRC or framing since
+    // the previous call.
+    unsigned take_parse_errors();
+
     void debug_drop_rate();
     void print_line(
         const char* index,
@@ -34,6 +44,7 @@ private:
     mavlink_status_t _status = {};
     char* _datagram = nullptr;
     unsigned _datagram_len = 0;
+    unsigned _parse_errors = 0;
 
     Time _time{};
 
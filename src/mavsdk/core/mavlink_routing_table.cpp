@@ -0,0 +1,170 @@
+#include "mavlink_routing_table.h"
+
+namespace mavsdk {
+
+MavlinkRoutingTable::MavlinkRoutingTable() :
+    // Value-initialized, so all zero.
+    _component_routes(new std::atomic<ConnectionMask>[NUM_ADDRESSES]()),
+    _recent_component_routes(new std::atomic<ConnectionMask>[NUM_ADDRESSES]()),
+    _sequence_windows(new std::atomic<uint64_t>[NUM_ADDRESSES]()),
+    _fingerprints(new std::atomic<uint64_t>[std::size_t(1) << FINGERPRINT_SLOT_BITS]())
+{}
+
+void MavlinkRoutingTable::learn(uint8_t system_id, uint8_t component_id, unsigned connection_index)
+{
+    if (connection_index >= MAX_CONNECTIONS) {
+        return;
+    }
+
+    const ConnectionMask bit = 1U << connection_index;
+
+    // Routes are learned on every message, so avoid the write if it is known.
+    const auto add = [bit](std::atomic<ConnectionMask>& route) {
+        if ((route.load(std::memory_order_relaxed) & bit) == 0) {
+            route.fetch_or(bit, std::memory_order_relaxed);
+        }
+    };
+
+    const auto address = address_index(system_id, component_id);
+    add(_recent_component_routes[address]);
+    add(_component_routes[address]);
+    add(_recent_system_routes[system_id]);
+    add(_system_routes[system_id]);
+}
+
+MavlinkRoutingTable::ConnectionMask MavlinkRoutingTable::route(
+    uint8_t target_system_id, uint8_t target_component_id, ConnectionMask all_connections) const
+{
+    if (target_system_id == 0) {
+        return all_connections;
+    }
+
+    if (target_component_id != 0) {
+        const auto component_route =
+            _component_routes[address_index(target_system_id, target_component_id)].load(
+                std::memory_order_relaxed);
+        if (component_route != 0) {
+            return component_route & all_connections;
+        }
+    }
+
+    return _system_routes[target_system_id].load(std::memory_order_relaxed) & all_connections;
+}
+
+bool MavlinkRoutingTable::has_redundant_routes(uint8_t system_id, uint8_t component_id) const
+{
+    const auto route =
+        _component_routes[address_index(system_id, component_id)].load(std::memory_order_relaxed);
+    // More than one bit set.
+    return (route & (route - 1)) != 0;
+}
+
+void MavlinkRoutingTable::age_routes()
+{
+    for (std::size_t address = 0; address < NUM_ADDRESSES; ++address) {
+        age_route(_component_routes[address], _recent_component_routes[address]);
+    }
+    for (std::size_t system_id = 0; system_id < _system_routes.size(); ++system_id) {
+        age_route(_system_routes[system_id], _recent_system_routes[system_id]);
+    }
+}
+
+void MavlinkRoutingTable::age_route(
+    std::atomic<ConnectionMask>& route, std::atomic<ConnectionMask>& recent)
+{
+    const auto recent_route = recent.exchange(0, std::memory_order_relaxed);
+    // A connection learned concurrently might get lost here, but as learn() is
+    // called for every message, it is added again with the next one.
+    if (recent_route != 0 && recent_route != route.load(std::memory_order_relaxed)) {
+        route.store(recent_route, std::memory_order_relaxed);
+    }
+}
+
+bool MavlinkRoutingTable::is_new_frame(
+    uint8_t system_id,
+    uint8_t component_id,
+    uint8_t sequence,
+    uint32_t message_id,
+    uint16_t checksum)
+{
+    const auto address = address_index(system_id, component_id);
+    const auto frame_fingerprint = fingerprint(address, sequence, message_id, checksum);
+    auto& slot = _fingerprints[fingerprint_slot(address, sequence)];
+    auto& window = _sequence_windows[address];
+
+    auto current = window.load(std::memory_order_relaxed);
+    while (true) {
+        bool restarted = false;
+        const auto updated = advance_window(current, sequence, restarted);
+        if (!updated) {
+            // The sequence number was seen, but only the same frame is a copy,
+            // not e.g. one from a sender that restarted.
+            if (slot.load(std::memory_order_relaxed) == frame_fingerprint) {
+                return false;
+            }
+            slot.store(frame_fingerprint, std::memory_order_relaxed);
+            return true;
+        }
+        if (restarted && slot.load(std::memory_order_relaxed) == frame_fingerprint) {
+            // Not a restart but a copy over a link which lags behind by more
+            // than the window, which must not be reset by it.
+            return false;
+        }
+        if (window.compare_exchange_weak(current, updated.value(), std::memory_order_relaxed)) {
+            slot.store(frame_fingerprint, std::memory_order_relaxed);
+            return true;
+        }
+    }
+}
+
+std::size_t MavlinkRoutingTable::fingerprint_slot(std::size_t address, uint8_t sequence)
+{
+    // Fibonacci hashing, so that the senders spread over all slots.
+    const auto key = static_cast<uint32_t>((address << 8) | sequence);
+    return (key * 2654435769U) >> (32 - FINGERPRINT_SLOT_BITS);
+}
+
+std::optional<uint64_t>
+MavlinkRoutingTable::advance_window(uint64_t window, uint8_t sequence, bool& restarted)
+{
+    constexpr uint64_t history_mask = (1ULL << WINDOW_HISTORY_LEN) - 1;
+    const auto pack = [](uint8_t last, uint64_t history) {
+        return (history << WINDOW_HISTORY_SHIFT) | WINDOW_VALID | last;
+    };
+
+    if ((window & WINDOW_VALID) == 0) {
+        return pack(sequence, 0);
+    }
+
+    const auto last = static_cast<uint8_t>(window & 0xff);
+    auto history = window >> WINDOW_HISTORY_SHIFT;
+
+    // Sequence numbers wrap around, so everything up to half the range ahead is newer.
+    const auto ahead = static_cast<uint8_t>(sequence - last);
+    if (ahead == 0) {
+        return {};
+    }
+    if (ahead < 128) {
+        // The last one moves into the history, along with everything before it.
+        history = (ahead > WINDOW_HISTORY_LEN) ?
+                      0 :
+                      ((history << ahead) | (1ULL << (ahead - 1))) & history_mask;
+        return pack(sequence, history);
+    }
+
+    const auto behind = static_cast<uint8_t>(last - sequence);
+    if (behind <= WINDOW_HISTORY_LEN) {
+        // Arrived out of order, or is a copy.
+        const uint64_t bit = 1ULL << (behind - 1);
+        if ((history & bit) != 0) {
+            return {};
+        }
+        return pack(last, history | bit);
+    }
+
+    // Too far behind to tell, most likely the sender restarted.
+    restarted = true;
+    return pack(sequence, 0);
+}
+
+} // namespace mavsdk
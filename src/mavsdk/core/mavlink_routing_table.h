@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+namespace mavsdk {
+
+// Learns from the incoming traffic which connections lead to which system and
+// component, and routes messages accordingly, following the rules described in
+// https://mavlink.io/en/guide/routing.html.
+//
+// Connections are referred to by their index, as a bit in a mask. Looking up
+// a route is an array access, and learning one is an atomic or, so neither
+// needs a lock on the hot path. Routes are aged out periodically, so that a
+// connection over which a sender went quiet is dropped from its route.
+class MavlinkRoutingTable {
+public:
+    using ConnectionMask = uint32_t;
+    static constexpr unsigned MAX_CONNECTIONS = 32;
+
+    MavlinkRoutingTable();
+    ~MavlinkRoutingTable() = default;
+
+    // To be called for every message received on a connection.
+    void learn(uint8_t system_id, uint8_t component_id, unsigned connection_index);
+
+    // The connections a message to the given target needs to go to. A target
+    // system of 0 is a broadcast to all connections, a target component of 0
+    // goes to all components of the system, as does a component that has not
+    // been seen yet. Unknown systems have no route.
+    [[nodiscard]] ConnectionMask route(
+        uint8_t target_system_id,
+        uint8_t target_component_id,
+        ConnectionMask all_connections) const;
+
+    // Whether the sender was seen on more than one connection.
+    [[nodiscard]] bool has_redundant_routes(uint8_t system_id, uint8_t component_id) const;
+
+    // To be called periodically. Routes are reduced to the connections on which
+    // the target was seen since the last call. Routes of targets which were not
+    // seen at all are kept, so a link that is down for a while still has them.
+    void age_routes();
+
+    // Returns false if the sender's frame with this sequence number, message ID
+    // and checksum was seen before, e.g. because it looped back over another
+    // link. A different frame reusing the sequence number is new.
+    bool is_new_frame(
+        uint8_t system_id,
+        uint8_t component_id,
+        uint8_t sequence,
+        uint32_t message_id,
+        uint16_t checksum);
+
+    // Non-copyable
+    MavlinkRoutingTable(const MavlinkRoutingTable&) = delete;
+    const MavlinkRoutingTable& operator=(const MavlinkRoutingTable&) = delete;
+
+private:
+    static constexpr std::size_t NUM_ADDRESSES = 256 * 256;
+
+    static std::size_t address_index(uint8_t system_id, uint8_t component_id)
+    {
+        return (static_cast<std::size_t>(system_id) << 8) | component_id;
+    }
+
+    // Returns the updated window, or nothing if the sequence number was in it.
+    // A sequence number too far behind restarts the window.
+    static std::optional<uint64_t>
+    advance_window(uint64_t window, uint8_t sequence, bool& restarted);
+
+    static void age_route(std::atomic<ConnectionMask>& route, std::atomic<ConnectionMask>& recent);
+
+    // Frames are told apart by their sender, sequence number, message ID and
+    // checksum, which fit exactly into 64 bits.
+    static uint64_t fingerprint(
+        std::size_t address, uint8_t sequence, uint32_t message_id, uint16_t checksum)
+    {
+        return (static_cast<uint64_t>(address) << 48) | (static_cast<uint64_t>(sequence) << 40) |
+               (static_cast<uint64_t>(message_id & 0xffffff) << 16) | checksum;
+    }
+    static std::size_t fingerprint_slot(std::size_t address, uint8_t sequence);
+
+    // The window packs the last sequence number into the lowest byte, a flag
+    // whether any was seen, and which of the preceding ones were seen.
+    static constexpr uint64_t WINDOW_VALID = 1ULL << 8;
+    static constexpr unsigned WINDOW_HISTORY_SHIFT = 9;
+    static constexpr unsigned WINDOW_HISTORY_LEN = 64 - WINDOW_HISTORY_SHIFT;
+
+    std::array<std::atomic<ConnectionMask>, 256> _system_routes{};
+    std::unique_ptr<std::atomic<ConnectionMask>[]> _component_routes;
+    // The connections each target was seen on since the routes were last aged.
+    std::array<std::atomic<ConnectionMask>, 256> _recent_system_routes{};
+    std::unique_ptr<std::atomic<ConnectionMask>[]> _recent_component_routes;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> _sequence_windows;
+
+    // The fingerprints of recent frames, by sender and sequence number. When
+    // two frames share a slot, the older one is forgotten, so it could pass
+    // twice, but a new frame is never taken for a copy.
+    static constexpr unsigned FINGERPRINT_SLOT_BITS = 12;
+    std::unique_ptr<std::atomic<uint64_t>[]> _fingerprints;
+};
+
+} // namespace mavsdk
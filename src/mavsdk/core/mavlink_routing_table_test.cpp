@@ -0,0 +1,142 @@
+#include "mavlink_routing_table.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(MavlinkRoutingTable, RoutesToLearnedConnections)
+{
+    MavlinkRoutingTable table;
+    const MavlinkRoutingTable::ConnectionMask all = 0b111;
+
+    // Nothing known yet, only broadcasts go out.
+    EXPECT_EQ(table.route(0, 0, all), all);
+    EXPECT_EQ(table.route(1, 0, all), 0);
+
+    // Autopilot and camera of system 1 on connection 0, the camera also on 2.
+    table.learn(1, 1, 0);
+    table.learn(1, 100, 0);
+    table.learn(1, 100, 2);
+    // A GCS on connection 1.
+    table.learn(255, 190, 1);
+
+    EXPECT_EQ(table.route(1, 1, all), 0b001);
+    EXPECT_EQ(table.route(1, 100, all), 0b101);
+    EXPECT_EQ(table.route(1, 0, all), 0b101);
+    EXPECT_EQ(table.route(255, 190, all), 0b010);
+    EXPECT_EQ(table.route(0, 0, all), all);
+
+    EXPECT_FALSE(table.has_redundant_routes(1, 1));
+    EXPECT_TRUE(table.has_redundant_routes(1, 100));
+
+    // A component not seen yet goes wherever the system is.
+    EXPECT_EQ(table.route(1, 154, all), 0b101);
+    // Unknown systems have no route.
+    EXPECT_EQ(table.route(2, 1, all), 0);
+
+    // Only connections that still exist are returned.
+    EXPECT_EQ(table.route(1, 100, 0b011), 0b001);
+
+    // Out of range indices are ignored.
+    table.learn(3, 1, MavlinkRoutingTable::MAX_CONNECTIONS);
+    EXPECT_EQ(table.route(3, 1, all), 0);
+}
+
+TEST(MavlinkRoutingTable, AgesOutQuietConnections)
+{
+    MavlinkRoutingTable table;
+    const MavlinkRoutingTable::ConnectionMask all = 0b111;
+
+    table.learn(1, 1, 0);
+    table.learn(1, 1, 1);
+    table.learn(255, 190, 2);
+    EXPECT_TRUE(table.has_redundant_routes(1, 1));
+
+    // Connection 1 went quiet.
+    table.age_routes();
+    table.learn(1, 1, 0);
+    table.age_routes();
+    EXPECT_FALSE(table.has_redundant_routes(1, 1));
+    EXPECT_EQ(table.route(1, 1, all), 0b001);
+    EXPECT_EQ(table.route(1, 0, all), 0b001);
+
+    // Nothing heard at all, e.g. the link is down for a while, keeps the route.
+    EXPECT_EQ(table.route(255, 190, all), 0b100);
+
+    // And back again.
+    table.learn(1, 1, 1);
+    EXPECT_TRUE(table.has_redundant_routes(1, 1));
+    EXPECT_EQ(table.route(1, 1, all), 0b011);
+}
+
+TEST(MavlinkRoutingTable, SuppressesSeenFrames)
+{
+    MavlinkRoutingTable table;
+
+    for (unsigned i = 0; i < 300; ++i) {
+        const auto sequence = static_cast<uint8_t>(i);
+        EXPECT_TRUE(table.is_new_frame(1, 1, sequence, 0, 1000));
+        // The same frame coming back over another link.
+        EXPECT_FALSE(table.is_new_frame(1, 1, sequence, 0, 1000));
+    }
+
+    // Other senders are independent.
+    EXPECT_TRUE(table.is_new_frame(1, 100, 43, 0, 1000));
+    EXPECT_TRUE(table.is_new_frame(2, 1, 43, 0, 1000));
+}
+
+TEST(MavlinkRoutingTable, TellsFramesWithSameSequenceApart)
+{
+    MavlinkRoutingTable table;
+
+    EXPECT_TRUE(table.is_new_frame(1, 1, 10, 0, 1000));
+    EXPECT_TRUE(table.is_new_frame(1, 1, 11, 30, 2000));
+
+    // Same sequence number, but another message or another payload.
+    EXPECT_TRUE(table.is_new_frame(1, 1, 10, 33, 1000));
+    EXPECT_TRUE(table.is_new_frame(1, 1, 11, 30, 2001));
+
+    // Copies of those are still caught.
+    EXPECT_FALSE(table.is_new_frame(1, 1, 10, 33, 1000));
+    EXPECT_FALSE(table.is_new_frame(1, 1, 11, 30, 2001));
+}
+
+TEST(MavlinkRoutingTable, SuppressesCopiesFromLaggingLink)
+{
+    MavlinkRoutingTable table;
+
+    // The copies over the slow link arrive 80 frames late, more than the
+    // window holds.
+    constexpr unsigned lag = 80;
+    for (unsigned i = 0; i < 400 + lag; ++i) {
+        if (i < 400) {
+            const auto checksum = static_cast<uint16_t>(i * 7);
+            EXPECT_TRUE(table.is_new_frame(1, 1, static_cast<uint8_t>(i), 0, checksum));
+        }
+        if (i >= lag) {
+            const auto late = i - lag;
+            const auto checksum = static_cast<uint16_t>(late * 7);
+            EXPECT_FALSE(table.is_new_frame(1, 1, static_cast<uint8_t>(late), 0, checksum));
+        }
+    }
+}
+
+TEST(MavlinkRoutingTable, AcceptsReorderedFrames)
+{
+    MavlinkRoutingTable table;
+
+    EXPECT_TRUE(table.is_new_frame(1, 1, 250, 0, 250));
+    // Skips a few, across the wrap around.
+    EXPECT_TRUE(table.is_new_frame(1, 1, 3, 0, 3));
+    // The skipped ones arrive late, but only once.
+    EXPECT_TRUE(table.is_new_frame(1, 1, 254, 0, 254));
+    EXPECT_TRUE(table.is_new_frame(1, 1, 0, 0, 0));
+    EXPECT_FALSE(table.is_new_frame(1, 1, 254, 0, 254));
+    EXPECT_FALSE(table.is_new_frame(1, 1, 250, 0, 250));
+    EXPECT_FALSE(table.is_new_frame(1, 1, 3, 0, 3));
+    EXPECT_TRUE(table.is_new_frame(1, 1, 4, 0, 4));
+
+    // A sender that restarts with sequence numbers far behind is accepted.
+    EXPECT_TRUE(table.is_new_frame(1, 1, 160, 0, 160));
+    EXPECT_TRUE(table.is_new_frame(1, 1, 161, 0, 161));
+    EXPECT_FALSE(table.is_new_frame(1, 1, 160, 0, 160));
+}
@@ -0,0 +1,233 @@
+#include "mavlink_sequence_tracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mavsdk {
+
+namespace {
+
+constexpr unsigned source_table_bits = 5;
+static_assert(
+    (1U << source_table_bits) == MavlinkSequenceTracker::MAX_SOURCES, "size mismatch");
+
+} // namespace
+
+MavlinkSequenceTracker::MavlinkSequenceTracker() :
+    _sources(new Source[MAX_SOURCES]),
+    _evaluations(new Evaluation[MAX_SOURCES])
+{}
+
+MavlinkSequenceTracker::FrameResult
+MavlinkSequenceTracker::add_frame(const mavlink_message_t& message, dl_time_t arrival_time)
+{
+    FrameResult result;
+
+    const uint32_t key = ((static_cast<uint32_t>(message.sysid) << 8) | message.compid) + 1;
+    Source* source = find_or_add_source(key);
+    if (source == nullptr) {
+        _untracked_frames.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    if (source->num_received.load(std::memory_order_relaxed) == 0) {
+        source->highest_seq = message.seq;
+        source->window = 1;
+        source->last_arrival = arrival_time;
+        source->num_received.store(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    // How far ahead of the highest sequence number so far, with wrap around.
+    const uint8_t ahead = static_cast<uint8_t>(message.seq - source->highest_seq);
+
+    if (ahead == 0) {
+        result.duplicate = true;
+
+    } else if (ahead < 128) {
+        result.gap = ahead - 1U;
+        source->window = (ahead < WINDOW) ? ((source->window << ahead) | 1) : 1;
+        source->highest_seq = message.seq;
+
+        if (result.gap == 0) {
+            update_jitter(*source, arrival_time);
+        } else {
+            source->num_lost.fetch_add(result.gap, std::memory_order_relaxed);
+            // The time since the previous frame says nothing about jitter.
+            source->last_arrival = arrival_time;
+            source->last_interval_s = -1.0;
+        }
+
+    } else {
+        const unsigned behind = 256U - ahead;
+
+        if (behind >= WINDOW) {
+            // Much more likely a restart of the source than such a late frame.
+            source->highest_seq = message.seq;
+            source->window = 1;
+            source->last_arrival = arrival_time;
+            source->last_interval_s = -1.0;
+        } else {
+            const uint64_t bit = uint64_t(1) << behind;
+            if ((source->window & bit) != 0) {
+                result.duplicate = true;
+            } else {
+                // It was counted as lost when the frames after it arrived.
+                result.reordered = true;
+                source->window |= bit;
+                source->num_lost.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    source->num_received.fetch_add(1, std::memory_order_relaxed);
+    if (result.duplicate) {
+        source->num_duplicate.fetch_add(1, std::memory_order_relaxed);
+    } else if (result.reordered) {
+        source->num_reordered.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return result;
+}
+
+MavlinkSequenceTracker::Source* MavlinkSequenceTracker::find_or_add_source(uint32_t key)
+{
+    // Multiplicative hashing, the upper bits are the well mixed ones.
+    auto index = static_cast<std::size_t>((key * 2654435761U) >> (32 - source_table_bits));
+
+    for (std::size_t probe = 0; probe < MAX_SOURCES; ++probe) {
+        auto& source = _sources[index];
+        // Keys are only ever added by the receive thread, so no compare and exchange.
+        const auto current = source.key.load(std::memory_order_relaxed);
+        if (current == key) {
+            return &source;
+        }
+        if (current == 0) {
+            source.key.store(key, std::memory_order_relaxed);
+            return &source;
+        }
+        index = (index + 1) & (MAX_SOURCES - 1);
+    }
+
+    return nullptr;
+}
+
+void MavlinkSequenceTracker::update_jitter(Source& source, dl_time_t arrival_time)
+{
+    const double interval_s =
+        std::chrono::duration<double>(arrival_time - source.last_arrival).count();
+
+    if (source.last_interval_s >= 0.0) {
+        const double deviation_s = std::fabs(interval_s - source.last_interval_s);
+        const auto jitter_s = static_cast<double>(source.jitter_s.load(std::memory_order_relaxed));
+        source.jitter_s.store(
+            static_cast<float>(jitter_s + (deviation_s - jitter_s) * JITTER_GAIN),
+            std::memory_order_relaxed);
+    }
+
+    source.last_interval_s = interval_s;
+    source.last_arrival = arrival_time;
+}
+
+void MavlinkSequenceTracker::evaluate()
+{
+    std::lock_guard<std::mutex> lock(_evaluation_mutex);
+
+    for (std::size_t i = 0; i < MAX_SOURCES; ++i) {
+        const auto& source = _sources[i];
+        if (source.key.load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        auto& evaluation = _evaluations[i];
+
+        const auto num_received = source.num_received.load(std::memory_order_relaxed);
+        const auto num_lost = source.num_lost.load(std::memory_order_relaxed);
+        const auto num_reordered = source.num_reordered.load(std::memory_order_relaxed);
+        const auto num_duplicate = source.num_duplicate.load(std::memory_order_relaxed);
+
+        const auto received_delta = num_received - evaluation.last_num_received;
+        // Can be negative if frames counted as lost before arrived late.
+        const auto lost_delta = std::max<int64_t>(num_lost - evaluation.last_num_lost, 0);
+        const auto reordered_delta = num_reordered - evaluation.last_num_reordered;
+        const auto duplicate_delta = num_duplicate - evaluation.last_num_duplicate;
+        evaluation.last_num_received = num_received;
+        evaluation.last_num_lost = num_lost;
+        evaluation.last_num_reordered = num_reordered;
+        evaluation.last_num_duplicate = num_duplicate;
+
+        evaluation.active = (received_delta > 0);
+        if (received_delta == 0) {
+            // Nothing arrived, and we can't tell how much was sent.
+            continue;
+        }
+
+        const auto num_sent = static_cast<float>(
+            received_delta - duplicate_delta + static_cast<uint64_t>(lost_delta));
+        const float loss_ratio = static_cast<float>(lost_delta) / num_sent;
+        const float reorder_ratio = static_cast<float>(reordered_delta) / num_sent;
+        const float duplicate_ratio =
+            static_cast<float>(duplicate_delta) / static_cast<float>(received_delta);
+
+        if (evaluation.evaluated) {
+            evaluation.loss_ratio =
+                SMOOTHING * loss_ratio + (1.0f - SMOOTHING) * evaluation.loss_ratio;
+            evaluation.reorder_ratio =
+                SMOOTHING * reorder_ratio + (1.0f - SMOOTHING) * evaluation.reorder_ratio;
+            evaluation.duplicate_ratio =
+                SMOOTHING * duplicate_ratio + (1.0f - SMOOTHING) * evaluation.duplicate_ratio;
+        } else {
+            evaluation.loss_ratio = loss_ratio;
+            evaluation.reorder_ratio = reorder_ratio;
+            evaluation.duplicate_ratio = duplicate_ratio;
+            evaluation.evaluated = true;
+        }
+    }
+}
+
+uint64_t MavlinkSequenceTracker::frames_lost() const
+{
+    uint64_t result = 0;
+    for (std::size_t i = 0; i < MAX_SOURCES; ++i) {
+        const auto num_lost = _sources[i].num_lost.load(std::memory_order_relaxed);
+        result += static_cast<uint64_t>(std::max<int64_t>(num_lost, 0));
+    }
+    return result;
+}
+
+std::vector<MavlinkSequenceTracker::SourceQuality> MavlinkSequenceTracker::source_qualities() const
+{
+    std::lock_guard<std::mutex> lock(_evaluation_mutex);
+
+    std::vector<SourceQuality> result;
+    for (std::size_t i = 0; i < MAX_SOURCES; ++i) {
+        const auto& source = _sources[i];
+        const auto key = source.key.load(std::memory_order_relaxed);
+        if (key == 0) {
+            continue;
+        }
+        const auto& evaluation = _evaluations[i];
+
+        SourceQuality quality;
+        quality.system_id = static_cast<uint8_t>((key - 1) >> 8);
+        quality.component_id = static_cast<uint8_t>((key - 1) & 0xff);
+        quality.frames_received = source.num_received.load(std::memory_order_relaxed);
+        quality.frames_lost = static_cast<uint64_t>(
+            std::max<int64_t>(source.num_lost.load(std::memory_order_relaxed), 0));
+        quality.frames_reordered = source.num_reordered.load(std::memory_order_relaxed);
+        quality.frames_duplicate = source.num_duplicate.load(std::memory_order_relaxed);
+        quality.loss_ratio = evaluation.loss_ratio;
+        quality.reorder_ratio = evaluation.reorder_ratio;
+        quality.duplicate_ratio = evaluation.duplicate_ratio;
+        quality.jitter_s = source.jitter_s.load(std::memory_order_relaxed);
+        quality.active = evaluation.active;
+        result.push_back(quality);
+    }
+
+    std::sort(result.begin(), result.end(), [](const auto& lhs, const auto& rhs) {
+        return (lhs.system_id != rhs.system_id) ? (lhs.system_id < rhs.system_id) :
+                                                  (lhs.component_id < rhs.component_id);
+    });
+    return result;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include "mavsdk_time.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mavsdk {
+
+// Tracks the sequence numbers of each source (system and component ID) on one
+// connection, to tell lost frames apart from reordered and duplicate ones,
+// and measures the jitter of the time between frames.
+//
+// add_frame() is only called from the connection's receive thread. It keeps
+// the sources in a fixed size table, so it neither locks nor allocates, and
+// sources which don't fit anymore are not tracked. Once per interval,
+// evaluate() turns the counts into ratios, which can be read from any thread.
+class MavlinkSequenceTracker {
+public:
+    static constexpr std::size_t MAX_SOURCES = 32;
+
+    struct SourceQuality {
+        uint8_t system_id{0};
+        uint8_t component_id{0};
+        // Totals since the source was first seen.
+        uint64_t frames_received{0};
+        uint64_t frames_lost{0};
+        uint64_t frames_reordered{0};
+        uint64_t frames_duplicate{0};
+        // Shares of the frames sent, smoothed over a few intervals.
+        float loss_ratio{0.0f};
+        float reorder_ratio{0.0f};
+        float duplicate_ratio{0.0f};
+        // Mean deviation of the time between consecutive frames, as in RFC 3550.
+        float jitter_s{0.0f};
+        // Whether any frame arrived in the last interval.
+        bool active{false};
+    };
+
+    struct FrameResult {
+        // Sequence numbers skipped by this frame.
+        unsigned gap{0};
+        bool reordered{false};
+        bool duplicate{false};
+    };
+
+    MavlinkSequenceTracker();
+    ~MavlinkSequenceTracker() = default;
+
+    FrameResult add_frame(const mavlink_message_t& message, dl_time_t arrival_time);
+
+    // To be called periodically, the ratios are smoothed over a few calls.
+    void evaluate();
+
+    [[nodiscard]] std::vector<SourceQuality> source_qualities() const;
+
+    // Frames lost over all sources, the sum of their frames_lost.
+    [[nodiscard]] uint64_t frames_lost() const;
+
+    // Frames of sources which didn't fit into the table.
+    [[nodiscard]] uint64_t untracked_frames() const
+    {
+        return _untracked_frames.load(std::memory_order_relaxed);
+    }
+
+    // Non-copyable
+    MavlinkSequenceTracker(const MavlinkSequenceTracker&) = delete;
+    const MavlinkSequenceTracker& operator=(const MavlinkSequenceTracker&) = delete;
+
+private:
+    // How far back a late frame is still recognized as reordered or duplicate.
+    // Anything older is taken as the source having restarted its sequence.
+    static constexpr unsigned WINDOW = 64;
+    // Weight of the latest interval in the smoothed ratios.
+    static constexpr float SMOOTHING = 0.5f;
+    // Weight of the latest deviation in the jitter, as in RFC 3550.
+    static constexpr double JITTER_GAIN = 1.0 / 16.0;
+
+    struct Source {
+        // (system ID << 8 | component ID) + 1, so that 0 means empty.
+        std::atomic<uint32_t> key{0};
+
+        // Only used by the receive thread.
+        uint8_t highest_seq{0};
+        // Bit i is set if highest_seq - i was received.
+        uint64_t window{0};
+        dl_time_t last_arrival{};
+        double last_interval_s{-1.0};
+
+        // Updated by the receive thread, read when evaluating.
+        std::atomic<uint64_t> num_received{0};
+        // Lost minus arrived late, so it can go down.
+        std::atomic<int64_t> num_lost{0};
+        std::atomic<uint64_t> num_reordered{0};
+        std::atomic<uint64_t> num_duplicate{0};
+        std::atomic<float> jitter_s{0.0f};
+    };
+
+    struct Evaluation {
+        uint64_t last_num_received{0};
+        int64_t last_num_lost{0};
+        uint64_t last_num_reordered{0};
+        uint64_t last_num_duplicate{0};
+        float loss_ratio{0.0f};
+        float reorder_ratio{0.0f};
+        float duplicate_ratio{0.0f};
+        bool active{false};
+        bool evaluated{false};
+    };
+
+    Source* find_or_add_source(uint32_t key);
+    static void update_jitter(Source& source, dl_time_t arrival_time);
+
+    std::unique_ptr<Source[]> _sources;
+    std::atomic<uint64_t> _untracked_frames{0};
+
+    mutable std::mutex _evaluation_mutex{};
+    std::unique_ptr<Evaluation[]> _evaluations;
+};
+
+} // namespace mavsdk
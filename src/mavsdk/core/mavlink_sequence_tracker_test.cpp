@@ -0,0 +1,135 @@
+#include "mavlink_sequence_tracker.h"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+mavlink_message_t make_message(uint8_t sysid, uint8_t compid, uint8_t seq)
+{
+    mavlink_message_t message{};
+    message.sysid = sysid;
+    message.compid = compid;
+    message.seq = seq;
+    return message;
+}
+
+void add_frames(
+    MavlinkSequenceTracker& tracker,
+    const std::vector<uint8_t>& sequence,
+    uint8_t compid = 1,
+    dl_time_t time = {})
+{
+    for (const auto seq : sequence) {
+        tracker.add_frame(make_message(1, compid, seq), time);
+    }
+}
+
+} // namespace
+
+TEST(MavlinkSequenceTracker, TellsLossFromReorderAndDuplicates)
+{
+    MavlinkSequenceTracker tracker;
+
+    // 3 is late, 5 comes twice, 7 and 8 are lost.
+    add_frames(tracker, {0, 1, 2, 4, 3, 5, 5, 6, 9});
+
+    const auto qualities = tracker.source_qualities();
+    ASSERT_EQ(qualities.size(), 1);
+    EXPECT_EQ(qualities[0].system_id, 1);
+    EXPECT_EQ(qualities[0].component_id, 1);
+    EXPECT_EQ(qualities[0].frames_received, 9);
+    EXPECT_EQ(qualities[0].frames_lost, 2);
+    EXPECT_EQ(qualities[0].frames_reordered, 1);
+    EXPECT_EQ(qualities[0].frames_duplicate, 1);
+}
+
+TEST(MavlinkSequenceTracker, ReportsGapsAsTheyHappen)
+{
+    MavlinkSequenceTracker tracker;
+    tracker.add_frame(make_message(1, 1, 254), {});
+
+    auto result = tracker.add_frame(make_message(1, 1, 2), {});
+    EXPECT_EQ(result.gap, 3);
+
+    result = tracker.add_frame(make_message(1, 1, 0), {});
+    EXPECT_EQ(result.gap, 0);
+    EXPECT_TRUE(result.reordered);
+
+    result = tracker.add_frame(make_message(1, 1, 0), {});
+    EXPECT_TRUE(result.duplicate);
+
+    EXPECT_EQ(tracker.source_qualities()[0].frames_lost, 2);
+}
+
+TEST(MavlinkSequenceTracker, RestartOfSourceIsNoLoss)
+{
+    MavlinkSequenceTracker tracker;
+    add_frames(tracker, {200, 201, 202, 100, 101});
+
+    const auto qualities = tracker.source_qualities();
+    ASSERT_EQ(qualities.size(), 1);
+    EXPECT_EQ(qualities[0].frames_lost, 0);
+    EXPECT_EQ(qualities[0].frames_reordered, 0);
+}
+
+TEST(MavlinkSequenceTracker, EvaluatesRatiosPerSource)
+{
+    MavlinkSequenceTracker tracker;
+
+    // Component 1 loses every other frame, component 2 nothing.
+    for (unsigned i = 0; i < 100; ++i) {
+        if (i % 2 == 0) {
+            tracker.add_frame(make_message(1, 1, static_cast<uint8_t>(i)), {});
+        }
+        tracker.add_frame(make_message(1, 2, static_cast<uint8_t>(i)), {});
+    }
+    tracker.evaluate();
+
+    auto qualities = tracker.source_qualities();
+    ASSERT_EQ(qualities.size(), 2);
+    EXPECT_EQ(qualities[0].component_id, 1);
+    EXPECT_NEAR(qualities[0].loss_ratio, 0.5f, 0.02f);
+    EXPECT_TRUE(qualities[0].active);
+    EXPECT_EQ(qualities[1].component_id, 2);
+    EXPECT_FLOAT_EQ(qualities[1].loss_ratio, 0.0f);
+
+    // Nothing arrives anymore.
+    tracker.evaluate();
+    qualities = tracker.source_qualities();
+    EXPECT_FALSE(qualities[0].active);
+    EXPECT_NEAR(qualities[0].loss_ratio, 0.5f, 0.02f);
+}
+
+TEST(MavlinkSequenceTracker, MeasuresJitter)
+{
+    MavlinkSequenceTracker tracker;
+
+    // Regular frames have no jitter.
+    dl_time_t time{};
+    for (uint8_t seq = 0; seq < 50; ++seq) {
+        tracker.add_frame(make_message(1, 1, seq), time);
+        time += std::chrono::milliseconds(20);
+    }
+    EXPECT_FLOAT_EQ(tracker.source_qualities()[0].jitter_s, 0.0f);
+
+    // Alternating between 10 and 30 ms apart, so 20 ms of deviation.
+    for (uint8_t seq = 50; seq < 250; ++seq) {
+        tracker.add_frame(make_message(1, 1, seq), time);
+        time += std::chrono::milliseconds((seq % 2 == 0) ? 10 : 30);
+    }
+    EXPECT_NEAR(tracker.source_qualities()[0].jitter_s, 0.02f, 0.001f);
+}
+
+TEST(MavlinkSequenceTracker, CountsSourcesThatDoNotFit)
+{
+    MavlinkSequenceTracker tracker;
+    for (unsigned compid = 0; compid < MavlinkSequenceTracker::MAX_SOURCES + 2; ++compid) {
+        tracker.add_frame(make_message(1, static_cast<uint8_t>(compid), 0), {});
+    }
+
+    EXPECT_EQ(tracker.source_qualities().size(), MavlinkSequenceTracker::MAX_SOURCES);
+    EXPECT_EQ(tracker.untracked_frames(), 2);
+}
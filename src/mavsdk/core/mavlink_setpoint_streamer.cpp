@@ -0,0 +1,288 @@
+#include "mavlink_setpoint_streamer.h"
+#include "log.h"
+#include "metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#if defined(LINUX) || defined(APPLE)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(WINDOWS)
+#include <windows.h>
+#endif
+
+namespace mavsdk {
+
+namespace {
+
+void raise_thread_priority()
+{
+#if defined(LINUX) || defined(APPLE)
+    sched_param param{};
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+    const int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (result != 0) {
+        // Real-time scheduling needs privileges, e.g. CAP_SYS_NICE on Linux.
+        LogDebug() << "Setpoints are sent at normal priority: " << std::strerror(result);
+    }
+#elif defined(WINDOWS)
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+#endif
+}
+
+} // namespace
+
+MavlinkSetpointStreamer::MavlinkSetpointStreamer(Time& time, SendCallback send, bool use_thread) :
+    _time(time),
+    _send(std::move(send)),
+    _use_thread(use_thread)
+{}
+
+MavlinkSetpointStreamer::~MavlinkSetpointStreamer()
+{
+    std::thread* thread = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _should_exit = true;
+        thread = _thread;
+        _thread = nullptr;
+        _cv.notify_one();
+    }
+
+    if (thread != nullptr) {
+        thread->join();
+        delete thread;
+    }
+}
+
+void MavlinkSetpointStreamer::set_interval(double interval_s)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _interval_s = interval_s;
+    // Don't wait for the old interval if the new one is shorter.
+    auto latest_due = _time.steady_time();
+    Time::shift_steady_time_by(latest_due, interval_s);
+    _next_due = std::min(_next_due, latest_due);
+
+    _changed = true;
+    _cv.notify_one();
+}
+
+bool MavlinkSetpointStreamer::send(
+    const mavlink_message_t* messages, std::size_t num_messages, Timestamp timestamp)
+{
+    std::lock_guard<std::mutex> send_lock(_send_mutex);
+
+    std::array<mavlink_message_t, MAX_MESSAGES> prepared;
+    num_messages = std::min(num_messages, MAX_MESSAGES);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _num_messages = num_messages;
+        for (std::size_t i = 0; i < _num_messages; ++i) {
+            auto& stored = _messages[i];
+            // Look up the message details only when the kind of setpoint changes.
+            if (!_streaming || stored.message.msgid != messages[i].msgid) {
+                const auto* entry = mavlink_get_msg_entry(messages[i].msgid);
+                stored.known = (entry != nullptr);
+                if (stored.known) {
+                    stored.min_length = entry->min_msg_len;
+                    stored.max_length = entry->max_msg_len;
+                    stored.crc_extra = entry->crc_extra;
+                }
+            }
+            stored.message = messages[i];
+        }
+        _timestamp = timestamp;
+        _streaming = (_num_messages > 0);
+
+        prepare_locked(prepared);
+
+        _next_due = _time.steady_time();
+        Time::shift_steady_time_by(_next_due, _interval_s);
+
+        if (_use_thread && _thread == nullptr) {
+            start_thread_locked();
+        }
+        _changed = true;
+        _cv.notify_one();
+    }
+
+    return send_locked(prepared, num_messages, -1.0);
+}
+
+void MavlinkSetpointStreamer::stop()
+{
+    std::lock_guard<std::mutex> send_lock(_send_mutex);
+
+    // The time until the next setpoint says nothing about jitter.
+    _last_sent.reset();
+    _last_interval_s = -1.0;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _streaming = false;
+    _changed = true;
+    _cv.notify_one();
+}
+
+bool MavlinkSetpointStreamer::is_streaming() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    return _streaming;
+}
+
+std::optional<dl_time_t> MavlinkSetpointStreamer::send_due()
+{
+    std::lock_guard<std::mutex> send_lock(_send_mutex);
+
+    std::array<mavlink_message_t, MAX_MESSAGES> prepared;
+    std::size_t num_messages = 0;
+    double lateness_s = 0.0;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (!_streaming) {
+            return std::nullopt;
+        }
+
+        const auto now = _time.steady_time();
+        if (now < _next_due) {
+            return _next_due;
+        }
+
+        lateness_s = std::chrono::duration<double>(now - _next_due).count();
+
+        Time::shift_steady_time_by(_next_due, _interval_s);
+        if (_next_due <= now) {
+            // We fell behind by more than an interval, e.g. because the system
+            // was suspended. Don't try to catch up with a burst.
+            _next_due = now;
+            Time::shift_steady_time_by(_next_due, _interval_s);
+        }
+
+        prepare_locked(prepared);
+        num_messages = _num_messages;
+    }
+
+    send_locked(prepared, num_messages, lateness_s);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _next_due;
+}
+
+MavlinkSetpointStreamer::Statistics MavlinkSetpointStreamer::statistics() const
+{
+    std::lock_guard<std::mutex> send_lock(_send_mutex);
+
+    return _statistics;
+}
+
+void MavlinkSetpointStreamer::prepare_locked(
+    std::array<mavlink_message_t, MAX_MESSAGES>& prepared)
+{
+    const auto time_boot_ms = static_cast<uint32_t>(_time.elapsed_ms());
+    const uint64_t time_usec = _time.elapsed_us();
+
+    for (std::size_t i = 0; i < _num_messages; ++i) {
+        const auto& stored = _messages[i];
+        auto& message = prepared[i];
+        message = stored.message;
+        if (!stored.known) {
+            continue;
+        }
+
+        // MAVLink payloads are little-endian, as are the hosts MAVLink supports.
+        if (_timestamp == Timestamp::TimeBootMs) {
+            std::memcpy(message.payload64, &time_boot_ms, sizeof(time_boot_ms));
+        } else if (_timestamp == Timestamp::TimeUsec) {
+            std::memcpy(message.payload64, &time_usec, sizeof(time_usec));
+        }
+
+        // Takes the next sequence number and computes the checksum again, the
+        // payload is trimmed again as well.
+        mavlink_finalize_message(
+            &message,
+            message.sysid,
+            message.compid,
+            stored.min_length,
+            stored.max_length,
+            stored.crc_extra);
+    }
+}
+
+bool MavlinkSetpointStreamer::send_locked(
+    std::array<mavlink_message_t, MAX_MESSAGES>& prepared,
+    std::size_t num_messages,
+    double lateness_s)
+{
+    bool success = true;
+    for (std::size_t i = 0; i < num_messages; ++i) {
+        success = _send(prepared[i]) && success;
+    }
+
+    const auto now = _time.steady_time();
+    ++_statistics.num_sent;
+
+    if (lateness_s >= 0.0) {
+        _statistics.max_lateness_s = std::max(_statistics.max_lateness_s, lateness_s);
+        double interval_s = 0.0;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            interval_s = _interval_s;
+        }
+        if (lateness_s > interval_s / 2.0) {
+            ++_statistics.num_deadlines_missed;
+            Metrics::instance().setpoint_deadlines_missed.add();
+        }
+    }
+
+    if (_last_sent) {
+        const double interval_s = std::chrono::duration<double>(now - _last_sent.value()).count();
+        Metrics::instance().setpoint_interval.record(now - _last_sent.value());
+
+        if (_last_interval_s >= 0.0) {
+            const double deviation_s = std::fabs(interval_s - _last_interval_s);
+            _statistics.jitter_s += (deviation_s - _statistics.jitter_s) * AVERAGING_GAIN;
+            _mean_interval_s += (interval_s - _mean_interval_s) * AVERAGING_GAIN;
+        } else {
+            _mean_interval_s = interval_s;
+        }
+        _last_interval_s = interval_s;
+        _statistics.rate_hz = (_mean_interval_s > 0.0) ? 1.0 / _mean_interval_s : 0.0;
+    }
+    _last_sent = now;
+
+    return success;
+}
+
+void MavlinkSetpointStreamer::start_thread_locked()
+{
+    _should_exit = false;
+    _thread = new std::thread(&MavlinkSetpointStreamer::run, this);
+}
+
+void MavlinkSetpointStreamer::run()
+{
+    raise_thread_priority();
+
+    while (!_should_exit) {
+        const auto next_due = send_due();
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        const auto woken = [this]() { return _should_exit || _changed; };
+        if (next_due) {
+            _cv.wait_until(lock, next_due.value(), woken);
+        } else {
+            _cv.wait(lock, woken);
+        }
+        _changed = false;
+    }
+}
+
+} // namespace mavsdk
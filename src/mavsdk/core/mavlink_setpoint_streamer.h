@@ -0,0 +1,127 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include "mavsdk_time.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace mavsdk {
+
+// Keeps sending the latest setpoint at a fixed rate from a thread of its own,
+// for setpoints which the autopilot expects as a continuous stream.
+//
+// The setpoint is kept as packed messages, so sending it again only means
+// refreshing its timestamp, sequence number and checksum. Setting a new one
+// sends it right away and restarts the interval from there, so a caller that
+// sets setpoints at a high rate determines the rate itself, and the thread
+// only fills the gaps. The thread runs at a raised priority where allowed,
+// and every send is checked against its deadline.
+class MavlinkSetpointStreamer {
+public:
+    using SendCallback = std::function<bool(mavlink_message_t&)>;
+
+    // A setpoint can take more than one message, e.g. several actuator groups.
+    static constexpr std::size_t MAX_MESSAGES = 2;
+
+    // Where the message carries a timestamp that is refreshed on every send.
+    enum class Timestamp {
+        None,
+        TimeBootMs, // uint32_t time_boot_ms at the start of the payload.
+        TimeUsec, // uint64_t time_usec at the start of the payload.
+    };
+
+    struct Statistics {
+        uint64_t num_sent{0};
+        // Sends by the thread that were more than half an interval late.
+        uint64_t num_deadlines_missed{0};
+        double rate_hz{0.0};
+        // Mean deviation of the time between consecutive sends, as in RFC 3550.
+        double jitter_s{0.0};
+        double max_lateness_s{0.0};
+    };
+
+    // Without the thread, send_due() needs to be called instead, e.g. in tests.
+    MavlinkSetpointStreamer(Time& time, SendCallback send, bool use_thread = true);
+    ~MavlinkSetpointStreamer();
+
+    void set_interval(double interval_s);
+
+    // Replaces the setpoint and sends it right away.
+    bool send(const mavlink_message_t* messages, std::size_t num_messages, Timestamp timestamp);
+    bool send(const mavlink_message_t& message, Timestamp timestamp)
+    {
+        return send(&message, 1, timestamp);
+    }
+
+    // Stops sending until the next setpoint is set.
+    void stop();
+
+    [[nodiscard]] bool is_streaming() const;
+
+    // Sends the setpoint if it is due, and returns when it is due next.
+    std::optional<dl_time_t> send_due();
+
+    [[nodiscard]] Statistics statistics() const;
+
+    // Non-copyable
+    MavlinkSetpointStreamer(const MavlinkSetpointStreamer&) = delete;
+    const MavlinkSetpointStreamer& operator=(const MavlinkSetpointStreamer&) = delete;
+
+private:
+    struct Message {
+        mavlink_message_t message{};
+        uint8_t min_length{0};
+        uint8_t max_length{0};
+        uint8_t crc_extra{0};
+        bool known{false};
+    };
+
+    // Copies the setpoint with a fresh timestamp.
+    void prepare_locked(std::array<mavlink_message_t, MAX_MESSAGES>& prepared);
+    bool send_locked(
+        std::array<mavlink_message_t, MAX_MESSAGES>& prepared,
+        std::size_t num_messages,
+        double lateness_s);
+    void start_thread_locked();
+    void run();
+
+    // Weight of the latest interval in the averages, as in RFC 3550.
+    static constexpr double AVERAGING_GAIN = 1.0 / 16.0;
+
+    Time& _time;
+    SendCallback _send;
+
+    // Held while sending, so that the thread can't send an older setpoint
+    // after a newer one. It also protects the statistics.
+    mutable std::mutex _send_mutex{};
+
+    mutable std::mutex _mutex{};
+    std::condition_variable _cv{};
+    double _interval_s{0.05};
+
+    bool _streaming{false};
+    std::array<Message, MAX_MESSAGES> _messages{};
+    std::size_t _num_messages{0};
+    Timestamp _timestamp{Timestamp::None};
+    dl_time_t _next_due{};
+
+    Statistics _statistics{};
+    std::optional<dl_time_t> _last_sent{};
+    double _last_interval_s{-1.0};
+    double _mean_interval_s{0.0};
+
+    const bool _use_thread;
+    std::thread* _thread{nullptr};
+    bool _changed{false};
+    std::atomic<bool> _should_exit{false};
+};
+
+} // namespace mavsdk
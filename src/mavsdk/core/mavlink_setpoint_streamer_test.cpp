@@ -0,0 +1,158 @@
+#include "mavlink_setpoint_streamer.h"
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+mavlink_message_t make_heartbeat(uint8_t type)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(1, 190, &message, type, MAV_AUTOPILOT_INVALID, 0, 0, 0);
+    return message;
+}
+
+} // namespace
+
+TEST(MavlinkSetpointStreamer, SendsRightAwayAndThenPeriodically)
+{
+    FakeTime time;
+    std::vector<mavlink_message_t> sent;
+    MavlinkSetpointStreamer streamer(
+        time,
+        [&sent](mavlink_message_t& message) {
+            sent.push_back(message);
+            return true;
+        },
+        false);
+    streamer.set_interval(0.05);
+
+    // Nothing to send yet.
+    EXPECT_FALSE(streamer.send_due());
+
+    EXPECT_TRUE(
+        streamer.send(make_heartbeat(MAV_TYPE_GCS), MavlinkSetpointStreamer::Timestamp::None));
+    EXPECT_TRUE(streamer.is_streaming());
+    ASSERT_EQ(sent.size(), 1);
+
+    // Not due yet.
+    EXPECT_TRUE(streamer.send_due());
+    EXPECT_EQ(sent.size(), 1);
+
+    time.sleep_for(std::chrono::milliseconds(50));
+    streamer.send_due();
+    ASSERT_EQ(sent.size(), 2);
+    EXPECT_EQ(mavlink_msg_heartbeat_get_type(&sent[1]), MAV_TYPE_GCS);
+    // Every send is a message of its own.
+    EXPECT_NE(sent[0].seq, sent[1].seq);
+
+    time.sleep_for(std::chrono::milliseconds(50));
+    streamer.send_due();
+    EXPECT_EQ(sent.size(), 3);
+
+    const auto statistics = streamer.statistics();
+    EXPECT_EQ(statistics.num_sent, 3);
+    EXPECT_EQ(statistics.num_deadlines_missed, 0);
+    EXPECT_NEAR(statistics.rate_hz, 20.0, 0.1);
+    EXPECT_NEAR(statistics.jitter_s, 0.0, 1e-4);
+}
+
+TEST(MavlinkSetpointStreamer, NewSetpointRestartsInterval)
+{
+    FakeTime time;
+    std::vector<mavlink_message_t> sent;
+    MavlinkSetpointStreamer streamer(
+        time,
+        [&sent](mavlink_message_t& message) {
+            sent.push_back(message);
+            return true;
+        },
+        false);
+    streamer.set_interval(0.05);
+
+    streamer.send(make_heartbeat(MAV_TYPE_GCS), MavlinkSetpointStreamer::Timestamp::None);
+    time.sleep_for(std::chrono::milliseconds(30));
+    streamer.send(
+        make_heartbeat(MAV_TYPE_ONBOARD_CONTROLLER), MavlinkSetpointStreamer::Timestamp::None);
+    time.sleep_for(std::chrono::milliseconds(30));
+
+    streamer.send_due();
+    EXPECT_EQ(sent.size(), 2);
+
+    time.sleep_for(std::chrono::milliseconds(25));
+    streamer.send_due();
+    ASSERT_EQ(sent.size(), 3);
+    EXPECT_EQ(mavlink_msg_heartbeat_get_type(&sent[2]), MAV_TYPE_ONBOARD_CONTROLLER);
+}
+
+TEST(MavlinkSetpointStreamer, StopsUntilNextSetpoint)
+{
+    FakeTime time;
+    unsigned num_sent = 0;
+    MavlinkSetpointStreamer streamer(
+        time,
+        [&num_sent](mavlink_message_t&) {
+            ++num_sent;
+            return true;
+        },
+        false);
+    streamer.set_interval(0.05);
+
+    streamer.send(make_heartbeat(MAV_TYPE_GCS), MavlinkSetpointStreamer::Timestamp::None);
+    streamer.stop();
+    EXPECT_FALSE(streamer.is_streaming());
+
+    time.sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FALSE(streamer.send_due());
+    EXPECT_EQ(num_sent, 1);
+}
+
+TEST(MavlinkSetpointStreamer, CountsMissedDeadlines)
+{
+    FakeTime time;
+    MavlinkSetpointStreamer streamer(
+        time, [](mavlink_message_t&) { return true; }, false);
+    streamer.set_interval(0.05);
+
+    streamer.send(make_heartbeat(MAV_TYPE_GCS), MavlinkSetpointStreamer::Timestamp::None);
+
+    // Late, but within half an interval.
+    time.sleep_for(std::chrono::milliseconds(60));
+    streamer.send_due();
+    EXPECT_EQ(streamer.statistics().num_deadlines_missed, 0);
+
+    // Due at 100 ms, sent at 130 ms.
+    time.sleep_for(std::chrono::milliseconds(70));
+    streamer.send_due();
+
+    const auto statistics = streamer.statistics();
+    EXPECT_EQ(statistics.num_sent, 3);
+    EXPECT_EQ(statistics.num_deadlines_missed, 1);
+    EXPECT_NEAR(statistics.max_lateness_s, 0.03, 1e-3);
+    EXPECT_GT(statistics.jitter_s, 0.0);
+}
+
+TEST(MavlinkSetpointStreamer, SendsFromThread)
+{
+    Time time;
+    std::mutex mutex;
+    std::condition_variable cv;
+    unsigned num_sent = 0;
+    MavlinkSetpointStreamer streamer(time, [&](mavlink_message_t&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++num_sent;
+        cv.notify_all();
+        return true;
+    });
+    streamer.set_interval(0.005);
+
+    streamer.send(make_heartbeat(MAV_TYPE_GCS), MavlinkSetpointStreamer::Timestamp::None);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    EXPECT_TRUE(
+        cv.wait_for(lock, std::chrono::seconds(2), [&num_sent]() { return num_sent >= 5; }));
+}
@@ -0,0 +1,178 @@
+#include "mavlink_signing.h"
+#include "sha256.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace mavsdk {
+
+namespace {
+
+void write_timestamp(uint8_t* bytes, uint64_t timestamp)
+{
+    for (unsigned i = 0; i < 6; ++i) {
+        bytes[i] = static_cast<uint8_t>(timestamp >> (i * 8));
+    }
+}
+
+uint64_t read_timestamp(const uint8_t* bytes)
+{
+    uint64_t timestamp = 0;
+    for (unsigned i = 0; i < 6; ++i) {
+        timestamp |= uint64_t(bytes[i]) << (i * 8);
+    }
+    return timestamp;
+}
+
+} // namespace
+
+MavlinkSigning::MavlinkSigning(Time& time) : _time(time) {}
+
+void MavlinkSigning::enable(const Options& options)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _options = options;
+    // A new key starts new streams.
+    _stream_timestamps.clear();
+    _enabled = true;
+}
+
+void MavlinkSigning::disable()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _enabled = false;
+    _options.secret_key.fill(0);
+    _stream_timestamps.clear();
+}
+
+uint16_t MavlinkSigning::serialize(uint8_t* buffer, const mavlink_message_t& message)
+{
+    const uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+
+    // Only MAVLink 2 frames can be signed.
+    if (!_enabled || buffer[0] != MAVLINK_STX || (buffer[2] & MAVLINK_IFLAG_SIGNED) != 0) {
+        return buffer_len;
+    }
+
+    // The signed flag is part of the checksum, which needs the CRC extra to recalculate.
+    const auto* entry = mavlink_get_msg_entry(message.msgid);
+    if (entry == nullptr) {
+        return buffer_len;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_enabled || !_options.sign_outgoing) {
+        return buffer_len;
+    }
+
+    const uint8_t payload_len = buffer[1];
+    buffer[2] |= MAVLINK_IFLAG_SIGNED;
+
+    uint16_t checksum = crc_calculate(&buffer[1], MAVLINK_NUM_HEADER_BYTES - 1 + payload_len);
+    crc_accumulate(entry->crc_extra, &checksum);
+    uint8_t* ck = &buffer[MAVLINK_NUM_HEADER_BYTES + payload_len];
+    ck[0] = static_cast<uint8_t>(checksum & 0xff);
+    ck[1] = static_cast<uint8_t>(checksum >> 8);
+
+    uint8_t* signature = ck + MAVLINK_NUM_CHECKSUM_BYTES;
+    signature[0] = _options.link_id;
+    // Every frame needs a new timestamp, even if the clock didn't move on.
+    _timestamp = std::max(_timestamp + 1, current_timestamp_locked());
+    write_timestamp(&signature[1], _timestamp);
+
+    // The signature covers the key and everything up to and including the timestamp.
+    Sha256 sha256;
+    sha256.update(_options.secret_key.data(), _options.secret_key.size());
+    sha256.update(buffer, static_cast<std::size_t>(&signature[7] - buffer));
+    const auto digest = sha256.finish();
+    std::copy(digest.begin(), digest.begin() + SIGNATURE_LEN, &signature[7]);
+
+    return buffer_len + MAVLINK_SIGNATURE_BLOCK_LEN;
+}
+
+bool MavlinkSigning::verify(const mavlink_message_t& message)
+{
+    if (!_enabled) {
+        return true;
+    }
+
+    if (message.magic != MAVLINK_STX || (message.incompat_flags & MAVLINK_IFLAG_SIGNED) == 0) {
+        // Radios inject their status and can't sign it.
+        if (message.msgid == MAVLINK_MSG_ID_RADIO_STATUS) {
+            return true;
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        return !_enabled || _options.accept_unsigned;
+    }
+
+    const uint8_t header[MAVLINK_NUM_HEADER_BYTES] = {
+        message.magic,
+        message.len,
+        message.incompat_flags,
+        message.compat_flags,
+        message.seq,
+        message.sysid,
+        message.compid,
+        static_cast<uint8_t>(message.msgid & 0xff),
+        static_cast<uint8_t>((message.msgid >> 8) & 0xff),
+        static_cast<uint8_t>((message.msgid >> 16) & 0xff)};
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_enabled) {
+        return true;
+    }
+
+    Sha256 sha256;
+    sha256.update(_options.secret_key.data(), _options.secret_key.size());
+    sha256.update(header, sizeof(header));
+    sha256.update(reinterpret_cast<const uint8_t*>(_MAV_PAYLOAD(&message)), message.len);
+    sha256.update(message.ck, MAVLINK_NUM_CHECKSUM_BYTES);
+    sha256.update(message.signature, 7);
+    const auto digest = sha256.finish();
+
+    // Compare all bytes, so the time taken doesn't tell how many matched.
+    uint8_t difference = 0;
+    for (std::size_t i = 0; i < SIGNATURE_LEN; ++i) {
+        difference |= digest[i] ^ message.signature[7 + i];
+    }
+    if (difference != 0) {
+        return false;
+    }
+
+    const uint64_t timestamp = read_timestamp(&message.signature[1]);
+    const uint32_t stream = (uint32_t(message.signature[0]) << 16) |
+                            (uint32_t(message.sysid) << 8) | message.compid;
+
+    auto it = _stream_timestamps.find(stream);
+    if (it == _stream_timestamps.end()) {
+        if (timestamp + REPLAY_WINDOW < current_timestamp_locked()) {
+            return false;
+        }
+        if (_stream_timestamps.size() >= MAX_STREAMS) {
+            return false;
+        }
+        _stream_timestamps.emplace(stream, timestamp);
+    } else {
+        if (timestamp <= it->second) {
+            return false;
+        }
+        it->second = timestamp;
+    }
+
+    // Our clock might be behind, a valid timestamp tells us the time is at least this.
+    _timestamp = std::max(_timestamp, timestamp);
+    return true;
+}
+
+uint64_t MavlinkSigning::current_timestamp_locked()
+{
+    const auto since_epoch = std::chrono::duration_cast<std::chrono::microseconds>(
+                                 _time.system_time().time_since_epoch())
+                                 .count();
+    const auto now = static_cast<uint64_t>(
+                         std::max<int64_t>(0, since_epoch - int64_t(EPOCH_OFFSET_S) * 1000000)) /
+                     10;
+    return std::max(_timestamp, now);
+}
+
+} // namespace mavsdk
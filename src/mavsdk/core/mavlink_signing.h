@@ -0,0 +1,66 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include "mavsdk_time.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+namespace mavsdk {
+
+// MAVLink 2 message signing of one connection.
+//
+// Outgoing frames are signed when they are serialized, received frames are
+// verified after parsing. The timestamp of every stream, identified by
+// (link id, system id, component id), has to go forward, so that recorded
+// frames can't be replayed.
+class MavlinkSigning {
+public:
+    struct Options {
+        std::array<uint8_t, 32> secret_key{};
+        uint8_t link_id{0};
+        bool sign_outgoing{true};
+        bool accept_unsigned{false};
+    };
+
+    explicit MavlinkSigning(Time& time);
+    ~MavlinkSigning() = default;
+
+    void enable(const Options& options);
+    void disable();
+    [[nodiscard]] bool is_enabled() const { return _enabled; }
+
+    // Serializes the message into a buffer of MAVLINK_MAX_PACKET_LEN bytes and
+    // returns the length. Frames which are signed already are left as they are.
+    uint16_t serialize(uint8_t* buffer, const mavlink_message_t& message);
+
+    // Whether a received message is to be accepted.
+    bool verify(const mavlink_message_t& message);
+
+    // Non-copyable
+    MavlinkSigning(const MavlinkSigning&) = delete;
+    const MavlinkSigning& operator=(const MavlinkSigning&) = delete;
+
+private:
+    uint64_t current_timestamp_locked();
+
+    // Timestamps count 10 microseconds since 1st January 2015 GMT.
+    static constexpr uint64_t EPOCH_OFFSET_S = 1420070400;
+    // New streams are accepted if they are at most a minute behind.
+    static constexpr uint64_t REPLAY_WINDOW = 60 * 100000;
+    static constexpr std::size_t MAX_STREAMS = 256;
+    static constexpr std::size_t SIGNATURE_LEN = 6;
+
+    Time& _time;
+    std::atomic<bool> _enabled{false};
+
+    std::mutex _mutex{};
+    Options _options{};
+    uint64_t _timestamp{0};
+    // Last timestamp by (link_id << 16 | sysid << 8 | compid).
+    std::unordered_map<uint32_t, uint64_t> _stream_timestamps{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,123 @@
+#include "mavlink_signing.h"
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <vector>
+
+using namespace mavsdk;
+
+static MavlinkSigning::Options options_with_key(uint8_t key_byte)
+{
+    MavlinkSigning::Options options;
+    options.secret_key.fill(key_byte);
+    options.link_id = 3;
+    return options;
+}
+
+static std::vector<uint8_t> serialize_heartbeat(MavlinkSigning& signing)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(1, 1, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, 0);
+
+    std::vector<uint8_t> buffer(MAVLINK_MAX_PACKET_LEN);
+    buffer.resize(signing.serialize(buffer.data(), message));
+    return buffer;
+}
+
+static mavlink_message_t parse(const std::vector<uint8_t>& buffer)
+{
+    mavlink_message_t message{};
+    mavlink_status_t status{};
+    for (auto byte : buffer) {
+        if (mavlink_parse_char(MAVLINK_COMM_0, byte, &message, &status) == MAVLINK_FRAMING_OK) {
+            break;
+        }
+    }
+    return message;
+}
+
+TEST(MavlinkSigning, SignedFramesAreVerified)
+{
+    Time time;
+    MavlinkSigning sender(time);
+    MavlinkSigning receiver(time);
+    sender.enable(options_with_key(42));
+    receiver.enable(options_with_key(42));
+
+    const auto buffer = serialize_heartbeat(sender);
+    const auto message = parse(buffer);
+    EXPECT_TRUE(message.incompat_flags & MAVLINK_IFLAG_SIGNED);
+    EXPECT_EQ(message.signature[0], 3);
+    EXPECT_TRUE(receiver.verify(message));
+
+    // The same frame again is a replay.
+    EXPECT_FALSE(receiver.verify(message));
+
+    // But the next one is fine.
+    EXPECT_TRUE(receiver.verify(parse(serialize_heartbeat(sender))));
+}
+
+TEST(MavlinkSigning, RejectsWrongKeyAndTampering)
+{
+    Time time;
+    MavlinkSigning sender(time);
+    MavlinkSigning receiver(time);
+    sender.enable(options_with_key(42));
+    receiver.enable(options_with_key(43));
+
+    EXPECT_FALSE(receiver.verify(parse(serialize_heartbeat(sender))));
+
+    receiver.enable(options_with_key(42));
+    auto message = parse(serialize_heartbeat(sender));
+    _MAV_PAYLOAD_NON_CONST(&message)[4] ^= 1;
+    EXPECT_FALSE(receiver.verify(message));
+}
+
+TEST(MavlinkSigning, UnsignedFramesOnlyIfAccepted)
+{
+    Time time;
+    MavlinkSigning sender(time);
+    MavlinkSigning receiver(time);
+
+    // Signing disabled, nothing changes.
+    const auto unsigned_message = parse(serialize_heartbeat(sender));
+    EXPECT_FALSE(unsigned_message.incompat_flags & MAVLINK_IFLAG_SIGNED);
+    EXPECT_TRUE(receiver.verify(unsigned_message));
+
+    receiver.enable(options_with_key(42));
+    EXPECT_FALSE(receiver.verify(unsigned_message));
+
+    auto options = options_with_key(42);
+    options.accept_unsigned = true;
+    receiver.enable(options);
+    EXPECT_TRUE(receiver.verify(unsigned_message));
+}
+
+class ShiftedTime : public Time {
+public:
+    explicit ShiftedTime(std::chrono::seconds shift) : _shift(shift) {}
+    dl_system_time_t system_time() override { return Time::system_time() + _shift; }
+
+private:
+    std::chrono::seconds _shift;
+};
+
+TEST(MavlinkSigning, RejectsNewStreamsTooFarBehind)
+{
+    Time time;
+    MavlinkSigning receiver(time);
+    receiver.enable(options_with_key(42));
+
+    ShiftedTime slightly_behind(std::chrono::seconds(-30));
+    MavlinkSigning sender(slightly_behind);
+    sender.enable(options_with_key(42));
+    EXPECT_TRUE(receiver.verify(parse(serialize_heartbeat(sender))));
+
+    // Another link id makes another stream.
+    ShiftedTime far_behind(std::chrono::seconds(-120));
+    MavlinkSigning old_sender(far_behind);
+    auto options = options_with_key(42);
+    options.link_id = 4;
+    old_sender.enable(options);
+    EXPECT_FALSE(receiver.verify(parse(serialize_heartbeat(old_sender))));
+}
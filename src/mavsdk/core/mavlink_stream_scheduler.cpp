@@ -0,0 +1,301 @@
+#include "mavlink_stream_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace mavsdk {
+
+MavlinkStreamScheduler::MavlinkStreamScheduler(Time& time) : _time(time) {}
+
+MavlinkStreamScheduler::~MavlinkStreamScheduler()
+{
+    stop();
+}
+
+void MavlinkStreamScheduler::set_stream(uint32_t message_id, double interval_s, Priority priority)
+{
+    if (interval_s <= 0.0) {
+        remove_stream(message_id);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const auto now = _time.steady_time();
+    auto stream = find_stream_locked(message_id);
+    if (stream != nullptr) {
+        stream->interval_s = interval_s;
+        stream->priority = priority;
+        // Keep the phase, unless that would delay the stream beyond the new interval.
+        auto latest_due = now;
+        Time::shift_steady_time_by(latest_due, interval_s);
+        stream->next_due = std::min(stream->next_due, latest_due);
+    } else {
+        // Spread the phases of the streams with the golden ratio, so that streams
+        // of the same rate are evenly spread, however many there are.
+        const double phase = std::fmod(_num_streams_added * 0.6180339887, 1.0);
+        ++_num_streams_added;
+
+        Stream new_stream;
+        new_stream.message_id = message_id;
+        new_stream.interval_s = interval_s;
+        new_stream.priority = priority;
+        new_stream.next_due = now;
+        Time::shift_steady_time_by(new_stream.next_due, phase * interval_s);
+
+        const auto* entry = mavlink_get_msg_entry(message_id);
+        new_stream.known = (entry != nullptr);
+        if (new_stream.known) {
+            new_stream.min_length = entry->min_msg_len;
+            new_stream.max_length = entry->max_msg_len;
+            new_stream.crc_extra = entry->crc_extra;
+        }
+        _streams.push_back(new_stream);
+    }
+
+    _streams_changed = true;
+    if (_send_callback && _thread == nullptr) {
+        start_thread_locked();
+    }
+    _cv.notify_one();
+}
+
+void MavlinkStreamScheduler::remove_stream(uint32_t message_id)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _streams.erase(
+        std::remove_if(
+            _streams.begin(),
+            _streams.end(),
+            [message_id](const Stream& stream) { return stream.message_id == message_id; }),
+        _streams.end());
+
+    _streams_changed = true;
+    _cv.notify_one();
+}
+
+bool MavlinkStreamScheduler::has_stream(uint32_t message_id) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    return std::any_of(_streams.begin(), _streams.end(), [message_id](const Stream& stream) {
+        return stream.message_id == message_id;
+    });
+}
+
+bool MavlinkStreamScheduler::update(uint32_t message_id, const mavlink_message_t& message)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto stream = find_stream_locked(message_id);
+    if (stream == nullptr) {
+        return false;
+    }
+    stream->message = message;
+    stream->has_message = true;
+    return true;
+}
+
+void MavlinkStreamScheduler::set_bandwidth_budget(double bytes_per_s)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _budget_bytes_per_s = std::max(bytes_per_s, 0.0);
+    _budget_bytes_available = budget_capacity_locked();
+    _budget_last_refill = _time.steady_time();
+}
+
+double MavlinkStreamScheduler::bandwidth_budget() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    return _budget_bytes_per_s;
+}
+
+std::optional<dl_time_t> MavlinkStreamScheduler::send_due(const SendCallback& send)
+{
+    std::vector<mavlink_message_t> messages;
+    std::optional<dl_time_t> next_due;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        const auto now = _time.steady_time();
+        refill_budget_locked(now);
+
+        std::vector<Stream*> due;
+        for (auto& stream : _streams) {
+            if (stream.next_due <= now) {
+                due.push_back(&stream);
+            }
+        }
+
+        // Within a priority, the stream that has waited longest goes first.
+        std::sort(due.begin(), due.end(), [](const Stream* lhs, const Stream* rhs) {
+            if (lhs->priority != rhs->priority) {
+                return lhs->priority < rhs->priority;
+            }
+            return lhs->next_due < rhs->next_due;
+        });
+
+        for (auto stream : due) {
+            Time::shift_steady_time_by(stream->next_due, stream->interval_s);
+            if (stream->next_due <= now) {
+                // We fell behind by more than an interval, e.g. because the system
+                // was suspended. Don't try to catch up with a burst.
+                stream->next_due = now;
+                Time::shift_steady_time_by(stream->next_due, stream->interval_s);
+            }
+
+            if (!stream->has_message) {
+                continue;
+            }
+
+            if (_budget_bytes_per_s > 0.0) {
+                // Streams of lower priority must leave part of the budget, so that it
+                // is not used up by the time a stream of higher priority is due.
+                const double reserved = budget_capacity_locked() *
+                                        (stream->priority == Priority::High   ? 0.0 :
+                                         stream->priority == Priority::Normal ? 0.25 :
+                                                                                0.5);
+                const auto length =
+                    static_cast<double>(mavlink_msg_get_send_buffer_length(&stream->message));
+                if (_budget_bytes_available - length < reserved) {
+                    ++stream->num_throttled;
+                    continue;
+                }
+                _budget_bytes_available -= length;
+            }
+
+            ++stream->num_sent;
+            messages.push_back(stream->message);
+
+            if (stream->known) {
+                // Every copy takes the next sequence number, so that receivers
+                // don't take it as a duplicate of the previous one.
+                auto& message = messages.back();
+                mavlink_finalize_message(
+                    &message,
+                    message.sysid,
+                    message.compid,
+                    stream->min_length,
+                    stream->max_length,
+                    stream->crc_extra);
+            }
+        }
+
+        for (const auto& stream : _streams) {
+            if (!next_due || stream.next_due < next_due.value()) {
+                next_due = stream.next_due;
+            }
+        }
+    }
+
+    // Send without holding the lock, so publishing isn't blocked by slow links.
+    for (auto& message : messages) {
+        send(message);
+    }
+
+    return next_due;
+}
+
+void MavlinkStreamScheduler::start(SendCallback send)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _send_callback = std::move(send);
+    if (!_streams.empty() && _thread == nullptr) {
+        start_thread_locked();
+    }
+}
+
+void MavlinkStreamScheduler::stop()
+{
+    std::thread* thread = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _should_exit = true;
+        thread = _thread;
+        _thread = nullptr;
+        _cv.notify_one();
+    }
+
+    if (thread != nullptr) {
+        thread->join();
+        delete thread;
+    }
+}
+
+std::vector<MavlinkStreamScheduler::StreamStatistics> MavlinkStreamScheduler::statistics() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::vector<StreamStatistics> result;
+    result.reserve(_streams.size());
+    for (const auto& stream : _streams) {
+        StreamStatistics statistics;
+        statistics.message_id = stream.message_id;
+        statistics.interval_s = stream.interval_s;
+        statistics.priority = stream.priority;
+        statistics.num_sent = stream.num_sent;
+        statistics.num_throttled = stream.num_throttled;
+        result.push_back(statistics);
+    }
+    return result;
+}
+
+MavlinkStreamScheduler::Stream* MavlinkStreamScheduler::find_stream_locked(uint32_t message_id)
+{
+    for (auto& stream : _streams) {
+        if (stream.message_id == message_id) {
+            return &stream;
+        }
+    }
+    return nullptr;
+}
+
+void MavlinkStreamScheduler::refill_budget_locked(const dl_time_t& now)
+{
+    if (_budget_bytes_per_s <= 0.0) {
+        return;
+    }
+
+    const double elapsed_s = std::chrono::duration<double>(now - _budget_last_refill).count();
+    _budget_last_refill = now;
+
+    _budget_bytes_available = std::min(
+        budget_capacity_locked(), _budget_bytes_available + elapsed_s * _budget_bytes_per_s);
+}
+
+double MavlinkStreamScheduler::budget_capacity_locked() const
+{
+    // Always allow a few messages of maximum size, otherwise a small budget
+    // would block big messages forever.
+    return std::max(
+        _budget_bytes_per_s * BUDGET_BURST_S, 2.0 * static_cast<double>(MAVLINK_MAX_PACKET_LEN));
+}
+
+void MavlinkStreamScheduler::start_thread_locked()
+{
+    _should_exit = false;
+    _thread = new std::thread(&MavlinkStreamScheduler::run, this);
+}
+
+void MavlinkStreamScheduler::run()
+{
+    while (!_should_exit) {
+        const auto next_due = send_due(_send_callback);
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        const auto woken = [this]() { return _should_exit || _streams_changed; };
+        if (next_due) {
+            _cv.wait_until(lock, next_due.value(), woken);
+        } else {
+            _cv.wait(lock, woken);
+        }
+        _streams_changed = false;
+    }
+}
+
+} // namespace mavsdk
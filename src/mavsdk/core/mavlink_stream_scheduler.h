@@ -0,0 +1,112 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include "mavsdk_time.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace mavsdk {
+
+// Sends the latest value of each outbound message stream at its configured
+// rate, like the stream engine of an autopilot.
+//
+// Every stream has its own deadline which advances by its interval, so the rate
+// does not drift with the time it takes to send. New streams start at a phase
+// offset to the existing ones, so that streams with the same rate don't all
+// become due at the same time. With a bandwidth budget set, streams that don't
+// fit into it skip their interval. Part of the budget is reserved for the
+// streams of higher priority, so they are the last ones to be throttled.
+class MavlinkStreamScheduler {
+public:
+    enum class Priority { High, Normal, Low };
+
+    using SendCallback = std::function<bool(mavlink_message_t&)>;
+
+    struct StreamStatistics {
+        uint32_t message_id{0};
+        double interval_s{0.0};
+        Priority priority{Priority::Normal};
+        uint64_t num_sent{0};
+        uint64_t num_throttled{0};
+    };
+
+    explicit MavlinkStreamScheduler(Time& time);
+    ~MavlinkStreamScheduler();
+
+    // An interval of 0 or less removes the stream.
+    void set_stream(uint32_t message_id, double interval_s, Priority priority);
+    void remove_stream(uint32_t message_id);
+    [[nodiscard]] bool has_stream(uint32_t message_id) const;
+
+    // Stores the latest value of a message. Returns false if there is no stream
+    // for it, in which case it is up to the caller to send it.
+    bool update(uint32_t message_id, const mavlink_message_t& message);
+
+    // Bytes per second, 0 for no limit.
+    void set_bandwidth_budget(double bytes_per_s);
+    [[nodiscard]] double bandwidth_budget() const;
+
+    // Sends all streams that are due, and returns when the next one is due.
+    std::optional<dl_time_t> send_due(const SendCallback& send);
+
+    // Runs send_due on a thread of its own from the first stream on.
+    void start(SendCallback send);
+    void stop();
+
+    [[nodiscard]] std::vector<StreamStatistics> statistics() const;
+
+    // Non-copyable
+    MavlinkStreamScheduler(const MavlinkStreamScheduler&) = delete;
+    const MavlinkStreamScheduler& operator=(const MavlinkStreamScheduler&) = delete;
+
+private:
+    struct Stream {
+        uint32_t message_id{0};
+        double interval_s{0.0};
+        Priority priority{Priority::Normal};
+        dl_time_t next_due{};
+        bool has_message{false};
+        mavlink_message_t message{};
+        // Needed to finalize the message again on every send.
+        uint8_t min_length{0};
+        uint8_t max_length{0};
+        uint8_t crc_extra{0};
+        bool known{false};
+        uint64_t num_sent{0};
+        uint64_t num_throttled{0};
+    };
+
+    Stream* find_stream_locked(uint32_t message_id);
+    void refill_budget_locked(const dl_time_t& now);
+    [[nodiscard]] double budget_capacity_locked() const;
+    void start_thread_locked();
+    void run();
+
+    // Burst that is allowed on top of the budget, in seconds worth of bytes.
+    static constexpr double BUDGET_BURST_S = 0.1;
+
+    Time& _time;
+
+    mutable std::mutex _mutex{};
+    std::condition_variable _cv{};
+    std::vector<Stream> _streams{};
+    unsigned _num_streams_added{0};
+
+    double _budget_bytes_per_s{0.0};
+    double _budget_bytes_available{0.0};
+    dl_time_t _budget_last_refill{};
+
+    SendCallback _send_callback{nullptr};
+    std::thread* _thread{nullptr};
+    bool _streams_changed{false};
+    std::atomic<bool> _should_exit{false};
+};
+
+} // namespace mavsdk
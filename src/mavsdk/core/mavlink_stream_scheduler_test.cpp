@@ -0,0 +1,136 @@
+#include "mavlink_stream_scheduler.h"
+#include <gtest/gtest.h>
+
+#include <map>
+#include <vector>
+
+using namespace mavsdk;
+
+static mavlink_message_t make_message(uint32_t msgid, uint8_t len)
+{
+    mavlink_message_t message{};
+    message.msgid = msgid;
+    message.len = len;
+    return message;
+}
+
+// Runs the scheduler in steps of 5 ms and counts the messages sent per ID.
+static std::map<uint32_t, unsigned>
+run_for(MavlinkStreamScheduler& scheduler, FakeTime& time, unsigned duration_ms)
+{
+    std::map<uint32_t, unsigned> num_sent;
+    for (unsigned i = 0; i < duration_ms / 5; ++i) {
+        scheduler.send_due([&num_sent](mavlink_message_t& message) {
+            ++num_sent[message.msgid];
+            return true;
+        });
+        time.sleep_for(std::chrono::milliseconds(5));
+    }
+    return num_sent;
+}
+
+TEST(MavlinkStreamScheduler, SendsLatestValueAtRate)
+{
+    FakeTime time;
+    MavlinkStreamScheduler scheduler(time);
+
+    // Without a stream, the caller has to send it.
+    EXPECT_FALSE(scheduler.update(30, make_message(30, 28)));
+
+    scheduler.set_stream(30, 0.1, MavlinkStreamScheduler::Priority::Normal);
+    scheduler.set_stream(33, 0.02, MavlinkStreamScheduler::Priority::Normal);
+    EXPECT_TRUE(scheduler.update(30, make_message(30, 28)));
+
+    // Nothing is sent for streams without a value.
+    auto num_sent = run_for(scheduler, time, 1000);
+    EXPECT_NEAR(num_sent[30], 10, 1);
+    EXPECT_EQ(num_sent[33], 0);
+
+    EXPECT_TRUE(scheduler.update(33, make_message(33, 28)));
+    num_sent = run_for(scheduler, time, 1000);
+    EXPECT_NEAR(num_sent[30], 10, 1);
+    EXPECT_NEAR(num_sent[33], 50, 1);
+
+    scheduler.set_stream(30, 0.0, MavlinkStreamScheduler::Priority::Normal);
+    EXPECT_FALSE(scheduler.has_stream(30));
+    num_sent = run_for(scheduler, time, 1000);
+    EXPECT_EQ(num_sent[30], 0);
+}
+
+TEST(MavlinkStreamScheduler, SpreadsPhases)
+{
+    FakeTime time;
+    MavlinkStreamScheduler scheduler(time);
+
+    for (uint32_t msgid = 1; msgid <= 4; ++msgid) {
+        scheduler.set_stream(msgid, 0.1, MavlinkStreamScheduler::Priority::Normal);
+        scheduler.update(msgid, make_message(msgid, 20));
+    }
+
+    unsigned max_sent_at_once = 0;
+    for (unsigned i = 0; i < 1000; ++i) {
+        unsigned sent = 0;
+        scheduler.send_due([&sent](mavlink_message_t&) {
+            ++sent;
+            return true;
+        });
+        max_sent_at_once = std::max(max_sent_at_once, sent);
+        time.sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(max_sent_at_once, 1);
+}
+
+TEST(MavlinkStreamScheduler, BudgetPrefersHigherPriority)
+{
+    FakeTime time;
+    MavlinkStreamScheduler scheduler(time);
+
+    // Each message is 40 + 12 bytes, both streams together would need 1040 bytes/s.
+    scheduler.set_stream(1, 0.1, MavlinkStreamScheduler::Priority::Low);
+    scheduler.set_stream(2, 0.1, MavlinkStreamScheduler::Priority::High);
+    scheduler.update(1, make_message(1, 40));
+    scheduler.update(2, make_message(2, 40));
+    scheduler.set_bandwidth_budget(600.0);
+
+    auto num_sent = run_for(scheduler, time, 10000);
+    EXPECT_NEAR(num_sent[2], 100, 1);
+    // 600 bytes/s for 10 s, plus the initial burst.
+    EXPECT_LE((num_sent[1] + num_sent[2]) * 52, 6000 + 2 * MAVLINK_MAX_PACKET_LEN);
+    EXPECT_GT(num_sent[1], 0);
+    EXPECT_LT(num_sent[1], num_sent[2]);
+
+    const auto statistics = scheduler.statistics();
+    ASSERT_EQ(statistics.size(), 2);
+    EXPECT_EQ(statistics[0].message_id, 1);
+    EXPECT_GT(statistics[0].num_throttled, 0);
+    EXPECT_EQ(statistics[1].num_throttled, 0);
+
+    scheduler.set_bandwidth_budget(0.0);
+    num_sent = run_for(scheduler, time, 1000);
+    EXPECT_NEAR(num_sent[1], 10, 1);
+    EXPECT_NEAR(num_sent[2], 10, 1);
+}
+
+TEST(MavlinkStreamScheduler, TakesNewSequenceNumberForEveryCopy)
+{
+    FakeTime time;
+    MavlinkStreamScheduler scheduler(time);
+
+    const uint32_t msgid = MAVLINK_MSG_ID_HEARTBEAT;
+    scheduler.set_stream(msgid, 0.02, MavlinkStreamScheduler::Priority::Normal);
+    EXPECT_TRUE(scheduler.update(msgid, make_message(msgid, 9)));
+
+    std::vector<uint8_t> seqs;
+    for (unsigned i = 0; i < 20; ++i) {
+        scheduler.send_due([&seqs](mavlink_message_t& message) {
+            seqs.push_back(message.seq);
+            return true;
+        });
+        time.sleep_for(std::chrono::milliseconds(20));
+    }
+
+    ASSERT_GE(seqs.size(), 10);
+    for (std::size_t i = 1; i < seqs.size(); ++i) {
+        EXPECT_EQ(seqs[i], static_cast<uint8_t>(seqs[i - 1] + 1));
+    }
+}
@@ -1,6 +1,7 @@
 #include "mavsdk.h"
 
 #include "mavsdk_impl.h"
+#include "metrics.h"
 
 namespace mavsdk {
 
@@ -54,6 +55,72 @@ ConnectionResult Mavsdk::add_serial_connection(
     return _impl->add_serial_connection(dev_path, baudrate, flow_control, forwarding_option);
 }
 
+ConnectionResult Mavsdk::add_serial_connection(
+    const std::string& dev_path,
+    const int baudrate,
+    bool flow_control,
+    ForwardingOption forwarding_option,
+    const SerialOptions& serial_options)
+{
+    return _impl->add_serial_connection(
+        dev_path, baudrate, flow_control, forwarding_option, serial_options);
+}
+
+std::vector<Mavsdk::ConnectionStatistics> Mavsdk::connection_statistics() const
+{
+    return _impl->connection_statistics();
+}
+
+void Mavsdk::set_redundant_link_policy(RedundantLinkPolicy policy)
+{
+    _impl->set_redundant_link_policy(policy);
+}
+
+std::vector<Mavsdk::LinkQuality> Mavsdk::link_quality() const
+{
+    return _impl->link_quality();
+}
+
+void Mavsdk::subscribe_link_quality(const LinkQualityCallback& callback)
+{
+    _impl->subscribe_link_quality(callback);
+}
+
+bool Mavsdk::enable_signing(const std::string& connection, const SigningOptions& options)
+{
+    return _impl->enable_signing(connection, options);
+}
+
+bool Mavsdk::disable_signing(const std::string& connection)
+{
+    return _impl->disable_signing(connection);
+}
+
+bool Mavsdk::start_tlog_recording(const std::string& path)
+{
+    return _impl->tlog_recorder.start(path);
+}
+
+void Mavsdk::stop_tlog_recording()
+{
+    _impl->tlog_recorder.stop();
+}
+
+std::vector<Mavsdk::Metric> Mavsdk::metrics() const
+{
+    return _impl->metrics();
+}
+
+std::string Mavsdk::metrics_prometheus() const
+{
+    return Metrics::to_prometheus(_impl->metrics());
+}
+
+bool Mavsdk::write_metrics_prometheus(const std::string& path) const
+{
+    return Metrics::write_prometheus(path, _impl->metrics());
+}
+
 std::vector<std::shared_ptr<System>> Mavsdk::systems() const
 {
     return _impl->systems();
@@ -183,4 +250,14 @@ void Mavsdk::Configuration::set_usage_type(Mavsdk::Configuration::UsageType usag
     _usage_type = usage_type;
 }
 
+std::string Mavsdk::Configuration::get_metadata_cache_directory() const
+{
+    return _metadata_cache_directory;
+}
+
+void Mavsdk::Configuration::set_metadata_cache_directory(const std::string& directory)
+{
+    _metadata_cache_directory = directory;
+}
+
 } // namespace mavsdk
@@ -1,18 +1,22 @@
 #include "mavsdk_impl.h"
 
 #include <algorithm>
+#include <chrono>
 #include <mutex>
 
+#include "async_log_writer.h"
 #include "connection.h"
 #include "tcp_connection.h"
 #include "udp_connection.h"
 #include "system.h"
 #include "system_impl.h"
 #include "serial_connection.h"
+#include "tlog_replay_connection.h"
 #include "cli_arg.h"
 #include "version.h"
 #include "unused.h"
 #include "server_component_impl.h"
+#include "metrics.h"
 
 namespace mavsdk {
 
@@ -34,6 +38,12 @@ MavsdkImpl::MavsdkImpl() : timeout_handler(_time), call_every_handler(_time)
         }
     }
 
+    call_every_handler.add(
+        [this]() { evaluate_link_quality(); }, LINK_QUALITY_INTERVAL_S, &_link_quality_cookie);
+
+    call_every_handler.add(
+        [this]() { _routing_table.age_routes(); }, ROUTE_AGING_INTERVAL_S, &_route_aging_cookie);
+
     _work_thread = new std::thread(&MavsdkImpl::work_thread, this);
 
     _process_user_callbacks_thread =
@@ -43,6 +53,8 @@ MavsdkImpl::MavsdkImpl() : timeout_handler(_time), call_every_handler(_time)
 MavsdkImpl::~MavsdkImpl()
 {
     call_every_handler.remove(_heartbeat_send_cookie);
+    call_every_handler.remove(_link_quality_cookie);
+    call_every_handler.remove(_route_aging_cookie);
 
     _should_exit = true;
 
@@ -64,10 +76,24 @@ MavsdkImpl::~MavsdkImpl()
         _systems.clear();
     }
 
+    std::shared_ptr<const ConnectionsSnapshot> snapshot;
     {
         std::lock_guard<std::mutex> lock(_connections_mutex);
+        snapshot = connections_snapshot();
         _connections.clear();
+        update_connections_snapshot_locked();
+    }
+
+    // Wait until the receive threads are done with the last snapshot.
+    // Otherwise, the last reference to a connection could be dropped on its
+    // own receive thread, which then can't be joined. Not holding the
+    // connections lock, as they might still need it to finish. No new ones
+    // start, as _should_exit is set.
+    {
+        std::unique_lock<std::mutex> lock(_receivers_mutex);
+        _receivers_cv.wait(lock, [this]() { return _num_receivers == 0; });
     }
+    snapshot.reset();
 }
 
 std::string MavsdkImpl::version()
@@ -217,26 +243,115 @@ void MavsdkImpl::forward_message(mavlink_message_t& message, Connection* connect
         (message.msgid != MAVLINK_MSG_ID_HEARTBEAT || forward_heartbeats_enabled);
 
     if (!targeted_only_at_us && heartbeat_check_ok) {
-        std::lock_guard<std::mutex> lock(_connections_mutex);
+        const auto snapshot = connections_snapshot();
+
+        // Only to forwarding connections on the way to the target, and never
+        // back to the one from which we received the message.
+        auto mask =
+            _routing_table.route(target_system_id, target_component_id, snapshot->forwarding);
+        if (mask == 0) {
+            // Nothing was received from the target yet, so there is no way to
+            // know where it is.
+            Metrics::instance().messages_unroutable.add();
+            if (_message_logging_on) {
+                LogDebug() << "No route to " << static_cast<int>(target_system_id) << "/"
+                           << static_cast<int>(target_component_id) << " for message "
+                           << message.msgid;
+            }
+            return;
+        }
+        if (connection->routing_index() < MavlinkRoutingTable::MAX_CONNECTIONS) {
+            mask &= ~(1U << connection->routing_index());
+        }
+        if (mask == 0) {
+            return;
+        }
 
-        unsigned successful_emissions = 0;
-        for (auto& _connection : _connections) {
-            // Check whether the connection is not the one from which we received the message.
-            // And also check if the connection was set to forward messages.
-            if (_connection.get() == connection || !(*_connection).should_forward_messages()) {
+        if (send_to_connections(message, *snapshot, mask) == 0) {
+            LogErr() << "Message forwarding failed";
+        }
+    }
+}
+
+void MavsdkImpl::receive_messages(
+    mavlink_message_t* messages, std::size_t count, Connection* connection)
+{
+    {
+        std::lock_guard<std::mutex> lock(_receivers_mutex);
+        if (_should_exit) {
+            return;
+        }
+        ++_num_receivers;
+    }
+
+    // Messages which are dropped get overwritten by the following ones, so the
+    // messages to dispatch end up at the front of the array.
+    std::size_t num_to_dispatch = 0;
+    {
+        const auto snapshot = connections_snapshot();
+
+        for (std::size_t i = 0; i < count; ++i) {
+            if (tlog_recorder.is_recording()) {
+                tlog_recorder.record(messages[i]);
+            }
+            const auto& message = messages[i];
+            _routing_table.learn(message.sysid, message.compid, connection->routing_index());
+
+            const bool is_new_frame = _routing_table.is_new_frame(
+                message.sysid, message.compid, message.seq, message.msgid, message.checksum);
+            if (is_new_frame) {
+                _path_monitor.add_first_copy(message.sysid, connection->routing_index());
+            }
+
+            // Copies arriving over redundant links are only processed once. Only
+            // then, so a sender restarting its sequence numbers is not mistaken
+            // for sending copies.
+            if (!is_new_frame &&
+                _routing_table.has_redundant_routes(message.sysid, message.compid)) {
+                continue;
+            }
+            Metrics::instance().messages_received.add(message.msgid);
+
+            if (!prepare_received_message(messages[i], connection, *snapshot, is_new_frame)) {
                 continue;
             }
-            if ((*_connection).send_message(message)) {
-                successful_emissions++;
+            if (num_to_dispatch != i) {
+                messages[num_to_dispatch] = messages[i];
             }
-        }
-        if (successful_emissions == 0) {
-            LogErr() << "Message forwarding failed";
+            ++num_to_dispatch;
         }
     }
+
+    {
+        std::lock_guard<std::mutex> lock(_receivers_mutex);
+        --_num_receivers;
+    }
+    _receivers_cv.notify_all();
+
+    if (num_to_dispatch == 0) {
+        return;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(_systems_mutex);
+
+    for (std::size_t i = 0; i < num_to_dispatch; ++i) {
+        add_system_component(messages[i]);
+    }
+
+    if (_should_exit) {
+        // Don't try to call at() if systems have already been destroyed
+        // in destructor.
+        return;
+    }
+
+    mavlink_message_handler.process_messages(messages, num_to_dispatch);
 }
 
-void MavsdkImpl::receive_message(mavlink_message_t& message, Connection* connection)
+bool MavsdkImpl::prepare_received_message(
+    mavlink_message_t& message,
+    Connection* connection,
+    const ConnectionsSnapshot& snapshot,
+    bool is_new_frame)
 {
     if (_message_logging_on) {
         LogDebug() << "Processing message " << message.msgid << " from "
@@ -249,23 +364,27 @@ void MavsdkImpl::receive_message(mavlink_message_t& message, Connection* connect
         bool keep = _intercept_incoming_messages_callback(message);
         if (!keep) {
             LogDebug() << "Dropped incoming message: " << int(message.msgid);
-            return;
+            return false;
         }
     }
 
+    if (_raw_frame_batchers_active) {
+        batch_raw_frame(message);
+    }
+
     /** @note: Forward message if option is enabled and multiple interfaces are connected.
      *  Performs message forwarding checks for every messages if message forwarding
-     *  is enabled on at least one connection, and in case of a single forwarding connection,
-     *  we check that it is not the one which received the current message.
+     *  is enabled on at least one connection other than the one which received
+     *  the current message.
      *
-     * Conditions:
-     * 1. At least 2 connections.
-     * 2. At least 1 forwarding connection.
-     * 3. At least 2 forwarding connections or current connection is not forwarding.
+     *  Frames that were seen before are not forwarded again, so that messages
+     *  don't circle if the links form a loop.
      */
-    if (_connections.size() > 1 && mavsdk::Connection::forwarding_connections_count() > 0 &&
-        (mavsdk::Connection::forwarding_connections_count() > 1 ||
-         !connection->should_forward_messages())) {
+    const auto receiving_connection_mask =
+        (connection->routing_index() < MavlinkRoutingTable::MAX_CONNECTIONS) ?
+            (1U << connection->routing_index()) :
+            0U;
+    if ((snapshot.forwarding & ~receiving_connection_mask) != 0 && is_new_frame) {
         if (_message_logging_on) {
             LogDebug() << "Forwarding message " << message.msgid << " from "
                        << static_cast<int>(message.sysid) << "/"
@@ -279,7 +398,7 @@ void MavsdkImpl::receive_message(mavlink_message_t& message, Connection* connect
         if (_message_logging_on) {
             LogDebug() << "Ignoring message with sysid == 0";
         }
-        return;
+        return false;
     }
 
     // Filter out messages by QGroundControl, however, only do that if MAVSDK
@@ -295,11 +414,14 @@ void MavsdkImpl::receive_message(mavlink_message_t& message, Connection* connect
         if (_message_logging_on) {
             LogDebug() << "Ignoring messages from QGC as we are also a ground station";
         }
-        return;
+        return false;
     }
 
-    std::lock_guard<std::recursive_mutex> lock(_systems_mutex);
+    return true;
+}
 
+void MavsdkImpl::add_system_component(const mavlink_message_t& message)
+{
     // The only situation where we create a system with sysid 0 is when we initialize the connection
     // to the remote.
     if (_systems.size() == 1 && _systems[0].first == 0) {
@@ -309,32 +431,14 @@ void MavsdkImpl::receive_message(mavlink_message_t& message, Connection* connect
         _systems[0].second->system_impl()->set_system_id(message.sysid);
     }
 
-    bool found_system = false;
     for (auto& system : _systems) {
         if (system.first == message.sysid) {
             system.second->system_impl()->add_new_component(message.compid);
-            found_system = true;
-            break;
+            return;
         }
     }
 
-    if (!found_system) {
-        make_system_with_component(message.sysid, message.compid);
-    }
-
-    if (_should_exit) {
-        // Don't try to call at() if systems have already been destroyed
-        // in destructor.
-        return;
-    }
-
-    for (auto& system : _systems) {
-        if (system.first == message.sysid) {
-            // system.second->system_impl()->process_mavlink_message(message);
-            mavlink_message_handler.process_message(message);
-            break;
-        }
-    }
+    make_system_with_component(message.sysid, message.compid);
 }
 
 bool MavsdkImpl::send_message(mavlink_message_t& message)
@@ -357,28 +461,31 @@ bool MavsdkImpl::send_message(mavlink_message_t& message)
         }
     }
 
-    std::lock_guard<std::mutex> lock(_connections_mutex);
+    if (tlog_recorder.is_recording()) {
+        tlog_recorder.record(message);
+    }
+
+    Metrics::instance().messages_sent.add(message.msgid);
+
+    const auto snapshot = connections_snapshot();
 
-    if (_connections.empty()) {
+    if (snapshot->connections.empty()) {
         // We obviously can't send any messages without a connection added, so
         // we silently ignore this.
         return true;
     }
 
-    uint8_t successful_emissions = 0;
-    for (auto& _connection : _connections) {
-        const uint8_t target_system_id = get_target_system_id(message);
-
-        if (target_system_id != 0 && !(*_connection).has_system_id(target_system_id)) {
-            continue;
-        }
+    const auto target_system_id = get_target_system_id(message);
+    auto mask =
+        _routing_table.route(target_system_id, get_target_component_id(message), snapshot->all);
 
-        if ((*_connection).send_message(message)) {
-            successful_emissions++;
-        }
+    // Broadcasts still go everywhere, as there could be other systems on each link.
+    if (_redundant_link_policy == Mavsdk::RedundantLinkPolicy::SendOnBestLink &&
+        target_system_id != 0 && (mask & (mask - 1)) != 0) {
+        mask = _path_monitor.best_path(target_system_id, mask);
     }
 
-    if (successful_emissions == 0) {
+    if (send_to_connections(message, *snapshot, mask) == 0) {
         LogErr() << "Sending message failed";
         return false;
     }
@@ -429,6 +536,10 @@ ConnectionResult MavsdkImpl::add_any_connection(
                 cli_arg.get_path(), baudrate, flow_control, forwarding_option);
         }
 
+        case CliArg::Protocol::File:
+            return add_tlog_replay_connection(
+                cli_arg.get_path(), cli_arg.get_replay_speed(), forwarding_option);
+
         default:
             return ConnectionResult::ConnectionError;
     }
@@ -438,8 +549,8 @@ ConnectionResult MavsdkImpl::add_udp_connection(
     const std::string& local_ip, const int local_port, ForwardingOption forwarding_option)
 {
     auto new_conn = std::make_shared<UdpConnection>(
-        [this](mavlink_message_t& message, Connection* connection) {
-            receive_message(message, connection);
+        [this](mavlink_message_t* messages, std::size_t count, Connection* connection) {
+            receive_messages(messages, count, connection);
         },
         local_ip,
         local_port,
@@ -458,8 +569,8 @@ ConnectionResult MavsdkImpl::setup_udp_remote(
     const std::string& remote_ip, int remote_port, ForwardingOption forwarding_option)
 {
     auto new_conn = std::make_shared<UdpConnection>(
-        [this](mavlink_message_t& message, Connection* connection) {
-            receive_message(message, connection);
+        [this](mavlink_message_t* messages, std::size_t count, Connection* connection) {
+            receive_messages(messages, count, connection);
         },
         "0.0.0.0",
         0,
@@ -481,8 +592,8 @@ ConnectionResult MavsdkImpl::add_tcp_connection(
     const std::string& remote_ip, int remote_port, ForwardingOption forwarding_option)
 {
     auto new_conn = std::make_shared<TcpConnection>(
-        [this](mavlink_message_t& message, Connection* connection) {
-            receive_message(message, connection);
+        [this](mavlink_message_t* messages, std::size_t count, Connection* connection) {
+            receive_messages(messages, count, connection);
         },
         remote_ip,
         remote_port,
@@ -501,15 +612,54 @@ ConnectionResult MavsdkImpl::add_serial_connection(
     const std::string& dev_path,
     int baudrate,
     bool flow_control,
-    ForwardingOption forwarding_option)
+    ForwardingOption forwarding_option,
+    const Mavsdk::SerialOptions& serial_options)
 {
     auto new_conn = std::make_shared<SerialConnection>(
-        [this](mavlink_message_t& message, Connection* connection) {
-            receive_message(message, connection);
+        [this](mavlink_message_t* messages, std::size_t count, Connection* connection) {
+            receive_messages(messages, count, connection);
         },
         dev_path,
         baudrate,
         flow_control,
+        forwarding_option,
+        serial_options);
+    if (!new_conn) {
+        return ConnectionResult::ConnectionError;
+    }
+    ConnectionResult ret = new_conn->start();
+    if (ret == ConnectionResult::Success) {
+        add_connection(new_conn);
+    }
+    return ret;
+}
+
+ConnectionResult MavsdkImpl::add_tlog_replay_connection(
+    const std::string& path, double speed, ForwardingOption forwarding_option)
+{
+    auto new_conn = std::make_shared<TlogReplayConnection>(
+        [this](mavlink_message_t* messages, std::size_t count, Connection* connection) {
+            // Recorded tlogs contain what we sent as well, which must not turn
+            // into a system of its own.
+            const uint8_t own_system_id = get_own_system_id();
+            const uint8_t own_component_id = get_own_component_id();
+            std::size_t num_received = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                if (messages[i].sysid == own_system_id &&
+                    messages[i].compid == own_component_id) {
+                    continue;
+                }
+                if (num_received != i) {
+                    messages[num_received] = messages[i];
+                }
+                ++num_received;
+            }
+            if (num_received > 0) {
+                receive_messages(messages, num_received, connection);
+            }
+        },
+        path,
+        speed,
         forwarding_option);
     if (!new_conn) {
         return ConnectionResult::ConnectionError;
@@ -524,7 +674,229 @@ ConnectionResult MavsdkImpl::add_serial_connection(
 void MavsdkImpl::add_connection(const std::shared_ptr<Connection>& new_connection)
 {
     std::lock_guard<std::mutex> lock(_connections_mutex);
+    if (_connections.size() < MavlinkRoutingTable::MAX_CONNECTIONS) {
+        new_connection->set_routing_index(static_cast<unsigned>(_connections.size()));
+    } else {
+        LogErr() << "Too many connections, not routing to " << new_connection->description();
+    }
     _connections.push_back(new_connection);
+    update_connections_snapshot_locked();
+}
+
+void MavsdkImpl::set_redundant_link_policy(Mavsdk::RedundantLinkPolicy policy)
+{
+    _redundant_link_policy = policy;
+}
+
+std::vector<Mavsdk::LinkQuality> MavsdkImpl::link_quality()
+{
+    const auto snapshot = connections_snapshot();
+
+    std::vector<Mavsdk::LinkQuality> link_quality;
+    for (const auto& connection : snapshot->connections) {
+        const auto description = connection->description();
+        for (const auto& source : connection->source_qualities()) {
+            Mavsdk::LinkQuality quality;
+            quality.connection = description;
+            quality.system_id = source.system_id;
+            quality.component_id = source.component_id;
+            quality.frames_received = source.frames_received;
+            quality.frames_lost = source.frames_lost;
+            quality.frames_reordered = source.frames_reordered;
+            quality.frames_duplicate = source.frames_duplicate;
+            quality.loss_ratio = source.loss_ratio;
+            quality.reorder_ratio = source.reorder_ratio;
+            quality.duplicate_ratio = source.duplicate_ratio;
+            quality.jitter_s = source.jitter_s;
+            quality.active = source.active;
+            link_quality.push_back(quality);
+        }
+    }
+    return link_quality;
+}
+
+void MavsdkImpl::subscribe_link_quality(const Mavsdk::LinkQualityCallback& callback)
+{
+    std::lock_guard<std::mutex> lock(_link_quality_mutex);
+    _link_quality_callback = callback;
+}
+
+void MavsdkImpl::evaluate_link_quality()
+{
+    MavlinkPathMonitor::ConnectionSources sources;
+    for (const auto& connection : connections_snapshot()->connections) {
+        connection->evaluate_sources();
+        const auto index = connection->routing_index();
+        if (index < sources.size()) {
+            sources[index] = connection->source_qualities();
+        }
+    }
+    _path_monitor.evaluate(sources);
+
+    std::lock_guard<std::mutex> lock(_link_quality_mutex);
+    if (_link_quality_callback) {
+        auto temp_callback = _link_quality_callback;
+        auto link_quality = this->link_quality();
+        call_user_callback([temp_callback, link_quality = std::move(link_quality)]() {
+            temp_callback(link_quality);
+        });
+    }
+}
+
+bool MavsdkImpl::enable_signing(
+    const std::string& connection, const Mavsdk::SigningOptions& options)
+{
+    MavlinkSigning::Options signing_options;
+    signing_options.secret_key = options.secret_key;
+    signing_options.link_id = options.link_id;
+    signing_options.sign_outgoing = options.sign_outgoing;
+    signing_options.accept_unsigned = options.accept_unsigned;
+
+    bool found = false;
+    for (const auto& candidate : connections_snapshot()->connections) {
+        if (candidate->description() == connection) {
+            candidate->enable_signing(signing_options);
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool MavsdkImpl::disable_signing(const std::string& connection)
+{
+    bool found = false;
+    for (const auto& candidate : connections_snapshot()->connections) {
+        if (candidate->description() == connection) {
+            candidate->disable_signing();
+            found = true;
+        }
+    }
+    return found;
+}
+
+std::shared_ptr<const MavsdkImpl::ConnectionsSnapshot> MavsdkImpl::connections_snapshot() const
+{
+    return std::atomic_load(&_connections_snapshot);
+}
+
+void MavsdkImpl::update_connections_snapshot_locked()
+{
+    auto snapshot = std::make_shared<ConnectionsSnapshot>();
+    snapshot->connections = _connections;
+    for (const auto& connection : _connections) {
+        if (connection->routing_index() >= MavlinkRoutingTable::MAX_CONNECTIONS) {
+            continue;
+        }
+        const MavlinkRoutingTable::ConnectionMask bit = 1U << connection->routing_index();
+        snapshot->all |= bit;
+        if (connection->should_forward_messages()) {
+            snapshot->forwarding |= bit;
+        }
+    }
+    std::atomic_store(
+        &_connections_snapshot, std::shared_ptr<const ConnectionsSnapshot>(std::move(snapshot)));
+}
+
+unsigned MavsdkImpl::send_to_connections(
+    const mavlink_message_t& message,
+    const ConnectionsSnapshot& snapshot,
+    MavlinkRoutingTable::ConnectionMask mask)
+{
+    unsigned successful_emissions = 0;
+    for (const auto& connection : snapshot.connections) {
+        const auto index = connection->routing_index();
+        if (index >= MavlinkRoutingTable::MAX_CONNECTIONS || (mask & (1U << index)) == 0) {
+            continue;
+        }
+        if (connection->send_message(message)) {
+            ++successful_emissions;
+        }
+    }
+    return successful_emissions;
+}
+
+std::vector<Mavsdk::ConnectionStatistics> MavsdkImpl::connection_statistics()
+{
+    std::lock_guard<std::mutex> lock(_connections_mutex);
+
+    std::vector<Mavsdk::ConnectionStatistics> statistics;
+    statistics.reserve(_connections.size());
+
+    for (const auto& connection : _connections) {
+        const auto snapshot = connection->statistics();
+
+        Mavsdk::ConnectionStatistics connection_statistics;
+        connection_statistics.connection = connection->description();
+        connection_statistics.bytes_received = snapshot.bytes_received;
+        connection_statistics.bytes_sent = snapshot.bytes_sent;
+        connection_statistics.frames_received = snapshot.frames_received;
+        connection_statistics.frames_sent = snapshot.frames_sent;
+        connection_statistics.send_errors = snapshot.send_errors;
+        connection_statistics.parse_errors = snapshot.parse_errors;
+        connection_statistics.dropped_sequence_numbers = snapshot.dropped_sequence_numbers;
+        connection_statistics.bytes_received_per_s = snapshot.bytes_received_per_s;
+        connection_statistics.bytes_sent_per_s = snapshot.bytes_sent_per_s;
+        connection_statistics.frames_received_per_s = snapshot.frames_received_per_s;
+        connection_statistics.frames_sent_per_s = snapshot.frames_sent_per_s;
+        statistics.push_back(connection_statistics);
+    }
+
+    return statistics;
+}
+
+std::vector<Mavsdk::Metric> MavsdkImpl::metrics()
+{
+    auto metrics = Metrics::instance().collect();
+
+    const auto statistics = connection_statistics();
+
+    const auto append = [&](const char* name,
+                            const char* help,
+                            auto field,
+                            Mavsdk::Metric::Type type = Mavsdk::Metric::Type::Counter) {
+        for (const auto& connection_statistics : statistics) {
+            Mavsdk::Metric metric;
+            metric.name = name;
+            metric.help = help;
+            metric.type = type;
+            metric.labels = {{"connection", connection_statistics.connection}};
+            metric.value = static_cast<double>(connection_statistics.*field);
+            metrics.push_back(std::move(metric));
+        }
+    };
+
+    append(
+        "mavsdk_link_bytes_received_total",
+        "Bytes received, by connection",
+        &Mavsdk::ConnectionStatistics::bytes_received);
+    append(
+        "mavsdk_link_bytes_sent_total",
+        "Bytes sent, by connection",
+        &Mavsdk::ConnectionStatistics::bytes_sent);
+    append(
+        "mavsdk_link_messages_received_total",
+        "MAVLink messages received, by connection",
+        &Mavsdk::ConnectionStatistics::frames_received);
+    append(
+        "mavsdk_link_messages_sent_total",
+        "MAVLink messages sent, by connection",
+        &Mavsdk::ConnectionStatistics::frames_sent);
+    append(
+        "mavsdk_link_send_errors_total",
+        "MAVLink messages which could not be sent, by connection",
+        &Mavsdk::ConnectionStatistics::send_errors);
+    append(
+        "mavsdk_link_parse_errors_total",
+        "Frames dropped because of bad CRC or framing, by connection",
+        &Mavsdk::ConnectionStatistics::parse_errors);
+    // Goes down again when messages counted as lost arrive late.
+    append(
+        "mavsdk_link_messages_lost",
+        "Messages lost according to sequence numbers, by connection",
+        &Mavsdk::ConnectionStatistics::dropped_sequence_numbers,
+        Mavsdk::Metric::Type::Gauge);
+
+    return metrics;
 }
 
 void MavsdkImpl::set_configuration(Mavsdk::Configuration new_configuration)
@@ -543,6 +915,11 @@ void MavsdkImpl::set_configuration(Mavsdk::Configuration new_configuration)
         stop_sending_heartbeats();
     }
 
+    if (new_configuration.get_metadata_cache_directory() !=
+        _configuration.get_metadata_cache_directory()) {
+        metadata_cache.set_directory(new_configuration.get_metadata_cache_directory());
+    }
+
     _configuration = new_configuration;
 }
 
@@ -657,6 +1034,10 @@ void MavsdkImpl::work_thread()
             }
         }
 
+        if (_raw_frame_batchers_active) {
+            flush_raw_frame_batches_if_due();
+        }
+
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
 }
@@ -684,6 +1065,8 @@ void MavsdkImpl::call_user_callback_located(
         _callback_debugging ? UserCallback{func, filename, linenumber} : UserCallback{func};
 
     _user_callback_queue.enqueue(user_callback);
+    Metrics::instance().user_callback_queue_depth.set(
+        static_cast<int64_t>(_user_callback_queue.size()));
 }
 
 void MavsdkImpl::process_user_callbacks_thread()
@@ -694,6 +1077,11 @@ void MavsdkImpl::process_user_callbacks_thread()
             continue;
         }
 
+        auto& metrics = Metrics::instance();
+        metrics.user_callback_queue_depth.set(static_cast<int64_t>(_user_callback_queue.size()));
+        metrics.user_callback_queue_wait.record(
+            std::chrono::steady_clock::now() - callback.value().enqueued);
+
         void* cookie{nullptr};
 
         const double timeout_s = 1.0;
@@ -703,6 +1091,7 @@ void MavsdkImpl::process_user_callbacks_thread()
                     LogWarn() << "Callback called from " << callback.value().filename << ":"
                               << callback.value().linenumber << " took more than " << timeout_s
                               << " second to run.";
+                    AsyncLogWriter::instance().flush();
                     //fflush(stdout);
                     //fflush(stderr);
                     abort();
@@ -714,7 +1103,10 @@ void MavsdkImpl::process_user_callbacks_thread()
             },
             timeout_s,
             &cookie);
-        callback.value().func();
+        {
+            MetricsTimer timer(metrics.user_callback_execution);
+            callback.value().func();
+        }
         timeout_handler.remove(cookie);
     }
 }
@@ -762,6 +1154,72 @@ void MavsdkImpl::intercept_outgoing_messages(std::function<bool(mavlink_message_
     _intercept_outgoing_messages_callback = callback;
 }
 
+void MavsdkImpl::subscribe_raw_frames(
+    const void* cookie,
+    const MavlinkFrameBatcher::Filter& filter,
+    unsigned max_frames_per_batch,
+    double max_batch_latency_s,
+    MavlinkFrameBatcher::BatchCallback callback)
+{
+    std::lock_guard<std::mutex> lock(_raw_frame_batchers_mutex);
+
+    // Only one subscription per cookie, a new one replaces the previous one.
+    _raw_frame_batchers.erase(
+        std::remove_if(
+            _raw_frame_batchers.begin(),
+            _raw_frame_batchers.end(),
+            [cookie](const auto& entry) { return entry.first == cookie; }),
+        _raw_frame_batchers.end());
+
+    if (callback != nullptr) {
+        _raw_frame_batchers.emplace_back(
+            cookie,
+            std::make_unique<MavlinkFrameBatcher>(
+                filter, max_frames_per_batch, max_batch_latency_s, std::move(callback)));
+    }
+
+    _raw_frame_batchers_active = !_raw_frame_batchers.empty();
+}
+
+void MavsdkImpl::unsubscribe_raw_frames(const void* cookie)
+{
+    subscribe_raw_frames(cookie, {}, 0, 0.0, nullptr);
+}
+
+void MavsdkImpl::batch_raw_frame(const mavlink_message_t& message)
+{
+    const auto now = _time.steady_time();
+    const auto timestamp_us = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            _time.system_time().time_since_epoch())
+            .count());
+
+    // We serialize lazily and at most once, no matter how many subscribers there are.
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    uint16_t buffer_len = 0;
+
+    std::lock_guard<std::mutex> lock(_raw_frame_batchers_mutex);
+    for (auto& entry : _raw_frame_batchers) {
+        if (!entry.second->accepts(message)) {
+            continue;
+        }
+        if (buffer_len == 0) {
+            buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+        }
+        entry.second->add_frame(buffer, buffer_len, timestamp_us, now);
+    }
+}
+
+void MavsdkImpl::flush_raw_frame_batches_if_due()
+{
+    const auto now = _time.steady_time();
+
+    std::lock_guard<std::mutex> lock(_raw_frame_batchers_mutex);
+    for (auto& entry : _raw_frame_batchers) {
+        entry.second->flush_if_due(now);
+    }
+}
+
 uint8_t MavsdkImpl::get_target_system_id(const mavlink_message_t& message)
 {
     // Checks whether connection knows target system ID by extracting target system if set.
@@ -795,7 +1253,7 @@ uint8_t MavsdkImpl::get_target_component_id(const mavlink_message_t& message)
         return 0;
     }
 
-    return (_MAV_PAYLOAD(&message))[meta->target_system_ofs];
+    return (_MAV_PAYLOAD(&message))[meta->target_component_ofs];
 }
 
 } // namespace mavsdk
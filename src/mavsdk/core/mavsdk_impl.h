@@ -1,5 +1,8 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <condition_variable>
 #include <mutex>
 #include <utility>
 #include <vector>
@@ -11,12 +14,17 @@
 #include "mavsdk.h"
 #include "mavlink_include.h"
 #include "mavlink_address.h"
+#include "mavlink_frame_batcher.h"
 #include "mavlink_message_handler.h"
+#include "mavlink_path_monitor.h"
+#include "mavlink_routing_table.h"
 #include "mavlink_command_receiver.h"
+#include "metadata_cache.h"
 #include "safe_queue.h"
 #include "server_component.h"
 #include "system.h"
 #include "timeout_handler.h"
+#include "tlog_recorder.h"
 
 namespace mavsdk {
 
@@ -47,7 +55,7 @@ public:
     static std::string version();
 
     void forward_message(mavlink_message_t& message, Connection* connection);
-    void receive_message(mavlink_message_t& message, Connection* connection);
+    void receive_messages(mavlink_message_t* messages, std::size_t count, Connection* connection);
     bool send_message(mavlink_message_t& message);
 
     ConnectionResult
@@ -60,12 +68,28 @@ public:
         const std::string& dev_path,
         int baudrate,
         bool flow_control,
-        ForwardingOption forwarding_option);
+        ForwardingOption forwarding_option,
+        const Mavsdk::SerialOptions& serial_options = {});
     ConnectionResult setup_udp_remote(
         const std::string& remote_ip, int remote_port, ForwardingOption forwarding_option);
+    ConnectionResult add_tlog_replay_connection(
+        const std::string& path, double speed, ForwardingOption forwarding_option);
 
     std::vector<std::shared_ptr<System>> systems() const;
 
+    std::vector<Mavsdk::ConnectionStatistics> connection_statistics();
+
+    // The shared metrics, followed by those of this instance's connections.
+    std::vector<Mavsdk::Metric> metrics();
+
+    void set_redundant_link_policy(Mavsdk::RedundantLinkPolicy policy);
+
+    std::vector<Mavsdk::LinkQuality> link_quality();
+    void subscribe_link_quality(const Mavsdk::LinkQualityCallback& callback);
+
+    bool enable_signing(const std::string& connection, const Mavsdk::SigningOptions& options);
+    bool disable_signing(const std::string& connection);
+
     void set_configuration(Mavsdk::Configuration new_configuration);
 
     uint8_t get_own_system_id() const;
@@ -83,6 +107,14 @@ public:
     void intercept_incoming_messages(std::function<bool(mavlink_message_t&)> callback);
     void intercept_outgoing_messages(std::function<bool(mavlink_message_t&)> callback);
 
+    void subscribe_raw_frames(
+        const void* cookie,
+        const MavlinkFrameBatcher::Filter& filter,
+        unsigned max_frames_per_batch,
+        double max_batch_latency_s,
+        MavlinkFrameBatcher::BatchCallback callback);
+    void unsubscribe_raw_frames(const void* cookie);
+
     std::shared_ptr<ServerComponent> server_component_by_type(
         Mavsdk::ServerComponentType server_component_type, unsigned instance = 0);
     std::shared_ptr<ServerComponent> server_component_by_id(uint8_t component_id);
@@ -99,23 +131,74 @@ public:
 
     MavlinkMessageHandler mavlink_message_handler{};
     Time time{};
+    // Shared by all systems, so a vehicle reconnecting on another link still hits it.
+    MetadataCache metadata_cache{};
+    // Records everything received and sent while it is started.
+    TlogRecorder tlog_recorder{};
 
 private:
     void add_connection(const std::shared_ptr<Connection>&);
     void make_system_with_component(
         uint8_t system_id, uint8_t component_id, bool always_connected = false);
 
+    // Immutable, replaced as a whole when connections are added, so that the
+    // send and receive paths don't need to lock.
+    struct ConnectionsSnapshot {
+        std::vector<std::shared_ptr<Connection>> connections{};
+        MavlinkRoutingTable::ConnectionMask all{0};
+        MavlinkRoutingTable::ConnectionMask forwarding{0};
+    };
+
+    std::shared_ptr<const ConnectionsSnapshot> connections_snapshot() const;
+    void update_connections_snapshot_locked();
+    static unsigned send_to_connections(
+        const mavlink_message_t& message,
+        const ConnectionsSnapshot& snapshot,
+        MavlinkRoutingTable::ConnectionMask mask);
+
+    // Returns false if the message should not be dispatched.
+    bool prepare_received_message(
+        mavlink_message_t& message,
+        Connection* connection,
+        const ConnectionsSnapshot& snapshot,
+        bool is_new_frame);
+    void add_system_component(const mavlink_message_t& message);
+
     void work_thread();
     void process_user_callbacks_thread();
 
     void send_heartbeat();
+    void evaluate_link_quality();
     bool is_any_system_connected() const;
 
+    void batch_raw_frame(const mavlink_message_t& message);
+    void flush_raw_frame_batches_if_due();
+
     static uint8_t get_target_system_id(const mavlink_message_t& message);
     static uint8_t get_target_component_id(const mavlink_message_t& message);
 
     std::mutex _connections_mutex{};
     std::vector<std::shared_ptr<Connection>> _connections{};
+    // Only to be accessed atomically, see connections_snapshot().
+    std::shared_ptr<const ConnectionsSnapshot> _connections_snapshot{
+        std::make_shared<ConnectionsSnapshot>()};
+    // Receive threads holding a connections snapshot, which the destructor
+    // waits for before dropping the connections.
+    std::mutex _receivers_mutex{};
+    std::condition_variable _receivers_cv{};
+    unsigned _num_receivers{0};
+    MavlinkRoutingTable _routing_table{};
+    MavlinkPathMonitor _path_monitor{};
+    std::atomic<Mavsdk::RedundantLinkPolicy> _redundant_link_policy{
+        Mavsdk::RedundantLinkPolicy::SendOnAllLinks};
+    // Senders are expected to send at least a heartbeat within this time.
+    static constexpr double ROUTE_AGING_INTERVAL_S = 10.0;
+    void* _route_aging_cookie{nullptr};
+
+    std::mutex _link_quality_mutex{};
+    Mavsdk::LinkQualityCallback _link_quality_callback{nullptr};
+    static constexpr double LINK_QUALITY_INTERVAL_S = 1.0;
+    void* _link_quality_cookie{nullptr};
 
     mutable std::recursive_mutex _systems_mutex{};
     std::vector<std::pair<uint8_t, std::shared_ptr<System>>> _systems{};
@@ -142,6 +225,7 @@ private:
         std::function<void()> func{};
         std::string filename{};
         int linenumber{};
+        std::chrono::steady_clock::time_point enqueued{std::chrono::steady_clock::now()};
     };
 
     std::thread* _work_thread{nullptr};
@@ -154,6 +238,12 @@ private:
     std::function<bool(mavlink_message_t&)> _intercept_incoming_messages_callback{nullptr};
     std::function<bool(mavlink_message_t&)> _intercept_outgoing_messages_callback{nullptr};
 
+    std::mutex _raw_frame_batchers_mutex{};
+    std::vector<std::pair<const void*, std::unique_ptr<MavlinkFrameBatcher>>>
+        _raw_frame_batchers{};
+    // Checked on the receive path, so we don't need to lock if no one is subscribed.
+    std::atomic<bool> _raw_frame_batchers_active{false};
+
     std::atomic<double> _timeout_s{Mavsdk::DEFAULT_TIMEOUT_S};
 
     static constexpr double HEARTBEAT_SEND_INTERVAL_S = 1.0;
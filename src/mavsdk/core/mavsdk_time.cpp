@@ -149,8 +149,7 @@ dl_system_time_t AutopilotTime::system_time()
 dl_autopilot_time_t AutopilotTime::now()
 {
     std::lock_guard<std::mutex> lock(_autopilot_system_time_offset_mutex);
-    return dl_autopilot_time_t(std::chrono::duration_cast<std::chrono::microseconds>(
-        system_time().time_since_epoch() + _autopilot_time_offset));
+    return time_in_locked(system_time());
 }
 
 void AutopilotTime::shift_time_by(std::chrono::nanoseconds offset)
@@ -159,11 +158,43 @@ void AutopilotTime::shift_time_by(std::chrono::nanoseconds offset)
     _autopilot_time_offset += offset;
 };
 
+void AutopilotTime::set_clock_model(
+    dl_system_time_t reference, std::chrono::nanoseconds offset, double skew)
+{
+    std::lock_guard<std::mutex> lock(_autopilot_system_time_offset_mutex);
+    _reference = reference;
+    _autopilot_time_offset = offset;
+    _skew = skew;
+}
+
 dl_autopilot_time_t AutopilotTime::time_in(dl_system_time_t local_system_time_point)
 {
     std::lock_guard<std::mutex> lock(_autopilot_system_time_offset_mutex);
-    return dl_autopilot_time_t(std::chrono::duration_cast<std::chrono::microseconds>(
-        local_system_time_point.time_since_epoch() + _autopilot_time_offset));
+    return time_in_locked(local_system_time_point);
 };
 
+dl_system_time_t AutopilotTime::system_time_in(dl_autopilot_time_t autopilot_time_point)
+{
+    std::lock_guard<std::mutex> lock(_autopilot_system_time_offset_mutex);
+
+    // Autopilot time - reference - offset = (1 + skew) * (local time - reference)
+    const auto scaled = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        autopilot_time_point - _reference - _autopilot_time_offset);
+    const auto since_reference = std::chrono::nanoseconds(
+        std::llround(static_cast<double>(scaled.count()) / (1.0 + _skew)));
+
+    return _reference + std::chrono::duration_cast<dl_system_time_t::duration>(since_reference);
+}
+
+dl_autopilot_time_t AutopilotTime::time_in_locked(dl_system_time_t local_system_time_point) const
+{
+    const auto since_reference =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(local_system_time_point - _reference);
+    const auto drift = std::chrono::nanoseconds(
+        std::llround(_skew * static_cast<double>(since_reference.count())));
+
+    return dl_autopilot_time_t(std::chrono::duration_cast<std::chrono::microseconds>(
+        local_system_time_point.time_since_epoch() + _autopilot_time_offset + drift));
+}
+
 } // namespace mavsdk
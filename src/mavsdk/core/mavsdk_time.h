@@ -57,11 +57,19 @@ public:
 
     void shift_time_by(std::chrono::nanoseconds offset);
 
+    // Autopilot time = local time + offset + skew * (local time - reference).
+    void set_clock_model(dl_system_time_t reference, std::chrono::nanoseconds offset, double skew);
+
     dl_autopilot_time_t time_in(dl_system_time_t local_system_time_point);
+    dl_system_time_t system_time_in(dl_autopilot_time_t autopilot_time_point);
 
 private:
+    dl_autopilot_time_t time_in_locked(dl_system_time_t local_system_time_point) const;
+
     mutable std::mutex _autopilot_system_time_offset_mutex{};
     std::chrono::nanoseconds _autopilot_time_offset{};
+    dl_system_time_t _reference{};
+    double _skew{0.0};
 
     virtual dl_system_time_t system_time();
 };
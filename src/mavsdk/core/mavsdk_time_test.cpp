@@ -50,3 +50,21 @@ TEST(Time, ElapsedIncreasing)
     double now = time.elapsed_s();
     ASSERT_GT(now, before);
 }
+
+TEST(AutopilotTime, ConvertsBothWays)
+{
+    AutopilotTime autopilot_time{};
+
+    const dl_system_time_t local(std::chrono::seconds(1'700'000'000));
+    EXPECT_EQ(autopilot_time.time_in(local), local);
+
+    // The autopilot counts since boot, 10 s ago, and runs faster by 50 ppm.
+    const auto offset = std::chrono::seconds(10) - local.time_since_epoch();
+    autopilot_time.set_clock_model(local, offset, 50e-6);
+    EXPECT_EQ(autopilot_time.time_in(local).time_since_epoch(), std::chrono::seconds(10));
+
+    const auto later = local + std::chrono::seconds(100);
+    const auto autopilot_later = autopilot_time.time_in(later);
+    EXPECT_EQ(autopilot_later.time_since_epoch(), std::chrono::microseconds(110'005'000));
+    EXPECT_EQ(autopilot_time.system_time_in(autopilot_later), later);
+}
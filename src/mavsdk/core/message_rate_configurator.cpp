@@ -0,0 +1,367 @@
+#include "log.h"
+#include "message_rate_configurator.h"
+#include <cmath>
+#include <utility>
+
+namespace mavsdk {
+
+MessageRateConfigurator::MessageRateConfigurator(
+    Sender& sender,
+    MavlinkCommandSender& command_sender,
+    MavlinkMessageHandler& message_handler,
+    TimeoutHandler& timeout_handler,
+    TimeoutSCallback timeout_s_callback) :
+    _sender(sender),
+    _command_sender(command_sender),
+    _message_handler(message_handler),
+    _timeout_handler(timeout_handler),
+    _timeout_s_callback(std::move(timeout_s_callback))
+{
+    _message_handler.register_one(
+        MAVLINK_MSG_ID_MESSAGE_INTERVAL,
+        [this](const mavlink_message_t& message) { handle_message_interval(message); },
+        this);
+}
+
+MessageRateConfigurator::~MessageRateConfigurator()
+{
+    _message_handler.unregister_all(this);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& work_item : _work_items) {
+        _timeout_handler.remove(work_item->timeout_cookie);
+    }
+}
+
+void MessageRateConfigurator::set_rates_async(
+    const RateProfile& rate_profile, uint8_t target_component, const ResultCallback& callback)
+{
+    if (rate_profile.empty()) {
+        if (callback) {
+            callback({});
+        }
+        return;
+    }
+
+    auto work_item = std::make_shared<WorkItem>();
+    work_item->target_component = target_component;
+    work_item->callback = callback;
+    for (const auto& rate : rate_profile) {
+        work_item->entries[rate.first].requested_rate_hz = rate.second;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    send_round(work_item);
+
+    if (is_finished(*work_item)) {
+        // Everything failed to send, no point in waiting.
+        const auto results = result_table(*work_item);
+        lock.unlock();
+        if (callback) {
+            callback(results);
+        }
+        return;
+    }
+
+    _timeout_handler.add(
+        [this, weak_work_item = std::weak_ptr<WorkItem>(work_item)]() {
+            handle_timeout(weak_work_item);
+        },
+        _timeout_s_callback(),
+        &work_item->timeout_cookie);
+
+    _work_items.push_back(work_item);
+}
+
+void MessageRateConfigurator::send_round(const std::shared_ptr<WorkItem>& work_item)
+{
+    const std::weak_ptr<WorkItem> weak_work_item = work_item;
+
+    for (auto& entry : work_item->entries) {
+        if (entry.second.done) {
+            continue;
+        }
+
+        const uint16_t message_id = entry.first;
+
+        auto set_interval = set_interval_command(
+            message_id, entry.second.requested_rate_hz, work_item->target_component);
+        set_interval.target_system_id = _sender.get_system_id();
+
+        // The response contains the interval which is actually applied.
+        MavlinkCommandSender::CommandLong request_interval{};
+        request_interval.command = MAV_CMD_REQUEST_MESSAGE;
+        request_interval.target_system_id = _sender.get_system_id();
+        request_interval.target_component_id = work_item->target_component;
+        request_interval.params.maybe_param1 = static_cast<float>(MAVLINK_MSG_ID_MESSAGE_INTERVAL);
+        request_interval.params.maybe_param2 = static_cast<float>(message_id);
+
+        if (!_command_sender.send_command_untracked(
+                set_interval,
+                [this, weak_work_item, message_id](MavlinkCommandSender::Result result, float) {
+                    handle_set_interval_result(weak_work_item, message_id, result);
+                }) ||
+            !_command_sender.send_command_untracked(
+                request_interval,
+                [this, weak_work_item, message_id](MavlinkCommandSender::Result result, float) {
+                    handle_request_interval_result(weak_work_item, message_id, result);
+                })) {
+            LogErr() << "connection send error setting rate of message " << entry.first;
+            entry.second.result.result = Result::ConnectionError;
+            entry.second.done = true;
+        }
+    }
+}
+
+void MessageRateConfigurator::handle_set_interval_result(
+    const std::weak_ptr<WorkItem>& weak_work_item,
+    uint16_t message_id,
+    MavlinkCommandSender::Result command_result)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto work_item = weak_work_item.lock();
+    if (!work_item) {
+        return;
+    }
+
+    auto entry_it = work_item->entries.find(message_id);
+    if (entry_it == work_item->entries.end() || entry_it->second.done) {
+        return;
+    }
+
+    auto& entry = entry_it->second;
+
+    switch (command_result) {
+        case MavlinkCommandSender::Result::Success:
+            entry.accepted = true;
+            if (entry.unverifiable) {
+                entry.result.result = Result::Success;
+                entry.done = true;
+            }
+            break;
+        case MavlinkCommandSender::Result::CommandDenied:
+            entry.result.result = Result::Denied;
+            entry.done = true;
+            break;
+        case MavlinkCommandSender::Result::Unsupported:
+            entry.result.result = Result::Unsupported;
+            entry.done = true;
+            break;
+        case MavlinkCommandSender::Result::ConnectionError:
+            entry.result.result = Result::ConnectionError;
+            entry.done = true;
+            break;
+        default:
+            // Lost on the way, it is sent again in the next round.
+            return;
+    }
+
+    finish_if_done(lock, work_item);
+}
+
+void MessageRateConfigurator::handle_request_interval_result(
+    const std::weak_ptr<WorkItem>& weak_work_item,
+    uint16_t message_id,
+    MavlinkCommandSender::Result command_result)
+{
+    if (command_result != MavlinkCommandSender::Result::CommandDenied &&
+        command_result != MavlinkCommandSender::Result::Unsupported) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto work_item = weak_work_item.lock();
+    if (!work_item) {
+        return;
+    }
+
+    auto entry_it = work_item->entries.find(message_id);
+    if (entry_it == work_item->entries.end() || entry_it->second.done) {
+        return;
+    }
+
+    // No MESSAGE_INTERVAL is coming, so the accepted set command is all we get.
+    auto& entry = entry_it->second;
+    entry.unverifiable = true;
+    if (entry.accepted) {
+        entry.result.result = Result::Success;
+        entry.done = true;
+    }
+
+    finish_if_done(lock, work_item);
+}
+
+void MessageRateConfigurator::handle_message_interval(const mavlink_message_t& message)
+{
+    if (message.sysid != _sender.get_system_id()) {
+        return;
+    }
+
+    mavlink_message_interval_t message_interval;
+    mavlink_msg_message_interval_decode(&message, &message_interval);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (const auto& work_item : _work_items) {
+        if (work_item->target_component != 0 && work_item->target_component != message.compid) {
+            continue;
+        }
+
+        auto entry_it = work_item->entries.find(message_interval.message_id);
+        if (entry_it == work_item->entries.end() || entry_it->second.done) {
+            continue;
+        }
+
+        auto& entry = entry_it->second;
+        entry.result.applied_rate_hz = rate_from_interval(message_interval.interval_us);
+
+        if (rate_matches(entry.requested_rate_hz, message_interval.interval_us)) {
+            entry.result.result = Result::Success;
+            entry.done = true;
+        } else {
+            // The set command might have been lost, so it is sent again
+            // in the next round.
+            entry.result.result = Result::Mismatch;
+        }
+
+        // Copied, as finishing removes it from _work_items.
+        const auto temp_work_item = work_item;
+        finish_if_done(lock, temp_work_item);
+        return;
+    }
+}
+
+void MessageRateConfigurator::handle_timeout(const std::weak_ptr<WorkItem>& weak_work_item)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto work_item = weak_work_item.lock();
+    if (!work_item) {
+        return;
+    }
+
+    // The timeout handler has already removed this timeout.
+    work_item->timeout_cookie = nullptr;
+
+    if (work_item->retries_to_do > 0) {
+        --work_item->retries_to_do;
+        LogWarn() << "Setting message rates again (retries to do: " << work_item->retries_to_do
+                  << ")";
+        send_round(work_item);
+
+        if (!is_finished(*work_item)) {
+            _timeout_handler.add(
+                [this, weak_work_item]() { handle_timeout(weak_work_item); },
+                _timeout_s_callback(),
+                &work_item->timeout_cookie);
+            return;
+        }
+    }
+
+    // Whatever is not done by now is reported as it is.
+    for (auto& entry : work_item->entries) {
+        entry.second.done = true;
+    }
+    finish_if_done(lock, work_item);
+}
+
+void MessageRateConfigurator::finish_if_done(
+    std::unique_lock<std::mutex>& lock, const std::shared_ptr<WorkItem>& work_item)
+{
+    if (!is_finished(*work_item)) {
+        return;
+    }
+
+    _timeout_handler.remove(work_item->timeout_cookie);
+    work_item->timeout_cookie = nullptr;
+
+    for (auto it = _work_items.begin(); it != _work_items.end(); ++it) {
+        if (*it == work_item) {
+            _work_items.erase(it);
+            break;
+        }
+    }
+
+    const auto results = result_table(*work_item);
+    lock.unlock();
+
+    if (work_item->callback) {
+        work_item->callback(results);
+    }
+}
+
+bool MessageRateConfigurator::is_finished(const WorkItem& work_item)
+{
+    for (const auto& entry : work_item.entries) {
+        if (!entry.second.done) {
+            return false;
+        }
+    }
+    return true;
+}
+
+MessageRateConfigurator::ResultTable
+MessageRateConfigurator::result_table(const WorkItem& work_item)
+{
+    ResultTable results;
+    for (const auto& entry : work_item.entries) {
+        results[entry.first] = entry.second.result;
+    }
+    return results;
+}
+
+MavlinkCommandSender::CommandLong MessageRateConfigurator::set_interval_command(
+    uint16_t message_id, double rate_hz, uint8_t target_component)
+{
+    MavlinkCommandSender::CommandLong command{};
+    command.command = MAV_CMD_SET_MESSAGE_INTERVAL;
+    command.target_component_id = target_component;
+    command.params.maybe_param1 = static_cast<float>(message_id);
+
+    // 0 to request the default rate, -1 to stop the stream.
+    if (rate_hz > 0.0) {
+        command.params.maybe_param2 = static_cast<float>(1e6 / rate_hz);
+    } else if (rate_hz < 0.0) {
+        command.params.maybe_param2 = -1.0f;
+    } else {
+        command.params.maybe_param2 = 0.0f;
+    }
+
+    return command;
+}
+
+bool MessageRateConfigurator::rate_matches(double requested_rate_hz, int32_t interval_us)
+{
+    if (requested_rate_hz < 0.0) {
+        return interval_us == -1;
+    }
+
+    if (requested_rate_hz == 0.0) {
+        // Any default rate is fine.
+        return true;
+    }
+
+    if (interval_us <= 0) {
+        return false;
+    }
+
+    // Autopilots round the interval to what their scheduler can do.
+    const double requested_interval_us = 1e6 / requested_rate_hz;
+    return std::abs(static_cast<double>(interval_us) - requested_interval_us) <=
+           0.05 * requested_interval_us;
+}
+
+double MessageRateConfigurator::rate_from_interval(int32_t interval_us)
+{
+    if (interval_us > 0) {
+        return 1e6 / static_cast<double>(interval_us);
+    }
+
+    // Keep -1 for disabled and 0 for not available.
+    return static_cast<double>(interval_us);
+}
+
+} // namespace mavsdk
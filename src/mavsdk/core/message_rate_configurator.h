@@ -0,0 +1,110 @@
+#pragma once
+
+#include "mavlink_command_sender.h"
+#include "mavlink_message_handler.h"
+#include "sender.h"
+#include "timeout_handler.h"
+#include "timeout_s_callback.h"
+#include "mavlink_include.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mavsdk {
+
+// Sets the rates of many messages at once. Instead of waiting for the ack of
+// each MAV_CMD_SET_MESSAGE_INTERVAL in turn, all commands are sent right away
+// and the applied rates are verified using the MESSAGE_INTERVAL responses,
+// which, unlike acks, tell us which message they are about. Acks which deny
+// a command are matched to the messages in the order the commands were sent.
+class MessageRateConfigurator {
+public:
+    MessageRateConfigurator(
+        Sender& sender,
+        MavlinkCommandSender& command_sender,
+        MavlinkMessageHandler& message_handler,
+        TimeoutHandler& timeout_handler,
+        TimeoutSCallback timeout_s_callback);
+    MessageRateConfigurator() = delete;
+    ~MessageRateConfigurator();
+
+    enum class Result {
+        Success,
+        Mismatch,
+        Denied,
+        Unsupported,
+        Timeout,
+        ConnectionError,
+    };
+
+    struct MessageRateResult {
+        Result result{Result::Timeout};
+        // As reported in MESSAGE_INTERVAL, 0 if not available, -1 if disabled.
+        double applied_rate_hz{0.0};
+    };
+
+    // Message ID to rate in Hz, 0 for the default rate and -1 to stop the stream.
+    using RateProfile = std::map<uint16_t, double>;
+    using ResultTable = std::map<uint16_t, MessageRateResult>;
+    using ResultCallback = std::function<void(const ResultTable&)>;
+
+    void set_rates_async(
+        const RateProfile& rate_profile, uint8_t target_component, const ResultCallback& callback);
+
+    // Non-copyable
+    MessageRateConfigurator(const MessageRateConfigurator&) = delete;
+    const MessageRateConfigurator& operator=(const MessageRateConfigurator&) = delete;
+
+private:
+    struct Entry {
+        double requested_rate_hz{0.0};
+        bool done{false};
+        // The set command was accepted, and whether the applied rate can be requested.
+        bool accepted{false};
+        bool unverifiable{false};
+        MessageRateResult result{};
+    };
+
+    struct WorkItem {
+        uint8_t target_component{0};
+        std::map<uint16_t, Entry> entries{};
+        ResultCallback callback{};
+        unsigned retries_to_do{3};
+        void* timeout_cookie{nullptr};
+    };
+
+    void send_round(const std::shared_ptr<WorkItem>& work_item);
+    void handle_set_interval_result(
+        const std::weak_ptr<WorkItem>& weak_work_item,
+        uint16_t message_id,
+        MavlinkCommandSender::Result command_result);
+    void handle_request_interval_result(
+        const std::weak_ptr<WorkItem>& weak_work_item,
+        uint16_t message_id,
+        MavlinkCommandSender::Result command_result);
+    void handle_message_interval(const mavlink_message_t& message);
+    void handle_timeout(const std::weak_ptr<WorkItem>& weak_work_item);
+    void finish_if_done(
+        std::unique_lock<std::mutex>& lock, const std::shared_ptr<WorkItem>& work_item);
+
+    static bool is_finished(const WorkItem& work_item);
+    static ResultTable result_table(const WorkItem& work_item);
+    static MavlinkCommandSender::CommandLong
+    set_interval_command(uint16_t message_id, double rate_hz, uint8_t target_component);
+    static bool rate_matches(double requested_rate_hz, int32_t interval_us);
+    static double rate_from_interval(int32_t interval_us);
+
+    Sender& _sender;
+    MavlinkCommandSender& _command_sender;
+    MavlinkMessageHandler& _message_handler;
+    TimeoutHandler& _timeout_handler;
+    TimeoutSCallback _timeout_s_callback;
+
+    std::mutex _mutex{};
+    std::vector<std::shared_ptr<WorkItem>> _work_items{};
+};
+
+} // namespace mavsdk
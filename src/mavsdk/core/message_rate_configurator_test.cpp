@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <optional>
+#include <vector>
+
+#include "message_rate_configurator.h"
+#include "mocks/sender_mock.h"
+
+using namespace mavsdk;
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+using MockSender = NiceMock<mavsdk::testing::MockSender>;
+
+using Result = MessageRateConfigurator::Result;
+using ResultTable = MessageRateConfigurator::ResultTable;
+
+static constexpr uint8_t own_system_id = 245;
+static constexpr uint8_t own_component_id = MAV_COMP_ID_MISSIONPLANNER;
+static constexpr uint8_t target_system_id = 1;
+static constexpr uint8_t target_component_id = MAV_COMP_ID_AUTOPILOT1;
+
+static constexpr uint16_t attitude_id = MAVLINK_MSG_ID_ATTITUDE;
+static constexpr uint16_t sys_status_id = MAVLINK_MSG_ID_SYS_STATUS;
+
+static constexpr double timeout_s = 0.5;
+
+class MessageRateConfiguratorTest : public ::testing::Test {
+protected:
+    MessageRateConfiguratorTest() :
+        ::testing::Test(),
+        timeout_handler(time),
+        command_sender(
+            mock_sender,
+            message_handler,
+            timeout_handler,
+            []() { return timeout_s; },
+            time,
+            [](const std::function<void()>& func) { func(); }),
+        configurator(
+            mock_sender,
+            command_sender,
+            message_handler,
+            timeout_handler,
+            []() { return timeout_s; })
+    {}
+
+    void SetUp() override
+    {
+        ON_CALL(mock_sender, get_own_system_id()).WillByDefault(Return(own_system_id));
+        ON_CALL(mock_sender, get_own_component_id()).WillByDefault(Return(own_component_id));
+        ON_CALL(mock_sender, get_system_id()).WillByDefault(Return(target_system_id));
+        ON_CALL(mock_sender, autopilot()).WillByDefault(Return(Sender::Autopilot::Px4));
+        ON_CALL(mock_sender, send_message(_))
+            .WillByDefault(Invoke([this](mavlink_message_t& message) {
+                mavlink_command_long_t command_long;
+                mavlink_msg_command_long_decode(&message, &command_long);
+                sent.push_back(command_long);
+                return true;
+            }));
+    }
+
+    void set_rates(const MessageRateConfigurator::RateProfile& rate_profile)
+    {
+        configurator.set_rates_async(
+            rate_profile, target_component_id, [this](const ResultTable& results) {
+                EXPECT_FALSE(maybe_results);
+                maybe_results = results;
+            });
+    }
+
+    void ack(uint16_t command, MAV_RESULT result)
+    {
+        mavlink_message_t message;
+        mavlink_msg_command_ack_pack(
+            target_system_id,
+            target_component_id,
+            &message,
+            command,
+            result,
+            0,
+            0,
+            own_system_id,
+            own_component_id);
+        message_handler.process_message(message);
+    }
+
+    void message_interval(
+        uint16_t message_id, int32_t interval_us, uint8_t system_id = target_system_id)
+    {
+        mavlink_message_t message;
+        mavlink_msg_message_interval_pack(
+            system_id, target_component_id, &message, message_id, interval_us);
+        message_handler.process_message(message);
+    }
+
+    void let_time_out()
+    {
+        time.sleep_for(std::chrono::milliseconds(static_cast<int>(timeout_s * 1000.0) + 10));
+        command_sender.do_work();
+        timeout_handler.run_once();
+    }
+
+    MockSender mock_sender;
+    MavlinkMessageHandler message_handler;
+    FakeTime time;
+    TimeoutHandler timeout_handler;
+    MavlinkCommandSender command_sender;
+    MessageRateConfigurator configurator;
+    std::vector<mavlink_command_long_t> sent{};
+    std::optional<ResultTable> maybe_results{};
+};
+
+TEST_F(MessageRateConfiguratorTest, SendsAllCommandsAtOnce)
+{
+    set_rates({{attitude_id, 50.0}, {sys_status_id, -1.0}});
+
+    ASSERT_EQ(sent.size(), 4);
+    EXPECT_EQ(sent[0].command, MAV_CMD_SET_MESSAGE_INTERVAL);
+    EXPECT_EQ(sent[0].param1, static_cast<float>(sys_status_id));
+    EXPECT_EQ(sent[0].param2, -1.0f);
+    EXPECT_EQ(sent[1].command, MAV_CMD_REQUEST_MESSAGE);
+    EXPECT_EQ(sent[1].param2, static_cast<float>(sys_status_id));
+    EXPECT_EQ(sent[2].command, MAV_CMD_SET_MESSAGE_INTERVAL);
+    EXPECT_EQ(sent[2].param1, static_cast<float>(attitude_id));
+    EXPECT_EQ(sent[2].param2, 20000.0f);
+    EXPECT_EQ(sent[3].command, MAV_CMD_REQUEST_MESSAGE);
+
+    ack(MAV_CMD_SET_MESSAGE_INTERVAL, MAV_RESULT_ACCEPTED);
+    ack(MAV_CMD_REQUEST_MESSAGE, MAV_RESULT_ACCEPTED);
+    message_interval(sys_status_id, -1);
+    EXPECT_FALSE(maybe_results);
+
+    ack(MAV_CMD_SET_MESSAGE_INTERVAL, MAV_RESULT_ACCEPTED);
+    ack(MAV_CMD_REQUEST_MESSAGE, MAV_RESULT_ACCEPTED);
+    message_interval(attitude_id, 20000);
+
+    ASSERT_TRUE(maybe_results);
+    auto& results = maybe_results.value();
+    EXPECT_EQ(results[attitude_id].result, Result::Success);
+    EXPECT_DOUBLE_EQ(results[attitude_id].applied_rate_hz, 50.0);
+    EXPECT_EQ(results[sys_status_id].result, Result::Success);
+    EXPECT_DOUBLE_EQ(results[sys_status_id].applied_rate_hz, -1.0);
+}
+
+TEST_F(MessageRateConfiguratorTest, ReportsDeniedAndUnsupportedRightAway)
+{
+    set_rates({{attitude_id, 50.0}, {sys_status_id, 2.0}});
+
+    // The acks arrive in the order the commands were sent.
+    ack(MAV_CMD_SET_MESSAGE_INTERVAL, MAV_RESULT_UNSUPPORTED);
+    ack(MAV_CMD_SET_MESSAGE_INTERVAL, MAV_RESULT_DENIED);
+
+    ASSERT_TRUE(maybe_results);
+    auto& results = maybe_results.value();
+    EXPECT_EQ(results[sys_status_id].result, Result::Unsupported);
+    EXPECT_EQ(results[attitude_id].result, Result::Denied);
+
+    // The late acks of the other commands don't matter anymore.
+    ack(MAV_CMD_REQUEST_MESSAGE, MAV_RESULT_ACCEPTED);
+    ack(MAV_CMD_REQUEST_MESSAGE, MAV_RESULT_ACCEPTED);
+}
+
+TEST_F(MessageRateConfiguratorTest, TrustsAckWhenRateCantBeRequested)
+{
+    set_rates({{attitude_id, 50.0}});
+
+    ack(MAV_CMD_SET_MESSAGE_INTERVAL, MAV_RESULT_ACCEPTED);
+    EXPECT_FALSE(maybe_results);
+    ack(MAV_CMD_REQUEST_MESSAGE, MAV_RESULT_UNSUPPORTED);
+
+    ASSERT_TRUE(maybe_results);
+    auto& results = maybe_results.value();
+    EXPECT_EQ(results[attitude_id].result, Result::Success);
+    EXPECT_DOUBLE_EQ(results[attitude_id].applied_rate_hz, 0.0);
+}
+
+TEST_F(MessageRateConfiguratorTest, RetriesMismatchAndTimesOut)
+{
+    set_rates({{attitude_id, 50.0}});
+    ASSERT_EQ(sent.size(), 2);
+
+    // Still at the old rate, the set command might have been lost.
+    message_interval(attitude_id, 100000);
+    EXPECT_FALSE(maybe_results);
+
+    let_time_out();
+    EXPECT_EQ(sent.size(), 4);
+    EXPECT_FALSE(maybe_results);
+
+    let_time_out();
+    let_time_out();
+    EXPECT_EQ(sent.size(), 8);
+    EXPECT_FALSE(maybe_results);
+
+    let_time_out();
+    ASSERT_TRUE(maybe_results);
+    auto& results = maybe_results.value();
+    EXPECT_EQ(results[attitude_id].result, Result::Mismatch);
+    EXPECT_DOUBLE_EQ(results[attitude_id].applied_rate_hz, 10.0);
+}
+
+TEST_F(MessageRateConfiguratorTest, IgnoresIntervalsOfOtherSystems)
+{
+    set_rates({{attitude_id, 50.0}});
+
+    ack(MAV_CMD_SET_MESSAGE_INTERVAL, MAV_RESULT_ACCEPTED);
+    ack(MAV_CMD_REQUEST_MESSAGE, MAV_RESULT_ACCEPTED);
+
+    // Another vehicle with the same component ID answers first.
+    message_interval(attitude_id, 20000, target_system_id + 1);
+    EXPECT_FALSE(maybe_results);
+    message_interval(attitude_id, 100000, target_system_id + 1);
+    EXPECT_FALSE(maybe_results);
+
+    message_interval(attitude_id, 20000);
+    ASSERT_TRUE(maybe_results);
+    EXPECT_EQ(maybe_results.value()[attitude_id].result, Result::Success);
+}
@@ -0,0 +1,294 @@
+#if defined(WINDOWS)
+#include "tronkko_dirent.h"
+#include <sys/utime.h>
+#else
+#include <dirent.h>
+#include <utime.h>
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "metadata_cache.h"
+#include "crc32.h"
+#include "fs.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace mavsdk {
+
+static const std::string data_suffix = ".data";
+static const std::string meta_suffix = ".meta";
+
+MetadataCache::MetadataCache() : MetadataCache(directory_from_env(), DEFAULT_MAX_SIZE_BYTES) {}
+
+MetadataCache::MetadataCache(const std::string& directory, uint64_t max_size_bytes) :
+    _max_size_bytes(max_size_bytes)
+{
+    set_directory(directory);
+}
+
+bool MetadataCache::enabled() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return !_directory.empty();
+}
+
+void MetadataCache::set_directory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _directory = directory;
+
+    if (_directory.empty()) {
+        return;
+    }
+
+    // Create the directory and its parent, e.g. ~/.cache/mavsdk. The parent
+    // usually exists already, so failing to create it is fine.
+    const auto parent_end = _directory.rfind(path_separator);
+    if (parent_end != std::string::npos && parent_end > 0) {
+        fs_create_directory(_directory.substr(0, parent_end));
+    }
+    fs_create_directory(_directory);
+
+    if (!fs_exists(_directory)) {
+        LogWarn() << "Could not create metadata cache directory " << _directory
+                  << ", metadata will not be cached";
+        _directory.clear();
+    }
+}
+
+std::string MetadataCache::directory_from_env()
+{
+    if (const char* env_p = std::getenv("MAVSDK_METADATA_CACHE_DIR")) {
+        return env_p;
+    }
+    return {};
+}
+
+std::string MetadataCache::entry_path(const std::string& uri, uint32_t crc) const
+{
+    // A hash collision of two URIs is caught by the URI stored in the meta file.
+    std::stringstream ss;
+    ss << _directory << path_separator << std::hex << std::setfill('0') << std::setw(8)
+       << crc32_of(uri) << '-' << std::setw(8) << crc;
+    return ss.str();
+}
+
+std::optional<std::string> MetadataCache::lookup(const std::string& uri, uint32_t crc)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_directory.empty()) {
+        return {};
+    }
+    std::string content;
+    return lookup_locked(uri, crc, content);
+}
+
+std::optional<std::string>
+MetadataCache::lookup_locked(const std::string& uri, uint32_t crc, std::string& content_out)
+{
+    const auto path = entry_path(uri, crc);
+    const auto data_path = path + data_suffix;
+
+    if (!fs_exists(data_path)) {
+        return {};
+    }
+
+    const auto maybe_meta = read_meta(path + meta_suffix);
+    if (!maybe_meta || maybe_meta->uri != uri || maybe_meta->crc != crc) {
+        LogDebug() << "Metadata cache entry for " << uri << " does not match, ignoring it";
+        return {};
+    }
+
+    if (!read_file(data_path, content_out) || content_out.size() != maybe_meta->content_size ||
+        crc32_of(content_out) != maybe_meta->content_crc) {
+        LogWarn() << "Metadata cache entry for " << uri << " is corrupt, removing it";
+        remove_entry_locked(path);
+        content_out.clear();
+        return {};
+    }
+
+    // The modification time marks when an entry was last used, for the eviction.
+    utime(data_path.c_str(), nullptr);
+
+    return data_path;
+}
+
+bool MetadataCache::load(const std::string& uri, uint32_t crc, std::string& content_out)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_directory.empty()) {
+        return false;
+    }
+    return lookup_locked(uri, crc, content_out).has_value();
+}
+
+std::optional<std::string>
+MetadataCache::store(const std::string& uri, uint32_t crc, const std::string& content)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_directory.empty()) {
+        return {};
+    }
+
+    const auto path = entry_path(uri, crc);
+    const auto data_path = path + data_suffix;
+
+    std::stringstream meta;
+    meta << uri << '\n' << crc << '\n' << crc32_of(content) << '\n' << content.size() << '\n';
+
+    // The meta file is written last, so an interrupted store is never valid.
+    fs_remove(path + meta_suffix);
+    if (!write_file(data_path, content) || !write_file(path + meta_suffix, meta.str())) {
+        LogWarn() << "Could not store " << uri << " in metadata cache";
+        remove_entry_locked(path);
+        return {};
+    }
+
+    evict_locked();
+
+    if (!fs_exists(data_path)) {
+        // Bigger than the whole cache.
+        return {};
+    }
+    return data_path;
+}
+
+std::optional<std::string>
+MetadataCache::store_file(const std::string& uri, uint32_t crc, const std::string& path)
+{
+    std::string content;
+    if (!read_file(path, content)) {
+        LogWarn() << "Could not read " << path << " to store it in metadata cache";
+        return {};
+    }
+    return store(uri, crc, content);
+}
+
+std::optional<uint32_t> MetadataCache::file_crc32(const std::string& path)
+{
+    std::string content;
+    if (!read_file(path, content)) {
+        return {};
+    }
+    return crc32_of(content);
+}
+
+void MetadataCache::remove_entry_locked(const std::string& path)
+{
+    fs_remove(path + meta_suffix);
+    fs_remove(path + data_suffix);
+}
+
+void MetadataCache::evict_locked()
+{
+    struct Entry {
+        std::string path{};
+        uint64_t size{0};
+        time_t last_used{0};
+    };
+
+    std::vector<Entry> entries;
+    uint64_t total_size = 0;
+
+    DIR* dir = opendir(_directory.c_str());
+    if (dir == nullptr) {
+        return;
+    }
+
+    struct dirent* dirent;
+    while ((dirent = readdir(dir)) != nullptr) {
+        const std::string name(dirent->d_name);
+        if (name.size() <= data_suffix.size() ||
+            name.compare(name.size() - data_suffix.size(), data_suffix.size(), data_suffix) !=
+                0) {
+            continue;
+        }
+
+        const auto path =
+            _directory + path_separator + name.substr(0, name.size() - data_suffix.size());
+
+        struct stat stat_buf;
+        if (stat((path + data_suffix).c_str(), &stat_buf) != 0) {
+            continue;
+        }
+
+        Entry entry;
+        entry.path = path;
+        entry.size = static_cast<uint64_t>(stat_buf.st_size) + fs_file_size(path + meta_suffix);
+        entry.last_used = stat_buf.st_mtime;
+        total_size += entry.size;
+        entries.push_back(std::move(entry));
+    }
+    closedir(dir);
+
+    if (total_size <= _max_size_bytes) {
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+        return lhs.last_used < rhs.last_used;
+    });
+
+    for (const auto& entry : entries) {
+        if (total_size <= _max_size_bytes) {
+            break;
+        }
+        LogDebug() << "Evicting " << entry.path << " from metadata cache";
+        remove_entry_locked(entry.path);
+        total_size -= entry.size;
+    }
+}
+
+uint32_t MetadataCache::crc32_of(const std::string& data)
+{
+    Crc32 crc32;
+    crc32.add(reinterpret_cast<const uint8_t*>(data.data()), static_cast<uint32_t>(data.size()));
+    return crc32.get();
+}
+
+bool MetadataCache::read_file(const std::string& path, std::string& content_out)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    content_out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
+
+bool MetadataCache::write_file(const std::string& path, const std::string& content)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file.write(content.data(), static_cast<std::streamsize>(content.size()));
+    return static_cast<bool>(file);
+}
+
+std::optional<MetadataCache::Meta> MetadataCache::read_meta(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        return {};
+    }
+
+    Meta meta;
+    if (!std::getline(file, meta.uri) ||
+        !(file >> meta.crc >> meta.content_crc >> meta.content_size)) {
+        return {};
+    }
+    return meta;
+}
+
+} // namespace mavsdk
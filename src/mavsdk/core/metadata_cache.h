@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace mavsdk {
+
+// On-disk cache for metadata files such as camera definitions and component
+// information, so they don't have to be downloaded again on every connect.
+//
+// Entries are keyed by the URI and the CRC or version that MAVLink supplies
+// alongside it, so a changed file on the vehicle results in a miss. Every entry
+// consists of the data file and a small meta file used to validate it on
+// lookup. Once the cache grows beyond its size limit, the least recently used
+// entries are removed.
+class MetadataCache {
+public:
+    static constexpr uint64_t DEFAULT_MAX_SIZE_BYTES = 50 * 1024 * 1024;
+
+    // Uses the directory set by MAVSDK_METADATA_CACHE_DIR, the cache is
+    // disabled if it is not set. It is usually set from the configuration.
+    MetadataCache();
+    MetadataCache(const std::string& directory, uint64_t max_size_bytes);
+    ~MetadataCache() = default;
+
+    [[nodiscard]] bool enabled() const;
+
+    // An empty directory disables the cache.
+    void set_directory(const std::string& directory);
+
+    // Returns the path of the cached file, or nothing if it is not cached.
+    std::optional<std::string> lookup(const std::string& uri, uint32_t crc);
+
+    bool load(const std::string& uri, uint32_t crc, std::string& content_out);
+
+    // Returns the path of the cached file, or nothing if it could not be stored.
+    std::optional<std::string>
+    store(const std::string& uri, uint32_t crc, const std::string& content);
+    std::optional<std::string>
+    store_file(const std::string& uri, uint32_t crc, const std::string& path);
+
+    // The CRC32 of a file as used in MAVLink, e.g. for component metadata, or
+    // nothing if the file can't be read.
+    static std::optional<uint32_t> file_crc32(const std::string& path);
+
+    // Non-copyable
+    MetadataCache(const MetadataCache&) = delete;
+    const MetadataCache& operator=(const MetadataCache&) = delete;
+
+private:
+    struct Meta {
+        std::string uri{};
+        uint32_t crc{0};
+        uint32_t content_crc{0};
+        uint64_t content_size{0};
+    };
+
+    [[nodiscard]] std::string entry_path(const std::string& uri, uint32_t crc) const;
+    std::optional<std::string>
+    lookup_locked(const std::string& uri, uint32_t crc, std::string& content_out);
+    void remove_entry_locked(const std::string& path);
+    void evict_locked();
+
+    static std::string directory_from_env();
+    static uint32_t crc32_of(const std::string& data);
+    static bool read_file(const std::string& path, std::string& content_out);
+    static bool write_file(const std::string& path, const std::string& content);
+    static std::optional<Meta> read_meta(const std::string& path);
+
+    mutable std::mutex _mutex{};
+    std::string _directory{};
+    uint64_t _max_size_bytes;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,138 @@
+#include "metadata_cache.h"
+#include "fs.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+
+using namespace mavsdk;
+
+static const std::string uri = "http://example.com/camera.xml";
+
+static std::string make_cache_dir()
+{
+    // Temporary directories are not available in all builds.
+    const auto tmp_dir = create_tmp_directory("mavsdk-metadata-cache-test");
+    return tmp_dir.value_or(".") + path_separator + "cache";
+}
+
+static void clear_cache_dir(const std::string& path)
+{
+    // Storing anything into a cache without space evicts all entries.
+    MetadataCache cache(path, 0);
+    cache.store("clear", 0, "");
+    fs_remove(path);
+
+    // And the temporary directory around it, if there is one.
+    fs_remove(path.substr(0, path.rfind(path_separator)));
+}
+
+TEST(MetadataCache, MissThenHit)
+{
+    const auto cache_dir = make_cache_dir();
+    MetadataCache cache(cache_dir, MetadataCache::DEFAULT_MAX_SIZE_BYTES);
+    ASSERT_TRUE(cache.enabled());
+
+    std::string content;
+    EXPECT_FALSE(cache.load(uri, 42, content));
+
+    EXPECT_TRUE(cache.store(uri, 42, "<xml>content</xml>"));
+    EXPECT_TRUE(cache.load(uri, 42, content));
+    EXPECT_EQ(content, "<xml>content</xml>");
+
+    // A different CRC or version is a different entry.
+    EXPECT_FALSE(cache.load(uri, 43, content));
+    EXPECT_FALSE(cache.lookup("http://example.com/other.xml", 42));
+
+    clear_cache_dir(cache_dir);
+}
+
+TEST(MetadataCache, CorruptEntryIsRemoved)
+{
+    const auto cache_dir = make_cache_dir();
+    MetadataCache cache(cache_dir, MetadataCache::DEFAULT_MAX_SIZE_BYTES);
+
+    const auto maybe_path = cache.store(uri, 1, "0123456789");
+    ASSERT_TRUE(maybe_path);
+
+    {
+        std::ofstream file(maybe_path.value(), std::ios::binary | std::ios::trunc);
+        file << "0123456780";
+    }
+
+    std::string content;
+    EXPECT_FALSE(cache.load(uri, 1, content));
+    EXPECT_FALSE(fs_exists(maybe_path.value()));
+
+    clear_cache_dir(cache_dir);
+}
+
+TEST(MetadataCache, EvictsWhenFull)
+{
+    const auto cache_dir = make_cache_dir();
+    MetadataCache cache(cache_dir, 1024);
+
+    const std::string big(800, 'x');
+    EXPECT_TRUE(cache.store(uri, 1, big));
+    EXPECT_TRUE(cache.store(uri, 2, big));
+
+    // Only one of the two fits.
+    EXPECT_NE(bool(cache.lookup(uri, 1)), bool(cache.lookup(uri, 2)));
+
+    // Bigger than the whole cache.
+    EXPECT_FALSE(cache.store(uri, 3, std::string(2048, 'x')));
+
+    clear_cache_dir(cache_dir);
+}
+
+TEST(MetadataCache, Disabled)
+{
+    MetadataCache cache("", MetadataCache::DEFAULT_MAX_SIZE_BYTES);
+    EXPECT_FALSE(cache.enabled());
+    EXPECT_FALSE(cache.store(uri, 1, "content"));
+
+    std::string content;
+    EXPECT_FALSE(cache.load(uri, 1, content));
+}
+
+TEST(MetadataCache, EnabledBySettingDirectory)
+{
+    MetadataCache cache("", MetadataCache::DEFAULT_MAX_SIZE_BYTES);
+    EXPECT_FALSE(cache.enabled());
+
+    const auto cache_dir = make_cache_dir();
+    cache.set_directory(cache_dir);
+    ASSERT_TRUE(cache.enabled());
+    EXPECT_TRUE(cache.store(uri, 1, "content"));
+
+    cache.set_directory("");
+    EXPECT_FALSE(cache.enabled());
+    std::string content;
+    EXPECT_FALSE(cache.load(uri, 1, content));
+
+    clear_cache_dir(cache_dir);
+}
+
+TEST(MetadataCache, LoadsWhatWasStoredFromFile)
+{
+    const auto cache_dir = make_cache_dir();
+    MetadataCache cache(cache_dir, MetadataCache::DEFAULT_MAX_SIZE_BYTES);
+
+    const auto file_path = cache_dir + path_separator + "downloaded.json";
+    {
+        std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+        file << "{\"version\": 1}";
+    }
+
+    const auto maybe_crc = MetadataCache::file_crc32(file_path);
+    ASSERT_TRUE(maybe_crc);
+    EXPECT_FALSE(MetadataCache::file_crc32(file_path + ".missing"));
+
+    EXPECT_TRUE(cache.store_file(uri, maybe_crc.value(), file_path));
+    fs_remove(file_path);
+
+    std::string content;
+    EXPECT_TRUE(cache.load(uri, maybe_crc.value(), content));
+    EXPECT_EQ(content, "{\"version\": 1}");
+
+    clear_cache_dir(cache_dir);
+}
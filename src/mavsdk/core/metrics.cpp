@@ -0,0 +1,423 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+namespace mavsdk {
+
+namespace {
+
+constexpr unsigned counter_map_bits = 10;
+static_assert((1U << counter_map_bits) == MetricsCounterMap::MAX_KEYS, "size mismatch");
+
+Mavsdk::Metric make_metric(
+    const char* name,
+    const char* help,
+    Mavsdk::Metric::Type type,
+    std::vector<std::pair<std::string, std::string>> labels = {})
+{
+    Mavsdk::Metric metric;
+    metric.name = name;
+    metric.help = help;
+    metric.type = type;
+    metric.labels = std::move(labels);
+    return metric;
+}
+
+void append_counter_map(
+    std::vector<Mavsdk::Metric>& metrics,
+    const MetricsCounterMap& counter_map,
+    const char* name,
+    const char* help,
+    const char* label)
+{
+    for (const auto& [key, value] : counter_map.values()) {
+        auto metric =
+            make_metric(name, help, Mavsdk::Metric::Type::Counter, {{label, std::to_string(key)}});
+        metric.value = static_cast<double>(value);
+        metrics.push_back(std::move(metric));
+    }
+
+    if (counter_map.overflow() > 0) {
+        auto metric = make_metric(name, help, Mavsdk::Metric::Type::Counter, {{label, "other"}});
+        metric.value = static_cast<double>(counter_map.overflow());
+        metrics.push_back(std::move(metric));
+    }
+}
+
+void append_histogram(
+    std::vector<Mavsdk::Metric>& metrics,
+    const MetricsHistogram& histogram,
+    const char* name,
+    const char* help)
+{
+    auto metric = make_metric(name, help, Mavsdk::Metric::Type::Histogram);
+    histogram.fill(metric);
+    metrics.push_back(std::move(metric));
+}
+
+void append_protocol_counters(
+    std::vector<Mavsdk::Metric>& metrics,
+    const char* name,
+    const char* help,
+    const std::array<std::pair<const char*, const MetricsCounter*>, 3>& counters)
+{
+    for (const auto& [protocol, counter] : counters) {
+        auto metric =
+            make_metric(name, help, Mavsdk::Metric::Type::Counter, {{"protocol", protocol}});
+        metric.value = static_cast<double>(counter->value());
+        metrics.push_back(std::move(metric));
+    }
+}
+
+void append_value(std::string& out, double value)
+{
+    if (std::isinf(value)) {
+        out += (value > 0) ? "+Inf" : "-Inf";
+        return;
+    }
+    if (std::isnan(value)) {
+        out += "NaN";
+        return;
+    }
+
+    char buffer[32];
+    // Counts are integers, and should look like ones.
+    if (value == std::floor(value) && std::fabs(value) < 9007199254740992.0) {
+        std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value));
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    }
+    out += buffer;
+}
+
+void append_label_value(std::string& out, const std::string& value)
+{
+    for (const char c : value) {
+        switch (c) {
+            case '\\':
+                out += "\\\\";
+                break;
+            case '"':
+                out += "\\\"";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            default:
+                out += c;
+                break;
+        }
+    }
+}
+
+void append_sample(
+    std::string& out,
+    const std::string& name,
+    const char* suffix,
+    const std::vector<std::pair<std::string, std::string>>& labels,
+    const char* le,
+    double value)
+{
+    out += name;
+    out += suffix;
+
+    if (!labels.empty() || le != nullptr) {
+        out += '{';
+        bool first = true;
+        for (const auto& [label, label_value] : labels) {
+            if (!first) {
+                out += ',';
+            }
+            first = false;
+            out += label;
+            out += "=\"";
+            append_label_value(out, label_value);
+            out += '"';
+        }
+        if (le != nullptr) {
+            if (!first) {
+                out += ',';
+            }
+            out += "le=\"";
+            out += le;
+            out += '"';
+        }
+        out += '}';
+    }
+
+    out += ' ';
+    append_value(out, value);
+    out += '\n';
+}
+
+const char* type_name(Mavsdk::Metric::Type type)
+{
+    switch (type) {
+        case Mavsdk::Metric::Type::Counter:
+            return "counter";
+        case Mavsdk::Metric::Type::Gauge:
+            return "gauge";
+        case Mavsdk::Metric::Type::Histogram:
+            return "histogram";
+    }
+    return "untyped";
+}
+
+} // namespace
+
+MetricsCounterMap::MetricsCounterMap() : _entries(new Entry[MAX_KEYS]) {}
+
+void MetricsCounterMap::add(uint32_t key, uint64_t value)
+{
+    const uint32_t stored_key = key + 1;
+
+    // Multiplicative hashing, the upper bits are the well mixed ones.
+    auto index = static_cast<std::size_t>((key * 2654435761U) >> (32 - counter_map_bits));
+
+    for (std::size_t probe = 0; probe < MAX_KEYS; ++probe) {
+        auto& entry = _entries[index];
+        auto current = entry.key.load(std::memory_order_relaxed);
+        if (current == 0 &&
+            entry.key.compare_exchange_strong(current, stored_key, std::memory_order_relaxed)) {
+            current = stored_key;
+        }
+        if (current == stored_key) {
+            entry.value.fetch_add(value, std::memory_order_relaxed);
+            return;
+        }
+        index = (index + 1) & (MAX_KEYS - 1);
+    }
+
+    _overflow.fetch_add(value, std::memory_order_relaxed);
+}
+
+std::vector<std::pair<uint32_t, uint64_t>> MetricsCounterMap::values() const
+{
+    std::vector<std::pair<uint32_t, uint64_t>> result;
+    for (std::size_t i = 0; i < MAX_KEYS; ++i) {
+        const auto key = _entries[i].key.load(std::memory_order_relaxed);
+        if (key != 0) {
+            result.emplace_back(key - 1, _entries[i].value.load(std::memory_order_relaxed));
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+void MetricsHistogram::record(std::chrono::nanoseconds duration)
+{
+    const auto ns = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+    // Divided, so that durations right on a bound end up exactly on it.
+    const double seconds = static_cast<double>(ns) / 1e9;
+
+    std::size_t bucket = 0;
+    while (bucket < BUCKET_BOUNDS_S.size() && seconds > BUCKET_BOUNDS_S[bucket]) {
+        ++bucket;
+    }
+
+    _counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    _sum_ns.fetch_add(ns, std::memory_order_relaxed);
+}
+
+void MetricsHistogram::fill(Mavsdk::Metric& metric) const
+{
+    metric.buckets.clear();
+    metric.buckets.reserve(BUCKET_BOUNDS_S.size());
+
+    uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < BUCKET_BOUNDS_S.size(); ++i) {
+        cumulative += _counts[i].load(std::memory_order_relaxed);
+        metric.buckets.emplace_back(BUCKET_BOUNDS_S[i], cumulative);
+    }
+    cumulative += _counts.back().load(std::memory_order_relaxed);
+
+    metric.count = cumulative;
+    metric.value = static_cast<double>(_sum_ns.load(std::memory_order_relaxed)) * 1e-9;
+}
+
+Metrics& Metrics::instance()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+std::vector<Mavsdk::Metric> Metrics::collect() const
+{
+    std::vector<Mavsdk::Metric> metrics;
+
+    append_counter_map(
+        metrics,
+        messages_received,
+        "mavsdk_messages_received_total",
+        "MAVLink messages received, by message ID",
+        "msgid");
+    append_counter_map(
+        metrics,
+        messages_sent,
+        "mavsdk_messages_sent_total",
+        "MAVLink messages sent, by message ID",
+        "msgid");
+
+    for (const auto& [sender, gaps] : sequence_gaps.values()) {
+        auto metric = make_metric(
+            "mavsdk_sequence_gaps_total",
+            "Messages missing according to sequence numbers, by sender",
+            Mavsdk::Metric::Type::Counter,
+            {{"sysid", std::to_string(sender >> 8)}, {"compid", std::to_string(sender & 0xff)}});
+        metric.value = static_cast<double>(gaps);
+        metrics.push_back(std::move(metric));
+    }
+
+    auto unroutable = make_metric(
+        "mavsdk_messages_unroutable_total",
+        "Messages not forwarded because their target was not seen yet",
+        Mavsdk::Metric::Type::Counter);
+    unroutable.value = static_cast<double>(messages_unroutable.value());
+    metrics.push_back(std::move(unroutable));
+
+    auto queue_depth = make_metric(
+        "mavsdk_user_callback_queue_depth",
+        "User callbacks waiting to be called",
+        Mavsdk::Metric::Type::Gauge);
+    queue_depth.value = static_cast<double>(user_callback_queue_depth.value());
+    metrics.push_back(std::move(queue_depth));
+
+    append_histogram(
+        metrics,
+        user_callback_queue_wait,
+        "mavsdk_user_callback_queue_wait_seconds",
+        "Time user callbacks wait in the queue");
+    append_histogram(
+        metrics,
+        user_callback_execution,
+        "mavsdk_user_callback_execution_seconds",
+        "Time user callbacks take");
+    append_histogram(
+        metrics,
+        message_handler_execution,
+        "mavsdk_message_handler_execution_seconds",
+        "Time the handlers of a received message take");
+
+    append_protocol_counters(
+        metrics,
+        "mavsdk_timeouts_total",
+        "Timeouts waiting for an answer, by protocol",
+        {{{"command", &command_timeouts},
+          {"parameter", &parameter_timeouts},
+          {"mission", &mission_timeouts}}});
+    append_protocol_counters(
+        metrics,
+        "mavsdk_retries_total",
+        "Requests sent again after a timeout, by protocol",
+        {{{"command", &command_retries},
+          {"parameter", &parameter_retries},
+          {"mission", &mission_retries}}});
+
+    append_histogram(
+        metrics,
+        setpoint_interval,
+        "mavsdk_setpoint_interval_seconds",
+        "Time between setpoints sent to an autopilot");
+
+    auto deadlines_missed = make_metric(
+        "mavsdk_setpoint_deadlines_missed_total",
+        "Setpoints sent more than half an interval late",
+        Mavsdk::Metric::Type::Counter);
+    deadlines_missed.value = static_cast<double>(setpoint_deadlines_missed.value());
+    metrics.push_back(std::move(deadlines_missed));
+
+    auto mocap_sent = make_metric(
+        "mavsdk_mocap_samples_sent_total",
+        "Motion capture samples sent in streaming mode",
+        Mavsdk::Metric::Type::Counter);
+    mocap_sent.value = static_cast<double>(mocap_samples_sent.value());
+    metrics.push_back(std::move(mocap_sent));
+
+    auto mocap_overwritten = make_metric(
+        "mavsdk_mocap_samples_overwritten_total",
+        "Motion capture samples replaced by a newer one before they were sent",
+        Mavsdk::Metric::Type::Counter);
+    mocap_overwritten.value = static_cast<double>(mocap_samples_overwritten.value());
+    metrics.push_back(std::move(mocap_overwritten));
+
+    append_histogram(
+        metrics,
+        mocap_latency,
+        "mavsdk_mocap_latency_seconds",
+        "Time from taking a motion capture sample until it is sent");
+
+    return metrics;
+}
+
+std::string Metrics::to_prometheus(const std::vector<Mavsdk::Metric>& metrics)
+{
+    std::string out;
+    out.reserve(metrics.size() * 96);
+
+    const std::string* previous_name = nullptr;
+    for (const auto& metric : metrics) {
+        if (previous_name == nullptr || *previous_name != metric.name) {
+            out += "# HELP ";
+            out += metric.name;
+            out += ' ';
+            out += metric.help;
+            out += "\n# TYPE ";
+            out += metric.name;
+            out += ' ';
+            out += type_name(metric.type);
+            out += '\n';
+            previous_name = &metric.name;
+        }
+
+        if (metric.type != Mavsdk::Metric::Type::Histogram) {
+            append_sample(out, metric.name, "", metric.labels, nullptr, metric.value);
+            continue;
+        }
+
+        char le[32];
+        for (const auto& [bound, count] : metric.buckets) {
+            std::snprintf(le, sizeof(le), "%g", bound);
+            append_sample(
+                out, metric.name, "_bucket", metric.labels, le, static_cast<double>(count));
+        }
+        append_sample(
+            out, metric.name, "_bucket", metric.labels, "+Inf", static_cast<double>(metric.count));
+        append_sample(out, metric.name, "_sum", metric.labels, nullptr, metric.value);
+        append_sample(
+            out, metric.name, "_count", metric.labels, nullptr, static_cast<double>(metric.count));
+    }
+
+    return out;
+}
+
+bool Metrics::write_prometheus(
+    const std::string& path, const std::vector<Mavsdk::Metric>& metrics)
+{
+    const std::string temporary_path = path + ".tmp";
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file << to_prometheus(metrics);
+        if (!file.flush()) {
+            std::remove(temporary_path.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+        // Windows doesn't replace existing files.
+        std::remove(path.c_str());
+        if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+            std::remove(temporary_path.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "mavsdk.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mavsdk {
+
+// Monotonic counter.
+class MetricsCounter {
+public:
+    void add(uint64_t value = 1) { _value.fetch_add(value, std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t value() const { return _value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> _value{0};
+};
+
+// Value which goes up and down, e.g. a queue depth.
+class MetricsGauge {
+public:
+    void set(int64_t value) { _value.store(value, std::memory_order_relaxed); }
+    [[nodiscard]] int64_t value() const { return _value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> _value{0};
+};
+
+// Counters by a key such as the message ID, e.g. to count messages per type.
+//
+// The keys go into a fixed size hash table by atomic compare and exchange, so
+// neither counting nor adding a key locks or allocates. Keys which don't fit
+// anymore are counted together as overflow.
+class MetricsCounterMap {
+public:
+    static constexpr std::size_t MAX_KEYS = 1024;
+
+    MetricsCounterMap();
+    ~MetricsCounterMap() = default;
+
+    // The key needs to be less than 2^32 - 1.
+    void add(uint32_t key, uint64_t value = 1);
+
+    [[nodiscard]] std::vector<std::pair<uint32_t, uint64_t>> values() const;
+    [[nodiscard]] uint64_t overflow() const { return _overflow.load(std::memory_order_relaxed); }
+
+    // Non-copyable
+    MetricsCounterMap(const MetricsCounterMap&) = delete;
+    const MetricsCounterMap& operator=(const MetricsCounterMap&) = delete;
+
+private:
+    struct Entry {
+        // Key + 1, so that 0 means empty.
+        std::atomic<uint32_t> key{0};
+        std::atomic<uint64_t> value{0};
+    };
+
+    std::unique_ptr<Entry[]> _entries;
+    std::atomic<uint64_t> _overflow{0};
+};
+
+// Distribution of durations, with buckets from 1 us to 10 s as in Prometheus.
+class MetricsHistogram {
+public:
+    static constexpr std::array<double, 15> BUCKET_BOUNDS_S = {
+        1e-6, 5e-6, 1e-5, 5e-5, 1e-4, 5e-4, 1e-3, 5e-3, 1e-2, 5e-2, 1e-1, 5e-1, 1.0, 5.0, 10.0};
+
+    void record(std::chrono::nanoseconds duration);
+
+    // Cumulative counts per bucket, the sum in seconds, and the total count.
+    void fill(Mavsdk::Metric& metric) const;
+
+private:
+    // The last one is for everything above the highest bound.
+    std::array<std::atomic<uint64_t>, BUCKET_BOUNDS_S.size() + 1> _counts{};
+    std::atomic<uint64_t> _sum_ns{0};
+};
+
+// Registry of the internal metrics of MAVSDK, shared by all Mavsdk instances.
+//
+// All of them are updated with relaxed atomics only, so they can be used on
+// the hot paths. What belongs to a connection is kept by the connection in
+// its LinkStatistics, and added by MavsdkImpl when the metrics are queried.
+class Metrics {
+public:
+    static Metrics& instance();
+
+    Metrics() = default;
+    ~Metrics() = default;
+
+    // By message ID, counted once per message, not per connection.
+    MetricsCounterMap messages_received{};
+    MetricsCounterMap messages_sent{};
+
+    // By (system ID << 8 | component ID) of the sender.
+    MetricsCounterMap sequence_gaps{};
+
+    // Messages not forwarded because no route to their target is known yet.
+    MetricsCounter messages_unroutable{};
+
+    MetricsGauge user_callback_queue_depth{};
+    MetricsHistogram user_callback_queue_wait{};
+    MetricsHistogram user_callback_execution{};
+    MetricsHistogram message_handler_execution{};
+
+    MetricsCounter command_timeouts{};
+    MetricsCounter command_retries{};
+    MetricsCounter parameter_timeouts{};
+    MetricsCounter parameter_retries{};
+    MetricsCounter mission_timeouts{};
+    MetricsCounter mission_retries{};
+
+    // Of setpoints streamed with MavlinkSetpointStreamer.
+    MetricsHistogram setpoint_interval{};
+    MetricsCounter setpoint_deadlines_missed{};
+
+    // Of motion capture samples in streaming mode, see MocapImpl.
+    MetricsCounter mocap_samples_sent{};
+    MetricsCounter mocap_samples_overwritten{};
+    MetricsHistogram mocap_latency{};
+
+    [[nodiscard]] std::vector<Mavsdk::Metric> collect() const;
+
+    // Prometheus text exposition format, version 0.0.4.
+    static std::string to_prometheus(const std::vector<Mavsdk::Metric>& metrics);
+
+    // Writes to a temporary file which is then renamed, so that readers such as
+    // the node_exporter textfile collector never see a partial file.
+    static bool
+    write_prometheus(const std::string& path, const std::vector<Mavsdk::Metric>& metrics);
+
+    // Non-copyable
+    Metrics(const Metrics&) = delete;
+    const Metrics& operator=(const Metrics&) = delete;
+};
+
+// Measures the time until it goes out of scope.
+class MetricsTimer {
+public:
+    explicit MetricsTimer(MetricsHistogram& histogram) :
+        _histogram(histogram),
+        _start(std::chrono::steady_clock::now())
+    {}
+
+    ~MetricsTimer() { _histogram.record(std::chrono::steady_clock::now() - _start); }
+
+    // Non-copyable
+    MetricsTimer(const MetricsTimer&) = delete;
+    const MetricsTimer& operator=(const MetricsTimer&) = delete;
+
+private:
+    MetricsHistogram& _histogram;
+    const std::chrono::steady_clock::time_point _start;
+};
+
+} // namespace mavsdk
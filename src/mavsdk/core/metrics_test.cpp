@@ -0,0 +1,145 @@
+#include "metrics.h"
+#include "fs.h"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+TEST(Metrics, CounterMapCountsPerKey)
+{
+    MetricsCounterMap counter_map;
+    counter_map.add(0);
+    counter_map.add(33, 2);
+    counter_map.add(0);
+    counter_map.add(12900);
+
+    const auto values = counter_map.values();
+    ASSERT_EQ(values.size(), 3);
+    EXPECT_EQ(values[0], std::make_pair(uint32_t(0), uint64_t(2)));
+    EXPECT_EQ(values[1], std::make_pair(uint32_t(33), uint64_t(2)));
+    EXPECT_EQ(values[2], std::make_pair(uint32_t(12900), uint64_t(1)));
+    EXPECT_EQ(counter_map.overflow(), 0);
+}
+
+TEST(Metrics, CounterMapFromSeveralThreads)
+{
+    MetricsCounterMap counter_map;
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < 4; ++i) {
+        threads.emplace_back([&counter_map]() {
+            for (uint32_t j = 0; j < 10000; ++j) {
+                counter_map.add(j % 100);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const auto values = counter_map.values();
+    ASSERT_EQ(values.size(), 100);
+    for (const auto& [key, value] : values) {
+        EXPECT_EQ(value, 400) << "key " << key;
+    }
+}
+
+TEST(Metrics, CounterMapOverflow)
+{
+    MetricsCounterMap counter_map;
+    for (uint32_t key = 0; key < MetricsCounterMap::MAX_KEYS + 10; ++key) {
+        counter_map.add(key);
+    }
+
+    EXPECT_EQ(counter_map.values().size(), MetricsCounterMap::MAX_KEYS);
+    EXPECT_EQ(counter_map.overflow(), 10);
+}
+
+TEST(Metrics, HistogramBuckets)
+{
+    MetricsHistogram histogram;
+    histogram.record(std::chrono::microseconds(1));
+    histogram.record(std::chrono::microseconds(300));
+    histogram.record(std::chrono::milliseconds(2));
+    histogram.record(std::chrono::seconds(20));
+
+    Mavsdk::Metric metric;
+    histogram.fill(metric);
+
+    ASSERT_EQ(metric.buckets.size(), MetricsHistogram::BUCKET_BOUNDS_S.size());
+    // Up to 1 us
+    EXPECT_EQ(metric.buckets[0].second, 1);
+    // Up to 500 us
+    EXPECT_DOUBLE_EQ(metric.buckets[5].first, 5e-4);
+    EXPECT_EQ(metric.buckets[5].second, 2);
+    // Up to 5 ms
+    EXPECT_EQ(metric.buckets[7].second, 3);
+    // Up to 10 s
+    EXPECT_EQ(metric.buckets.back().second, 3);
+    EXPECT_EQ(metric.count, 4);
+    EXPECT_NEAR(metric.value, 20.002301, 1e-9);
+}
+
+TEST(Metrics, PrometheusFormat)
+{
+    std::vector<Mavsdk::Metric> metrics(3);
+    metrics[0].name = "mavsdk_messages_received_total";
+    metrics[0].help = "Messages";
+    metrics[0].labels = {{"msgid", "0"}};
+    metrics[0].value = 12;
+    metrics[1] = metrics[0];
+    metrics[1].labels = {{"msgid", "33"}};
+    metrics[1].value = 3;
+    metrics[2].name = "mavsdk_wait_seconds";
+    metrics[2].help = "Wait";
+    metrics[2].type = Mavsdk::Metric::Type::Histogram;
+    metrics[2].labels = {{"connection", "udp://\"x\""}};
+    metrics[2].buckets = {{1e-3, 1}, {1.0, 2}};
+    metrics[2].count = 3;
+    metrics[2].value = 2.5;
+
+    EXPECT_EQ(
+        Metrics::to_prometheus(metrics),
+        "# HELP mavsdk_messages_received_total Messages\n"
+        "# TYPE mavsdk_messages_received_total counter\n"
+        "mavsdk_messages_received_total{msgid=\"0\"} 12\n"
+        "mavsdk_messages_received_total{msgid=\"33\"} 3\n"
+        "# HELP mavsdk_wait_seconds Wait\n"
+        "# TYPE mavsdk_wait_seconds histogram\n"
+        "mavsdk_wait_seconds_bucket{connection=\"udp://\\\"x\\\"\",le=\"0.001\"} 1\n"
+        "mavsdk_wait_seconds_bucket{connection=\"udp://\\\"x\\\"\",le=\"1\"} 2\n"
+        "mavsdk_wait_seconds_bucket{connection=\"udp://\\\"x\\\"\",le=\"+Inf\"} 3\n"
+        "mavsdk_wait_seconds_sum{connection=\"udp://\\\"x\\\"\"} 2.5\n"
+        "mavsdk_wait_seconds_count{connection=\"udp://\\\"x\\\"\"} 3\n");
+}
+
+TEST(Metrics, CollectAndWrite)
+{
+    Metrics metrics;
+    metrics.messages_sent.add(76);
+    metrics.sequence_gaps.add((1 << 8) | 190, 4);
+    metrics.mission_timeouts.add();
+
+    const auto collected = metrics.collect();
+    const auto text = Metrics::to_prometheus(collected);
+    EXPECT_NE(text.find("mavsdk_messages_sent_total{msgid=\"76\"} 1\n"), std::string::npos);
+    EXPECT_NE(
+        text.find("mavsdk_sequence_gaps_total{sysid=\"1\",compid=\"190\"} 4\n"),
+        std::string::npos);
+    EXPECT_NE(text.find("mavsdk_timeouts_total{protocol=\"mission\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE mavsdk_user_callback_queue_depth gauge\n"), std::string::npos);
+
+    const auto tmp_dir = create_tmp_directory("mavsdk-metrics-test");
+    const std::string path = tmp_dir.value_or(".") + path_separator + "metrics.prom";
+    ASSERT_TRUE(Metrics::write_prometheus(path, collected));
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    EXPECT_EQ(content.str(), text);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace mavsdk {
+
+// Bounded queue for any number of producer threads and one consumer thread.
+//
+// Every slot carries a sequence number which tells whether it is free to be
+// written or ready to be read, so producers only contend on claiming a slot
+// and never lock. All storage is allocated up front. When the queue is full,
+// new items are rejected, the consumer is expected to drain it often enough.
+template<typename T> class MpscRing {
+public:
+    // The capacity is rounded up to the next power of two.
+    explicit MpscRing(std::size_t capacity) :
+        _capacity(round_up_to_power_of_two(capacity)),
+        _cells(new Cell[_capacity])
+    {
+        for (std::size_t i = 0; i < _capacity; ++i) {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    ~MpscRing() = default;
+
+    // Producer side, safe to call from several threads, returns false if the queue is full.
+    bool push(const T& value)
+    {
+        return push_with([&value](T& slot_value) { slot_value = value; });
+    }
+
+    // Like push, but the item is filled in place, which lets it reuse what the
+    // slot has allocated already.
+    template<typename Fill> bool push_with(Fill&& fill)
+    {
+        auto head = _head.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        while (true) {
+            cell = &_cells[head & (_capacity - 1)];
+            const auto sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff =
+                static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(head);
+            if (diff == 0) {
+                // The slot is free, try to claim it.
+                if (_head.compare_exchange_weak(head, head + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // The slot has not been read yet since the last round.
+                return false;
+            } else {
+                // Another producer claimed it first.
+                head = _head.load(std::memory_order_relaxed);
+            }
+        }
+
+        fill(cell->value);
+        cell->sequence.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, copies up to max_count items and returns how many.
+    std::size_t pop(T* values, std::size_t max_count)
+    {
+        std::size_t count = 0;
+        while (count < max_count) {
+            auto& cell = _cells[_tail & (_capacity - 1)];
+            if (cell.sequence.load(std::memory_order_acquire) != _tail + 1) {
+                // Empty, or the producer of the next slot is not done yet.
+                break;
+            }
+            values[count++] = cell.value;
+            cell.sequence.store(_tail + _capacity, std::memory_order_release);
+            ++_tail;
+        }
+        return count;
+    }
+
+    // Consumer side, whether the next item can be popped.
+    [[nodiscard]] bool ready() const
+    {
+        return _cells[_tail & (_capacity - 1)].sequence.load(std::memory_order_acquire) ==
+               _tail + 1;
+    }
+
+    [[nodiscard]] std::size_t capacity() const { return _capacity; }
+
+    // Non-copyable
+    MpscRing(const MpscRing&) = delete;
+    const MpscRing& operator=(const MpscRing&) = delete;
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence{0};
+        T value{};
+    };
+
+    static std::size_t round_up_to_power_of_two(std::size_t value)
+    {
+        std::size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const std::size_t _capacity;
+    std::unique_ptr<Cell[]> _cells;
+    // Ever increasing, the index into the cells is masked. The tail is only
+    // touched by the consumer.
+    alignas(64) std::atomic<std::size_t> _head{0};
+    alignas(64) std::size_t _tail{0};
+};
+
+} // namespace mavsdk
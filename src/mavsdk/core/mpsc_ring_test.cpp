@@ -0,0 +1,80 @@
+#include "mpsc_ring.h"
+#include <gtest/gtest.h>
+
+#include <array>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+TEST(MpscRing, PushAndPop)
+{
+    MpscRing<int> ring(3);
+    EXPECT_EQ(ring.capacity(), 4);
+    EXPECT_FALSE(ring.ready());
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.push(i));
+    }
+    // Full
+    EXPECT_FALSE(ring.push(4));
+    EXPECT_TRUE(ring.ready());
+
+    std::array<int, 3> values{};
+    EXPECT_EQ(ring.pop(values.data(), values.size()), 3);
+    EXPECT_EQ(values[0], 0);
+    EXPECT_EQ(values[2], 2);
+
+    // Wraps around
+    EXPECT_TRUE(ring.push(5));
+    EXPECT_TRUE(ring.push(6));
+    EXPECT_EQ(ring.pop(values.data(), values.size()), 3);
+    EXPECT_EQ(values[0], 3);
+    EXPECT_EQ(values[1], 5);
+    EXPECT_EQ(values[2], 6);
+    EXPECT_FALSE(ring.ready());
+    EXPECT_EQ(ring.pop(values.data(), values.size()), 0);
+}
+
+TEST(MpscRing, KeepsOrderPerProducer)
+{
+    MpscRing<unsigned> ring(64);
+    constexpr unsigned num_producers = 3;
+    constexpr unsigned num_values = 5000;
+
+    // The producer is encoded in the upper bits of each value.
+    std::vector<std::thread> producers;
+    for (unsigned producer = 0; producer < num_producers; ++producer) {
+        producers.emplace_back([&ring, producer]() {
+            for (unsigned i = 0; i < num_values; ++i) {
+                while (!ring.push((producer << 16) | i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::array<unsigned, num_producers> expected{};
+    unsigned num_received = 0;
+    bool in_order = true;
+    std::array<unsigned, 16> values{};
+    while (num_received < num_producers * num_values) {
+        const auto count = ring.pop(values.data(), values.size());
+        if (count == 0) {
+            std::this_thread::yield();
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto producer = values[i] >> 16;
+            in_order = in_order && (producer < num_producers) &&
+                       ((values[i] & 0xffff) == expected[producer]);
+            ++expected[producer % num_producers];
+            ++num_received;
+        }
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    EXPECT_TRUE(in_order);
+    EXPECT_EQ(ring.pop(values.data(), values.size()), 0);
+}
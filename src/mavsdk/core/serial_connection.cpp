@@ -6,10 +6,17 @@
 #include <fcntl.h>
 #include <termios.h>
 #include <poll.h>
+#endif
 
-#include <utility>
+#if defined(LINUX)
+#include <sys/ioctl.h>
+#include <linux/serial.h>
 #endif
 
+#include <algorithm>
+#include <string>
+#include <utility>
+
 namespace mavsdk {
 
 #ifndef WINDOWS
@@ -50,11 +57,13 @@ SerialConnection::SerialConnection(
     std::string path,
     int baudrate,
     bool flow_control,
-    ForwardingOption forwarding_option) :
+    ForwardingOption forwarding_option,
+    const Mavsdk::SerialOptions& serial_options) :
     Connection(std::move(receiver_callback), forwarding_option),
     _serial_node(std::move(path)),
     _baudrate(baudrate),
-    _flow_control(flow_control)
+    _flow_control(flow_control),
+    _serial_options(serial_options)
 {}
 
 SerialConnection::~SerialConnection()
@@ -76,6 +85,10 @@ ConnectionResult SerialConnection::start()
 
     start_recv_thread();
 
+    if (_serial_options.coalesce_writes) {
+        start_write_thread();
+    }
+
     return ConnectionResult::Success;
 }
 
@@ -131,8 +144,9 @@ ConnectionResult SerialConnection::setup_port()
     tc.c_cflag &= ~(CSIZE | PARENB | CRTSCTS);
     tc.c_cflag |= CS8;
 
-    tc.c_cc[VMIN] = 0; // We are ok with 0 bytes.
-    tc.c_cc[VTIME] = 10; // Timeout after 1 second.
+    // VMIN and VTIME are single bytes.
+    tc.c_cc[VMIN] = static_cast<cc_t>(std::min(_serial_options.read_min_bytes, 255u));
+    tc.c_cc[VTIME] = static_cast<cc_t>(std::min(_serial_options.read_timeout_ds, 255u));
 
     if (_flow_control) {
         tc.c_cflag |= CRTSCTS;
@@ -171,6 +185,22 @@ ConnectionResult SerialConnection::setup_port()
     }
 #endif
 
+#if defined(LINUX)
+    if (_serial_options.low_latency) {
+        // Without this, USB serial adapters such as FTDI hold back received
+        // data for up to 16 ms. Not all drivers support it, which is fine.
+        struct serial_struct serial_info {};
+        if (ioctl(_fd, TIOCGSERIAL, &serial_info) == 0) {
+            serial_info.flags |= ASYNC_LOW_LATENCY;
+            if (ioctl(_fd, TIOCSSERIAL, &serial_info) != 0) {
+                LogDebug() << "Could not set serial port to low latency: " << GET_ERROR();
+            }
+        } else {
+            LogDebug() << "Could not get serial port info: " << GET_ERROR();
+        }
+    }
+#endif
+
 #if defined(WINDOWS)
     DCB dcb;
     SecureZeroMemory(&dcb, sizeof(DCB));
@@ -227,6 +257,15 @@ void SerialConnection::start_recv_thread()
     _recv_thread = std::make_unique<std::thread>(&SerialConnection::receive, this);
 }
 
+void SerialConnection::start_write_thread()
+{
+    {
+        std::lock_guard<std::mutex> lock(_write_mutex);
+        _should_exit_write = false;
+    }
+    _write_thread = std::make_unique<std::thread>(&SerialConnection::write_queued, this);
+}
+
 ConnectionResult SerialConnection::stop()
 {
     _should_exit = true;
@@ -236,6 +275,16 @@ ConnectionResult SerialConnection::stop()
         _recv_thread.reset();
     }
 
+    if (_write_thread) {
+        {
+            std::lock_guard<std::mutex> lock(_write_mutex);
+            _should_exit_write = true;
+        }
+        _write_cv.notify_one();
+        _write_thread->join();
+        _write_thread.reset();
+    }
+
 #if defined(LINUX) || defined(APPLE)
     close(_fd);
 #elif defined(WINDOWS)
@@ -262,30 +311,114 @@ bool SerialConnection::send_message(const mavlink_message_t& message)
     }
 
     uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
-    uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+    uint16_t buffer_len = serialize_message(buffer, message);
+
+    if (!_serial_options.coalesce_writes) {
+        // Messages are sent from several threads, and partial writes must not interleave.
+        std::lock_guard<std::mutex> lock(_write_mutex);
+        if (!write_to_port(buffer, buffer_len)) {
+            _statistics.add_send_errors(1);
+            return false;
+        }
+        _statistics.add_sent_frame(buffer_len);
+        return true;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_write_mutex);
+        // If the port can't keep up, we rather drop frames than let the
+        // latency grow without bounds.
+        if (_write_queue.size() + buffer_len > MAX_WRITE_QUEUE_BYTES) {
+            _statistics.add_send_errors(1);
+            ++_drops_since_warning;
+
+            // Warning about every frame would only add to the congestion.
+            const auto now = std::chrono::steady_clock::now();
+            if (now - _last_drop_warning >= std::chrono::seconds(1)) {
+                const unsigned drops = _drops_since_warning;
+                _drops_since_warning = 0;
+                _last_drop_warning = now;
+                lock.unlock();
+                LogWarn() << "Serial write queue full, dropped " << drops << " messages";
+            }
+            return false;
+        }
+        _write_queue.insert(_write_queue.end(), buffer, buffer + buffer_len);
+        ++_write_queue_frames;
+    }
+    _write_cv.notify_one();
 
-    int send_len;
+    // Counted as sent once it is actually written.
+    return true;
+}
+
+std::string SerialConnection::description() const
+{
+    return "serial://" + _serial_node + ":" + std::to_string(_baudrate);
+}
+
+bool SerialConnection::write_to_port(const uint8_t* data, std::size_t len)
+{
+    // A write can be partial if the driver's buffer is full.
+    while (len > 0) {
+        int send_len;
 #if defined(LINUX) || defined(APPLE)
-    send_len = static_cast<int>(write(_fd, buffer, buffer_len));
+        send_len = static_cast<int>(write(_fd, data, len));
 #else
-    if (!WriteFile(_handle, buffer, buffer_len, LPDWORD(&send_len), NULL)) {
-        LogErr() << "WriteFile failure: " << GET_ERROR();
-        return false;
-    }
+        if (!WriteFile(_handle, data, static_cast<DWORD>(len), LPDWORD(&send_len), NULL)) {
+            LogErr() << "WriteFile failure: " << GET_ERROR();
+            return false;
+        }
 #endif
 
-    if (send_len != buffer_len) {
-        LogErr() << "write failure: " << GET_ERROR();
-        return false;
+        if (send_len <= 0) {
+            LogErr() << "write failure: " << GET_ERROR();
+            return false;
+        }
+
+        data += send_len;
+        len -= static_cast<std::size_t>(send_len);
     }
 
     return true;
 }
 
+void SerialConnection::write_queued()
+{
+    // Everything that got queued while the previous write was ongoing is
+    // written at once, so a burst of messages only costs one syscall.
+    std::vector<uint8_t> writing;
+
+    std::unique_lock<std::mutex> lock(_write_mutex);
+    while (true) {
+        _write_cv.wait(lock, [this] { return _should_exit_write || !_write_queue.empty(); });
+
+        if (_should_exit_write) {
+            break;
+        }
+
+        writing.swap(_write_queue);
+        const unsigned writing_frames = _write_queue_frames;
+        _write_queue_frames = 0;
+        lock.unlock();
+
+        // The frames are gone either way, a failure is only counted and logged.
+        if (write_to_port(writing.data(), writing.size())) {
+            _statistics.add_sent_frames(writing_frames, writing.size());
+        } else {
+            _statistics.add_send_errors(writing_frames);
+        }
+        writing.clear();
+
+        lock.lock();
+    }
+}
+
 void SerialConnection::receive()
 {
-    // Enough for MTU 1500 bytes.
-    char buffer[2048];
+    // Large enough to take everything the driver has buffered in one read,
+    // even at high baudrates.
+    std::vector<char> buffer(16 * 1024);
 
 #if defined(LINUX) || defined(APPLE)
     struct pollfd fds[1];
@@ -303,24 +436,25 @@ void SerialConnection::receive()
             LogErr() << "read poll failure: " << GET_ERROR();
         }
         // We enter here if (fds[0].revents & POLLIN) == true
-        recv_len = static_cast<int>(read(_fd, buffer, sizeof(buffer)));
+        recv_len = static_cast<int>(read(_fd, buffer.data(), buffer.size()));
         if (recv_len < -1) {
             LogErr() << "read failure: " << GET_ERROR();
         }
 #else
-        if (!ReadFile(_handle, buffer, sizeof(buffer), LPDWORD(&recv_len), NULL)) {
+        if (!ReadFile(
+                _handle,
+                buffer.data(),
+                static_cast<DWORD>(buffer.size()),
+                LPDWORD(&recv_len),
+                NULL)) {
             LogErr() << "ReadFile failure: " << GET_ERROR();
             continue;
         }
 #endif
-        if (recv_len > static_cast<int>(sizeof(buffer)) || recv_len == 0) {
+        if (recv_len > static_cast<int>(buffer.size()) || recv_len <= 0) {
             continue;
         }
-        _mavlink_receiver->set_new_datagram(buffer, recv_len);
-        // Parse all mavlink messages in one data packet. Once exhausted, we'll exit while.
-        while (_mavlink_receiver->parse_message()) {
-            receive_message(_mavlink_receiver->get_last_message(), this);
-        }
+        receive_datagram(buffer.data(), static_cast<unsigned>(recv_len));
     }
 }
 
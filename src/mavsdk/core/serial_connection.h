@@ -3,7 +3,11 @@
 #include <mutex>
 #include <memory>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <thread>
+#include <vector>
 #include "connection.h"
 
 #if defined(WINDOWS)
@@ -19,13 +23,16 @@ public:
         std::string path,
         int baudrate,
         bool flow_control,
-        ForwardingOption forwarding_option = ForwardingOption::ForwardingOff);
+        ForwardingOption forwarding_option = ForwardingOption::ForwardingOff,
+        const Mavsdk::SerialOptions& serial_options = {});
     ConnectionResult start() override;
     ConnectionResult stop() override;
     ~SerialConnection() override;
 
     bool send_message(const mavlink_message_t& message) override;
 
+    std::string description() const override;
+
     // Non-copyable
     SerialConnection(const SerialConnection&) = delete;
     const SerialConnection& operator=(const SerialConnection&) = delete;
@@ -35,6 +42,10 @@ private:
     void start_recv_thread();
     void receive();
 
+    bool write_to_port(const uint8_t* data, std::size_t len);
+    void start_write_thread();
+    void write_queued();
+
 #if defined(LINUX)
     static int define_from_baudrate(int baudrate);
 #endif
@@ -42,6 +53,7 @@ private:
     const std::string _serial_node;
     const int _baudrate;
     const bool _flow_control;
+    const Mavsdk::SerialOptions _serial_options;
 
     std::mutex _mutex = {};
 #if !defined(WINDOWS)
@@ -52,6 +64,18 @@ private:
 
     std::unique_ptr<std::thread> _recv_thread{};
     std::atomic_bool _should_exit{false};
+
+    // Frames waiting to be written by the write thread if writes are coalesced.
+    static constexpr std::size_t MAX_WRITE_QUEUE_BYTES = 64 * 1024;
+    std::mutex _write_mutex{};
+    std::condition_variable _write_cv{};
+    std::vector<uint8_t> _write_queue{};
+    unsigned _write_queue_frames{0};
+    // Drops are warned about at most once per second, with their count.
+    unsigned _drops_since_warning{0};
+    std::chrono::steady_clock::time_point _last_drop_warning{};
+    bool _should_exit_write{false};
+    std::unique_ptr<std::thread> _write_thread{};
 };
 
 } // namespace mavsdk
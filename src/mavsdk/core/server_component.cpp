@@ -7,4 +7,9 @@ ServerComponent::ServerComponent(MavsdkImpl& mavsdk_impl, uint8_t component_id)
     _impl(std::make_unique<ServerComponentImpl>(mavsdk_impl, component_id))
 {}
 
+void ServerComponent::set_stream_bandwidth_budget(double bytes_per_second)
+{
+    _impl->stream_scheduler().set_bandwidth_budget(bytes_per_second);
+}
+
 } // namespace mavsdk
@@ -19,8 +19,12 @@ ServerComponentImpl::ServerComponentImpl(MavsdkImpl& mavsdk_impl, uint8_t compon
         mavsdk_impl.mavlink_message_handler,
         mavsdk_impl.timeout_handler,
         [this]() { return _mavsdk_impl.timeout_s(); }),
-    _mavlink_request_message_handler(mavsdk_impl, *this, _mavlink_command_receiver)
-{}
+    _mavlink_request_message_handler(mavsdk_impl, *this, _mavlink_command_receiver),
+    _stream_scheduler(mavsdk_impl.time)
+{
+    _stream_scheduler.start(
+        [this](mavlink_message_t& message) { return _mavsdk_impl.send_message(message); });
+}
 
 void ServerComponentImpl::register_plugin(ServerPluginImplBase* server_plugin_impl)
 {
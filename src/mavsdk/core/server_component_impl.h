@@ -5,6 +5,7 @@
 #include "mavlink_mission_transfer.h"
 #include "mavlink_parameter_receiver.h"
 #include "mavlink_request_message_handler.h"
+#include "mavlink_stream_scheduler.h"
 #include "mavsdk_time.h"
 #include "flight_mode.h"
 #include "log.h"
@@ -134,6 +135,7 @@ public:
     {
         return _mavlink_request_message_handler;
     }
+    MavlinkStreamScheduler& stream_scheduler() { return _stream_scheduler; }
 
     void do_work();
 
@@ -153,6 +155,8 @@ private:
     MavlinkMissionTransfer _mission_transfer;
     MavlinkParameterReceiver _mavlink_parameter_receiver;
     MavlinkRequestMessageHandler _mavlink_request_message_handler;
+    // Last, so that it stops sending before anything else is torn down.
+    MavlinkStreamScheduler _stream_scheduler;
 };
 
 } // namespace mavsdk
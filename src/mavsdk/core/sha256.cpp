@@ -0,0 +1,311 @@
+#include "sha256.h"
+
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define MAVSDK_SHA256_SHANI
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+#define MAVSDK_SHA256_ARMV8
+#include <arm_neon.h>
+#endif
+
+namespace mavsdk {
+
+namespace {
+
+alignas(16) constexpr uint32_t round_constants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+constexpr std::array<uint32_t, 8> initial_state = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+inline uint32_t rotate_right(uint32_t value, unsigned bits)
+{
+    return (value >> bits) | (value << (32 - bits));
+}
+
+void process_blocks_portable(uint32_t* state, const uint8_t* blocks, std::size_t num_blocks)
+{
+    for (; num_blocks > 0; --num_blocks, blocks += 64) {
+        uint32_t w[64];
+        for (unsigned i = 0; i < 16; ++i) {
+            w[i] = (uint32_t(blocks[i * 4]) << 24) | (uint32_t(blocks[i * 4 + 1]) << 16) |
+                   (uint32_t(blocks[i * 4 + 2]) << 8) | uint32_t(blocks[i * 4 + 3]);
+        }
+        for (unsigned i = 16; i < 64; ++i) {
+            const uint32_t s0 =
+                rotate_right(w[i - 15], 7) ^ rotate_right(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const uint32_t s1 =
+                rotate_right(w[i - 2], 17) ^ rotate_right(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+        for (unsigned i = 0; i < 64; ++i) {
+            const uint32_t s1 = rotate_right(e, 6) ^ rotate_right(e, 11) ^ rotate_right(e, 25);
+            const uint32_t choice = (e & f) ^ (~e & g);
+            const uint32_t temp1 = h + s1 + choice + round_constants[i] + w[i];
+            const uint32_t s0 = rotate_right(a, 2) ^ rotate_right(a, 13) ^ rotate_right(a, 22);
+            const uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+            const uint32_t temp2 = s0 + majority;
+
+            h = g;
+            g = f;
+            f = e;
+            e = d + temp1;
+            d = c;
+            c = b;
+            b = a;
+            a = temp1 + temp2;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if defined(MAVSDK_SHA256_SHANI)
+bool cpu_has_sha_ni()
+{
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    const bool has_ssse3 = (ecx & (1U << 9)) != 0;
+    const bool has_sse41 = (ecx & (1U << 19)) != 0;
+
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    const bool has_sha = (ebx & (1U << 29)) != 0;
+
+    return has_ssse3 && has_sse41 && has_sha;
+}
+
+// The instructions work on the state as ABEF and CDGH instead of ABCD and EFGH.
+__attribute__((target("sha,sse4.1,ssse3"))) void
+process_blocks_sha_ni(uint32_t* state, const uint8_t* blocks, std::size_t num_blocks)
+{
+    const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+    __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+    tmp = _mm_shuffle_epi32(tmp, 0xB1); // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B); // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8); // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0); // CDGH
+
+    for (; num_blocks > 0; --num_blocks, blocks += 64) {
+        const __m128i abef_save = state0;
+        const __m128i cdgh_save = state1;
+
+        __m128i w[4];
+        for (unsigned i = 0; i < 4; ++i) {
+            w[i] = _mm_shuffle_epi8(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + i * 16)), byte_swap);
+        }
+
+        // Four rounds at a time, while the message schedule is computed ahead.
+#pragma GCC unroll 16
+        for (unsigned group = 0; group < 16; ++group) {
+            __m128i message = _mm_add_epi32(
+                w[group % 4],
+                _mm_load_si128(reinterpret_cast<const __m128i*>(&round_constants[group * 4])));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+
+            if (group >= 3 && group < 15) {
+                tmp = _mm_alignr_epi8(w[group % 4], w[(group + 3) % 4], 4);
+                w[(group + 1) % 4] = _mm_add_epi32(w[(group + 1) % 4], tmp);
+                w[(group + 1) % 4] = _mm_sha256msg2_epu32(w[(group + 1) % 4], w[group % 4]);
+            }
+
+            message = _mm_shuffle_epi32(message, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, message);
+
+            if (group >= 1 && group < 13) {
+                w[(group + 3) % 4] = _mm_sha256msg1_epu32(w[(group + 3) % 4], w[group % 4]);
+            }
+        }
+
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B); // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1); // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0); // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8); // HGFE
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+#endif
+
+#if defined(MAVSDK_SHA256_ARMV8)
+void process_blocks_armv8(uint32_t* state, const uint8_t* blocks, std::size_t num_blocks)
+{
+    uint32x4_t state0 = vld1q_u32(&state[0]);
+    uint32x4_t state1 = vld1q_u32(&state[4]);
+
+    for (; num_blocks > 0; --num_blocks, blocks += 64) {
+        const uint32x4_t abcd_save = state0;
+        const uint32x4_t efgh_save = state1;
+
+        uint32x4_t w[4];
+        for (unsigned i = 0; i < 4; ++i) {
+            w[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + i * 16)));
+        }
+
+        for (unsigned group = 0; group < 16; ++group) {
+            const uint32x4_t message =
+                vaddq_u32(w[group % 4], vld1q_u32(&round_constants[group * 4]));
+
+            if (group < 12) {
+                w[group % 4] = vsha256su1q_u32(
+                    vsha256su0q_u32(w[group % 4], w[(group + 1) % 4]),
+                    w[(group + 2) % 4],
+                    w[(group + 3) % 4]);
+            }
+
+            const uint32x4_t previous_state0 = state0;
+            state0 = vsha256hq_u32(state0, state1, message);
+            state1 = vsha256h2q_u32(state1, previous_state0, message);
+        }
+
+        state0 = vaddq_u32(state0, abcd_save);
+        state1 = vaddq_u32(state1, efgh_save);
+    }
+
+    vst1q_u32(&state[0], state0);
+    vst1q_u32(&state[4], state1);
+}
+#endif
+
+} // namespace
+
+Sha256::Sha256(Implementation implementation) :
+    _process_blocks(block_function(implementation)),
+    _state(initial_state)
+{}
+
+void Sha256::update(const uint8_t* data, std::size_t len)
+{
+    _total_len += len;
+
+    if (_buffer_len > 0) {
+        const auto to_copy = std::min(len, BLOCK_SIZE - _buffer_len);
+        std::memcpy(_buffer.data() + _buffer_len, data, to_copy);
+        _buffer_len += to_copy;
+        data += to_copy;
+        len -= to_copy;
+
+        if (_buffer_len < BLOCK_SIZE) {
+            return;
+        }
+        _process_blocks(_state.data(), _buffer.data(), 1);
+        _buffer_len = 0;
+    }
+
+    // Full blocks are processed straight from the input.
+    const auto num_blocks = len / BLOCK_SIZE;
+    if (num_blocks > 0) {
+        _process_blocks(_state.data(), data, num_blocks);
+        data += num_blocks * BLOCK_SIZE;
+        len -= num_blocks * BLOCK_SIZE;
+    }
+
+    std::memcpy(_buffer.data(), data, len);
+    _buffer_len = len;
+}
+
+Sha256::Digest Sha256::finish()
+{
+    const uint64_t total_bits = _total_len * 8;
+
+    // Padding: a one bit, zeros, and the length in bits, up to a full block.
+    _buffer[_buffer_len++] = 0x80;
+    if (_buffer_len > BLOCK_SIZE - 8) {
+        std::memset(_buffer.data() + _buffer_len, 0, BLOCK_SIZE - _buffer_len);
+        _process_blocks(_state.data(), _buffer.data(), 1);
+        _buffer_len = 0;
+    }
+    std::memset(_buffer.data() + _buffer_len, 0, BLOCK_SIZE - 8 - _buffer_len);
+    for (unsigned i = 0; i < 8; ++i) {
+        _buffer[BLOCK_SIZE - 1 - i] = static_cast<uint8_t>(total_bits >> (i * 8));
+    }
+    _process_blocks(_state.data(), _buffer.data(), 1);
+
+    Digest digest;
+    for (unsigned i = 0; i < 8; ++i) {
+        digest[i * 4] = static_cast<uint8_t>(_state[i] >> 24);
+        digest[i * 4 + 1] = static_cast<uint8_t>(_state[i] >> 16);
+        digest[i * 4 + 2] = static_cast<uint8_t>(_state[i] >> 8);
+        digest[i * 4 + 3] = static_cast<uint8_t>(_state[i]);
+    }
+    return digest;
+}
+
+Sha256::Implementation Sha256::fastest_implementation()
+{
+#if defined(MAVSDK_SHA256_SHANI)
+    static const bool has_sha_ni = cpu_has_sha_ni();
+    if (has_sha_ni) {
+        return Implementation::ShaNi;
+    }
+#endif
+#if defined(MAVSDK_SHA256_ARMV8)
+    return Implementation::Armv8;
+#endif
+    return Implementation::Portable;
+}
+
+const char* Sha256::implementation_name(Implementation implementation)
+{
+    switch (implementation) {
+        case Implementation::ShaNi:
+            return "SHA-NI";
+        case Implementation::Armv8:
+            return "ARMv8";
+        case Implementation::Portable:
+        default:
+            return "portable";
+    }
+}
+
+Sha256::BlockFunction Sha256::block_function(Implementation implementation)
+{
+    switch (implementation) {
+#if defined(MAVSDK_SHA256_SHANI)
+        case Implementation::ShaNi:
+            return process_blocks_sha_ni;
+#endif
+#if defined(MAVSDK_SHA256_ARMV8)
+        case Implementation::Armv8:
+            return process_blocks_armv8;
+#endif
+        default:
+            return process_blocks_portable;
+    }
+}
+
+} // namespace mavsdk
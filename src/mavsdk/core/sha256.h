@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace mavsdk {
+
+// SHA-256 as used for MAVLink 2 message signing.
+//
+// Uses the SHA instructions of the CPU where available: SHA-NI on x86,
+// detected at runtime, and the ARMv8 crypto extensions if the compiler
+// targets them. Everything else uses the portable implementation.
+class Sha256 {
+public:
+    enum class Implementation { Portable, ShaNi, Armv8 };
+
+    using Digest = std::array<uint8_t, 32>;
+
+    explicit Sha256(Implementation implementation = fastest_implementation());
+
+    void update(const uint8_t* data, std::size_t len);
+    Digest finish();
+
+    // The fastest implementation supported on this machine.
+    static Implementation fastest_implementation();
+    static const char* implementation_name(Implementation implementation);
+
+private:
+    using BlockFunction = void (*)(uint32_t* state, const uint8_t* blocks, std::size_t num_blocks);
+    static BlockFunction block_function(Implementation implementation);
+
+    static constexpr std::size_t BLOCK_SIZE = 64;
+
+    BlockFunction _process_blocks;
+    std::array<uint32_t, 8> _state;
+    std::array<uint8_t, BLOCK_SIZE> _buffer{};
+    std::size_t _buffer_len{0};
+    uint64_t _total_len{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,68 @@
+#include "sha256.h"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace mavsdk;
+
+static std::string to_hex(const Sha256::Digest& digest)
+{
+    std::string result;
+    char hex[3];
+    for (auto byte : digest) {
+        snprintf(hex, sizeof(hex), "%02x", byte);
+        result += hex;
+    }
+    return result;
+}
+
+static std::string hash(const std::string& input, Sha256::Implementation implementation)
+{
+    Sha256 sha256(implementation);
+    sha256.update(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+    return to_hex(sha256.finish());
+}
+
+TEST(Sha256, KnownDigests)
+{
+    for (auto implementation :
+         {Sha256::Implementation::Portable, Sha256::fastest_implementation()}) {
+        SCOPED_TRACE(Sha256::implementation_name(implementation));
+
+        EXPECT_EQ(
+            hash("", implementation),
+            "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+        EXPECT_EQ(
+            hash("abc", implementation),
+            "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+        EXPECT_EQ(
+            hash("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", implementation),
+            "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+        EXPECT_EQ(
+            hash(std::string(1000000, 'a'), implementation),
+            "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    }
+}
+
+TEST(Sha256, SameResultInPieces)
+{
+    std::vector<uint8_t> data(300);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    for (std::size_t len = 0; len <= data.size(); len += 13) {
+        Sha256 reference(Sha256::Implementation::Portable);
+        reference.update(data.data(), len);
+        const auto expected = reference.finish();
+
+        // In uneven pieces, with the fastest implementation.
+        Sha256 sha256;
+        for (std::size_t offset = 0; offset < len; offset += 37) {
+            sha256.update(data.data() + offset, std::min<std::size_t>(37, len - offset));
+        }
+        EXPECT_EQ(sha256.finish(), expected) << "length " << len;
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace mavsdk {
+
+// Bounded queue for exactly one producer and one consumer thread.
+//
+// All storage is allocated up front, so pushing and popping never allocates
+// or locks. When the queue is full, new items are rejected, the consumer is
+// expected to drain it often enough.
+template<typename T> class SpscRing {
+public:
+    // The capacity is rounded up to the next power of two.
+    explicit SpscRing(std::size_t capacity) : _storage(round_up_to_power_of_two(capacity)) {}
+    ~SpscRing() = default;
+
+    // Producer side, returns false if the queue is full.
+    bool push(const T& value)
+    {
+        const auto head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == _storage.size()) {
+            return false;
+        }
+        _storage[head & (_storage.size() - 1)] = value;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, copies up to max_count items and returns how many.
+    std::size_t pop(T* values, std::size_t max_count)
+    {
+        const auto tail = _tail.load(std::memory_order_relaxed);
+        const auto available = _head.load(std::memory_order_acquire) - tail;
+        const auto count = (available < max_count) ? available : max_count;
+        for (std::size_t i = 0; i < count; ++i) {
+            values[i] = _storage[(tail + i) & (_storage.size() - 1)];
+        }
+        _tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    [[nodiscard]] std::size_t size() const
+    {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] std::size_t capacity() const { return _storage.size(); }
+
+    // Non-copyable
+    SpscRing(const SpscRing&) = delete;
+    const SpscRing& operator=(const SpscRing&) = delete;
+
+private:
+    static std::size_t round_up_to_power_of_two(std::size_t value)
+    {
+        std::size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    std::vector<T> _storage;
+    // Ever increasing, the index into the storage is masked. Kept apart to
+    // avoid false sharing between the producer and consumer.
+    alignas(64) std::atomic<std::size_t> _head{0};
+    alignas(64) std::atomic<std::size_t> _tail{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,66 @@
+#include "spsc_ring.h"
+#include <gtest/gtest.h>
+
+#include <array>
+#include <thread>
+
+using namespace mavsdk;
+
+TEST(SpscRing, PushAndPop)
+{
+    SpscRing<int> ring(3);
+    EXPECT_EQ(ring.capacity(), 4);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.push(i));
+    }
+    // Full
+    EXPECT_FALSE(ring.push(4));
+    EXPECT_EQ(ring.size(), 4);
+
+    std::array<int, 3> values{};
+    EXPECT_EQ(ring.pop(values.data(), values.size()), 3);
+    EXPECT_EQ(values[0], 0);
+    EXPECT_EQ(values[2], 2);
+
+    // Wraps around
+    EXPECT_TRUE(ring.push(5));
+    EXPECT_TRUE(ring.push(6));
+    EXPECT_EQ(ring.pop(values.data(), values.size()), 3);
+    EXPECT_EQ(values[0], 3);
+    EXPECT_EQ(values[1], 5);
+    EXPECT_EQ(values[2], 6);
+    EXPECT_EQ(ring.pop(values.data(), values.size()), 0);
+}
+
+TEST(SpscRing, KeepsOrderAcrossThreads)
+{
+    SpscRing<unsigned> ring(64);
+    constexpr unsigned num_values = 10000;
+
+    std::thread producer([&ring]() {
+        for (unsigned i = 0; i < num_values; ++i) {
+            while (!ring.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    unsigned expected = 0;
+    bool in_order = true;
+    std::array<unsigned, 16> values{};
+    while (expected < num_values) {
+        const auto count = ring.pop(values.data(), values.size());
+        if (count == 0) {
+            std::this_thread::yield();
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            in_order = in_order && (values[i] == expected);
+            ++expected;
+        }
+    }
+    producer.join();
+
+    EXPECT_TRUE(in_order);
+    EXPECT_EQ(ring.size(), 0);
+}
@@ -2,6 +2,7 @@
 #include "mavsdk_impl.h"
 #include "system_impl.h"
 #include "plugin_impl_base.h"
+#include <chrono>
 #include <functional>
 #include <utility>
 #include "px4_custom_mode.h"
@@ -75,4 +76,40 @@ void System::enable_timesync()
     _system_impl->enable_timesync();
 }
 
+System::TimesyncStatistics System::timesync_statistics() const
+{
+    const auto statistics = _system_impl->timesync_statistics();
+
+    TimesyncStatistics result;
+    result.converged = statistics.converged;
+    result.offset_s = static_cast<double>(statistics.offset_ns) * 1e-9;
+    result.skew_ppm = statistics.skew * 1e6;
+    result.min_round_trip_time_s = static_cast<double>(statistics.min_rtt_ns) * 1e-9;
+    result.residual_s = static_cast<double>(statistics.residual_ns) * 1e-9;
+    result.samples_accepted = statistics.samples_accepted;
+    result.samples_rejected_rtt = statistics.samples_rejected_rtt;
+    result.samples_rejected_outlier = statistics.samples_rejected_outlier;
+    result.resets = statistics.resets;
+    result.time_to_converge_s = statistics.time_to_converge_s;
+    return result;
+}
+
+uint64_t System::autopilot_time_usec(uint64_t local_time_usec) const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               _system_impl->get_autopilot_time()
+                   .time_in(dl_system_time_t(std::chrono::microseconds(local_time_usec)))
+                   .time_since_epoch())
+        .count();
+}
+
+uint64_t System::local_time_usec(uint64_t autopilot_time_usec) const
+{
+    const dl_autopilot_time_t autopilot_time{std::chrono::microseconds(autopilot_time_usec)};
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               _system_impl->get_autopilot_time().system_time_in(autopilot_time).time_since_epoch())
+        .count();
+}
+
 } // namespace mavsdk
@@ -17,7 +17,13 @@ namespace mavsdk {
 SystemImpl::SystemImpl(MavsdkImpl& parent) :
     Sender(),
     _parent(parent),
-    _command_sender(*this),
+    _command_sender(
+        *this,
+        _parent.mavlink_message_handler,
+        _parent.timeout_handler,
+        [this]() { return timeout_s(); },
+        _parent.time,
+        [this](const std::function<void()>& func) { call_user_callback(func); }),
     _timesync(*this),
     _ping(*this),
     _mission_transfer(
@@ -27,6 +33,12 @@ SystemImpl::SystemImpl(MavsdkImpl& parent) :
         [this]() { return timeout_s(); }),
     _request_message(
         *this, _command_sender, _parent.mavlink_message_handler, _parent.timeout_handler),
+    _message_rate_configurator(
+        *this,
+        _command_sender,
+        _parent.mavlink_message_handler,
+        _parent.timeout_handler,
+        [this]() { return timeout_s(); }),
     _mavlink_ftp(*this)
 {
     _system_thread = new std::thread(&SystemImpl::system_thread, this);
@@ -151,6 +163,11 @@ void SystemImpl::enable_timesync()
     _timesync.enable();
 }
 
+TimesyncClockModel::Statistics SystemImpl::timesync_statistics() const
+{
+    return _timesync.statistics();
+}
+
 void SystemImpl::subscribe_is_connected(System::IsConnectedCallback callback)
 {
     std::lock_guard<std::mutex> lock(_connection_mutex);
@@ -682,6 +699,17 @@ void SystemImpl::get_param_async(
         name, value, callback, cookie);
 }
 
+void SystemImpl::get_params_async(
+    const std::vector<std::string>& names,
+    const MavlinkParameterSender::GetParamsCallback& callback,
+    const void* cookie,
+    std::optional<uint8_t> maybe_component_id,
+    bool extended)
+{
+    auto tmp= get_param_senderX(maybe_component_id,extended);
+    tmp->get_params_async(names, callback, cookie);
+}
+
 void SystemImpl::get_param_float_async(
     const std::string& name,
     const GetParamFloatCallback& callback,
@@ -1019,6 +1047,28 @@ void SystemImpl::set_msg_rate_async(
     send_command_async(command, callback);
 }
 
+MessageRateConfigurator::ResultTable SystemImpl::set_msg_rates(
+    const MessageRateConfigurator::RateProfile& rate_profile, uint8_t component_id)
+{
+    auto prom = std::promise<MessageRateConfigurator::ResultTable>();
+    auto fut = prom.get_future();
+
+    set_msg_rates_async(
+        rate_profile,
+        [&prom](const MessageRateConfigurator::ResultTable& results) { prom.set_value(results); },
+        component_id);
+
+    return fut.get();
+}
+
+void SystemImpl::set_msg_rates_async(
+    const MessageRateConfigurator::RateProfile& rate_profile,
+    const MessageRateConfigurator::ResultCallback& callback,
+    uint8_t component_id)
+{
+    _message_rate_configurator.set_rates_async(rate_profile, component_id, callback);
+}
+
 MavlinkCommandSender::CommandLong
 SystemImpl::make_command_msg_rate(uint16_t message_id, double rate_hz, uint8_t component_id)
 {
@@ -1131,11 +1181,32 @@ void SystemImpl::intercept_outgoing_messages(std::function<bool(mavlink_message_
     _parent.intercept_outgoing_messages(callback);
 }
 
+void SystemImpl::subscribe_raw_frames(
+    const void* cookie,
+    const MavlinkFrameBatcher::Filter& filter,
+    unsigned max_frames_per_batch,
+    double max_batch_latency_s,
+    MavlinkFrameBatcher::BatchCallback callback)
+{
+    _parent.subscribe_raw_frames(
+        cookie, filter, max_frames_per_batch, max_batch_latency_s, std::move(callback));
+}
+
+void SystemImpl::unsubscribe_raw_frames(const void* cookie)
+{
+    _parent.unsubscribe_raw_frames(cookie);
+}
+
 Time& SystemImpl::get_time()
 {
     return _parent.time;
 }
 
+MetadataCache& SystemImpl::metadata_cache()
+{
+    return _parent.metadata_cache;
+}
+
 void SystemImpl::subscribe_param_float(
     const std::string& name,
     const MavlinkParameterSender::ParamFloatChangedCallback& callback,
@@ -5,11 +5,14 @@
 #include "mavlink_include.h"
 #include "mavlink_parameter_sender.h"
 #include "mavlink_command_sender.h"
+#include "mavlink_frame_batcher.h"
 #include "mavlink_ftp.h"
 #include "mavlink_message_handler.h"
 #include "mavlink_mission_transfer.h"
 #include "mavlink_request_message_handler.h"
 #include "mavlink_statustext_handler.h"
+#include "message_rate_configurator.h"
+#include "metadata_cache.h"
 #include "request_message.h"
 #include "ardupilot_custom_mode.h"
 #include "ping.h"
@@ -42,6 +45,7 @@ public:
     void init(uint8_t system_id, uint8_t comp_id, bool connected);
 
     void enable_timesync();
+    TimesyncClockModel::Statistics timesync_statistics() const;
 
     void subscribe_is_connected(System::IsConnectedCallback callback);
 
@@ -96,6 +100,18 @@ public:
         const CommandResultCallback& callback,
         uint8_t maybe_component_id = MAV_COMP_ID_AUTOPILOT1);
 
+    MessageRateConfigurator::ResultTable set_msg_rates(
+        const MessageRateConfigurator::RateProfile& rate_profile,
+        uint8_t maybe_component_id = MAV_COMP_ID_AUTOPILOT1);
+
+    void set_msg_rates_async(
+        const MessageRateConfigurator::RateProfile& rate_profile,
+        const MessageRateConfigurator::ResultCallback& callback,
+        uint8_t maybe_component_id = MAV_COMP_ID_AUTOPILOT1);
+
+    MavlinkCommandSender::CommandLong
+    make_command_msg_rate(uint16_t message_id, double rate_hz, uint8_t component_id);
+
     // Adds unique component ids
     void add_new_component(uint8_t component_id);
     size_t total_components() const;
@@ -179,6 +195,13 @@ public:
         std::optional<uint8_t> maybe_component_id = {},
         bool extended = false);
 
+    void get_params_async(
+        const std::vector<std::string>& names,
+        const MavlinkParameterSender::GetParamsCallback& callback,
+        const void* cookie,
+        std::optional<uint8_t> maybe_component_id = {},
+        bool extended = false);
+
     void get_param_float_async(
         const std::string& name,
         const GetParamFloatCallback& callback,
@@ -242,9 +265,19 @@ public:
 
     RequestMessage& request_message() { return _request_message; };
 
+    MetadataCache& metadata_cache();
+
     void intercept_incoming_messages(std::function<bool(mavlink_message_t&)> callback);
     void intercept_outgoing_messages(std::function<bool(mavlink_message_t&)> callback);
 
+    void subscribe_raw_frames(
+        const void* cookie,
+        const MavlinkFrameBatcher::Filter& filter,
+        unsigned max_frames_per_batch,
+        double max_batch_latency_s,
+        MavlinkFrameBatcher::BatchCallback callback);
+    void unsubscribe_raw_frames(const void* cookie);
+
     // Non-copyable
     SystemImpl(const SystemImpl&) = delete;
     const SystemImpl& operator=(const SystemImpl&) = delete;
@@ -287,9 +320,6 @@ private:
     static ardupilot::RoverMode flight_mode_to_ardupilot_rover_mode(FlightMode flight_mode);
     static ardupilot::CopterMode flight_mode_to_ardupilot_copter_mode(FlightMode flight_mode);
 
-    MavlinkCommandSender::CommandLong
-    make_command_msg_rate(uint16_t message_id, double rate_hz, uint8_t component_id);
-
     std::mutex _component_discovered_callback_mutex{};
     System::DiscoverCallback _component_discovered_callback{nullptr};
     System::DiscoverIdCallback _component_discovered_id_callback{nullptr};
@@ -340,6 +370,7 @@ private:
 
     MavlinkMissionTransfer _mission_transfer;
     RequestMessage _request_message;
+    MessageRateConfigurator _message_rate_configurator;
     MavlinkFtp _mavlink_ftp;
 
     std::mutex _plugin_impls_mutex{};
@@ -152,7 +152,7 @@ bool TcpConnection::send_message(const mavlink_message_t& message)
     dest_addr.sin_port = htons(_remote_port_number);
 
     uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
-    uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+    uint16_t buffer_len = serialize_message(buffer, message);
 
     // TODO: remove this assert again
     assert(buffer_len <= MAVLINK_MAX_PACKET_LEN);
@@ -176,9 +176,16 @@ bool TcpConnection::send_message(const mavlink_message_t& message)
         _is_ok = false;
         return false;
     }
+
+    _statistics.add_sent_frame(buffer_len);
     return true;
 }
 
+std::string TcpConnection::description() const
+{
+    return "tcp://" + _remote_ip + ":" + std::to_string(_remote_port_number);
+}
+
 void TcpConnection::receive()
 {
     // Enough for MTU 1500 bytes.
@@ -209,12 +216,7 @@ void TcpConnection::receive()
             continue;
         }
 
-        _mavlink_receiver->set_new_datagram(buffer, static_cast<int>(recv_len));
-
-        // Parse all mavlink messages in one data packet. Once exhausted, we'll exit while.
-        while (_mavlink_receiver->parse_message()) {
-            receive_message(_mavlink_receiver->get_last_message(), this);
-        }
+        receive_datagram(buffer, static_cast<unsigned>(recv_len));
     }
 }
 
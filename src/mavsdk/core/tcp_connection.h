@@ -30,6 +30,8 @@ public:
 
     bool send_message(const mavlink_message_t& message) override;
 
+    std::string description() const override;
+
     // Non-copyable
     TcpConnection(const TcpConnection&) = delete;
     const TcpConnection& operator=(const TcpConnection&) = delete;
@@ -15,6 +15,11 @@ Timesync::~Timesync()
 
 void Timesync::enable()
 {
+    // Plugins can ask for it as well, the handler must only be registered once.
+    if (_is_enabled) {
+        return;
+    }
+
     _is_enabled = true;
     _parent.register_mavlink_message_handler(
         MAVLINK_MSG_ID_TIMESYNC,
@@ -28,36 +33,52 @@ void Timesync::do_work()
         return;
     }
 
-    if (_parent.get_time().elapsed_since_s(_last_time) >= TIMESYNC_SEND_INTERVAL_S) {
+    bool converged = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        converged = _clock_model.converged();
+    }
+    const double interval_s =
+        converged ? TIMESYNC_SEND_INTERVAL_S : TIMESYNC_CONVERGING_SEND_INTERVAL_S;
+
+    if (_parent.get_time().elapsed_since_s(_last_time) >= interval_s) {
         if (_parent.is_connected()) {
-            uint64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
-                                  _parent.get_autopilot_time().now().time_since_epoch())
-                                  .count();
-            send_timesync(0, now_ns);
+            const int64_t now_ns = local_time_ns();
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _last_sent_ns = now_ns;
+            }
+            send_timesync(0, static_cast<uint64_t>(now_ns));
         } else {
             _autopilot_timesync_acquired = false;
+            // The autopilot might come back rebooted, with a clock starting over.
+            std::lock_guard<std::mutex> lock(_mutex);
+            _clock_model.reset();
         }
         _last_time = _parent.get_time().steady_time();
     }
 }
 
+TimesyncClockModel::Statistics Timesync::statistics() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _clock_model.statistics();
+}
+
 void Timesync::process_timesync(const mavlink_message_t& message)
 {
     mavlink_timesync_t timesync{};
 
     mavlink_msg_timesync_decode(&message, &timesync);
 
-    int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
-                         _parent.get_autopilot_time().now().time_since_epoch())
-                         .count();
-
     if (timesync.tc1 == 0 && _autopilot_timesync_acquired) {
         // Send synced time to remote system
+        int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             _parent.get_autopilot_time().now().time_since_epoch())
+                             .count();
         send_timesync(now_ns, timesync.ts1);
     } else if (timesync.tc1 > 0) {
-        // Time offset between this system and the remote system is calculated assuming RTT for
-        // the timesync packet is roughly equal both ways.
-        set_timesync_offset((timesync.tc1 * 2 - (timesync.ts1 + now_ns)) / 2, timesync.ts1);
+        add_sample(timesync.tc1, timesync.ts1);
     }
 }
 
@@ -74,37 +95,67 @@ void Timesync::send_timesync(uint64_t tc1, uint64_t ts1)
     _parent.send_message(message);
 }
 
-void Timesync::set_timesync_offset(int64_t offset_ns, uint64_t start_transfer_local_time_ns)
+void Timesync::add_sample(int64_t remote_ns, int64_t local_sent_ns)
 {
-    uint64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
-                          _parent.get_autopilot_time().now().time_since_epoch())
-                          .count();
-
-    // Calculate the round trip time (RTT) it took the timesync packet to bounce back to us from
-    // remote system
-    uint64_t rtt_ns = now_ns - start_transfer_local_time_ns;
+    const int64_t local_received_ns = local_time_ns();
 
-    if (rtt_ns < MAX_RTT_SAMPLE_MS * 1000000ULL) { // Only use samples with low RTT
+    std::lock_guard<std::mutex> lock(_mutex);
 
-        // Save time offset for other components to use
-        _parent.get_autopilot_time().shift_time_by(std::chrono::nanoseconds(offset_ns));
-        _autopilot_timesync_acquired = true;
-
-        // Reset high RTT count after filter update
-        _high_rtt_count = 0;
-    } else {
-        // Increment counter if round trip time is too high for accurate timesync
-        _high_rtt_count++;
-
-        if (_high_rtt_count > MAX_CONS_HIGH_RTT) {
-            // Issue a warning to the user if the RTT is constantly high
-            LogWarn() << "RTT too high for timesync: " << static_cast<double>(rtt_ns) / 1000000.0
-                      << " ms.";
-
-            // Reset counter
+    // Only the answer to our latest request, and only once.
+    if (local_sent_ns != _last_sent_ns) {
+        return;
+    }
+    _last_sent_ns = 0;
+
+    const bool was_converged = _clock_model.converged();
+    const auto result = _clock_model.add_sample(local_sent_ns, remote_ns, local_received_ns);
+
+    switch (result) {
+        case TimesyncClockModel::SampleResult::Reset:
+            LogWarn() << "Autopilot clock jumped, timesync starts over.";
+            [[fallthrough]];
+        case TimesyncClockModel::SampleResult::Accepted:
+            // Save the clock model for other components to use
+            _parent.get_autopilot_time().set_clock_model(
+                dl_system_time_t(std::chrono::duration_cast<dl_system_time_t::duration>(
+                    std::chrono::nanoseconds(_clock_model.reference_ns()))),
+                std::chrono::nanoseconds(_clock_model.offset_at_reference_ns()),
+                _clock_model.skew());
+            _autopilot_timesync_acquired = true;
             _high_rtt_count = 0;
-        }
+
+            if (!was_converged && _clock_model.converged()) {
+                const auto statistics = _clock_model.statistics();
+                LogDebug() << "Timesync converged after " << statistics.time_to_converge_s
+                           << " s, skew: " << statistics.skew * 1e6 << " ppm";
+            }
+            break;
+
+        case TimesyncClockModel::SampleResult::RejectedRtt:
+            // Increment counter if round trip time is too high for accurate timesync
+            _high_rtt_count++;
+
+            if (_high_rtt_count > MAX_CONS_HIGH_RTT) {
+                // Issue a warning to the user if the RTT is constantly high
+                LogWarn() << "RTT too high for timesync: "
+                          << static_cast<double>(local_received_ns - local_sent_ns) / 1000000.0
+                          << " ms.";
+
+                // Reset counter
+                _high_rtt_count = 0;
+            }
+            break;
+
+        case TimesyncClockModel::SampleResult::RejectedOutlier:
+            break;
     }
 }
 
+int64_t Timesync::local_time_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               _parent.get_time().system_time().time_since_epoch())
+        .count();
+}
+
 } // namespace mavsdk
@@ -2,6 +2,9 @@
 
 #include "mavsdk_time.h"
 #include "mavlink_include.h"
+#include "timesync_clock_model.h"
+
+#include <mutex>
 
 namespace mavsdk {
 
@@ -15,6 +18,8 @@ public:
     void enable();
     void do_work();
 
+    [[nodiscard]] TimesyncClockModel::Statistics statistics() const;
+
     Timesync(const Timesync&) = delete;
     Timesync& operator=(const Timesync&) = delete;
 
@@ -23,13 +28,21 @@ private:
 
     void process_timesync(const mavlink_message_t& message);
     void send_timesync(uint64_t tc1, uint64_t ts1);
-    void set_timesync_offset(int64_t offset_ns, uint64_t start_transfer_local_time_ns);
+    void add_sample(int64_t remote_ns, int64_t local_sent_ns);
+    int64_t local_time_ns();
 
     static constexpr double TIMESYNC_SEND_INTERVAL_S = 5.0;
+    // Until the clock model has converged.
+    static constexpr double TIMESYNC_CONVERGING_SEND_INTERVAL_S = 0.5;
     dl_time_t _last_time{};
 
+    mutable std::mutex _mutex{};
+    TimesyncClockModel _clock_model{};
+    // Sent with the latest request and echoed in its answer, which tells it
+    // apart from answers to other components and to earlier requests.
+    int64_t _last_sent_ns{0};
+
     static constexpr uint64_t MAX_CONS_HIGH_RTT = 5;
-    static constexpr uint64_t MAX_RTT_SAMPLE_MS = 10;
     uint64_t _high_rtt_count{};
     bool _autopilot_timesync_acquired{false};
     bool _is_enabled{false};
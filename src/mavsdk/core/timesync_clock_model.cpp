@@ -0,0 +1,185 @@
+#include "timesync_clock_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace mavsdk {
+
+TimesyncClockModel::SampleResult TimesyncClockModel::add_sample(
+    int64_t local_sent_ns, int64_t remote_ns, int64_t local_received_ns)
+{
+    const int64_t rtt_ns = local_received_ns - local_sent_ns;
+    if (rtt_ns < 0) {
+        ++_statistics.samples_rejected_rtt;
+        return SampleResult::RejectedRtt;
+    }
+
+    add_rtt(rtt_ns);
+
+    if (static_cast<double>(rtt_ns) >
+        static_cast<double>(_min_rtt_ns) * RTT_FACTOR + static_cast<double>(RTT_MARGIN_NS)) {
+        ++_statistics.samples_rejected_rtt;
+        return SampleResult::RejectedRtt;
+    }
+
+    // Assuming the same delay both ways, the autopilot answered halfway.
+    const int64_t local_ns = local_sent_ns + rtt_ns / 2;
+    const int64_t offset_ns = remote_ns - local_ns;
+
+    auto result = SampleResult::Accepted;
+
+    if (_num_samples == 0) {
+        start(local_ns, offset_ns);
+
+    } else if (_converged) {
+        const int64_t residual_ns = offset_ns - offset_ns_at(local_ns);
+        if (std::llabs(residual_ns) > rtt_ns / 2 + OUTLIER_MARGIN_NS) {
+            if (++_consecutive_outliers < MAX_CONSECUTIVE_OUTLIERS) {
+                ++_statistics.samples_rejected_outlier;
+                return SampleResult::RejectedOutlier;
+            }
+
+            ++_statistics.resets;
+            reset();
+            add_rtt(rtt_ns);
+            start(local_ns, offset_ns);
+            result = SampleResult::Reset;
+        }
+    }
+    _consecutive_outliers = 0;
+
+    auto& sample = _samples[_next_sample];
+    sample.local_ns = static_cast<double>(local_ns - _first_local_ns);
+    sample.offset_ns = static_cast<double>(offset_ns - _first_offset_ns);
+    sample.rtt_ns = rtt_ns;
+    _next_sample = (_next_sample + 1) % WINDOW;
+    _num_samples = std::min(_num_samples + 1, WINDOW);
+    ++_statistics.samples_accepted;
+
+    fit();
+
+    _statistics.offset_ns = offset_ns_at(local_ns);
+
+    if (!_converged && _num_samples >= CONVERGENCE_SAMPLES &&
+        _residual_ns <= static_cast<double>(std::max(CONVERGED_RESIDUAL_NS, _min_rtt_ns / 2))) {
+        _converged = true;
+        _statistics.time_to_converge_s = static_cast<double>(local_ns - _first_local_ns) * 1e-9;
+    }
+
+    return result;
+}
+
+void TimesyncClockModel::reset()
+{
+    _num_rtts = 0;
+    _next_rtt = 0;
+    _min_rtt_ns = 0;
+    _num_samples = 0;
+    _next_sample = 0;
+    _skew = 0.0;
+    _residual_ns = 0.0;
+    _converged = false;
+    _consecutive_outliers = 0;
+}
+
+int64_t TimesyncClockModel::offset_ns_at(int64_t local_ns) const
+{
+    return _offset_at_reference_ns +
+           std::llround(_skew * static_cast<double>(local_ns - _reference_ns));
+}
+
+TimesyncClockModel::Statistics TimesyncClockModel::statistics() const
+{
+    auto statistics = _statistics;
+    statistics.converged = _converged;
+    statistics.skew = _skew;
+    statistics.min_rtt_ns = _min_rtt_ns;
+    statistics.residual_ns = std::llround(_residual_ns);
+    if (!_converged) {
+        statistics.time_to_converge_s = -1.0;
+    }
+    return statistics;
+}
+
+void TimesyncClockModel::start(int64_t local_ns, int64_t offset_ns)
+{
+    _first_local_ns = local_ns;
+    _first_offset_ns = offset_ns;
+}
+
+void TimesyncClockModel::add_rtt(int64_t rtt_ns)
+{
+    _rtts[_next_rtt] = rtt_ns;
+    _next_rtt = (_next_rtt + 1) % WINDOW;
+    _num_rtts = std::min(_num_rtts + 1, WINDOW);
+
+    _min_rtt_ns = *std::min_element(_rtts.begin(), _rtts.begin() + _num_rtts);
+}
+
+void TimesyncClockModel::fit()
+{
+    // Samples accepted before a lower RTT came along might not pass anymore.
+    const double max_rtt_ns =
+        static_cast<double>(_min_rtt_ns) * RTT_FACTOR + static_cast<double>(RTT_MARGIN_NS);
+    const auto selected = [&](const Sample& sample) {
+        return static_cast<double>(sample.rtt_ns) <= max_rtt_ns;
+    };
+
+    std::size_t count = 0;
+    double sum_local_ns = 0.0;
+    double sum_offset_ns = 0.0;
+    double min_local_ns = 0.0;
+    double max_local_ns = 0.0;
+    for (std::size_t i = 0; i < _num_samples; ++i) {
+        const auto& sample = _samples[i];
+        if (!selected(sample)) {
+            continue;
+        }
+        min_local_ns = (count == 0) ? sample.local_ns : std::min(min_local_ns, sample.local_ns);
+        max_local_ns = (count == 0) ? sample.local_ns : std::max(max_local_ns, sample.local_ns);
+        sum_local_ns += sample.local_ns;
+        sum_offset_ns += sample.offset_ns;
+        ++count;
+    }
+
+    if (count == 0) {
+        return;
+    }
+
+    const double mean_local_ns = sum_local_ns / static_cast<double>(count);
+    const double mean_offset_ns = sum_offset_ns / static_cast<double>(count);
+
+    double skew = 0.0;
+    if (count >= MIN_SKEW_SAMPLES && max_local_ns - min_local_ns >= MIN_SKEW_SPAN_NS) {
+        double sum_xx = 0.0;
+        double sum_xy = 0.0;
+        for (std::size_t i = 0; i < _num_samples; ++i) {
+            const auto& sample = _samples[i];
+            if (!selected(sample)) {
+                continue;
+            }
+            const double x = sample.local_ns - mean_local_ns;
+            sum_xx += x * x;
+            sum_xy += x * (sample.offset_ns - mean_offset_ns);
+        }
+        skew = std::clamp(sum_xy / sum_xx, -MAX_SKEW, MAX_SKEW);
+    }
+
+    double sum_residual_ns = 0.0;
+    for (std::size_t i = 0; i < _num_samples; ++i) {
+        const auto& sample = _samples[i];
+        if (!selected(sample)) {
+            continue;
+        }
+        const double model_ns = mean_offset_ns + skew * (sample.local_ns - mean_local_ns);
+        sum_residual_ns += std::fabs(sample.offset_ns - model_ns);
+    }
+
+    _skew = skew;
+    _residual_ns = sum_residual_ns / static_cast<double>(count);
+    _reference_ns = _first_local_ns + std::llround(mean_local_ns);
+    _offset_at_reference_ns = _first_offset_ns + std::llround(mean_offset_ns);
+}
+
+} // namespace mavsdk
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace mavsdk {
+
+// Model of the autopilot clock against the local one, from TIMESYNC exchanges:
+//
+//     autopilot time = local time + offset + skew * (local time - reference)
+//
+// Every exchange gives an offset sample, which is off by at most half its
+// round trip time (RTT) and is most accurate when the RTT is close to the
+// lowest recent one. Only such samples are accepted, the rest were queued
+// somewhere on the way. Once converged, accepted samples which still don't
+// fit the model are rejected as outliers, and if they keep coming the clock
+// of the autopilot has jumped, e.g. because it rebooted, and the model starts
+// over. The offset and skew are a least squares fit through the accepted
+// samples of a window, so that a single sample can't move the model much.
+//
+// All times are in nanoseconds. It is not thread-safe.
+class TimesyncClockModel {
+public:
+    enum class SampleResult {
+        Accepted,
+        RejectedRtt, // RTT too high compared to the recent ones.
+        RejectedOutlier, // Doesn't fit the model.
+        Reset, // Too many outliers in a row, started over with this sample.
+    };
+
+    struct Statistics {
+        bool converged{false};
+        // At the latest accepted sample.
+        int64_t offset_ns{0};
+        double skew{0.0};
+        int64_t min_rtt_ns{0};
+        // Mean absolute deviation of the accepted samples from the model.
+        int64_t residual_ns{0};
+        uint64_t samples_accepted{0};
+        uint64_t samples_rejected_rtt{0};
+        uint64_t samples_rejected_outlier{0};
+        uint64_t resets{0};
+        // From the first sample until converged, negative if not converged yet.
+        double time_to_converge_s{-1.0};
+    };
+
+    // Accepted samples kept for the fit, and RTTs kept for the lowest one.
+    static constexpr std::size_t WINDOW = 16;
+
+    TimesyncClockModel() = default;
+    ~TimesyncClockModel() = default;
+
+    // The local times at which the request was sent and the response received,
+    // and the autopilot time in the response.
+    SampleResult add_sample(int64_t local_sent_ns, int64_t remote_ns, int64_t local_received_ns);
+
+    void reset();
+
+    [[nodiscard]] bool has_model() const { return _num_samples > 0; }
+    [[nodiscard]] bool converged() const { return _converged; }
+
+    // The model, valid once has_model() is true.
+    [[nodiscard]] int64_t reference_ns() const { return _reference_ns; }
+    [[nodiscard]] int64_t offset_at_reference_ns() const { return _offset_at_reference_ns; }
+    [[nodiscard]] double skew() const { return _skew; }
+
+    [[nodiscard]] int64_t offset_ns_at(int64_t local_ns) const;
+
+    [[nodiscard]] Statistics statistics() const;
+
+    // Non-copyable
+    TimesyncClockModel(const TimesyncClockModel&) = delete;
+    const TimesyncClockModel& operator=(const TimesyncClockModel&) = delete;
+
+private:
+    struct Sample {
+        // Relative to the first sample, so that doubles keep the precision.
+        double local_ns{0.0};
+        double offset_ns{0.0};
+        int64_t rtt_ns{0};
+    };
+
+    void start(int64_t local_ns, int64_t offset_ns);
+    void add_rtt(int64_t rtt_ns);
+    void fit();
+
+    // Samples within this much of the lowest recent RTT are accepted.
+    static constexpr double RTT_FACTOR = 1.5;
+    static constexpr int64_t RTT_MARGIN_NS = 2'000'000;
+    // Accepted samples further off the model than half their RTT plus this are outliers.
+    static constexpr int64_t OUTLIER_MARGIN_NS = 2'000'000;
+    static constexpr unsigned MAX_CONSECUTIVE_OUTLIERS = 5;
+    // Enough accepted samples and time to tell skew apart from noise.
+    static constexpr std::size_t MIN_SKEW_SAMPLES = 4;
+    static constexpr double MIN_SKEW_SPAN_NS = 10e9;
+    // Crystal oscillators are within about 100 ppm, anything above is noise.
+    static constexpr double MAX_SKEW = 500e-6;
+    static constexpr std::size_t CONVERGENCE_SAMPLES = 8;
+    static constexpr int64_t CONVERGED_RESIDUAL_NS = 1'000'000;
+
+    std::array<int64_t, WINDOW> _rtts{};
+    std::size_t _num_rtts{0};
+    std::size_t _next_rtt{0};
+    int64_t _min_rtt_ns{0};
+
+    std::array<Sample, WINDOW> _samples{};
+    std::size_t _num_samples{0};
+    std::size_t _next_sample{0};
+
+    int64_t _first_local_ns{0};
+    int64_t _first_offset_ns{0};
+
+    int64_t _reference_ns{0};
+    int64_t _offset_at_reference_ns{0};
+    double _skew{0.0};
+    double _residual_ns{0.0};
+    bool _converged{false};
+    unsigned _consecutive_outliers{0};
+
+    Statistics _statistics{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,187 @@
+#include "timesync_clock_model.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+
+using namespace mavsdk;
+
+namespace {
+
+// Local time in ns since the epoch, and the autopilot time in ns since boot.
+constexpr int64_t local_start_ns = 1'700'000'000'000'000'000;
+constexpr int64_t ms = 1'000'000;
+constexpr int64_t s = 1'000'000'000;
+
+// A link to an autopilot whose clock runs at a different rate, with random
+// delays in both directions and occasional congestion in one of them.
+class SimulatedLink {
+public:
+    SimulatedLink(double skew, double jitter_mean_ms, double congestion_probability) :
+        _skew(skew),
+        _jitter(1.0 / (jitter_mean_ms > 0.0 ? jitter_mean_ms : 1.0)),
+        _use_jitter(jitter_mean_ms > 0.0),
+        _congestion_probability(congestion_probability)
+    {}
+
+    int64_t remote_time(int64_t local_ns) const
+    {
+        const auto since_start_ns = static_cast<double>(local_ns - local_start_ns);
+        return _boot_offset_ns + std::llround(since_start_ns * (1.0 + _skew));
+    }
+
+    int64_t true_offset_ns(int64_t local_ns) const { return remote_time(local_ns) - local_ns; }
+
+    void reboot() { _boot_offset_ns -= 100 * s; }
+
+    TimesyncClockModel::SampleResult exchange(TimesyncClockModel& model, int64_t local_sent_ns)
+    {
+        const int64_t there_ns = delay_ns();
+        const int64_t back_ns = delay_ns();
+        const int64_t local_received_ns = local_sent_ns + there_ns + back_ns;
+        return model.add_sample(
+            local_sent_ns, remote_time(local_sent_ns + there_ns), local_received_ns);
+    }
+
+private:
+    int64_t delay_ns()
+    {
+        double delay_ms = 5.0;
+        if (_use_jitter) {
+            delay_ms += _jitter(_rng);
+        }
+        if (_uniform(_rng) < _congestion_probability) {
+            delay_ms += 30.0 + 120.0 * _uniform(_rng);
+        }
+        return std::llround(delay_ms * static_cast<double>(ms));
+    }
+
+    const double _skew;
+    int64_t _boot_offset_ns{s};
+    std::mt19937 _rng{42};
+    std::exponential_distribution<double> _jitter;
+    std::uniform_real_distribution<double> _uniform{0.0, 1.0};
+    const bool _use_jitter;
+    const double _congestion_probability;
+};
+
+// Sends faster until converged, as Timesync does.
+int64_t run(TimesyncClockModel& model, SimulatedLink& link, int64_t local_ns, int64_t duration_ns)
+{
+    const int64_t end_ns = local_ns + duration_ns;
+    while (local_ns < end_ns) {
+        link.exchange(model, local_ns);
+        local_ns += model.converged() ? 5 * s : s / 2;
+    }
+    return local_ns;
+}
+
+} // namespace
+
+TEST(TimesyncClockModel, MatchesSymmetricLinkExactly)
+{
+    TimesyncClockModel model;
+    SimulatedLink link(0.0, 0.0, 0.0);
+
+    int64_t local_ns = local_start_ns;
+    for (unsigned i = 0; i < 8; ++i) {
+        EXPECT_EQ(link.exchange(model, local_ns), TimesyncClockModel::SampleResult::Accepted);
+        local_ns += s / 2;
+    }
+
+    EXPECT_TRUE(model.converged());
+    EXPECT_EQ(model.offset_ns_at(local_ns), link.true_offset_ns(local_ns));
+    EXPECT_DOUBLE_EQ(model.skew(), 0.0);
+
+    const auto statistics = model.statistics();
+    EXPECT_EQ(statistics.samples_accepted, 8);
+    EXPECT_EQ(statistics.min_rtt_ns, 10 * ms);
+    EXPECT_EQ(statistics.residual_ns, 0);
+    EXPECT_DOUBLE_EQ(statistics.time_to_converge_s, 3.5);
+}
+
+TEST(TimesyncClockModel, ConvergesOverJitteryCongestedLink)
+{
+    TimesyncClockModel model;
+    constexpr double skew = 40e-6;
+    SimulatedLink link(skew, 2.0, 0.2);
+
+    const int64_t local_ns = run(model, link, local_start_ns, 600 * s);
+
+    ASSERT_TRUE(model.converged());
+    // Also in between and a bit beyond the samples.
+    for (int64_t t = local_ns - 60 * s; t <= local_ns + 10 * s; t += 7 * s) {
+        EXPECT_LT(std::llabs(model.offset_ns_at(t) - link.true_offset_ns(t)), 2 * ms);
+    }
+    EXPECT_NEAR(model.skew(), skew, 20e-6);
+
+    const auto statistics = model.statistics();
+    EXPECT_GT(statistics.samples_rejected_rtt, 0);
+    EXPECT_LT(statistics.residual_ns, 2 * ms);
+    EXPECT_GT(statistics.time_to_converge_s, 0.0);
+    EXPECT_LT(statistics.time_to_converge_s, 30.0);
+    EXPECT_EQ(statistics.resets, 0);
+}
+
+TEST(TimesyncClockModel, IgnoresEarlySampleWithHighRtt)
+{
+    TimesyncClockModel model;
+    SimulatedLink link(0.0, 0.0, 0.0);
+
+    // Queued for 200 ms on the way back.
+    int64_t local_ns = local_start_ns;
+    EXPECT_EQ(
+        model.add_sample(local_ns, link.remote_time(local_ns + 5 * ms), local_ns + 210 * ms),
+        TimesyncClockModel::SampleResult::Accepted);
+    EXPECT_EQ(model.offset_ns_at(local_ns), link.true_offset_ns(local_ns) - 100 * ms);
+
+    local_ns += s / 2;
+    link.exchange(model, local_ns);
+    EXPECT_EQ(model.offset_ns_at(local_ns), link.true_offset_ns(local_ns));
+}
+
+TEST(TimesyncClockModel, RejectsOutliers)
+{
+    TimesyncClockModel model;
+    SimulatedLink link(0.0, 0.0, 0.0);
+
+    int64_t local_ns = run(model, link, local_start_ns, 10 * s);
+    ASSERT_TRUE(model.converged());
+    const int64_t offset_ns = model.offset_ns_at(local_ns);
+
+    // A low RTT, but an answer which is 50 ms off.
+    const int64_t remote_ns = link.remote_time(local_ns + 5 * ms) + 50 * ms;
+    EXPECT_EQ(
+        model.add_sample(local_ns, remote_ns, local_ns + 10 * ms),
+        TimesyncClockModel::SampleResult::RejectedOutlier);
+    EXPECT_EQ(model.offset_ns_at(local_ns), offset_ns);
+    EXPECT_EQ(model.statistics().samples_rejected_outlier, 1);
+
+    local_ns += s / 2;
+    EXPECT_EQ(link.exchange(model, local_ns), TimesyncClockModel::SampleResult::Accepted);
+}
+
+TEST(TimesyncClockModel, StartsOverWhenAutopilotClockJumps)
+{
+    TimesyncClockModel model;
+    SimulatedLink link(10e-6, 0.0, 0.0);
+
+    int64_t local_ns = run(model, link, local_start_ns, 30 * s);
+    ASSERT_TRUE(model.converged());
+
+    link.reboot();
+    for (unsigned i = 0; i < 4; ++i) {
+        EXPECT_EQ(
+            link.exchange(model, local_ns), TimesyncClockModel::SampleResult::RejectedOutlier);
+        local_ns += 5 * s;
+    }
+    EXPECT_EQ(link.exchange(model, local_ns), TimesyncClockModel::SampleResult::Reset);
+    EXPECT_FALSE(model.converged());
+    EXPECT_EQ(model.statistics().resets, 1);
+
+    local_ns = run(model, link, local_ns + s / 2, 30 * s);
+    ASSERT_TRUE(model.converged());
+    EXPECT_LT(std::llabs(model.offset_ns_at(local_ns) - link.true_offset_ns(local_ns)), ms);
+}
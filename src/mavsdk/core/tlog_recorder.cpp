@@ -0,0 +1,160 @@
+#include "tlog_recorder.h"
+#include "log.h"
+
+#include <array>
+#include <chrono>
+
+namespace mavsdk {
+
+TlogRecorder::~TlogRecorder()
+{
+    stop();
+}
+
+bool TlogRecorder::start(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_write_thread != nullptr) {
+        LogWarn() << "Already recording tlog";
+        return false;
+    }
+
+    _file.open(path, std::ios::binary | std::ios::trunc);
+    if (!_file) {
+        LogErr() << "Could not open tlog file: " << path;
+        return false;
+    }
+
+    if (!_frames) {
+        _frames = std::make_unique<MpscRing<Frame>>(RING_CAPACITY);
+    } else {
+        // Discard what was recorded concurrently with the last stop.
+        std::array<Frame, FRAMES_PER_BATCH> frames{};
+        while (_frames->pop(frames.data(), frames.size()) > 0) {}
+    }
+    _write_buffer.clear();
+    _write_buffer.reserve(WRITE_BUFFER_SIZE);
+
+    _num_recorded = 0;
+    _num_dropped = 0;
+    _num_bytes_written = 0;
+
+    _should_exit = false;
+    _write_thread = new std::thread(&TlogRecorder::write_frames, this);
+    // Publishes the ring and the thread to record() on the receive and send paths.
+    _recording.store(true, std::memory_order_release);
+
+    LogInfo() << "Recording tlog to " << path;
+    return true;
+}
+
+void TlogRecorder::stop()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_write_thread == nullptr) {
+        return;
+    }
+
+    _recording.store(false, std::memory_order_release);
+    _should_exit = true;
+    _write_thread->join();
+    delete _write_thread;
+    _write_thread = nullptr;
+
+    _file.close();
+
+    if (_num_dropped > 0) {
+        LogWarn() << "Dropped " << _num_dropped << " messages while recording tlog";
+    }
+}
+
+void TlogRecorder::record(const mavlink_message_t& message)
+{
+    if (!_recording.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    Frame frame;
+    frame.timestamp_us = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
+    frame.message = message;
+
+    if (_frames->push(frame)) {
+        ++_num_recorded;
+    } else {
+        ++_num_dropped;
+    }
+}
+
+TlogRecorder::Statistics TlogRecorder::statistics() const
+{
+    Statistics statistics;
+    statistics.num_recorded = _num_recorded;
+    statistics.num_dropped = _num_dropped;
+    statistics.num_bytes_written = _num_bytes_written;
+    return statistics;
+}
+
+void TlogRecorder::write_frames()
+{
+    std::array<Frame, FRAMES_PER_BATCH> frames{};
+
+    while (true) {
+        // Read the flag before draining, so nothing pushed before stop() is lost.
+        const bool should_exit = _should_exit;
+
+        const auto count = _frames->pop(frames.data(), frames.size());
+        for (std::size_t i = 0; i < count; ++i) {
+            if (_write_buffer.size() + TIMESTAMP_SIZE + MAVLINK_MAX_PACKET_LEN >
+                WRITE_BUFFER_SIZE) {
+                flush_buffer();
+            }
+
+            for (int shift = 56; shift >= 0; shift -= 8) {
+                _write_buffer.push_back(static_cast<char>(frames[i].timestamp_us >> shift));
+            }
+
+            uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+            const auto length = mavlink_msg_to_send_buffer(buffer, &frames[i].message);
+            _write_buffer.insert(_write_buffer.end(), buffer, buffer + length);
+        }
+
+        if (count == frames.size()) {
+            // There is more waiting.
+            continue;
+        }
+
+        if (count == 0) {
+            // Write out whatever is buffered when traffic is quiet, so the
+            // file is mostly up to date if we don't get to close it.
+            flush_buffer();
+            if (should_exit) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+}
+
+void TlogRecorder::flush_buffer()
+{
+    if (_write_buffer.empty()) {
+        return;
+    }
+
+    _file.write(_write_buffer.data(), static_cast<std::streamsize>(_write_buffer.size()));
+    _file.flush();
+    if (!_file) {
+        LogErr() << "Writing tlog failed";
+        _file.clear();
+    } else {
+        _num_bytes_written += _write_buffer.size();
+    }
+    _write_buffer.clear();
+}
+
+} // namespace mavsdk
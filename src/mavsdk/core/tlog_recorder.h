@@ -0,0 +1,84 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include "mpsc_ring.h"
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mavsdk {
+
+// Records MAVLink traffic to a telemetry log (tlog) file, as written by
+// QGroundControl and MAVProxy: every frame is preceded by its time of
+// reception as microseconds since the Unix epoch, in big-endian byte order.
+//
+// Recording is meant to be called from the receive and send paths, so it
+// only copies the message into a lock-free ring. A thread of its own
+// serializes the messages and writes them to the file in large chunks. If
+// the writer can't keep up, messages are dropped and counted, rather than
+// blocking the links.
+class TlogRecorder {
+public:
+    struct Statistics {
+        uint64_t num_recorded{0};
+        uint64_t num_dropped{0};
+        uint64_t num_bytes_written{0};
+    };
+
+    TlogRecorder() = default;
+    ~TlogRecorder();
+
+    // Truncates the file if it exists. Returns false if it can't be opened.
+    bool start(const std::string& path);
+    // Writes out everything recorded so far and closes the file.
+    void stop();
+
+    [[nodiscard]] bool is_recording() const { return _recording.load(std::memory_order_acquire); }
+
+    // Safe to call from any thread, never blocks.
+    void record(const mavlink_message_t& message);
+
+    [[nodiscard]] Statistics statistics() const;
+
+    // Non-copyable
+    TlogRecorder(const TlogRecorder&) = delete;
+    const TlogRecorder& operator=(const TlogRecorder&) = delete;
+
+private:
+    struct Frame {
+        uint64_t timestamp_us{0};
+        mavlink_message_t message{};
+    };
+
+    void write_frames();
+    void flush_buffer();
+
+    static constexpr std::size_t RING_CAPACITY = 4096;
+    static constexpr std::size_t FRAMES_PER_BATCH = 64;
+    static constexpr std::size_t WRITE_BUFFER_SIZE = 256 * 1024;
+    static constexpr std::size_t TIMESTAMP_SIZE = 8;
+
+    std::mutex _mutex{};
+    std::atomic<bool> _recording{false};
+    std::atomic<bool> _should_exit{false};
+
+    // Allocated on the first start and kept until destruction, so that
+    // record() never races with it going away.
+    std::unique_ptr<MpscRing<Frame>> _frames{};
+
+    std::ofstream _file{};
+    std::vector<char> _write_buffer{};
+    std::thread* _write_thread{nullptr};
+
+    std::atomic<uint64_t> _num_recorded{0};
+    std::atomic<uint64_t> _num_dropped{0};
+    std::atomic<uint64_t> _num_bytes_written{0};
+};
+
+} // namespace mavsdk
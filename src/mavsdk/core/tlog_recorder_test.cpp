@@ -0,0 +1,139 @@
+#include "tlog_recorder.h"
+#include "tlog_replay_connection.h"
+#include "fs.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+static mavlink_message_t make_heartbeat(uint8_t system_id)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(
+        system_id,
+        MAV_COMP_ID_AUTOPILOT1,
+        &message,
+        MAV_TYPE_QUADROTOR,
+        MAV_AUTOPILOT_PX4,
+        0,
+        0,
+        0);
+    return message;
+}
+
+static uint64_t now_us()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count());
+}
+
+static std::string tlog_path()
+{
+    // Temporary directories are not available in all builds.
+    const auto tmp_dir = create_tmp_directory("mavsdk-tlog-test");
+    return tmp_dir.value_or(".") + path_separator + "test.tlog";
+}
+
+TEST(TlogRecorder, WritesTimestampedFrames)
+{
+    const auto path = tlog_path();
+    const auto message = make_heartbeat(1);
+    const auto frame_len = mavlink_msg_get_send_buffer_length(&message);
+
+    TlogRecorder recorder;
+    // Nothing is recorded before starting.
+    recorder.record(message);
+
+    const auto before_us = now_us();
+    ASSERT_TRUE(recorder.start(path));
+    EXPECT_TRUE(recorder.is_recording());
+    for (unsigned i = 0; i < 100; ++i) {
+        recorder.record(message);
+    }
+    recorder.stop();
+    const auto after_us = now_us();
+    EXPECT_FALSE(recorder.is_recording());
+
+    const auto statistics = recorder.statistics();
+    EXPECT_EQ(statistics.num_recorded, 100);
+    EXPECT_EQ(statistics.num_dropped, 0);
+    EXPECT_EQ(statistics.num_bytes_written, 100 * (8 + frame_len));
+
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<uint8_t> content(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    ASSERT_EQ(content.size(), statistics.num_bytes_written);
+
+    for (std::size_t offset = 0; offset < content.size(); offset += 8 + frame_len) {
+        uint64_t timestamp_us = 0;
+        for (std::size_t i = 0; i < 8; ++i) {
+            timestamp_us = (timestamp_us << 8) | content[offset + i];
+        }
+        EXPECT_GE(timestamp_us, before_us);
+        EXPECT_LE(timestamp_us, after_us);
+        EXPECT_EQ(TlogReplayConnection::frame_length(&content[offset + 8]), frame_len);
+    }
+
+    fs_remove(path);
+}
+
+TEST(TlogReplayConnection, FrameLength)
+{
+    // MAVLink 1
+    const uint8_t v1[] = {MAVLINK_STX_MAVLINK1, 9, 0};
+    EXPECT_EQ(TlogReplayConnection::frame_length(v1), 17);
+
+    // MAVLink 2, unsigned and signed
+    const uint8_t v2[] = {MAVLINK_STX, 9, 0};
+    EXPECT_EQ(TlogReplayConnection::frame_length(v2), 21);
+    const uint8_t v2_signed[] = {MAVLINK_STX, 9, MAVLINK_IFLAG_SIGNED};
+    EXPECT_EQ(TlogReplayConnection::frame_length(v2_signed), 34);
+
+    const uint8_t garbage[] = {0x42, 9, 0};
+    EXPECT_EQ(TlogReplayConnection::frame_length(garbage), 0);
+}
+
+TEST(TlogReplayConnection, ReplaysRecording)
+{
+    const auto path = tlog_path();
+
+    TlogRecorder recorder;
+    ASSERT_TRUE(recorder.start(path));
+    for (uint8_t system_id = 1; system_id <= 50; ++system_id) {
+        recorder.record(make_heartbeat(system_id));
+    }
+    recorder.stop();
+
+    std::atomic<unsigned> num_received{0};
+    std::atomic<bool> in_order{true};
+    TlogReplayConnection connection(
+        [&](mavlink_message_t* messages, std::size_t count, Connection*) {
+            for (std::size_t i = 0; i < count; ++i) {
+                if (messages[i].sysid != num_received + 1) {
+                    in_order = false;
+                }
+                ++num_received;
+            }
+        },
+        path,
+        0.0);
+    EXPECT_EQ(connection.description(), "file://" + path);
+    ASSERT_EQ(connection.start(), ConnectionResult::Success);
+
+    for (unsigned i = 0; i < 100 && num_received < 50; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    connection.stop();
+
+    EXPECT_EQ(num_received, 50);
+    EXPECT_TRUE(in_order);
+
+    fs_remove(path);
+}
@@ -0,0 +1,179 @@
+#include "tlog_replay_connection.h"
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <utility>
+
+namespace mavsdk {
+
+TlogReplayConnection::TlogReplayConnection(
+    Connection::receiver_callback_t receiver_callback,
+    std::string path,
+    double speed,
+    ForwardingOption forwarding_option) :
+    Connection(std::move(receiver_callback), forwarding_option),
+    _path(std::move(path)),
+    _speed(std::max(speed, 0.0))
+{}
+
+TlogReplayConnection::~TlogReplayConnection()
+{
+    // If no one explicitly called stop before, we should at least do it.
+    stop();
+}
+
+ConnectionResult TlogReplayConnection::start()
+{
+    if (!start_mavlink_receiver()) {
+        return ConnectionResult::ConnectionsExhausted;
+    }
+
+    _file.open(_path, std::ios::binary);
+    if (!_file) {
+        LogErr() << "Could not open tlog file: " << _path;
+        return ConnectionResult::ConnectionError;
+    }
+
+    _buffer.reserve(CHUNK_SIZE + MAVLINK_MAX_PACKET_LEN);
+
+    _should_exit = false;
+    _replay_thread = std::make_unique<std::thread>(&TlogReplayConnection::replay, this);
+
+    return ConnectionResult::Success;
+}
+
+ConnectionResult TlogReplayConnection::stop()
+{
+    _should_exit = true;
+
+    if (_replay_thread) {
+        _replay_thread->join();
+        _replay_thread.reset();
+    }
+
+    _file.close();
+
+    // We need to stop this after stopping the replay thread, otherwise
+    // it can happen that we interfere with the parsing of a message.
+    stop_mavlink_receiver();
+
+    return ConnectionResult::Success;
+}
+
+bool TlogReplayConnection::send_message(const mavlink_message_t& message)
+{
+    // There is no one to send to, so it is discarded but counts as sent.
+    _statistics.add_sent_frame(mavlink_msg_get_send_buffer_length(&message));
+    return true;
+}
+
+std::string TlogReplayConnection::description() const
+{
+    return "file://" + _path;
+}
+
+std::size_t TlogReplayConnection::frame_length(const uint8_t* header)
+{
+    const std::size_t payload_len = header[1];
+
+    switch (header[0]) {
+        case MAVLINK_STX_MAVLINK1:
+            // 6 bytes header and 2 bytes checksum.
+            return payload_len + 8;
+        case MAVLINK_STX:
+            // 10 bytes header and 2 bytes checksum, plus the signature if signed.
+            return payload_len + 12 +
+                   ((header[2] & MAVLINK_IFLAG_SIGNED) ? MAVLINK_SIGNATURE_BLOCK_LEN : 0);
+        default:
+            return 0;
+    }
+}
+
+void TlogReplayConnection::replay()
+{
+    uint8_t frame[MAVLINK_MAX_PACKET_LEN];
+    std::size_t frame_len = 0;
+    uint64_t timestamp_us = 0;
+
+    std::optional<uint64_t> first_timestamp_us;
+    const auto start_time = _time.steady_time();
+
+    while (!_should_exit && read_frame(timestamp_us, frame, frame_len)) {
+        if (!first_timestamp_us) {
+            first_timestamp_us = timestamp_us;
+        }
+
+        if (_speed > 0.0 && timestamp_us > first_timestamp_us.value()) {
+            const double offset_s =
+                static_cast<double>(timestamp_us - first_timestamp_us.value()) * 1e-6 / _speed;
+            auto due = start_time;
+            Time::shift_steady_time_by(due, offset_s);
+
+            if (due > _time.steady_time()) {
+                // Everything before this frame is due already.
+                pass_on_buffer();
+
+                // Sleep in steps, so that stopping doesn't have to wait for long gaps.
+                while (!_should_exit && due > _time.steady_time()) {
+                    _time.sleep_for(std::min(
+                        std::chrono::duration_cast<std::chrono::microseconds>(
+                            due - _time.steady_time()),
+                        std::chrono::microseconds(100000)));
+                }
+            }
+        }
+
+        _buffer.insert(_buffer.end(), frame, frame + frame_len);
+        if (_buffer.size() >= CHUNK_SIZE) {
+            pass_on_buffer();
+        }
+    }
+
+    pass_on_buffer();
+
+    if (!_should_exit) {
+        LogInfo() << "Replay of " << _path << " finished";
+    }
+}
+
+bool TlogReplayConnection::read_frame(
+    uint64_t& timestamp_us, uint8_t* frame, std::size_t& frame_len)
+{
+    uint8_t timestamp[8];
+    if (!_file.read(reinterpret_cast<char*>(timestamp), sizeof(timestamp))) {
+        return false;
+    }
+
+    timestamp_us = 0;
+    for (auto byte : timestamp) {
+        timestamp_us = (timestamp_us << 8) | byte;
+    }
+
+    constexpr std::size_t header_len = 3;
+    if (!_file.read(reinterpret_cast<char*>(frame), header_len)) {
+        return false;
+    }
+
+    frame_len = frame_length(frame);
+    if (frame_len == 0) {
+        LogErr() << "Invalid frame in tlog " << _path << ", stopping replay";
+        return false;
+    }
+
+    return static_cast<bool>(
+        _file.read(reinterpret_cast<char*>(frame + header_len), frame_len - header_len));
+}
+
+void TlogReplayConnection::pass_on_buffer()
+{
+    if (_buffer.empty()) {
+        return;
+    }
+
+    receive_datagram(_buffer.data(), static_cast<unsigned>(_buffer.size()));
+    _buffer.clear();
+}
+
+} // namespace mavsdk
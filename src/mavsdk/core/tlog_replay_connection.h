@@ -0,0 +1,63 @@
+#pragma once
+
+#include "connection.h"
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mavsdk {
+
+// Plays back a telemetry log (tlog) file as if the traffic was arriving on a
+// link, e.g. to test against recorded flights.
+//
+// The timing of the recording is kept, scaled by the speed factor: 1 is real
+// time, 2 twice as fast and 0 as fast as the messages can be parsed. Messages
+// sent to the connection are discarded.
+class TlogReplayConnection : public Connection {
+public:
+    explicit TlogReplayConnection(
+        Connection::receiver_callback_t receiver_callback,
+        std::string path,
+        double speed,
+        ForwardingOption forwarding_option = ForwardingOption::ForwardingOff);
+    ~TlogReplayConnection() override;
+    ConnectionResult start() override;
+    ConnectionResult stop() override;
+
+    bool send_message(const mavlink_message_t& message) override;
+
+    std::string description() const override;
+
+    // Length of the frame starting with the given header, or 0 if it is not
+    // the start of a MAVLink frame. At least the first 3 bytes are required.
+    static std::size_t frame_length(const uint8_t* header);
+
+    // Non-copyable
+    TlogReplayConnection(const TlogReplayConnection&) = delete;
+    const TlogReplayConnection& operator=(const TlogReplayConnection&) = delete;
+
+private:
+    void replay();
+    bool read_frame(uint64_t& timestamp_us, uint8_t* frame, std::size_t& frame_len);
+    void pass_on_buffer();
+
+    // Frames are passed on in chunks of this size, unless the timing requires
+    // passing them on sooner.
+    static constexpr std::size_t CHUNK_SIZE = 16 * 1024;
+
+    const std::string _path;
+    const double _speed;
+
+    std::ifstream _file{};
+    std::vector<char> _buffer{};
+
+    std::unique_ptr<std::thread> _replay_thread{};
+    std::atomic_bool _should_exit{false};
+};
+
+} // namespace mavsdk
@@ -140,6 +140,10 @@ bool UdpConnection::send_message(const mavlink_message_t& message)
         return false;
     }
 
+    // Serialized once, the same frame goes to every remote.
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t buffer_len = serialize_message(buffer, message);
+
     // Send the message to all the remotes. A remote is a UDP endpoint
     // identified by its <ip, port>. This means that if we have two
     // systems on two different endpoints, then messages directed towards
@@ -153,9 +157,6 @@ bool UdpConnection::send_message(const mavlink_message_t& message)
         inet_pton(AF_INET, remote.ip.c_str(), &dest_addr.sin_addr.s_addr);
         dest_addr.sin_port = htons(remote.port_number);
 
-        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
-        uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
-
         const auto send_len = sendto(
             _socket_fd,
             reinterpret_cast<char*>(buffer),
@@ -169,11 +170,18 @@ bool UdpConnection::send_message(const mavlink_message_t& message)
             send_successful = false;
             continue;
         }
+
+        _statistics.add_sent_frame(buffer_len);
     }
 
     return send_successful;
 }
 
+std::string UdpConnection::description() const
+{
+    return "udp://" + _local_ip + ":" + std::to_string(_local_port_number);
+}
+
 void UdpConnection::add_remote(const std::string& remote_ip, const int remote_port)
 {
     add_remote_with_remote_sysid(remote_ip, remote_port, 0);
@@ -232,19 +240,31 @@ void UdpConnection::receive()
             continue;
         }
 
+        _statistics.add_received_bytes(static_cast<std::size_t>(recv_len));
         _mavlink_receiver->set_new_datagram(buffer, static_cast<int>(recv_len));
 
-        // Parse all mavlink messages in one datagram. Once exhausted, we'll exit while.
-        while (_mavlink_receiver->parse_message()) {
-            const uint8_t sysid = _mavlink_receiver->get_last_message().sysid;
-
-            if (sysid != 0) {
-                add_remote_with_remote_sysid(
-                    inet_ntoa(src_addr.sin_addr), ntohs(src_addr.sin_port), sysid);
+        // Parse all mavlink messages in one datagram, one batch at a time.
+        std::size_t count;
+        while ((count = _mavlink_receiver->parse_messages(
+                    _received_messages.data(), _received_messages.size())) > 0) {
+            // Only verified frames make their sender a remote, otherwise a
+            // forged frame could redirect everything we send, signed or not.
+            const auto accepted = accept_messages(_received_messages.data(), count);
+            for (std::size_t i = 0; i < accepted; ++i) {
+                const uint8_t sysid = _received_messages[i].sysid;
+
+                if (sysid != 0) {
+                    add_remote_with_remote_sysid(
+                        inet_ntoa(src_addr.sin_addr), ntohs(src_addr.sin_port), sysid);
+                }
             }
 
-            receive_message(_mavlink_receiver->get_last_message(), this);
+            if (accepted > 0) {
+                _receiver_callback(_received_messages.data(), accepted, this);
+            }
         }
+
+        _statistics.add_parse_errors(_mavlink_receiver->take_parse_errors());
     }
 }
 
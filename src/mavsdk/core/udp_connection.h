@@ -24,6 +24,8 @@ public:
 
     bool send_message(const mavlink_message_t& message) override;
 
+    std::string description() const override;
+
     void add_remote(const std::string& remote_ip, int remote_port);
 
     // Non-copyable
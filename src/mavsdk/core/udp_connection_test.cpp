@@ -0,0 +1,119 @@
+#include "udp_connection.h"
+#include "mavlink_signing.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#if !defined(WINDOWS)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+using namespace mavsdk;
+
+static constexpr int connection_port = 14591;
+
+// A plain socket on the other end of the connection.
+class UdpPeer {
+public:
+    UdpPeer()
+    {
+        _fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+        struct sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        addr.sin_port = 0;
+        bind(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+
+        struct timeval timeout {};
+        timeout.tv_usec = 200000;
+        setsockopt(_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+
+    ~UdpPeer() { close(_fd); }
+
+    void send(const std::vector<uint8_t>& buffer)
+    {
+        struct sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        addr.sin_port = htons(connection_port);
+        sendto(
+            _fd,
+            buffer.data(),
+            buffer.size(),
+            0,
+            reinterpret_cast<const sockaddr*>(&addr),
+            sizeof(addr));
+    }
+
+    bool receive_any()
+    {
+        char buffer[2048];
+        return recv(_fd, buffer, sizeof(buffer), 0) > 0;
+    }
+
+    UdpPeer(const UdpPeer&) = delete;
+    const UdpPeer& operator=(const UdpPeer&) = delete;
+
+private:
+    int _fd{-1};
+};
+
+static std::vector<uint8_t> serialize_heartbeat(MavlinkSigning& signing)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(1, 1, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, 0);
+
+    std::vector<uint8_t> buffer(MAVLINK_MAX_PACKET_LEN);
+    buffer.resize(signing.serialize(buffer.data(), message));
+    return buffer;
+}
+
+TEST(UdpConnection, OnlyVerifiedFramesAddRemotes)
+{
+    std::atomic<unsigned> num_received{0};
+    UdpConnection connection(
+        [&num_received](mavlink_message_t*, std::size_t count, Connection*) {
+            num_received += static_cast<unsigned>(count);
+        },
+        "127.0.0.1",
+        connection_port);
+
+    MavlinkSigning::Options options;
+    options.secret_key.fill(42);
+    connection.enable_signing(options);
+    ASSERT_EQ(connection.start(), ConnectionResult::Success);
+
+    Time time;
+    MavlinkSigning unsigned_sender(time);
+    MavlinkSigning signed_sender(time);
+    signed_sender.enable(options);
+
+    UdpPeer attacker;
+    UdpPeer peer;
+    attacker.send(serialize_heartbeat(unsigned_sender));
+    peer.send(serialize_heartbeat(signed_sender));
+
+    for (unsigned i = 0; i < 100 && num_received == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(num_received, 1);
+
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(245, 190, &message, MAV_TYPE_GCS, MAV_AUTOPILOT_INVALID, 0, 0, 0);
+    EXPECT_TRUE(connection.send_message(message));
+
+    EXPECT_TRUE(peer.receive_any());
+    EXPECT_FALSE(attacker.receive_any());
+
+    connection.stop();
+}
+
+#endif
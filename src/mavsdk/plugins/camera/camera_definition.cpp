@@ -1,6 +1,8 @@
 #include "log.h"
 #include "camera_definition.h"
 
+#include <algorithm>
+
 namespace mavsdk {
 
 CameraDefinition::CameraDefinition() {}
@@ -9,24 +11,28 @@ CameraDefinition::~CameraDefinition() {}
 
 bool CameraDefinition::load_file(const std::string& filepath)
 {
-    tinyxml2::XMLError xml_error = _doc.LoadFile(filepath.c_str());
+    // The document is only needed while parsing, everything we need is
+    // copied into the parameter tables.
+    tinyxml2::XMLDocument doc;
+    tinyxml2::XMLError xml_error = doc.LoadFile(filepath.c_str());
     if (xml_error != tinyxml2::XML_SUCCESS) {
-        LogErr() << "tinyxml2::LoadFile failed: " << _doc.ErrorStr();
+        LogErr() << "tinyxml2::LoadFile failed: " << doc.ErrorStr();
         return false;
     }
 
-    return parse_xml();
+    return parse_xml(doc);
 }
 
 bool CameraDefinition::load_string(const std::string& content)
 {
-    tinyxml2::XMLError xml_error = _doc.Parse(content.c_str());
+    tinyxml2::XMLDocument doc;
+    tinyxml2::XMLError xml_error = doc.Parse(content.c_str());
     if (xml_error != tinyxml2::XML_SUCCESS) {
-        LogErr() << "tinyxml2::Parse failed: " << _doc.ErrorStr();
+        LogErr() << "tinyxml2::Parse failed: " << doc.ErrorStr();
         return false;
     }
 
-    return parse_xml();
+    return parse_xml(doc);
 }
 
 std::string CameraDefinition::get_model() const
@@ -43,11 +49,40 @@ std::string CameraDefinition::get_vendor() const
     return _vendor;
 }
 
-bool CameraDefinition::parse_xml()
+bool CameraDefinition::parse_xml(const tinyxml2::XMLDocument& doc)
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    auto e_mavlinkcamera = _doc.FirstChildElement("mavlinkcamera");
+    clear_locked();
+
+    // A definition which fails half-way is not used at all, rather than
+    // leaving the tables with only some of the parameters.
+    if (!parse_xml_locked(doc)) {
+        clear_locked();
+        return false;
+    }
+
+    return true;
+}
+
+void CameraDefinition::clear_locked()
+{
+    _parameters.clear();
+    _parameter_indices.clear();
+    _current_settings.clear();
+    _active_options.clear();
+    _exclusion_counts.clear();
+    _known_exclusion_counts.clear();
+    _range_targets.clear();
+    _range_sources.clear();
+    _possible_options_cache.clear();
+    _model.clear();
+    _vendor.clear();
+}
+
+bool CameraDefinition::parse_xml_locked(const tinyxml2::XMLDocument& doc)
+{
+    auto e_mavlinkcamera = doc.FirstChildElement("mavlinkcamera");
     if (!e_mavlinkcamera) {
         LogErr() << "Tag mavlinkcamera not found";
         return false;
@@ -100,9 +135,12 @@ bool CameraDefinition::parse_xml()
         type_map[param_name] = type_str;
     }
 
+    std::vector<ParameterReferences> references;
+
     for (auto e_parameter = e_parameters->FirstChildElement("parameter"); e_parameter != nullptr;
          e_parameter = e_parameter->NextSiblingElement("parameter")) {
-        auto new_parameter = std::make_shared<Parameter>();
+        Parameter new_parameter{};
+        ParameterReferences new_references{};
 
         const char* param_name = e_parameter->Attribute("name");
         if (!param_name) {
@@ -126,44 +164,44 @@ bool CameraDefinition::parse_xml()
             continue;
         }
 
-        if (!new_parameter->type.set_empty_type_from_xml(type_str)) {
+        if (!new_parameter.type.set_empty_type_from_xml(type_str)) {
             LogErr() << "Unknown type attribute: " << type_str;
             return false;
         }
 
         // By default control is on.
-        new_parameter->is_control = true;
+        new_parameter.is_control = true;
         const char* control_str = e_parameter->Attribute("control");
         if (control_str) {
             if (strcmp(control_str, "0") == 0) {
-                new_parameter->is_control = false;
+                new_parameter.is_control = false;
             }
         }
 
-        new_parameter->is_readonly = false;
+        new_parameter.is_readonly = false;
         const char* readonly_str = e_parameter->Attribute("readonly");
         if (readonly_str) {
             if (strcmp(readonly_str, "1") == 0) {
-                new_parameter->is_readonly = true;
+                new_parameter.is_readonly = true;
             }
         }
 
-        new_parameter->is_writeonly = false;
+        new_parameter.is_writeonly = false;
         const char* writeonly_str = e_parameter->Attribute("writeonly");
         if (writeonly_str) {
             if (strcmp(writeonly_str, "1") == 0) {
-                new_parameter->is_writeonly = true;
+                new_parameter.is_writeonly = true;
             }
         }
 
-        if (new_parameter->is_readonly && new_parameter->is_writeonly) {
+        if (new_parameter.is_readonly && new_parameter.is_writeonly) {
             LogErr() << "parameter can't be readonly and writeonly";
             return false;
         }
 
         // Be definition custom types do not have control.
         if (strcmp(type_map[param_name].c_str(), "custom") == 0) {
-            new_parameter->is_control = false;
+            new_parameter.is_control = false;
         }
 
         auto e_description = e_parameter->FirstChildElement("description");
@@ -172,13 +210,13 @@ bool CameraDefinition::parse_xml()
             return false;
         }
 
-        new_parameter->description = e_description->GetText();
+        new_parameter.description = e_description->GetText();
 
-        // LogDebug() << "Found: " << new_parameter->description
+        // LogDebug() << "Found: " << new_parameter.description
         //            << " (" << param_name
-        //            << ", control: " << (new_parameter->is_control ? "yes" : "no")
-        //            << ", readonly: " << (new_parameter->is_readonly ? "yes" : "no")
-        //            << ", writeonly: " << (new_parameter->is_writeonly ? "yes" : "no")
+        //            << ", control: " << (new_parameter.is_control ? "yes" : "no")
+        //            << ", readonly: " << (new_parameter.is_readonly ? "yes" : "no")
+        //            << ", writeonly: " << (new_parameter.is_writeonly ? "yes" : "no")
         //            << ")";
 
         auto e_updates = e_parameter->FirstChildElement("updates");
@@ -186,7 +224,7 @@ bool CameraDefinition::parse_xml()
             for (auto e_update = e_updates->FirstChildElement("update"); e_update != nullptr;
                  e_update = e_update->NextSiblingElement("update")) {
                 // LogDebug() << "Updates: " << e_update->GetText();
-                new_parameter->updates.push_back(e_update->GetText());
+                new_references.updates.push_back(e_update->GetText());
             }
         }
 
@@ -198,70 +236,159 @@ bool CameraDefinition::parse_xml()
 
         auto e_options = e_parameter->FirstChildElement("options");
         if (e_options) {
-            auto maybe_options = parse_options(e_options, param_name, type_map);
-            if (!maybe_options.first) {
+            if (!parse_options(
+                    e_options,
+                    param_name,
+                    type_map,
+                    new_parameter.options,
+                    new_references.options)) {
                 continue;
             }
-            new_parameter->options = maybe_options.second;
 
-            auto maybe_default = find_default(new_parameter->options, default_str);
-
-            if (!maybe_default.first) {
+            if (!find_default(new_parameter.options, default_str, new_parameter.default_value)) {
                 LogWarn() << "Default not found for " << param_name;
                 return false;
             }
 
-            new_parameter->default_option = maybe_default.second;
-
         } else {
-            auto maybe_range_options = parse_range_options(e_parameter, param_name, type_map);
-            if (!std::get<0>(maybe_range_options)) {
+            if (!parse_range_options(
+                    e_parameter,
+                    param_name,
+                    type_map,
+                    new_parameter.options,
+                    new_parameter.default_value)) {
                 LogWarn() << "Not found: " << param_name;
                 continue;
             }
 
-            new_parameter->options = std::get<1>(maybe_range_options);
-            new_parameter->is_range = true;
-            new_parameter->default_option = std::get<2>(maybe_range_options);
+            new_parameter.is_range = true;
+            new_references.options.resize(new_parameter.options.size());
         }
 
-        _parameter_map[param_name] = new_parameter;
+        new_parameter.name = param_name;
+
+        const auto existing = _parameter_indices.find(param_name);
+        if (existing != _parameter_indices.end()) {
+            // Same as before, a later definition of a parameter replaces the earlier one.
+            _parameters[existing->second] = std::move(new_parameter);
+            references[existing->second] = std::move(new_references);
+        } else {
+            _parameter_indices[param_name] = static_cast<ParameterIndex>(_parameters.size());
+            _parameters.push_back(std::move(new_parameter));
+            references.push_back(std::move(new_references));
+        }
+    }
+
+    resolve_references(references);
+    build_dependencies();
 
-        InternalCurrentSetting empty_setting{};
-        empty_setting.needs_updating = true;
-        _current_settings[param_name] = empty_setting;
+    InternalCurrentSetting empty_setting{};
+    empty_setting.needs_updating = true;
+    _current_settings.assign(_parameters.size(), empty_setting);
+    _active_options.assign(_parameters.size(), NO_ACTIVE_OPTION);
+    _exclusion_counts.assign(_parameters.size(), 0);
+    _known_exclusion_counts.assign(_parameters.size(), 0);
+    _possible_options_cache.assign(_parameters.size(), std::nullopt);
+
+    for (std::size_t i = 0; i < _parameters.size(); ++i) {
+        change_setting_locked(static_cast<ParameterIndex>(i), nullptr, true);
     }
 
     return true;
 }
 
-std::pair<bool, std::vector<std::shared_ptr<CameraDefinition::Option>>>
-CameraDefinition::parse_options(
+void CameraDefinition::resolve_references(const std::vector<ParameterReferences>& references)
+{
+    // References to parameters which we don't know or ignore are dropped, they
+    // could never match a setting anyway.
+    for (std::size_t i = 0; i < _parameters.size(); ++i) {
+        auto& parameter = _parameters[i];
+
+        for (const auto& update : references[i].updates) {
+            if (const auto maybe_index = find_parameter(update)) {
+                parameter.updates.push_back(maybe_index.value());
+            }
+        }
+
+        for (std::size_t j = 0; j < parameter.options.size(); ++j) {
+            auto& option = parameter.options[j];
+            const auto& option_references = references[i].options[j];
+
+            for (const auto& exclusion : option_references.exclusions) {
+                if (const auto maybe_index = find_parameter(exclusion)) {
+                    option.exclusions.push_back(maybe_index.value());
+                }
+            }
+
+            for (const auto& parameter_range : option_references.parameter_ranges) {
+                if (const auto maybe_index = find_parameter(parameter_range.first)) {
+                    option.parameter_ranges.push_back(
+                        ParameterRange{maybe_index.value(), parameter_range.second});
+                }
+            }
+        }
+    }
+}
+
+void CameraDefinition::build_dependencies()
+{
+    _range_targets.assign(_parameters.size(), {});
+    _range_sources.assign(_parameters.size(), {});
+
+    const auto add_unique = [](std::vector<ParameterIndex>& indices, ParameterIndex index) {
+        if (std::find(indices.begin(), indices.end(), index) == indices.end()) {
+            indices.push_back(index);
+        }
+    };
+
+    for (std::size_t i = 0; i < _parameters.size(); ++i) {
+        for (const auto& option : _parameters[i].options) {
+            for (const auto& parameter_range : option.parameter_ranges) {
+                add_unique(_range_targets[i], parameter_range.parameter);
+                add_unique(
+                    _range_sources[parameter_range.parameter], static_cast<ParameterIndex>(i));
+            }
+        }
+    }
+}
+
+std::optional<CameraDefinition::ParameterIndex>
+CameraDefinition::find_parameter(const std::string& name) const
+{
+    const auto it = _parameter_indices.find(name);
+    if (it == _parameter_indices.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+bool CameraDefinition::parse_options(
     const tinyxml2::XMLElement* options_handle,
     const std::string& param_name,
-    std::unordered_map<std::string, std::string>& type_map)
+    std::unordered_map<std::string, std::string>& type_map,
+    std::vector<Option>& options,
+    std::vector<OptionReferences>& references)
 {
-    std::vector<std::shared_ptr<Option>> options{};
-
     for (auto e_option = options_handle->FirstChildElement("option"); e_option != nullptr;
          e_option = e_option->NextSiblingElement("option")) {
         const char* option_name = e_option->Attribute("name");
         if (!option_name) {
             LogErr() << "no option name given";
-            return std::make_pair<>(false, options);
+            return false;
         }
 
         const char* option_value = e_option->Attribute("value");
         if (!option_value) {
             LogErr() << "no option value given";
-            return std::make_pair<>(false, options);
+            return false;
         }
 
-        auto new_option = std::make_shared<Option>();
+        Option new_option{};
+        OptionReferences new_references{};
 
-        new_option->name = option_name;
+        new_option.name = option_name;
 
-        new_option->value.set_from_xml(type_map[param_name], option_value);
+        new_option.value.set_from_xml(type_map[param_name], option_value);
 
         // LogDebug() << "Type: " << type_map[param_name] << ", name: " << option_name;
 
@@ -270,7 +397,7 @@ CameraDefinition::parse_options(
             for (auto e_exclude = e_exclusions->FirstChildElement("exclude"); e_exclude != nullptr;
                  e_exclude = e_exclude->NextSiblingElement("exclude")) {
                 // LogDebug() << "Exclude: " << e_exclude->GetText();
-                new_option->exclusions.push_back(e_exclude->GetText());
+                new_references.exclusions.push_back(e_exclude->GetText());
             }
         }
 
@@ -282,10 +409,10 @@ CameraDefinition::parse_options(
                 const char* roption_parameter_str = e_parameterrange->Attribute("parameter");
                 if (!roption_parameter_str) {
                     LogErr() << "missing roption parameter name";
-                    return std::make_pair<>(false, options);
+                    return false;
                 }
 
-                parameter_range_t new_parameter_range;
+                std::vector<ParamValue> new_parameter_range;
 
                 for (auto e_roption = e_parameterrange->FirstChildElement("roption");
                      e_roption != nullptr;
@@ -293,24 +420,24 @@ CameraDefinition::parse_options(
                     const char* roption_name_str = e_roption->Attribute("name");
                     if (!roption_name_str) {
                         LogErr() << "missing roption name attribute";
-                        return std::make_pair<>(false, options);
+                        return false;
                     }
 
                     const char* roption_value_str = e_roption->Attribute("value");
                     if (!roption_value_str) {
                         LogErr() << "missing roption value attribute";
-                        return std::make_pair<>(false, options);
+                        return false;
                     }
 
                     if (type_map.find(roption_parameter_str) == type_map.end()) {
                         LogErr() << "unknown roption type";
-                        return std::make_pair<>(false, options);
+                        return false;
                     }
 
                     ParamValue new_param_value;
                     new_param_value.set_from_xml(
                         type_map[roption_parameter_str], roption_value_str);
-                    new_parameter_range[roption_name_str] = new_param_value;
+                    new_parameter_range.push_back(new_param_value);
 
                     // LogDebug() << "range option: "
                     //            << roption_name_str
@@ -319,51 +446,57 @@ CameraDefinition::parse_options(
                     //            << " (" << new_param_value.typestr() << ")";
                 }
 
-                new_option->parameter_ranges[roption_parameter_str] = new_parameter_range;
+                // A later range for the same parameter replaces the earlier one.
+                auto existing = std::find_if(
+                    new_references.parameter_ranges.begin(),
+                    new_references.parameter_ranges.end(),
+                    [&](const auto& range) { return range.first == roption_parameter_str; });
+                if (existing != new_references.parameter_ranges.end()) {
+                    existing->second = std::move(new_parameter_range);
+                } else {
+                    new_references.parameter_ranges.emplace_back(
+                        roption_parameter_str, std::move(new_parameter_range));
+                }
 
                 // LogDebug() << "adding to: " << roption_parameter_str;
             }
         }
 
-        options.push_back(new_option);
+        options.push_back(std::move(new_option));
+        references.push_back(std::move(new_references));
     }
-    return std::make_pair<>(true, options);
+    return true;
 }
 
-std::tuple<bool, std::vector<std::shared_ptr<CameraDefinition::Option>>, CameraDefinition::Option>
-CameraDefinition::parse_range_options(
+bool CameraDefinition::parse_range_options(
     const tinyxml2::XMLElement* param_handle,
     const std::string& param_name,
-    std::unordered_map<std::string, std::string>& type_map)
+    std::unordered_map<std::string, std::string>& type_map,
+    std::vector<Option>& options,
+    ParamValue& default_value)
 {
-    std::vector<std::shared_ptr<Option>> options{};
-    Option default_option{};
-
     const char* min_str = param_handle->Attribute("min");
     if (!min_str) {
         LogErr() << "min range missing for " << param_name;
-        return std::make_tuple<>(false, options, default_option);
+        return false;
     }
 
-    ParamValue min_value;
-    min_value.set_from_xml(type_map[param_name], min_str);
+    Option min_option{};
+    min_option.name = "min";
+    min_option.value.set_from_xml(type_map[param_name], min_str);
 
     const char* max_str = param_handle->Attribute("max");
     if (!max_str) {
         LogErr() << "max range missing for " << param_name;
-        return std::make_tuple<>(false, options, default_option);
+        return false;
     }
 
-    auto min_option = std::make_shared<Option>();
-    min_option->name = "min";
-    min_option->value = min_value;
-
-    ParamValue max_value;
-    max_value.set_from_xml(type_map[param_name], max_str);
+    Option max_option{};
+    max_option.name = "max";
+    max_option.value.set_from_xml(type_map[param_name], max_str);
 
-    auto max_option = std::make_shared<Option>();
-    max_option->name = "max";
-    max_option->value = max_value;
+    options.push_back(std::move(min_option));
+    options.push_back(std::move(max_option));
 
     const char* step_str = param_handle->Attribute("step");
     if (!step_str) {
@@ -371,91 +504,53 @@ CameraDefinition::parse_range_options(
     }
 
     if (step_str) {
-        ParamValue step_value;
-        step_value.set_from_xml(type_map[param_name], step_str);
+        Option step_option{};
+        step_option.name = "step";
+        step_option.value.set_from_xml(type_map[param_name], step_str);
 
-        auto step_option = std::make_shared<Option>();
-        step_option->name = "step";
-        step_option->value = step_value;
-
-        options.push_back(min_option);
-        options.push_back(max_option);
-        options.push_back(step_option);
-    } else {
-        options.push_back(min_option);
-        options.push_back(max_option);
+        options.push_back(std::move(step_option));
     }
 
     const char* default_str = param_handle->Attribute("default");
     if (!default_str) {
         LogDebug() << "default range missing for " << param_name;
-        return std::make_tuple<>(false, options, default_option);
+        return false;
     }
 
-    ParamValue default_value;
     default_value.set_from_xml(type_map[param_name], default_str);
 
-    default_option.name = default_str;
-    default_option.value = default_value;
-
-    return std::make_tuple<>(true, options, default_option);
+    return true;
 }
 
-std::pair<bool, CameraDefinition::Option> CameraDefinition::find_default(
-    const std::vector<std::shared_ptr<Option>>& options, const std::string& default_str)
+bool CameraDefinition::find_default(
+    const std::vector<Option>& options, const std::string& default_str, ParamValue& default_value)
 {
-    Option default_option{};
-
     bool found_default = false;
     for (auto& option : options) {
-        if (option->value == default_str) {
+        if (option.value == default_str) {
             if (!found_default) {
-                default_option = *option;
+                default_value = option.value;
                 found_default = true;
             } else {
                 LogErr() << "Found more than one default";
-                return std::make_pair<>(false, default_option);
+                return false;
             }
         }
     }
     if (!found_default) {
         LogErr() << "No default found";
-        return std::make_pair<>(false, default_option);
+        return false;
     }
-    return std::make_pair<>(true, default_option);
+    return true;
 }
 
 void CameraDefinition::assume_default_settings()
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    _current_settings.clear();
-
-    for (const auto& parameter : _parameter_map) {
-        // if (parameter.second->is_range) {
-
-        InternalCurrentSetting new_setting;
-        new_setting.value = parameter.second->default_option.value;
-        new_setting.needs_updating = false;
-        _current_settings[parameter.first] = new_setting;
-
-        //} else {
-
-        //    for (const auto &option : parameter.second->options) {
-        //        if (!option->is_default) {
-        //            //LogDebug() << option->name << " not default";
-        //            continue;
-        //        }
-        //        //LogDebug() << option->name << " default value: " << option->value << " (type: "
-        //        <<
-        //        // option->value.typestr() << ")";
-
-        //        InternalCurrentSetting new_setting;
-        //        new_setting.value = option->value;
-        //        new_setting.needs_updating = false;
-        //        _current_settings[parameter.first] = new_setting;
-        //    }
-        //}
+    for (std::size_t i = 0; i < _parameters.size(); ++i) {
+        change_setting_locked(
+            static_cast<ParameterIndex>(i), &_parameters[i].default_value, false);
     }
 }
 
@@ -464,8 +559,8 @@ bool CameraDefinition::get_all_settings(std::unordered_map<std::string, ParamVal
     std::lock_guard<std::mutex> lock(_mutex);
 
     settings.clear();
-    for (const auto& current_setting : _current_settings) {
-        settings[current_setting.first] = current_setting.second.value;
+    for (std::size_t i = 0; i < _parameters.size(); ++i) {
+        settings[_parameters[i].name] = _current_settings[i].value;
     }
 
     return (settings.size() > 0);
@@ -478,42 +573,87 @@ bool CameraDefinition::get_possible_settings(std::unordered_map<std::string, Par
     return get_possible_settings_locked(settings);
 }
 
-bool CameraDefinition::get_possible_settings_locked(
-    std::unordered_map<std::string, ParamValue>& settings)
+void CameraDefinition::change_setting_locked(
+    ParameterIndex index, const ParamValue* new_value, bool needs_updating)
 {
-    settings.clear();
+    apply_exclusions_locked(index, false);
 
-    // Find all exclusions
-    // TODO: use set instead of vector
-    std::vector<std::string> exclusions{};
-
-    for (const auto& parameter : _parameter_map) {
-        for (const auto& option : parameter.second->options) {
-            if (_current_settings[parameter.first].value == option->value) {
-                for (const auto& exclusion : option->exclusions) {
-                    // LogDebug() << "found exclusion for " << parameter.first
-                    //            << "(" << option->value << "): " << exclusion;
-                    exclusions.push_back(exclusion);
-                }
-            }
+    auto& current_setting = _current_settings[index];
+    if (new_value != nullptr) {
+        current_setting.value = *new_value;
+    }
+    current_setting.needs_updating = needs_updating;
+    _active_options[index] = find_active_option(index);
+
+    apply_exclusions_locked(index, true);
+    invalidate_range_targets_locked(index);
+}
+
+std::size_t CameraDefinition::find_active_option(ParameterIndex index) const
+{
+    const auto& value = _current_settings[index].value;
+    const auto& options = _parameters[index].options;
+
+    for (std::size_t i = 0; i < options.size(); ++i) {
+        // Check the type first, ParamValue warns when comparing different types.
+        if (value.is_same_type(options[i].value) && value == options[i].value) {
+            return i;
         }
     }
+    return NO_ACTIVE_OPTION;
+}
 
-    for (const auto& setting : _current_settings) {
-        bool excluded = false;
-        for (const auto& exclusion : exclusions) {
-            if (setting.first == exclusion) {
-                excluded = true;
-            }
+void CameraDefinition::apply_exclusions_locked(ParameterIndex index, bool add)
+{
+    const auto active_option = _active_options[index];
+    if (active_option == NO_ACTIVE_OPTION) {
+        return;
+    }
+
+    const bool is_known = !_current_settings[index].needs_updating;
+
+    for (const auto exclusion : _parameters[index].options[active_option].exclusions) {
+        if (add) {
+            ++_exclusion_counts[exclusion];
+        } else {
+            --_exclusion_counts[exclusion];
         }
-        if (!_parameter_map[setting.first]->is_control) {
+
+        if (!is_known) {
             continue;
         }
 
-        if (excluded) {
+        // Excluded parameters don't restrict the options of others, so these
+        // need to be evaluated again once it changes.
+        if (add) {
+            if (_known_exclusion_counts[exclusion]++ == 0) {
+                invalidate_range_targets_locked(exclusion);
+            }
+        } else {
+            if (--_known_exclusion_counts[exclusion] == 0) {
+                invalidate_range_targets_locked(exclusion);
+            }
+        }
+    }
+}
+
+void CameraDefinition::invalidate_range_targets_locked(ParameterIndex index)
+{
+    for (const auto target : _range_targets[index]) {
+        _possible_options_cache[target].reset();
+    }
+}
+
+bool CameraDefinition::get_possible_settings_locked(
+    std::unordered_map<std::string, ParamValue>& settings)
+{
+    settings.clear();
+
+    for (std::size_t i = 0; i < _parameters.size(); ++i) {
+        if (!_parameters[i].is_control || _exclusion_counts[i] > 0) {
             continue;
         }
-        settings[setting.first] = setting.second.value;
+        settings[_parameters[i].name] = _current_settings[i].value;
     }
 
     return (settings.size() > 0);
@@ -523,55 +663,97 @@ bool CameraDefinition::set_setting(const std::string& name, const ParamValue& va
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    if (_parameter_map.find(name) == _parameter_map.end()) {
-        LogErr() << "Unknown setting to set: " << name;
+    const auto maybe_index = set_setting_locked(name, value);
+    if (!maybe_index) {
         return false;
     }
 
+    // Some param changes cause other params to change, so they need to be updated.
+    // The camera definition just keeps track of these params but the actual param fetching
+    // needs to happen outside of this class.
+    for (const auto update : _parameters[maybe_index.value()].updates) {
+        if (!_current_settings[update].needs_updating) {
+            change_setting_locked(update, nullptr, true);
+        }
+    }
+
+    return true;
+}
+
+bool CameraDefinition::set_settings(const std::map<std::string, ParamValue>& settings)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    bool all_set = true;
+    std::vector<ParameterIndex> changed;
+    changed.reserve(settings.size());
+    for (const auto& setting : settings) {
+        const auto maybe_index = set_setting_locked(setting.first, setting.second);
+        if (!maybe_index) {
+            all_set = false;
+            continue;
+        }
+        changed.push_back(maybe_index.value());
+    }
+
+    // The values were read together, so a param that is updated by another one
+    // of this batch is already current and doesn't need to be fetched again.
+    for (const auto index : changed) {
+        for (const auto update : _parameters[index].updates) {
+            if (!_current_settings[update].needs_updating &&
+                std::find(changed.begin(), changed.end(), update) == changed.end()) {
+                change_setting_locked(update, nullptr, true);
+            }
+        }
+    }
+
+    return all_set;
+}
+
+std::optional<CameraDefinition::ParameterIndex>
+CameraDefinition::set_setting_locked(const std::string& name, const ParamValue& value)
+{
+    const auto maybe_index = find_parameter(name);
+    if (!maybe_index) {
+        LogErr() << "Unknown setting to set: " << name;
+        return {};
+    }
+
+    const auto& parameter = _parameters[maybe_index.value()];
+
     // For range params, we need to verify the range.
-    if (_parameter_map[name]->is_range) {
+    if (parameter.is_range) {
         // Check against the minimum
-        if (value < _parameter_map[name]->options[0]->value) {
+        if (value < parameter.options[0].value) {
             LogErr() << "Chosen value smaller than minimum";
-            return false;
+            return {};
         }
 
-        if (value > _parameter_map[name]->options[1]->value) {
+        if (value > parameter.options[1].value) {
             LogErr() << "Chosen value bigger than maximum";
-            return false;
+            return {};
         }
 
         // TODO: Check step as well, until now we have only seen steps of 1 in the wild though.
     }
 
-    _current_settings[name].value = value;
-    _current_settings[name].needs_updating = false;
-
-    // Some param changes cause other params to change, so they need to be updated.
-    // The camera definition just keeps track of these params but the actual param fetching
-    // needs to happen outside of this class.
-    for (const auto& update : _parameter_map[name]->updates) {
-        if (_current_settings.find(update) == _current_settings.end()) {
-            // LogDebug() << "Update to '" << update << "' not understood.";
-            continue;
-        }
-        _current_settings[update].needs_updating = true;
-    }
-
-    return true;
+    change_setting_locked(maybe_index.value(), &value, false);
+    return maybe_index;
 }
 
 bool CameraDefinition::get_setting(const std::string& name, ParamValue& value)
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    if (_current_settings.find(name) == _current_settings.end()) {
+    const auto maybe_index = find_parameter(name);
+    if (!maybe_index) {
         LogErr() << "Unknown setting to get: " << name;
         return false;
     }
 
-    if (!_current_settings.at(name).needs_updating) {
-        value = _current_settings.at(name).value;
+    const auto& current_setting = _current_settings[maybe_index.value()];
+    if (!current_setting.needs_updating) {
+        value = current_setting.value;
         return true;
     } else {
         return false;
@@ -583,14 +765,15 @@ bool CameraDefinition::get_option_value(
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    if (_parameter_map.find(param_name) == _parameter_map.end()) {
+    const auto maybe_index = find_parameter(param_name);
+    if (!maybe_index) {
         LogErr() << "Unknown parameter to get option: " << param_name;
         return false;
     }
 
-    for (const auto& option : _parameter_map[param_name]->options) {
-        if (option->value == option_value) {
-            value = option->value;
+    for (const auto& option : _parameters[maybe_index.value()].options) {
+        if (option.value == option_value) {
+            value = option.value;
             return true;
         }
     }
@@ -604,13 +787,14 @@ bool CameraDefinition::get_all_options(const std::string& name, std::vector<Para
 
     values.clear();
 
-    if (_parameter_map.find(name) == _parameter_map.end()) {
+    const auto maybe_index = find_parameter(name);
+    if (!maybe_index) {
         LogErr() << "Unknown parameter to get all options";
         return false;
     }
 
-    for (const auto& option : _parameter_map[name]->options) {
-        values.push_back(option->value);
+    for (const auto& option : _parameters[maybe_index.value()].options) {
+        values.push_back(option.value);
     }
 
     return true;
@@ -623,92 +807,67 @@ bool CameraDefinition::get_possible_options(
 
     values.clear();
 
-    if (_parameter_map.find(name) == _parameter_map.end()) {
+    const auto maybe_index = find_parameter(name);
+    if (!maybe_index) {
         LogErr() << "Unknown parameter to get possible options";
         return false;
     }
+    const auto index = maybe_index.value();
 
-    std::unordered_map<std::string, ParamValue> settings;
-    if (!get_possible_settings_locked(settings)) {
-        return false;
-    }
-    if (settings.find(name) == settings.end()) {
+    if (!_parameters[index].is_control || _exclusion_counts[index] > 0) {
         LogErr() << "Setting " << name << " currently not applicable";
         return false;
     }
 
-    // Find all exclusions because excluded parameters need to be neglected for range
-    // check below.
-    // TODO: use set instead of vector
-    std::vector<std::string> exclusions{};
-
-    for (const auto& parameter : _parameter_map) {
-        for (const auto& option : parameter.second->options) {
-            if (_current_settings[parameter.first].needs_updating) {
-                // LogWarn() << parameter.first << " needs updating";
-                continue;
-            }
-            if (_current_settings[parameter.first].value == option->value) {
-                for (const auto& exclusion : option->exclusions) {
-                    // LogDebug() << "found exclusion for " << parameter.first
-                    //            << "(" << option->value << "): " << exclusion;
-                    exclusions.push_back(exclusion);
-                }
-            }
-        }
+    auto& cached_values = _possible_options_cache[index];
+    if (!cached_values) {
+        cached_values = evaluate_possible_options_locked(index);
     }
 
-    // TODO: use set instead of vector for this
-    std::vector<ParamValue> allowed_ranges{};
-
-    // Check allowed ranges.
-    for (const auto& parameter : _parameter_map) {
-        if (!parameter.second->is_control) {
-            continue;
-        }
+    values = cached_values.value();
+    return true;
+}
 
-        bool excluded = false;
-        for (const auto& exclusion : exclusions) {
-            if (parameter.first == exclusion) {
-                excluded = true;
-            }
-        }
-        if (excluded) {
+std::vector<ParamValue> CameraDefinition::evaluate_possible_options_locked(ParameterIndex index)
+{
+    // Collect the values allowed by the options currently set, and intersect
+    // them with our options. Only the parameters with ranges for this one are
+    // looked at.
+    const auto& options = _parameters[index].options;
+    bool found_allowed_ranges = false;
+    std::vector<bool> allowed(options.size(), false);
+
+    for (const auto source : _range_sources[index]) {
+        // Excluded parameters and the ones we don't know the value of are neglected.
+        if (!_parameters[source].is_control || _known_exclusion_counts[source] > 0 ||
+            _current_settings[source].needs_updating ||
+            _active_options[source] == NO_ACTIVE_OPTION) {
             continue;
         }
 
-        for (const auto& option : parameter.second->options) {
-            if (_current_settings[parameter.first].needs_updating) {
-                // LogWarn() << parameter.first << " needs updating";
+        const auto& active_option = _parameters[source].options[_active_options[source]];
+        for (const auto& parameter_range : active_option.parameter_ranges) {
+            if (parameter_range.parameter != index) {
                 continue;
             }
-            // Only look at current set option.
-            if (_current_settings[parameter.first].value == option->value) {
-                // Go through parameter ranges but only concerning the parameter that
-                // we're interested in..
-                if (option->parameter_ranges.find(name) != option->parameter_ranges.end()) {
-                    for (const auto& range : option->parameter_ranges[name]) {
-                        allowed_ranges.push_back(range.second);
+            for (const auto& range_value : parameter_range.values) {
+                found_allowed_ranges = true;
+                for (std::size_t i = 0; i < options.size(); ++i) {
+                    if (options[i].value == range_value) {
+                        allowed[i] = true;
                     }
                 }
             }
         }
     }
 
-    // Intersect
-    for (const auto& option : _parameter_map[name]->options) {
-        bool option_allowed = false;
-        for (const auto& allowed_range : allowed_ranges) {
-            if (option->value == allowed_range) {
-                option_allowed = true;
-            }
-        }
-        if (option_allowed || allowed_ranges.size() == 0) {
-            values.push_back(option->value);
+    std::vector<ParamValue> values;
+    for (std::size_t i = 0; i < options.size(); ++i) {
+        if (allowed[i] || !found_allowed_ranges) {
+            values.push_back(options[i].value);
         }
     }
-
-    return true;
+    return values;
 }
 
 void CameraDefinition::get_unknown_params(std::vector<std::pair<std::string, ParamValue>>& params)
@@ -717,9 +876,9 @@ void CameraDefinition::get_unknown_params(std::vector<std::pair<std::string, Par
 
     params.clear();
 
-    for (const auto& parameter : _parameter_map) {
-        if (_current_settings[parameter.first].needs_updating) {
-            params.push_back(std::make_pair<>(parameter.first, parameter.second->type));
+    for (std::size_t i = 0; i < _parameters.size(); ++i) {
+        if (_current_settings[i].needs_updating) {
+            params.push_back(std::make_pair<>(_parameters[i].name, _parameters[i].type));
         }
     }
 }
@@ -728,8 +887,10 @@ void CameraDefinition::set_all_params_unknown()
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    for (auto& parameter : _parameter_map) {
-        _current_settings[parameter.first].needs_updating = true;
+    for (std::size_t i = 0; i < _parameters.size(); ++i) {
+        if (!_current_settings[i].needs_updating) {
+            change_setting_locked(static_cast<ParameterIndex>(i), nullptr, true);
+        }
     }
 }
 
@@ -737,12 +898,13 @@ bool CameraDefinition::is_setting_range(const std::string& name)
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    if (_parameter_map.find(name) == _parameter_map.end()) {
+    const auto maybe_index = find_parameter(name);
+    if (!maybe_index) {
         LogWarn() << "Setting " << name << " not found.";
         return false;
     }
 
-    return _parameter_map[name]->is_range;
+    return _parameters[maybe_index.value()].is_range;
 }
 
 bool CameraDefinition::get_setting_str(const std::string& name, std::string& description)
@@ -751,12 +913,13 @@ bool CameraDefinition::get_setting_str(const std::string& name, std::string& des
 
     description.clear();
 
-    if (_parameter_map.find(name) == _parameter_map.end()) {
+    const auto maybe_index = find_parameter(name);
+    if (!maybe_index) {
         LogWarn() << "Setting " << name << " not found.";
         return false;
     }
 
-    description = _parameter_map[name]->description;
+    description = _parameters[maybe_index.value()].description;
     return true;
 }
 
@@ -767,16 +930,15 @@ bool CameraDefinition::get_option_str(
 
     description.clear();
 
-    if (_parameter_map.find(setting_name) == _parameter_map.end()) {
+    const auto maybe_index = find_parameter(setting_name);
+    if (!maybe_index) {
         LogWarn() << "Setting " << setting_name << " not found.";
         return false;
     }
 
-    for (const auto& option : _parameter_map[setting_name]->options) {
-        std::stringstream value_ss{};
-        value_ss << option->value;
-        if (option->value == option_name) {
-            description = option->name;
+    for (const auto& option : _parameters[maybe_index.value()].options) {
+        if (option.value == option_name) {
+            description = option.name;
             return true;
         }
     }
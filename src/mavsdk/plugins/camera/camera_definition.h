@@ -2,12 +2,13 @@
 
 #include "mavlink_parameter_sender.h"
 #include <tinyxml2.h>
+#include <map>
 #include <vector>
 #include <memory>
 #include <unordered_map>
 #include <mutex>
+#include <optional>
 #include <string>
-#include <tuple>
 #include <utility>
 
 namespace mavsdk {
@@ -31,6 +32,9 @@ public:
     };
 
     bool set_setting(const std::string& name, const ParamValue& value);
+    // Applies several settings at once, e.g. all params read in one refresh.
+    // Returns false if any of them could not be set.
+    bool set_settings(const std::map<std::string, ParamValue>& settings);
     bool get_setting(const std::string& name, ParamValue& value);
     bool get_all_settings(std::unordered_map<std::string, ParamValue>& settings);
     bool get_possible_settings(std::unordered_map<std::string, ParamValue>& settings);
@@ -56,54 +60,113 @@ public:
 private:
     bool get_possible_settings_locked(std::unordered_map<std::string, ParamValue>& settings);
 
-    typedef std::unordered_map<std::string, ParamValue> parameter_range_t;
+    // Parameters reference each other by their index into _parameters, so
+    // that lookups don't need to hash or compare any strings.
+    using ParameterIndex = uint16_t;
+
+    struct ParameterRange {
+        ParameterIndex parameter{0};
+        std::vector<ParamValue> values{};
+    };
 
     struct Option {
         std::string name{};
         ParamValue value{};
-        std::vector<std::string> exclusions{};
-        std::unordered_map<std::string, parameter_range_t> parameter_ranges{};
+        std::vector<ParameterIndex> exclusions{};
+        std::vector<ParameterRange> parameter_ranges{};
     };
 
     struct Parameter {
+        std::string name{};
         std::string description{};
         bool is_control{false};
         bool is_readonly{false};
         bool is_writeonly{false};
         ParamValue type{}; // for type only, doesn't hold a value
-        std::vector<std::string> updates{};
-        std::vector<std::shared_ptr<Option>> options{};
-        Option default_option{};
+        std::vector<ParameterIndex> updates{};
+        std::vector<Option> options{};
+        ParamValue default_value{};
         bool is_range{false};
     };
 
-    bool parse_xml();
+    // Parameters are referenced by name in the XML, these are resolved to
+    // indices once all parameters are parsed.
+    struct OptionReferences {
+        std::vector<std::string> exclusions{};
+        std::vector<std::pair<std::string, std::vector<ParamValue>>> parameter_ranges{};
+    };
+
+    struct ParameterReferences {
+        std::vector<std::string> updates{};
+        std::vector<OptionReferences> options{};
+    };
 
-    // Until we have std::optional we need to use std::pair to return something that might be
-    // nothing.
-    std::pair<bool, std::vector<std::shared_ptr<Option>>> parse_options(
+    bool parse_xml(const tinyxml2::XMLDocument& doc);
+    bool parse_xml_locked(const tinyxml2::XMLDocument& doc);
+    void clear_locked();
+    void resolve_references(const std::vector<ParameterReferences>& references);
+
+    bool parse_options(
         const tinyxml2::XMLElement* options_handle,
         const std::string& param_name,
-        std::unordered_map<std::string, std::string>& type_map);
-    std::tuple<bool, std::vector<std::shared_ptr<Option>>, Option> parse_range_options(
+        std::unordered_map<std::string, std::string>& type_map,
+        std::vector<Option>& options,
+        std::vector<OptionReferences>& references);
+    bool parse_range_options(
         const tinyxml2::XMLElement* param_handle,
         const std::string& param_name,
-        std::unordered_map<std::string, std::string>& type_map);
-    std::pair<bool, Option> find_default(
-        const std::vector<std::shared_ptr<Option>>& options, const std::string& default_str);
+        std::unordered_map<std::string, std::string>& type_map,
+        std::vector<Option>& options,
+        ParamValue& default_value);
+    static bool find_default(
+        const std::vector<Option>& options,
+        const std::string& default_str,
+        ParamValue& default_value);
+
+    std::optional<ParameterIndex> find_parameter(const std::string& name) const;
+
+    void build_dependencies();
+
+    // Every change of a setting goes through here, so that the exclusions and
+    // the cached possible options are kept up to date incrementally.
+    void
+    change_setting_locked(ParameterIndex index, const ParamValue* new_value, bool needs_updating);
+    std::size_t find_active_option(ParameterIndex index) const;
+    std::optional<ParameterIndex>
+    set_setting_locked(const std::string& name, const ParamValue& value);
+    void apply_exclusions_locked(ParameterIndex index, bool add);
+    void invalidate_range_targets_locked(ParameterIndex index);
+    std::vector<ParamValue> evaluate_possible_options_locked(ParameterIndex index);
 
     mutable std::mutex _mutex{};
 
-    tinyxml2::XMLDocument _doc{};
-
-    std::unordered_map<std::string, std::shared_ptr<Parameter>> _parameter_map{};
+    std::vector<Parameter> _parameters{};
+    std::unordered_map<std::string, ParameterIndex> _parameter_indices{};
 
     struct InternalCurrentSetting {
         ParamValue value{};
         bool needs_updating{false};
     };
 
-    std::unordered_map<std::string, InternalCurrentSetting> _current_settings{};
+    // All of these have the same indices as _parameters.
+    std::vector<InternalCurrentSetting> _current_settings{};
+
+    // The option matching the current value. Options of a parameter have
+    // distinct values, so there is at most one.
+    static constexpr std::size_t NO_ACTIVE_OPTION = static_cast<std::size_t>(-1);
+    std::vector<std::size_t> _active_options{};
+
+    // How many active options exclude a parameter, in total and counting only
+    // the options of settings that are known to be up to date.
+    std::vector<uint16_t> _exclusion_counts{};
+    std::vector<uint16_t> _known_exclusion_counts{};
+
+    // The parameters whose possible options depend on the value of a parameter
+    // through parameter ranges, and the other way round.
+    std::vector<std::vector<ParameterIndex>> _range_targets{};
+    std::vector<std::vector<ParameterIndex>> _range_sources{};
+
+    std::vector<std::optional<std::vector<ParamValue>>> _possible_options_cache{};
 
     std::string _model{};
     std::string _vendor{};
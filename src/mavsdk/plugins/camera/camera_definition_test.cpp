@@ -33,6 +33,51 @@ TEST(CameraDefinition, E90LoadInfoString)
     EXPECT_STREQ(cd.get_model().c_str(), "E90");
 }
 
+TEST(CameraDefinition, BrokenDefinitionLeavesNothingBehind)
+{
+    CameraDefinition cd;
+    ASSERT_TRUE(cd.load_file(e90_unit_test_file));
+
+    // The first parameter is fine, the second one lacks its description.
+    const std::string broken_content = R"(<?xml version="1.0" encoding="UTF-8" ?>
+<mavlinkcamera>
+    <definition version="1">
+        <model>Broken</model>
+        <vendor>Nobody</vendor>
+    </definition>
+    <parameters>
+        <parameter name="CAM_EV" type="float" default="0.0">
+            <description>Exposure Compensation</description>
+            <options>
+                <option name="0" value="0.0" />
+                <option name="+1" value="1.0" />
+            </options>
+        </parameter>
+        <parameter name="CAM_ISO" type="uint32" default="100" />
+    </parameters>
+</mavlinkcamera>
+)";
+    EXPECT_FALSE(cd.load_string(broken_content));
+
+    EXPECT_TRUE(cd.get_model().empty());
+    EXPECT_TRUE(cd.get_vendor().empty());
+
+    std::unordered_map<std::string, ParamValue> settings{};
+    EXPECT_FALSE(cd.get_all_settings(settings));
+    EXPECT_FALSE(cd.get_possible_settings(settings));
+
+    ParamValue value{};
+    EXPECT_FALSE(cd.get_setting("CAM_EV", value));
+    std::vector<ParamValue> options{};
+    EXPECT_FALSE(cd.get_possible_options("CAM_EV", options));
+
+    // It is still usable after a good definition.
+    ASSERT_TRUE(cd.load_file(e90_unit_test_file));
+    cd.assume_default_settings();
+    EXPECT_TRUE(cd.get_all_settings(settings));
+    EXPECT_TRUE(cd.get_possible_options("CAM_EV", options));
+}
+
 TEST(CameraDefinition, E90CheckDefaultSettings)
 {
     // Run this from root.
@@ -275,6 +320,46 @@ TEST(CameraDefinition, E90ShowOptions)
     }
 }
 
+TEST(CameraDefinition, E90PossibleOptionsFollowUnknownSettings)
+{
+    // Run this from root.
+    CameraDefinition cd;
+    ASSERT_TRUE(cd.load_file(e90_unit_test_file));
+
+    cd.assume_default_settings();
+
+    {
+        // Switch to HEVC which restricts VIDRES.
+        ParamValue value;
+        value.set<uint32_t>(3);
+        EXPECT_TRUE(cd.set_setting("CAM_VIDFMT", value));
+
+        std::vector<ParamValue> values;
+        EXPECT_TRUE(cd.get_possible_options("CAM_VIDRES", values));
+        EXPECT_EQ(values.size(), 26);
+    }
+
+    {
+        // A format we don't know doesn't restrict anything.
+        cd.set_all_params_unknown();
+
+        std::vector<ParamValue> values;
+        EXPECT_TRUE(cd.get_possible_options("CAM_VIDRES", values));
+        EXPECT_EQ(values.size(), 32);
+    }
+
+    {
+        // Once it's known again, the restriction is back.
+        ParamValue value;
+        value.set<uint32_t>(3);
+        EXPECT_TRUE(cd.set_setting("CAM_VIDFMT", value));
+
+        std::vector<ParamValue> values;
+        EXPECT_TRUE(cd.get_possible_options("CAM_VIDRES", values));
+        EXPECT_EQ(values.size(), 26);
+    }
+}
+
 TEST(CameraDefinition, E90SettingsToUpdate)
 {
     // Run this from root.
@@ -372,6 +457,51 @@ TEST(CameraDefinition, E90SettingsCauseUpdates)
     }
 }
 
+TEST(CameraDefinition, E90SetSettingsTogether)
+{
+    // Run this from root.
+    CameraDefinition cd;
+    ASSERT_TRUE(cd.load_file(e90_unit_test_file));
+
+    cd.assume_default_settings();
+
+    std::map<std::string, ParamValue> settings;
+    {
+        std::unordered_map<std::string, ParamValue> all_settings;
+        EXPECT_TRUE(cd.get_all_settings(all_settings));
+        settings.insert(all_settings.begin(), all_settings.end());
+    }
+
+    cd.set_all_params_unknown();
+
+    // Setting CAM_MODE on its own would require its updates to be fetched again,
+    // but not if they are part of the same batch.
+    EXPECT_TRUE(cd.set_settings(settings));
+    {
+        std::vector<std::pair<std::string, ParamValue>> params;
+        cd.get_unknown_params(params);
+        EXPECT_EQ(params.size(), 0);
+    }
+
+    {
+        ParamValue value;
+        value.set<uint32_t>(0);
+        std::map<std::string, ParamValue> mode_only{{"CAM_MODE", value}};
+        EXPECT_TRUE(cd.set_settings(mode_only));
+
+        std::vector<std::pair<std::string, ParamValue>> params;
+        cd.get_unknown_params(params);
+        EXPECT_EQ(params.size(), 4);
+    }
+
+    {
+        ParamValue value;
+        value.set<uint32_t>(0);
+        std::map<std::string, ParamValue> unknown_setting{{"CAM_FOO", value}};
+        EXPECT_FALSE(cd.set_settings(unknown_setting));
+    }
+}
+
 TEST(CameraDefinition, E90OptionValues)
 {
     // Run this from root.
@@ -1106,20 +1106,33 @@ void CameraImpl::process_camera_information(const mavlink_message_t& message)
 
         std::thread([this, camera_information]() {
             std::string content{};
-            const auto has_succeeded = fetch_camera_definition(camera_information, content);
+            bool downloaded = false;
+            const auto has_succeeded =
+                fetch_camera_definition(camera_information, content, downloaded);
 
-            if (has_succeeded) {
+            // A definition which can't be parsed is dropped as if it couldn't be fetched.
+            auto camera_definition = std::make_unique<CameraDefinition>();
+            const auto has_parsed = has_succeeded && camera_definition->load_string(content);
+
+            if (has_parsed) {
                 LogDebug() << "Successfully loaded camera definition";
 
+                if (downloaded) {
+                    store_camera_definition(camera_information, content);
+                }
+
                 if (_camera_definition_callback) {
                     _parent->call_user_callback([this]() { _camera_definition_callback(true); });
                 }
 
-                _camera_definition.reset(new CameraDefinition());
-                _camera_definition->load_string(content);
+                _camera_definition = std::move(camera_definition);
                 refresh_params();
             } else {
-                LogDebug() << "Failed to fetch camera definition!";
+                if (has_succeeded) {
+                    LogWarn() << "Failed to parse camera definition!";
+                } else {
+                    LogDebug() << "Failed to fetch camera definition!";
+                }
 
                 if (++_camera_definition_fetch_count >= 3) {
                     LogWarn() << "Giving up fetching the camera definition";
@@ -1147,18 +1160,46 @@ bool CameraImpl::should_fetch_camera_definition(const std::string& uri) const
 }
 
 bool CameraImpl::fetch_camera_definition(
-    const mavlink_camera_information_t& camera_information, std::string& camera_definition_out)
-{
-    auto download_succeeded =
-        download_definition_file(camera_information.cam_definition_uri, camera_definition_out);
+    const mavlink_camera_information_t& camera_information,
+    std::string& camera_definition_out,
+    bool& downloaded_out)
+{
+    const std::string uri(camera_information.cam_definition_uri);
+    downloaded_out = false;
+
+    // The version is bumped whenever the definition changes, so a cached file
+    // with the same version is still up to date. Version 0 means unknown.
+    if (camera_information.cam_definition_version != 0 &&
+        _parent->metadata_cache().load(
+            uri, camera_information.cam_definition_version, camera_definition_out)) {
+        LogInfo() << "Using cached camera definition from: " << uri;
+        return true;
+    }
+
+    auto download_succeeded = download_definition_file(uri, camera_definition_out);
 
     if (download_succeeded) {
+        downloaded_out = true;
         return true;
     }
 
     return load_stored_definition(camera_information, camera_definition_out);
 }
 
+void CameraImpl::store_camera_definition(
+    const mavlink_camera_information_t& camera_information, const std::string& camera_definition)
+{
+    // Without a version we could never tell whether the cached file is outdated.
+    if (camera_information.cam_definition_version == 0) {
+        return;
+    }
+
+    _parent->metadata_cache().store(
+        camera_information.cam_definition_uri,
+        camera_information.cam_definition_version,
+        camera_definition);
+}
+
 bool CameraImpl::download_definition_file(
     const std::string& uri, std::string& camera_definition_out)
 {
@@ -1684,6 +1725,7 @@ void CameraImpl::subscribe_current_settings(const Camera::CurrentSettingsCallbac
     {
         std::lock_guard<std::mutex> lock(_subscribe_current_settings.mutex);
         _subscribe_current_settings.callback = callback;
+        _subscribe_current_settings.last_notified.reset();
     }
     notify_current_settings();
 }
@@ -1694,6 +1736,7 @@ void CameraImpl::subscribe_possible_setting_options(
     {
         std::lock_guard<std::mutex> lock(_subscribe_possible_setting_options.mutex);
         _subscribe_possible_setting_options.callback = callback;
+        _subscribe_possible_setting_options.last_notified.reset();
     }
     notify_possible_setting_options();
 }
@@ -1737,6 +1780,11 @@ void CameraImpl::notify_current_settings()
         }
     }
 
+    if (_subscribe_current_settings.last_notified == current_settings) {
+        return;
+    }
+    _subscribe_current_settings.last_notified = current_settings;
+
     _parent->call_user_callback(
         [temp_callback = _subscribe_current_settings.callback,
          temp_settings = std::move(current_settings)]() { temp_callback(temp_settings); });
@@ -1760,6 +1808,11 @@ void CameraImpl::notify_possible_setting_options()
         return;
     }
 
+    if (_subscribe_possible_setting_options.last_notified == setting_options) {
+        return;
+    }
+    _subscribe_possible_setting_options.last_notified = setting_options;
+
     _parent->call_user_callback([temp_callback = _subscribe_possible_setting_options.callback,
                                  setting_options]() { temp_callback(setting_options); });
 }
@@ -1803,37 +1856,60 @@ void CameraImpl::refresh_params()
         return;
     }
 
-    unsigned count = 0;
+    // All unknown params are requested at once, with several requests in flight, and
+    // applied together when all of them are back. That way the settings are consistent
+    // and subscribers are only notified once per refresh.
+    std::vector<std::string> param_names;
+    param_names.reserve(params.size());
     for (const auto& param : params) {
-        const std::string& param_name = param.first;
-        const ParamValue& param_value_type = param.second;
-        const bool is_last = (count == params.size() - 1);
-        _parent->get_param_async(
-            param_name,
-            param_value_type,
-            [param_name, is_last, this](MavlinkParameterSender::Result result, ParamValue value) {
-                if (result != MavlinkParameterSender::Result::Success) {
-                    return;
-                }
-                // We need to check again by the time this callback runs
-                if (!this->_camera_definition) {
-                    return;
-                }
+        param_names.push_back(param.first);
+    }
 
-                if (!this->_camera_definition->set_setting(param_name, value)) {
-                    return;
-                }
+    _parent->get_params_async(
+        param_names,
+        [params, this](
+            MavlinkParameterSender::Result result, std::map<std::string, ParamValue> values) {
+            if (result != MavlinkParameterSender::Result::Success) {
+                LogWarn() << "Could not refresh all camera params: " << result << " ("
+                          << values.size() << " of " << params.size() << " received)";
+            }
+            apply_refreshed_params(params, values);
+        },
+        this,
+        static_cast<uint8_t>(_camera_id + MAV_COMP_ID_CAMERA),
+        true);
+}
 
-                if (is_last) {
-                    notify_current_settings();
-                    notify_possible_setting_options();
-                }
-            },
-            this,
-            static_cast<uint8_t>(_camera_id + MAV_COMP_ID_CAMERA),
-            true);
-        ++count;
+void CameraImpl::apply_refreshed_params(
+    const std::vector<std::pair<std::string, ParamValue>>& params,
+    const std::map<std::string, ParamValue>& values)
+{
+    // We need to check again by the time this callback runs
+    if (!_camera_definition) {
+        return;
     }
+
+    std::map<std::string, ParamValue> settings;
+    for (const auto& param : params) {
+        const auto it = values.find(param.first);
+        if (it == values.end()) {
+            continue;
+        }
+        if (!it->second.is_same_type(param.second)) {
+            LogWarn() << "Camera param " << param.first << " has unexpected type";
+            continue;
+        }
+        settings.insert(*it);
+    }
+
+    if (settings.empty()) {
+        return;
+    }
+
+    _camera_definition->set_settings(settings);
+
+    notify_current_settings();
+    notify_possible_setting_options();
 }
 
 void CameraImpl::invalidate_params()
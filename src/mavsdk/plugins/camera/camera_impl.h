@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <optional>
 
 #include "camera_definition.h"
 #include "mavlink_include.h"
@@ -144,12 +145,20 @@ private:
 
     bool should_fetch_camera_definition(const std::string& uri) const;
     bool fetch_camera_definition(
-        const mavlink_camera_information_t& camera_information, std::string& camera_definition_out);
+        const mavlink_camera_information_t& camera_information,
+        std::string& camera_definition_out,
+        bool& downloaded_out);
+    void store_camera_definition(
+        const mavlink_camera_information_t& camera_information,
+        const std::string& camera_definition);
     bool download_definition_file(const std::string& uri, std::string& camera_definition_out);
     bool
     load_stored_definition(const mavlink_camera_information_t&, std::string& camera_definition_out);
 
     void refresh_params();
+    void apply_refreshed_params(
+        const std::vector<std::pair<std::string, ParamValue>>& params,
+        const std::map<std::string, ParamValue>& values);
     void invalidate_params();
 
     void save_camera_mode(const float mavlink_camera_mode);
@@ -252,11 +261,14 @@ private:
     struct {
         std::mutex mutex{};
         Camera::CurrentSettingsCallback callback{nullptr};
+        // To skip notifying the same settings again.
+        std::optional<std::vector<Camera::Setting>> last_notified{};
     } _subscribe_current_settings{};
 
     struct {
         std::mutex mutex{};
         Camera::PossibleSettingOptionsCallback callback{nullptr};
+        std::optional<std::vector<Camera::SettingOptions>> last_notified{};
     } _subscribe_possible_setting_options{};
 
     std::condition_variable _captured_request_cv;
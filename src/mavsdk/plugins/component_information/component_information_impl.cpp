@@ -55,13 +55,25 @@ void ComponentInformationImpl::receive_component_information(
     const auto general_metadata_uri = std::string(component_information.general_metadata_uri);
 
     download_file_async(
-        general_metadata_uri, [this](std::string path) { parse_metadata_file(path); });
+        general_metadata_uri,
+        component_information.general_metadata_file_crc,
+        [this](std::string path) { return parse_metadata_file(path); });
 }
 
 void ComponentInformationImpl::download_file_async(
-    const std::string& uri, std::function<void(std::string path)> callback)
+    const std::string& uri, uint32_t crc, std::function<bool(std::string path)> callback)
 {
-    // TODO: check CRC
+    // Without a CRC we can't tell whether the file has changed, so we don't
+    // use the cache in that case.
+    const bool use_cache = crc != 0;
+
+    if (use_cache) {
+        if (const auto maybe_cached_path = _parent->metadata_cache().lookup(uri, crc)) {
+            LogDebug() << "Using cached file for " << uri;
+            callback(maybe_cached_path.value());
+            return;
+        }
+    }
 
     if (uri.empty()) {
         LogErr() << "No component information URI provided";
@@ -78,7 +90,7 @@ void ComponentInformationImpl::download_file_async(
         _parent->mavlink_ftp().download_async(
             path,
             path_to_download,
-            [path_to_download, callback, path](
+            [this, path_to_download, callback, path, uri, crc, use_cache](
                 MavlinkFtp::ClientResult download_result, MavlinkFtp::ProgressData progress_data) {
                 if (download_result == MavlinkFtp::ClientResult::Next) {
                     LogDebug() << "File download progress: " << progress_data.bytes_transferred
@@ -86,8 +98,20 @@ void ComponentInformationImpl::download_file_async(
                 } else {
                     LogDebug() << "File download ended with result " << download_result;
                     if (download_result == MavlinkFtp::ClientResult::Success) {
-                        LogDebug() << "Received file " << path_to_download + "/" + path;
-                        callback(path_to_download + "/" + path);
+                        const auto downloaded_path = path_to_download + "/" + path;
+                        LogDebug() << "Received file " << downloaded_path;
+
+                        // A file which doesn't match its CRC would never be looked up
+                        // again, or worse, be taken for the right one.
+                        const bool cacheable =
+                            use_cache && MetadataCache::file_crc32(downloaded_path) == crc;
+                        if (use_cache && !cacheable) {
+                            LogWarn() << "CRC of " << uri << " does not match, not caching it";
+                        }
+
+                        if (callback(downloaded_path) && cacheable) {
+                            _parent->metadata_cache().store_file(uri, crc, downloaded_path);
+                        }
                     }
                 }
             });
@@ -98,12 +122,12 @@ void ComponentInformationImpl::download_file_async(
     }
 }
 
-void ComponentInformationImpl::parse_metadata_file(const std::string& path)
+bool ComponentInformationImpl::parse_metadata_file(const std::string& path)
 {
     std::ifstream f(path);
     if (f.bad()) {
         LogErr() << "Could not open json metadata file.";
-        return;
+        return false;
     }
 
     Json::Value metadata;
@@ -111,7 +135,7 @@ void ComponentInformationImpl::parse_metadata_file(const std::string& path)
 
     if (!metadata.isMember("version")) {
         LogErr() << "version not found";
-        return;
+        return false;
     }
 
     if (metadata["version"].asInt() != 1) {
@@ -120,35 +144,39 @@ void ComponentInformationImpl::parse_metadata_file(const std::string& path)
 
     if (!metadata.isMember("metadataTypes")) {
         LogErr() << "metadataTypes not found";
-        return;
+        return false;
     }
 
     for (auto& metadata_type : metadata["metadataTypes"]) {
         if (!metadata_type.isMember("type")) {
             LogErr() << "type missing";
-            return;
+            return false;
         }
         if (!metadata_type.isMember("uri")) {
             LogErr() << "uri missing";
-            return;
+            return false;
         }
 
         if (metadata_type["type"].asInt() == COMP_METADATA_TYPE_PARAMETER) {
             download_file_async(
-                metadata_type["uri"].asString(), [this](const std::string& parameter_file_path) {
+                metadata_type["uri"].asString(),
+                metadata_type.isMember("fileCrc") ? metadata_type["fileCrc"].asUInt() : 0,
+                [this](const std::string& parameter_file_path) {
                     LogDebug() << "Found parameter file at: " << parameter_file_path;
-                    parse_parameter_file(parameter_file_path);
+                    return parse_parameter_file(parameter_file_path);
                 });
         }
     }
+
+    return true;
 }
 
-void ComponentInformationImpl::parse_parameter_file(const std::string& path)
+bool ComponentInformationImpl::parse_parameter_file(const std::string& path)
 {
     std::ifstream f(path);
     if (f.bad()) {
         LogErr() << "Could not open json parameter file.";
-        return;
+        return false;
     }
 
     Json::Value parameters;
@@ -156,7 +184,7 @@ void ComponentInformationImpl::parse_parameter_file(const std::string& path)
 
     if (!parameters.isMember("version")) {
         LogErr() << "version not found";
-        return;
+        return false;
     }
 
     if (parameters["version"].asInt() != 1) {
@@ -165,7 +193,7 @@ void ComponentInformationImpl::parse_parameter_file(const std::string& path)
 
     if (!parameters.isMember("parameters")) {
         LogErr() << "parameters not found";
-        return;
+        return false;
     }
 
     std::lock_guard<std::mutex> lock(_mutex);
@@ -174,7 +202,7 @@ void ComponentInformationImpl::parse_parameter_file(const std::string& path)
     for (auto& param : parameters["parameters"]) {
         if (!param.isMember("type")) {
             LogErr() << "type not found";
-            return;
+            return false;
         }
 
         if (param["type"].asString() == "Float") {
@@ -205,6 +233,8 @@ void ComponentInformationImpl::parse_parameter_file(const std::string& path)
             LogWarn() << "Ignoring type " << param["type"].asString() << " for now.";
         }
     }
+
+    return true;
 }
 
 void ComponentInformationImpl::get_float_param_result(
@@ -26,10 +26,11 @@ private:
     void receive_component_information(
         MavlinkCommandSender::Result result, const mavlink_message_t& message);
 
-    void
-    download_file_async(const std::string& uri, std::function<void(std::string path)> callback);
-    void parse_metadata_file(const std::string& path);
-    void parse_parameter_file(const std::string& path);
+    // The callback returns whether the file could be used, only then it is cached.
+    void download_file_async(
+        const std::string& uri, uint32_t crc, std::function<bool(std::string path)> callback);
+    bool parse_metadata_file(const std::string& path);
+    bool parse_parameter_file(const std::string& path);
 
     void get_float_param_result(
         const std::string& name, MavlinkParameterSender::Result result, float value);
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <functional>
+#include <map>
+#include <vector>
 
 // This plugin provides/includes the mavlink 2.0 header files.
 #include "mavlink_include.h"
@@ -65,6 +69,7 @@ public:
         CommandDenied, /**< @brief Command has been denied. */
         CommandUnsupported, /**< @brief Command is not supported. */
         CommandTimeout, /**< @brief A timeout happened. */
+        RateMismatch, /**< @brief A different message rate than requested was reported. */
     };
 
     /**
@@ -145,6 +150,187 @@ public:
     void subscribe_message_async(
         uint16_t message_id, std::function<void(const mavlink_message_t&)> callback);
 
+    /**
+     * @brief Subscribe to messages using message ID, with the callback called
+     * directly on the receive path.
+     *
+     * Unlike subscribe_message_async, the message is not copied into the user
+     * callback queue, so there is no allocation per message. The callback holds
+     * up the processing of all received messages: it needs to return quickly and
+     * must not call any blocking MAVSDK functions or (un)subscribe to messages.
+     * To stop the subscription, call this method with `nullptr` as the argument.
+     *
+     * @param message_id The MAVLink message ID.
+     * @param callback Callback to be called for message subscription.
+     */
+    void subscribe_message_sync(
+        uint16_t message_id, std::function<void(const mavlink_message_t&)> callback);
+
+    /**
+     * @brief Collect messages with the given IDs in a queue, to be taken out with poll_messages.
+     *
+     * The queue is allocated once with a fixed capacity, so receiving a message
+     * only copies it into the queue. This is meant for bridges or recorders which
+     * consume many messages at full rate and can drain them in batches. If the
+     * queue is full, messages are dropped and counted.
+     *
+     * Calling this again replaces the queue, an empty list of IDs stops it.
+     *
+     * @param message_ids The MAVLink message IDs to collect.
+     * @param capacity Number of messages the queue can hold, rounded up to a power of two.
+     */
+    void subscribe_message_queue(
+        const std::vector<uint16_t>& message_ids, std::size_t capacity = 1024);
+
+    /**
+     * @brief Take the oldest messages out of the queue set up with subscribe_message_queue.
+     *
+     * This must only be called from one thread at a time.
+     *
+     * @param messages Array to copy the messages into.
+     * @param max_count Size of the array.
+     *
+     * @return the number of messages copied.
+     */
+    std::size_t poll_messages(mavlink_message_t* messages, std::size_t max_count);
+
+    /**
+     * @brief Get the number of messages dropped because the queue was full.
+     *
+     * @return the number of dropped messages since the queue was set up.
+     */
+    uint64_t dropped_queued_messages() const;
+
+    /**
+     * @brief Filter for raw frame subscriptions.
+     *
+     * An empty list means that all IDs are accepted.
+     */
+    struct RawFrameFilter {
+        std::vector<uint32_t> message_ids{}; /**< @brief Message IDs to include. */
+        std::vector<uint8_t> system_ids{}; /**< @brief System IDs to include. */
+    };
+
+    /**
+     * @brief Batch of raw MAVLink frames.
+     *
+     * The frames are stored back to back in `data`, exactly as received
+     * on the wire, and `frame_lengths` can be used to split them.
+     */
+    struct RawFrameBatch {
+        std::vector<uint8_t> data{}; /**< @brief Serialized frames. */
+        std::vector<uint32_t> frame_lengths{}; /**< @brief Length of each frame in bytes. */
+        std::vector<uint64_t> timestamps_us{}; /**< @brief Receive time of each frame (Unix
+                                                  epoch) in microseconds. */
+    };
+
+    /**
+     * @brief Callback type for subscribe_raw_frames_async.
+     */
+    using RawFramesCallback = std::function<void(const RawFrameBatch&)>;
+
+    /**
+     * @brief Subscribe to raw MAVLink frames, delivered in batches.
+     *
+     * This is meant for consumers which need every frame such as recorders
+     * or bridges. Instead of one callback per message, the frames are
+     * collected and delivered together, once either the batch is full or
+     * the oldest frame in it has waited for `max_batch_latency_s`.
+     *
+     * Frames from all systems are considered, use the filter to limit them.
+     * To stop the subscription, call this method with `nullptr` as the callback.
+     *
+     * @param filter Message and system IDs to include.
+     * @param callback Callback to be called with each batch.
+     * @param max_frames_per_batch Maximum number of frames in one batch.
+     * @param max_batch_latency_s Maximum time a frame waits before its batch is delivered.
+     */
+    void subscribe_raw_frames_async(
+        const RawFrameFilter& filter,
+        RawFramesCallback callback,
+        unsigned max_frames_per_batch = 64,
+        double max_batch_latency_s = 0.05);
+
+    /**
+     * @brief Handle of a raw frame subscription made with subscribe_raw_frames.
+     */
+    using RawFramesHandle = uint64_t;
+
+    /**
+     * @brief Subscribe to raw MAVLink frames, delivered in batches.
+     *
+     * Like subscribe_raw_frames_async, but any number of these subscriptions
+     * can exist at the same time, each one is stopped with its own handle.
+     *
+     * @param filter Message and system IDs to include.
+     * @param callback Callback to be called with each batch.
+     * @param max_frames_per_batch Maximum number of frames in one batch.
+     * @param max_batch_latency_s Maximum time a frame waits before its batch is delivered.
+     *
+     * @return the handle to pass to unsubscribe_raw_frames.
+     */
+    RawFramesHandle subscribe_raw_frames(
+        const RawFrameFilter& filter,
+        RawFramesCallback callback,
+        unsigned max_frames_per_batch = 64,
+        double max_batch_latency_s = 0.05);
+
+    /**
+     * @brief Stop a raw frame subscription made with subscribe_raw_frames.
+     *
+     * @param handle Handle returned by subscribe_raw_frames.
+     */
+    void unsubscribe_raw_frames(RawFramesHandle handle);
+
+    /**
+     * @brief Result of setting the rate of one message.
+     */
+    struct MessageRateResult {
+        Result result{Result::Unknown}; /**< @brief Success if the autopilot confirmed the rate,
+                                           CommandDenied if it denied the command, RateMismatch
+                                           if it kept reporting a different rate,
+                                           CommandUnsupported if it does not support the
+                                           command, or CommandTimeout if it did not report
+                                           any. */
+        double applied_rate_hz{0.0}; /**< @brief Rate reported by the autopilot (0 if not
+                                        available, -1 if disabled). */
+    };
+
+    /**
+     * @brief Callback type for set_message_rates_async.
+     */
+    using MessageRatesCallback = std::function<void(std::map<uint16_t, MessageRateResult>)>;
+
+    /**
+     * @brief Set the rates of several messages at once.
+     *
+     * All MAV_CMD_SET_MESSAGE_INTERVAL commands are sent at the same time
+     * instead of one after the other, and the applied rates are verified
+     * using the MESSAGE_INTERVAL responses. Messages which are not confirmed
+     * are retried.
+     *
+     * @param rates_hz Map of message ID to rate in Hz (0 for the default rate, -1 to disable).
+     * @param target_compid Component ID to send the commands to.
+     *
+     * @return result for each message.
+     */
+    std::map<uint16_t, MessageRateResult> set_message_rates(
+        const std::map<uint16_t, double>& rates_hz, uint8_t target_compid = MAV_COMP_ID_AUTOPILOT1);
+
+    /**
+     * @brief Set the rates of several messages at once, asynchronously.
+     *
+     * @see set_message_rates
+     *
+     * @param rates_hz Map of message ID to rate in Hz (0 for the default rate, -1 to disable).
+     * @param callback Callback to be called with the result for each message.
+     * @param target_compid Component ID to send the commands to.
+     */
+    void set_message_rates_async(
+        const std::map<uint16_t, double>& rates_hz,
+        const MessageRatesCallback& callback,
+        uint8_t target_compid = MAV_COMP_ID_AUTOPILOT1);
+
     /**
      * @brief Get our own system ID.
      *
@@ -36,6 +36,66 @@ void MavlinkPassthrough::subscribe_message_async(
     _impl->subscribe_message_async(message_id, callback);
 }
 
+void MavlinkPassthrough::subscribe_message_sync(
+    uint16_t message_id, std::function<void(const mavlink_message_t&)> callback)
+{
+    _impl->subscribe_message_sync(message_id, callback);
+}
+
+void MavlinkPassthrough::subscribe_message_queue(
+    const std::vector<uint16_t>& message_ids, std::size_t capacity)
+{
+    _impl->subscribe_message_queue(message_ids, capacity);
+}
+
+std::size_t MavlinkPassthrough::poll_messages(mavlink_message_t* messages, std::size_t max_count)
+{
+    return _impl->poll_messages(messages, max_count);
+}
+
+uint64_t MavlinkPassthrough::dropped_queued_messages() const
+{
+    return _impl->dropped_queued_messages();
+}
+
+void MavlinkPassthrough::subscribe_raw_frames_async(
+    const RawFrameFilter& filter,
+    RawFramesCallback callback,
+    unsigned max_frames_per_batch,
+    double max_batch_latency_s)
+{
+    _impl->subscribe_raw_frames_async(
+        filter, callback, max_frames_per_batch, max_batch_latency_s);
+}
+
+MavlinkPassthrough::RawFramesHandle MavlinkPassthrough::subscribe_raw_frames(
+    const RawFrameFilter& filter,
+    RawFramesCallback callback,
+    unsigned max_frames_per_batch,
+    double max_batch_latency_s)
+{
+    return _impl->subscribe_raw_frames(filter, callback, max_frames_per_batch, max_batch_latency_s);
+}
+
+void MavlinkPassthrough::unsubscribe_raw_frames(RawFramesHandle handle)
+{
+    _impl->unsubscribe_raw_frames(handle);
+}
+
+std::map<uint16_t, MavlinkPassthrough::MessageRateResult> MavlinkPassthrough::set_message_rates(
+    const std::map<uint16_t, double>& rates_hz, uint8_t target_compid)
+{
+    return _impl->set_message_rates(rates_hz, target_compid);
+}
+
+void MavlinkPassthrough::set_message_rates_async(
+    const std::map<uint16_t, double>& rates_hz,
+    const MessageRatesCallback& callback,
+    uint8_t target_compid)
+{
+    _impl->set_message_rates_async(rates_hz, callback, target_compid);
+}
+
 std::ostream& operator<<(std::ostream& str, MavlinkPassthrough::Result const& result)
 {
     switch (result) {
@@ -47,6 +107,8 @@ std::ostream& operator<<(std::ostream& str, MavlinkPassthrough::Result const& re
             return str << "Success";
         case MavlinkPassthrough::Result::ConnectionError:
             return str << "Connection Error";
+        case MavlinkPassthrough::Result::RateMismatch:
+            return str << "Rate Mismatch";
     }
 }
 
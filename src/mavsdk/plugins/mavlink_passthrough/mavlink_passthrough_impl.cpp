@@ -27,6 +27,10 @@ void MavlinkPassthroughImpl::deinit()
     _parent->intercept_incoming_messages(nullptr);
     _parent->intercept_outgoing_messages(nullptr);
     _parent->unregister_all_mavlink_message_handlers(this);
+    _parent->unregister_all_mavlink_message_handlers(&_sync_message_cookie);
+    _parent->unsubscribe_raw_frames(this);
+    unsubscribe_all_raw_frames();
+    unsubscribe_message_queue();
 }
 
 void MavlinkPassthroughImpl::enable() {}
@@ -124,6 +128,222 @@ void MavlinkPassthroughImpl::subscribe_message_async(
     }
 }
 
+void MavlinkPassthroughImpl::subscribe_message_sync(
+    uint16_t message_id, std::function<void(const mavlink_message_t&)> callback)
+{
+    // A cookie of its own, so that it doesn't replace or remove the async
+    // subscription to the same message.
+    if (callback == nullptr) {
+        _parent->unregister_mavlink_message_handler(message_id, &_sync_message_cookie);
+    } else {
+        _parent->register_mavlink_message_handler(message_id, callback, &_sync_message_cookie);
+    }
+}
+
+void MavlinkPassthroughImpl::subscribe_message_queue(
+    const std::vector<uint16_t>& message_ids, std::size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(_message_queue_mutex);
+
+    unsubscribe_message_queue_locked();
+
+    if (message_ids.empty() || capacity == 0) {
+        return;
+    }
+
+    _message_queue = std::make_unique<SpscRing<mavlink_message_t>>(capacity);
+    _message_queue_dropped = 0;
+
+    // All handlers are called one after the other with the message handler
+    // locked, so there is only ever one producer, whichever link received it.
+    for (const auto message_id : message_ids) {
+        _parent->register_mavlink_message_handler(
+            message_id,
+            [this](const mavlink_message_t& message) {
+                if (!_message_queue->push(message)) {
+                    ++_message_queue_dropped;
+                }
+            },
+            &_message_queue);
+    }
+}
+
+void MavlinkPassthroughImpl::unsubscribe_message_queue()
+{
+    std::lock_guard<std::mutex> lock(_message_queue_mutex);
+    unsubscribe_message_queue_locked();
+}
+
+void MavlinkPassthroughImpl::unsubscribe_message_queue_locked()
+{
+    // Once this returns, no handler is running anymore, so the queue can go.
+    _parent->unregister_all_mavlink_message_handlers(&_message_queue);
+    _message_queue.reset();
+}
+
+std::size_t
+MavlinkPassthroughImpl::poll_messages(mavlink_message_t* messages, std::size_t max_count)
+{
+    std::lock_guard<std::mutex> lock(_message_queue_mutex);
+
+    if (!_message_queue) {
+        return 0;
+    }
+    return _message_queue->pop(messages, max_count);
+}
+
+uint64_t MavlinkPassthroughImpl::dropped_queued_messages() const
+{
+    return _message_queue_dropped;
+}
+
+void MavlinkPassthroughImpl::subscribe_raw_frames_async(
+    const MavlinkPassthrough::RawFrameFilter& filter,
+    const MavlinkPassthrough::RawFramesCallback& callback,
+    unsigned max_frames_per_batch,
+    double max_batch_latency_s)
+{
+    if (callback == nullptr) {
+        _parent->unsubscribe_raw_frames(this);
+        return;
+    }
+
+    subscribe_raw_frames_with_cookie(
+        this, filter, callback, max_frames_per_batch, max_batch_latency_s);
+}
+
+MavlinkPassthrough::RawFramesHandle MavlinkPassthroughImpl::subscribe_raw_frames(
+    const MavlinkPassthrough::RawFrameFilter& filter,
+    const MavlinkPassthrough::RawFramesCallback& callback,
+    unsigned max_frames_per_batch,
+    double max_batch_latency_s)
+{
+    if (callback == nullptr) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(_raw_frames_mutex);
+
+    const auto handle = _next_raw_frames_handle++;
+    const auto& cookie = *_raw_frames_handles.insert(handle).first;
+    subscribe_raw_frames_with_cookie(
+        &cookie, filter, callback, max_frames_per_batch, max_batch_latency_s);
+
+    return handle;
+}
+
+void MavlinkPassthroughImpl::unsubscribe_raw_frames(MavlinkPassthrough::RawFramesHandle handle)
+{
+    std::lock_guard<std::mutex> lock(_raw_frames_mutex);
+
+    auto it = _raw_frames_handles.find(handle);
+    if (it == _raw_frames_handles.end()) {
+        return;
+    }
+    _parent->unsubscribe_raw_frames(&(*it));
+    _raw_frames_handles.erase(it);
+}
+
+void MavlinkPassthroughImpl::unsubscribe_all_raw_frames()
+{
+    std::lock_guard<std::mutex> lock(_raw_frames_mutex);
+
+    for (const auto& handle : _raw_frames_handles) {
+        _parent->unsubscribe_raw_frames(&handle);
+    }
+    _raw_frames_handles.clear();
+}
+
+void MavlinkPassthroughImpl::subscribe_raw_frames_with_cookie(
+    const void* cookie,
+    const MavlinkPassthrough::RawFrameFilter& filter,
+    const MavlinkPassthrough::RawFramesCallback& callback,
+    unsigned max_frames_per_batch,
+    double max_batch_latency_s)
+{
+    MavlinkFrameBatcher::Filter batcher_filter{};
+    batcher_filter.message_ids = filter.message_ids;
+    batcher_filter.system_ids = filter.system_ids;
+
+    auto temp_callback = callback;
+    _parent->subscribe_raw_frames(
+        cookie,
+        batcher_filter,
+        max_frames_per_batch,
+        max_batch_latency_s,
+        [this, temp_callback](MavlinkFrameBatcher::Batch batch) {
+            // The batch is moved into a shared pointer, so the frames don't get
+            // copied again on the way through the user callback queue.
+            auto raw_frame_batch = std::make_shared<MavlinkPassthrough::RawFrameBatch>();
+            raw_frame_batch->data = std::move(batch.data);
+            raw_frame_batch->frame_lengths = std::move(batch.frame_lengths);
+            raw_frame_batch->timestamps_us = std::move(batch.timestamps_us);
+
+            _parent->call_user_callback(
+                [temp_callback, raw_frame_batch]() { temp_callback(*raw_frame_batch); });
+        });
+}
+
+std::map<uint16_t, MavlinkPassthrough::MessageRateResult> MavlinkPassthroughImpl::set_message_rates(
+    const std::map<uint16_t, double>& rates_hz, uint8_t target_compid)
+{
+    return to_message_rate_results(_parent->set_msg_rates(rates_hz, target_compid));
+}
+
+void MavlinkPassthroughImpl::set_message_rates_async(
+    const std::map<uint16_t, double>& rates_hz,
+    const MavlinkPassthrough::MessageRatesCallback& callback,
+    uint8_t target_compid)
+{
+    auto temp_callback = callback;
+    _parent->set_msg_rates_async(
+        rates_hz,
+        [this, temp_callback](const MessageRateConfigurator::ResultTable& results) {
+            if (temp_callback == nullptr) {
+                return;
+            }
+            auto message_rate_results = to_message_rate_results(results);
+            _parent->call_user_callback([temp_callback, message_rate_results]() {
+                temp_callback(message_rate_results);
+            });
+        },
+        target_compid);
+}
+
+std::map<uint16_t, MavlinkPassthrough::MessageRateResult>
+MavlinkPassthroughImpl::to_message_rate_results(const MessageRateConfigurator::ResultTable& results)
+{
+    std::map<uint16_t, MavlinkPassthrough::MessageRateResult> message_rate_results;
+
+    for (const auto& result : results) {
+        auto& message_rate_result = message_rate_results[result.first];
+        message_rate_result.applied_rate_hz = result.second.applied_rate_hz;
+
+        switch (result.second.result) {
+            case MessageRateConfigurator::Result::Success:
+                message_rate_result.result = MavlinkPassthrough::Result::Success;
+                break;
+            case MessageRateConfigurator::Result::Mismatch:
+                message_rate_result.result = MavlinkPassthrough::Result::RateMismatch;
+                break;
+            case MessageRateConfigurator::Result::Denied:
+                message_rate_result.result = MavlinkPassthrough::Result::CommandDenied;
+                break;
+            case MessageRateConfigurator::Result::Unsupported:
+                message_rate_result.result = MavlinkPassthrough::Result::CommandUnsupported;
+                break;
+            case MessageRateConfigurator::Result::Timeout:
+                message_rate_result.result = MavlinkPassthrough::Result::CommandTimeout;
+                break;
+            case MessageRateConfigurator::Result::ConnectionError:
+                message_rate_result.result = MavlinkPassthrough::Result::ConnectionError;
+                break;
+        }
+    }
+
+    return message_rate_results;
+}
+
 uint8_t MavlinkPassthroughImpl::get_our_sysid() const
 {
     return _parent->get_own_system_id();
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <set>
+#include <vector>
 
 #include "mavlink_include.h"
 #include "plugins/mavlink_passthrough/mavlink_passthrough.h"
 #include "plugin_impl_base.h"
+#include "spsc_ring.h"
 
 namespace mavsdk {
 
@@ -26,6 +31,33 @@ public:
 
     void subscribe_message_async(
         uint16_t message_id, std::function<void(const mavlink_message_t&)> callback);
+    void subscribe_message_sync(
+        uint16_t message_id, std::function<void(const mavlink_message_t&)> callback);
+
+    void subscribe_message_queue(const std::vector<uint16_t>& message_ids, std::size_t capacity);
+    std::size_t poll_messages(mavlink_message_t* messages, std::size_t max_count);
+    uint64_t dropped_queued_messages() const;
+
+    void subscribe_raw_frames_async(
+        const MavlinkPassthrough::RawFrameFilter& filter,
+        const MavlinkPassthrough::RawFramesCallback& callback,
+        unsigned max_frames_per_batch,
+        double max_batch_latency_s);
+
+    MavlinkPassthrough::RawFramesHandle subscribe_raw_frames(
+        const MavlinkPassthrough::RawFrameFilter& filter,
+        const MavlinkPassthrough::RawFramesCallback& callback,
+        unsigned max_frames_per_batch,
+        double max_batch_latency_s);
+    void unsubscribe_raw_frames(MavlinkPassthrough::RawFramesHandle handle);
+
+    std::map<uint16_t, MavlinkPassthrough::MessageRateResult>
+    set_message_rates(const std::map<uint16_t, double>& rates_hz, uint8_t target_compid);
+
+    void set_message_rates_async(
+        const std::map<uint16_t, double>& rates_hz,
+        const MavlinkPassthrough::MessageRatesCallback& callback,
+        uint8_t target_compid);
 
     uint8_t get_our_sysid() const;
     uint8_t get_our_compid() const;
@@ -38,6 +70,35 @@ public:
 private:
     static MavlinkPassthrough::Result
     to_mavlink_passthrough_result_from_mavlink_commands_result(MavlinkCommandSender::Result result);
+
+    static std::map<uint16_t, MavlinkPassthrough::MessageRateResult>
+    to_message_rate_results(const MessageRateConfigurator::ResultTable& results);
+
+    void unsubscribe_message_queue();
+    void unsubscribe_message_queue_locked();
+
+    void subscribe_raw_frames_with_cookie(
+        const void* cookie,
+        const MavlinkPassthrough::RawFrameFilter& filter,
+        const MavlinkPassthrough::RawFramesCallback& callback,
+        unsigned max_frames_per_batch,
+        double max_batch_latency_s);
+    void unsubscribe_all_raw_frames();
+
+    // Only its address is used, as the cookie of the sync message subscriptions.
+    const char _sync_message_cookie{0};
+
+    // Filled on the receive path and drained by poll_messages. Replacing it
+    // takes this mutex, after the handlers filling it are unregistered.
+    std::mutex _message_queue_mutex{};
+    std::unique_ptr<SpscRing<mavlink_message_t>> _message_queue{};
+    std::atomic<uint64_t> _message_queue_dropped{0};
+
+    // The set entries are the cookies of the raw frame subscriptions, their
+    // addresses stay the same while they are in the set.
+    std::mutex _raw_frames_mutex{};
+    std::set<MavlinkPassthrough::RawFramesHandle> _raw_frames_handles{};
+    MavlinkPassthrough::RawFramesHandle _next_raw_frames_handle{1};
 };
 
 } // namespace mavsdk
@@ -3,19 +3,40 @@
 #include "unused.h"
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <string>
 
 namespace mavsdk {
 
 using MissionItem = Mission::MissionItem;
 using CameraAction = Mission::MissionItem::CameraAction;
 
+namespace {
+
+bool upload_only_changes_from_env()
+{
+    // Uploads then only send the items which differ from the vehicle's copy,
+    // using partial writes, which doesn't reset the mission progress.
+    if (const char* env_p = std::getenv("MAVSDK_MISSION_UPLOAD_ONLY_CHANGES")) {
+        if (std::string(env_p) == "1") {
+            LogDebug() << "Mission uploads only send changed items.";
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
 MissionImpl::MissionImpl(System& system) : PluginImplBase(system)
 {
+    _upload_only_changes = upload_only_changes_from_env();
     _parent->register_plugin(this);
 }
 
 MissionImpl::MissionImpl(std::shared_ptr<System> system) : PluginImplBase(std::move(system))
 {
+    _upload_only_changes = upload_only_changes_from_env();
     _parent->register_plugin(this);
 }
 
@@ -58,6 +79,9 @@ void MissionImpl::disable()
 {
     reset_mission_progress();
     _gimbal_protocol = GimbalProtocol::Unknown;
+
+    // Whatever happened meanwhile, the vehicle's mission is not known anymore.
+    _parent->mission_transfer().forget_vehicle_items(MAV_MISSION_TYPE_MISSION);
 }
 
 void MissionImpl::deinit()
@@ -152,17 +176,23 @@ void MissionImpl::upload_mission_async(
     wait_for_protocol_async([callback, mission_plan, this]() {
         const auto int_items = convert_to_int_items(mission_plan.mission_items);
 
-        _mission_data.last_upload = _parent->mission_transfer().upload_items_async(
-            MAV_MISSION_TYPE_MISSION,
-            int_items,
-            [this, callback](MavlinkMissionTransfer::Result result) {
-                auto converted_result = convert_result(result);
-                _parent->call_user_callback([callback, converted_result]() {
-                    if (callback) {
-                        callback(converted_result);
-                    }
-                });
+        const auto transfer_callback = [this, callback](MavlinkMissionTransfer::Result result) {
+            auto converted_result = convert_result(result);
+            _parent->call_user_callback([callback, converted_result]() {
+                if (callback) {
+                    callback(converted_result);
+                }
             });
+        };
+
+        auto& mission_transfer = _parent->mission_transfer();
+        if (_upload_only_changes) {
+            _mission_data.last_upload = mission_transfer.update_items_async(
+                MAV_MISSION_TYPE_MISSION, int_items, transfer_callback);
+        } else {
+            _mission_data.last_upload = mission_transfer.upload_items_async(
+                MAV_MISSION_TYPE_MISSION, int_items, transfer_callback);
+        }
     });
 }
 
@@ -144,6 +144,9 @@ private:
     void* _gimbal_protocol_cookie{nullptr};
     enum class GimbalProtocol { Unknown, V1, V2 };
     std::atomic<GimbalProtocol> _gimbal_protocol{GimbalProtocol::Unknown};
+
+    // Set with MAVSDK_MISSION_UPLOAD_ONLY_CHANGES, see the constructor.
+    bool _upload_only_changes{false};
 };
 
 } // namespace mavsdk
@@ -0,0 +1,465 @@
+#include "json_reader.h"
+
+#include <array>
+#include <clocale>
+#include <cstdint>
+#include <cstdlib>
+
+namespace mavsdk {
+
+namespace {
+
+bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// Powers of ten which are exact as double.
+constexpr std::array<double, 23> exact_powers_of_ten = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+} // namespace
+
+JsonReader::JsonReader(const std::string& json) :
+    _begin(json.data()),
+    _pos(json.data()),
+    _end(json.data() + json.size())
+{}
+
+JsonReader::Token JsonReader::next()
+{
+    skip_whitespace();
+
+    switch (_state) {
+        case State::Value:
+            return read_value();
+
+        case State::ObjectFirst:
+            if (_pos < _end && *_pos == '}') {
+                return end_container('{');
+            }
+            return read_key();
+
+        case State::ObjectNext:
+            if (_pos < _end && *_pos == '}') {
+                return end_container('{');
+            }
+            if (_pos == _end || *_pos != ',') {
+                return fail("expected ',' or '}'");
+            }
+            ++_pos;
+            skip_whitespace();
+            return read_key();
+
+        case State::ArrayFirst:
+            if (_pos < _end && *_pos == ']') {
+                return end_container('[');
+            }
+            return read_value();
+
+        case State::ArrayNext:
+            if (_pos < _end && *_pos == ']') {
+                return end_container('[');
+            }
+            if (_pos == _end || *_pos != ',') {
+                return fail("expected ',' or ']'");
+            }
+            ++_pos;
+            skip_whitespace();
+            return read_value();
+
+        case State::Done:
+            if (!_error.empty()) {
+                return Token::Error;
+            }
+            if (_pos != _end) {
+                return fail("unexpected data after the document");
+            }
+            return Token::End;
+    }
+
+    return fail("invalid state");
+}
+
+bool JsonReader::skip(Token first)
+{
+    if (first == Token::Key) {
+        first = next();
+    }
+
+    if (first != Token::ObjectBegin && first != Token::ArrayBegin) {
+        return first != Token::Error && first != Token::End && first != Token::ObjectEnd &&
+               first != Token::ArrayEnd;
+    }
+
+    const auto depth = _containers.size();
+    while (_containers.size() >= depth) {
+        const auto token = next();
+        if (token == Token::Error || token == Token::End) {
+            return false;
+        }
+    }
+    return true;
+}
+
+JsonReader::Token JsonReader::read_value()
+{
+    if (_pos == _end) {
+        return fail("unexpected end of document");
+    }
+
+    switch (*_pos) {
+        case '{':
+            ++_pos;
+            _containers.push_back('{');
+            _state = State::ObjectFirst;
+            return Token::ObjectBegin;
+
+        case '[':
+            ++_pos;
+            _containers.push_back('[');
+            _state = State::ArrayFirst;
+            return Token::ArrayBegin;
+
+        case '"':
+            if (!read_string()) {
+                return Token::Error;
+            }
+            after_value();
+            return Token::String;
+
+        case 't':
+            return read_literal("true", Token::True);
+
+        case 'f':
+            return read_literal("false", Token::False);
+
+        case 'n':
+            return read_literal("null", Token::Null);
+
+        default:
+            if (!read_number()) {
+                return Token::Error;
+            }
+            after_value();
+            return Token::Number;
+    }
+}
+
+JsonReader::Token JsonReader::read_key()
+{
+    if (_pos == _end || *_pos != '"') {
+        return fail("expected a key");
+    }
+    if (!read_string()) {
+        return Token::Error;
+    }
+
+    skip_whitespace();
+    if (_pos == _end || *_pos != ':') {
+        return fail("expected ':'");
+    }
+    ++_pos;
+
+    _state = State::Value;
+    return Token::Key;
+}
+
+JsonReader::Token JsonReader::read_literal(std::string_view literal, Token token)
+{
+    if (static_cast<std::size_t>(_end - _pos) < literal.size() ||
+        std::string_view(_pos, literal.size()) != literal) {
+        return fail("invalid literal");
+    }
+    _pos += literal.size();
+    after_value();
+    return token;
+}
+
+bool JsonReader::read_string()
+{
+    // Skip the opening quote.
+    const char* begin = ++_pos;
+
+    // Without escapes, the string can be handed out as it is.
+    while (_pos < _end && *_pos != '"' && *_pos != '\\') {
+        if (static_cast<unsigned char>(*_pos) < 0x20) {
+            fail("control character in string");
+            return false;
+        }
+        ++_pos;
+    }
+    if (_pos == _end) {
+        fail("unterminated string");
+        return false;
+    }
+    if (*_pos == '"') {
+        _string = std::string_view(begin, static_cast<std::size_t>(_pos - begin));
+        ++_pos;
+        return true;
+    }
+
+    _unescaped.assign(begin, _pos);
+    while (_pos < _end && *_pos != '"') {
+        if (static_cast<unsigned char>(*_pos) < 0x20) {
+            fail("control character in string");
+            return false;
+        }
+        if (*_pos != '\\') {
+            _unescaped.push_back(*_pos++);
+            continue;
+        }
+
+        if (++_pos == _end) {
+            break;
+        }
+        switch (*_pos++) {
+            case '"':
+                _unescaped.push_back('"');
+                break;
+            case '\\':
+                _unescaped.push_back('\\');
+                break;
+            case '/':
+                _unescaped.push_back('/');
+                break;
+            case 'b':
+                _unescaped.push_back('\b');
+                break;
+            case 'f':
+                _unescaped.push_back('\f');
+                break;
+            case 'n':
+                _unescaped.push_back('\n');
+                break;
+            case 'r':
+                _unescaped.push_back('\r');
+                break;
+            case 't':
+                _unescaped.push_back('\t');
+                break;
+            case 'u': {
+                unsigned code_point = 0;
+                for (unsigned i = 0; i < 4; ++i) {
+                    const int value = (_pos < _end) ? hex_value(*_pos++) : -1;
+                    if (value < 0) {
+                        fail("invalid unicode escape");
+                        return false;
+                    }
+                    code_point = (code_point << 4) | static_cast<unsigned>(value);
+                }
+                if (!append_utf8(code_point)) {
+                    return false;
+                }
+                break;
+            }
+            default:
+                fail("invalid escape");
+                return false;
+        }
+    }
+    if (_pos == _end) {
+        fail("unterminated string");
+        return false;
+    }
+
+    _string = _unescaped;
+    ++_pos;
+    return true;
+}
+
+bool JsonReader::append_utf8(unsigned code_point)
+{
+    // A high surrogate needs to be followed by a low one.
+    if (code_point >= 0xd800 && code_point <= 0xdbff) {
+        if (_end - _pos < 6 || _pos[0] != '\\' || _pos[1] != 'u') {
+            fail("invalid surrogate pair");
+            return false;
+        }
+        unsigned low = 0;
+        for (unsigned i = 2; i < 6; ++i) {
+            const int value = hex_value(_pos[i]);
+            if (value < 0) {
+                fail("invalid unicode escape");
+                return false;
+            }
+            low = (low << 4) | static_cast<unsigned>(value);
+        }
+        if (low < 0xdc00 || low > 0xdfff) {
+            fail("invalid surrogate pair");
+            return false;
+        }
+        _pos += 6;
+        code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+    } else if (code_point >= 0xdc00 && code_point <= 0xdfff) {
+        fail("invalid surrogate pair");
+        return false;
+    }
+
+    if (code_point < 0x80) {
+        _unescaped.push_back(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+        _unescaped.push_back(static_cast<char>(0xc0 | (code_point >> 6)));
+        _unescaped.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+    } else if (code_point < 0x10000) {
+        _unescaped.push_back(static_cast<char>(0xe0 | (code_point >> 12)));
+        _unescaped.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+        _unescaped.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+    } else {
+        _unescaped.push_back(static_cast<char>(0xf0 | (code_point >> 18)));
+        _unescaped.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3f)));
+        _unescaped.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+        _unescaped.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+    }
+    return true;
+}
+
+bool JsonReader::read_number()
+{
+    const char* begin = _pos;
+    const bool negative = (*_pos == '-');
+    if (negative) {
+        ++_pos;
+    }
+
+    // Up to 19 digits fit in the mantissa, more go to strtod.
+    uint64_t mantissa = 0;
+    int num_digits = 0;
+    int exponent = 0;
+
+    if (_pos == _end || !is_digit(*_pos)) {
+        fail("invalid value");
+        return false;
+    }
+    if (*_pos == '0') {
+        ++_pos;
+    } else {
+        while (_pos < _end && is_digit(*_pos)) {
+            if (num_digits < 19) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*_pos - '0');
+            } else {
+                ++exponent;
+            }
+            ++num_digits;
+            ++_pos;
+        }
+    }
+
+    if (_pos < _end && *_pos == '.') {
+        ++_pos;
+        if (_pos == _end || !is_digit(*_pos)) {
+            fail("invalid number");
+            return false;
+        }
+        while (_pos < _end && is_digit(*_pos)) {
+            if (num_digits < 19) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*_pos - '0');
+                --exponent;
+            }
+            ++num_digits;
+            ++_pos;
+        }
+    }
+
+    if (_pos < _end && (*_pos == 'e' || *_pos == 'E')) {
+        ++_pos;
+        bool negative_exponent = false;
+        if (_pos < _end && (*_pos == '+' || *_pos == '-')) {
+            negative_exponent = (*_pos == '-');
+            ++_pos;
+        }
+        if (_pos == _end || !is_digit(*_pos)) {
+            fail("invalid number");
+            return false;
+        }
+        int explicit_exponent = 0;
+        while (_pos < _end && is_digit(*_pos)) {
+            if (explicit_exponent < 10000) {
+                explicit_exponent = explicit_exponent * 10 + (*_pos - '0');
+            }
+            ++_pos;
+        }
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+
+    // If mantissa and power of ten are exact, so is the result, which is the common case.
+    if (num_digits <= 19 && mantissa <= (uint64_t(1) << 53) && exponent >= -22 &&
+        exponent <= 22) {
+        const auto value = static_cast<double>(mantissa);
+        const auto power = exact_powers_of_ten[static_cast<std::size_t>(std::abs(exponent))];
+        _number = (exponent < 0) ? value / power : value * power;
+        if (negative) {
+            _number = -_number;
+        }
+        return true;
+    }
+
+    // Otherwise strtod rounds correctly, but it expects the decimal point of the locale.
+    std::string number(begin, _pos);
+    const char decimal_point = *std::localeconv()->decimal_point;
+    if (decimal_point != '.') {
+        for (auto& c : number) {
+            if (c == '.') {
+                c = decimal_point;
+            }
+        }
+    }
+    _number = std::strtod(number.c_str(), nullptr);
+    return true;
+}
+
+JsonReader::Token JsonReader::end_container(char expected)
+{
+    if (_containers.empty() || _containers.back() != expected) {
+        return fail("mismatched brackets");
+    }
+    ++_pos;
+    _containers.pop_back();
+    after_value();
+    return (expected == '{') ? Token::ObjectEnd : Token::ArrayEnd;
+}
+
+void JsonReader::after_value()
+{
+    if (_containers.empty()) {
+        _state = State::Done;
+    } else if (_containers.back() == '{') {
+        _state = State::ObjectNext;
+    } else {
+        _state = State::ArrayNext;
+    }
+}
+
+void JsonReader::skip_whitespace()
+{
+    while (_pos < _end && (*_pos == ' ' || *_pos == '\n' || *_pos == '\r' || *_pos == '\t')) {
+        ++_pos;
+    }
+}
+
+JsonReader::Token JsonReader::fail(const char* reason)
+{
+    if (_error.empty()) {
+        _error = std::string(reason) + " at offset " + std::to_string(_pos - _begin);
+    }
+    _state = State::Done;
+    _containers.clear();
+    return Token::Error;
+}
+
+} // namespace mavsdk
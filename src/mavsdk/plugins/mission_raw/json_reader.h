@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mavsdk {
+
+// Pull parser for a JSON document which hands out one token at a time.
+//
+// Nothing is kept of the document except the nesting, so the caller can write
+// values straight to where they are needed instead of going through a DOM.
+// The document has to outlive the reader.
+class JsonReader {
+public:
+    enum class Token {
+        ObjectBegin,
+        ObjectEnd,
+        ArrayBegin,
+        ArrayEnd,
+        Key,
+        String,
+        Number,
+        True,
+        False,
+        Null,
+        End,
+        Error,
+    };
+
+    explicit JsonReader(const std::string& json);
+    ~JsonReader() = default;
+
+    Token next();
+
+    // Skips the rest of a value of which the first token was just returned.
+    // Returns false on a parse error.
+    bool skip(Token first);
+
+    // Skips the next value, e.g. the one after a key.
+    bool skip_value() { return skip(next()); }
+
+    // Content of the last Key or String token, valid until the next call.
+    [[nodiscard]] std::string_view string() const { return _string; }
+
+    // Value of the last Number token.
+    [[nodiscard]] double number() const { return _number; }
+
+    [[nodiscard]] const std::string& error() const { return _error; }
+
+    // Non-copyable
+    JsonReader(const JsonReader&) = delete;
+    const JsonReader& operator=(const JsonReader&) = delete;
+
+private:
+    enum class State {
+        Value,
+        ObjectFirst,
+        ObjectNext,
+        ArrayFirst,
+        ArrayNext,
+        Done,
+    };
+
+    Token read_value();
+    Token read_key();
+    Token read_literal(std::string_view literal, Token token);
+    bool read_string();
+    bool read_number();
+    bool append_utf8(unsigned code_point);
+    Token end_container(char expected);
+    void after_value();
+    void skip_whitespace();
+    Token fail(const char* reason);
+
+    const char* const _begin;
+    const char* _pos;
+    const char* const _end;
+
+    State _state{State::Value};
+    std::vector<char> _containers{};
+
+    std::string_view _string{};
+    // Only used for strings with escapes, others point into the document.
+    std::string _unescaped{};
+    double _number{0.0};
+    std::string _error{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,96 @@
+#include "json_reader.h"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace mavsdk;
+using Token = JsonReader::Token;
+
+static std::vector<Token> tokens(const std::string& json)
+{
+    JsonReader reader(json);
+    std::vector<Token> result;
+    for (auto token = reader.next();; token = reader.next()) {
+        result.push_back(token);
+        if (token == Token::End || token == Token::Error) {
+            break;
+        }
+    }
+    return result;
+}
+
+TEST(JsonReader, ReadsAllTokens)
+{
+    const std::string json = R"({"a": [1, -2.5e3, "x", true, false, null], "b": {}, "c": []})";
+
+    EXPECT_EQ(
+        tokens(json),
+        (std::vector<Token>{
+            Token::ObjectBegin,
+            Token::Key,
+            Token::ArrayBegin,
+            Token::Number,
+            Token::Number,
+            Token::String,
+            Token::True,
+            Token::False,
+            Token::Null,
+            Token::ArrayEnd,
+            Token::Key,
+            Token::ObjectBegin,
+            Token::ObjectEnd,
+            Token::Key,
+            Token::ArrayBegin,
+            Token::ArrayEnd,
+            Token::ObjectEnd,
+            Token::End}));
+}
+
+TEST(JsonReader, ReadsNumbersAndStrings)
+{
+    const std::string json =
+        R"([47.397705960554916, -0.125, 1e-3, 12345678901234567890, "a\"b\u00e9\ud83d\ude00"])";
+    JsonReader reader(json);
+
+    ASSERT_EQ(reader.next(), Token::ArrayBegin);
+    ASSERT_EQ(reader.next(), Token::Number);
+    EXPECT_EQ(reader.number(), 47.397705960554916);
+    ASSERT_EQ(reader.next(), Token::Number);
+    EXPECT_EQ(reader.number(), -0.125);
+    ASSERT_EQ(reader.next(), Token::Number);
+    EXPECT_EQ(reader.number(), 1e-3);
+    ASSERT_EQ(reader.next(), Token::Number);
+    EXPECT_EQ(reader.number(), 12345678901234567890.0);
+    ASSERT_EQ(reader.next(), Token::String);
+    EXPECT_EQ(reader.string(), "a\"b\xc3\xa9\xf0\x9f\x98\x80");
+    EXPECT_EQ(reader.next(), Token::ArrayEnd);
+    EXPECT_EQ(reader.next(), Token::End);
+}
+
+TEST(JsonReader, SkipsValues)
+{
+    const std::string json = R"({"skip": {"a": [1, {"b": [[]]}]}, "keep": 3})";
+    JsonReader reader(json);
+
+    ASSERT_EQ(reader.next(), Token::ObjectBegin);
+    ASSERT_EQ(reader.next(), Token::Key);
+    EXPECT_EQ(reader.string(), "skip");
+    EXPECT_TRUE(reader.skip_value());
+    ASSERT_EQ(reader.next(), Token::Key);
+    EXPECT_EQ(reader.string(), "keep");
+    ASSERT_EQ(reader.next(), Token::Number);
+    EXPECT_EQ(reader.number(), 3.0);
+    EXPECT_EQ(reader.next(), Token::ObjectEnd);
+    EXPECT_EQ(reader.next(), Token::End);
+}
+
+TEST(JsonReader, RejectsInvalidDocuments)
+{
+    for (const std::string json :
+         {"", "{", "[1 2]", "[1,]", "{\"a\" 1}", "{\"a\": 1,}", "[01]", "[1.]", "[tru]",
+          "\"abc", "[\"\\x\"]", "[1]]", "{\"a\": 1} x", "[\"\\ud800\"]", "[-]", "[0x10]"}) {
+        const auto result = tokens(json);
+        EXPECT_EQ(result.back(), Token::Error) << json;
+    }
+}
@@ -0,0 +1,194 @@
+#include "mission_export.h"
+#include "mavlink_include.h"
+#include <algorithm>
+#include <array>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream> // for `std::stringstream`
+
+namespace mavsdk {
+
+namespace {
+
+// Enough for the longest item: 7 numbers and the fixed keys.
+constexpr std::size_t max_item_len = 384;
+
+char* write_string(char* buffer, const char* str)
+{
+    const auto len = std::strlen(str);
+    std::memcpy(buffer, str, len);
+    return buffer + len;
+}
+
+// JSON needs a '.', whatever the locale says.
+char* fix_decimal_point(char* begin, int len)
+{
+    const char decimal_point = *std::localeconv()->decimal_point;
+    if (decimal_point != '.') {
+        std::replace(begin, begin + len, decimal_point, '.');
+    }
+    return begin + len;
+}
+
+} // namespace
+
+void MissionExport::write_plan(
+    std::ostream& stream, const std::vector<MissionRaw::MissionItem>& mission_items)
+{
+    // QGroundControl wants a planned home position, the first global item is as good as any.
+    std::array<char, 128> home{};
+    int32_t home_lat_e7 = 0;
+    int32_t home_lon_e7 = 0;
+    for (const auto& item : mission_items) {
+        if (item.mission_type == MAV_MISSION_TYPE_MISSION && (item.x != 0 || item.y != 0) &&
+            item.frame != MAV_FRAME_MISSION) {
+            home_lat_e7 = item.x;
+            home_lon_e7 = item.y;
+            break;
+        }
+    }
+    char* end = write_degrees(home.data(), home_lat_e7);
+    end = write_string(end, ", ");
+    end = write_degrees(end, home_lon_e7);
+    *end = '\0';
+
+    stream << "{\n"
+           << "    \"fileType\": \"Plan\",\n"
+           << "    \"geoFence\": {\n"
+           << "        \"circles\": [],\n"
+           << "        \"polygons\": [],\n"
+           << "        \"version\": 2\n"
+           << "    },\n"
+           << "    \"groundStation\": \"MAVSDK\",\n"
+           << "    \"mission\": {\n"
+           << "        \"firmwareType\": " << MAV_AUTOPILOT_GENERIC << ",\n"
+           << "        \"items\": [";
+
+    std::array<char, max_item_len> buffer{};
+    bool first = true;
+    unsigned jump_id = 1;
+    for (const auto& item : mission_items) {
+        if (item.mission_type != MAV_MISSION_TYPE_MISSION) {
+            continue;
+        }
+        char* item_end = write_string(buffer.data(), first ? "\n" : ",\n");
+        item_end = write_item(item_end, item, jump_id++);
+        stream.write(buffer.data(), item_end - buffer.data());
+        first = false;
+    }
+
+    stream << (first ? "" : "\n        ") << "],\n"
+           << "        \"plannedHomePosition\": [" << home.data() << ", 0],\n"
+           << "        \"vehicleType\": " << MAV_TYPE_GENERIC << ",\n"
+           << "        \"version\": 2\n"
+           << "    },\n"
+           << "    \"rallyPoints\": {\n"
+           << "        \"points\": [],\n"
+           << "        \"version\": 2\n"
+           << "    },\n"
+           << "    \"version\": 1\n"
+           << "}\n";
+}
+
+std::string MissionExport::to_json(const std::vector<MissionRaw::MissionItem>& mission_items)
+{
+    std::stringstream stream;
+    write_plan(stream, mission_items);
+    return stream.str();
+}
+
+char* MissionExport::write_item(char* buffer, const MissionRaw::MissionItem& item, unsigned jump_id)
+{
+    buffer = write_string(buffer, "            {\"autoContinue\": ");
+    buffer = write_string(buffer, item.autocontinue != 0 ? "true" : "false");
+    buffer = write_string(buffer, ", \"command\": ");
+    buffer = write_uint(buffer, item.command);
+    buffer = write_string(buffer, ", \"doJumpId\": ");
+    buffer = write_uint(buffer, jump_id);
+    buffer = write_string(buffer, ", \"frame\": ");
+    buffer = write_uint(buffer, item.frame);
+    buffer = write_string(buffer, ", \"params\": [");
+
+    for (const float param : {item.param1, item.param2, item.param3, item.param4}) {
+        buffer = write_float(buffer, param);
+        buffer = write_string(buffer, ", ");
+    }
+    buffer = write_degrees(buffer, item.x);
+    buffer = write_string(buffer, ", ");
+    buffer = write_degrees(buffer, item.y);
+    buffer = write_string(buffer, ", ");
+    buffer = write_float(buffer, item.z);
+
+    return write_string(buffer, "], \"type\": \"SimpleItem\"}");
+}
+
+char* MissionExport::write_float(char* buffer, float value)
+{
+    if (!std::isfinite(value)) {
+        return write_string(buffer, "null");
+    }
+
+    // Most params are whole numbers, which don't need printf.
+    if (std::fabs(value) < 1e7f && std::trunc(value) == value) {
+        if (std::signbit(value)) {
+            *buffer++ = '-';
+        }
+        return write_uint(buffer, static_cast<uint32_t>(std::fabs(value)));
+    }
+
+    // The short form is enough for most values, otherwise 9 digits always read back the same.
+    int len = std::sprintf(buffer, "%g", static_cast<double>(value));
+    if (std::strtof(buffer, nullptr) != value) {
+        len = std::sprintf(buffer, "%.9g", static_cast<double>(value));
+    }
+    return fix_decimal_point(buffer, len);
+}
+
+char* MissionExport::write_degrees(char* buffer, int32_t value_e7)
+{
+    // Written as exact decimal, so the import gets back the same integer when it
+    // multiplies with 1e7 and rounds.
+    const int64_t value = value_e7;
+    const auto magnitude = static_cast<uint64_t>(value < 0 ? -value : value);
+    if (value < 0) {
+        *buffer++ = '-';
+    }
+    buffer = write_uint(buffer, static_cast<uint32_t>(magnitude / 10000000));
+
+    auto fraction = static_cast<uint32_t>(magnitude % 10000000);
+    if (fraction == 0) {
+        return buffer;
+    }
+
+    *buffer++ = '.';
+    unsigned num_digits = 7;
+    while (fraction % 10 == 0) {
+        fraction /= 10;
+        --num_digits;
+    }
+    for (unsigned i = num_digits; i > 0; --i) {
+        buffer[i - 1] = static_cast<char>('0' + fraction % 10);
+        fraction /= 10;
+    }
+    return buffer + num_digits;
+}
+
+char* MissionExport::write_uint(char* buffer, uint32_t value)
+{
+    char digits[10];
+    unsigned num_digits = 0;
+    do {
+        digits[num_digits++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    while (num_digits > 0) {
+        *buffer++ = digits[--num_digits];
+    }
+    return buffer;
+}
+
+} // namespace mavsdk
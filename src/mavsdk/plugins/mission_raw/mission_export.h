@@ -0,0 +1,30 @@
+#pragma once
+
+#include "plugins/mission_raw/mission_raw.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace mavsdk {
+
+// Export of mission items, e.g. a downloaded mission, as QGroundControl .plan.
+//
+// Items are formatted one by one straight into the stream, without building a
+// JSON document first. The result can be read back with MissionImport.
+class MissionExport {
+public:
+    // Only items of the mission type are written, fence and rally items are left out.
+    static void
+    write_plan(std::ostream& stream, const std::vector<MissionRaw::MissionItem>& mission_items);
+
+    static std::string to_json(const std::vector<MissionRaw::MissionItem>& mission_items);
+
+private:
+    static char* write_item(char* buffer, const MissionRaw::MissionItem& item, unsigned jump_id);
+    static char* write_float(char* buffer, float value);
+    static char* write_degrees(char* buffer, int32_t value_e7);
+    static char* write_uint(char* buffer, uint32_t value);
+};
+
+} // namespace mavsdk
@@ -0,0 +1,85 @@
+#include <cmath>
+#include <fstream> // for `std::ifstream`
+#include <sstream> // for `std::stringstream`
+#include <string>
+#include <gtest/gtest.h>
+
+#include "mavlink_include.h"
+#include "plugins/mission_raw/mission_raw.h"
+#include "mission_export.h"
+#include "mission_import.h"
+
+using namespace mavsdk;
+
+static std::string read_test_plan(const std::string& name)
+{
+    std::ifstream file(std::string("src/mavsdk/plugins/mission_raw/test_plans/") + name);
+    std::stringstream buf;
+    buf << file.rdbuf();
+    return buf.str();
+}
+
+TEST(MissionRaw, ExportedPlanImportsTheSame)
+{
+    for (const auto& name :
+         {"qgroundcontrol_sample.plan", "qgroundcontrol_sample_with_survey.plan"}) {
+        const auto imported = MissionImport::parse_json(read_test_plan(name));
+        ASSERT_EQ(imported.first, MissionRaw::Result::Success) << name;
+        ASSERT_FALSE(imported.second.mission_items.empty()) << name;
+
+        const auto reimported =
+            MissionImport::parse_json(MissionExport::to_json(imported.second.mission_items));
+        EXPECT_EQ(reimported.first, MissionRaw::Result::Success) << name;
+        EXPECT_EQ(reimported.second.mission_items, imported.second.mission_items) << name;
+    }
+}
+
+TEST(MissionRaw, ExportKeepsExactValues)
+{
+    std::vector<MissionRaw::MissionItem> items;
+    items.push_back(
+        {0,
+         MAV_FRAME_GLOBAL_RELATIVE_ALT,
+         MAV_CMD_NAV_WAYPOINT,
+         1,
+         1,
+         0.1f,
+         1e-8f,
+         -123456.789f,
+         NAN,
+         -899999999,
+         1799999999,
+         12.345f,
+         MAV_MISSION_TYPE_MISSION});
+    items.push_back(
+        {1,
+         MAV_FRAME_MISSION,
+         MAV_CMD_DO_SET_CAM_TRIGG_DIST,
+         0,
+         0,
+         25.0f,
+         0.0f,
+         1.0f,
+         0.0f,
+         0,
+         0,
+         0.0f,
+         MAV_MISSION_TYPE_MISSION});
+
+    // Fence items are not part of the mission.
+    auto fence_item = items[1];
+    fence_item.mission_type = MAV_MISSION_TYPE_FENCE;
+    auto with_fence = items;
+    with_fence.push_back(fence_item);
+
+    const auto result = MissionImport::parse_json(MissionExport::to_json(with_fence));
+    EXPECT_EQ(result.first, MissionRaw::Result::Success);
+    EXPECT_EQ(result.second.mission_items, items);
+}
+
+TEST(MissionRaw, ExportEmptyMission)
+{
+    const auto result = MissionImport::parse_json(MissionExport::to_json({}));
+    EXPECT_EQ(result.first, MissionRaw::Result::Success);
+    EXPECT_TRUE(result.second.mission_items.empty());
+}
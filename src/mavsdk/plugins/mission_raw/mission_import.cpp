@@ -2,220 +2,495 @@
 #include "mission_import.h"
 #include "mavlink_include.h"
 #include <cmath> // for `std::round`
-#include <sstream> // for `std::stringstream`
 
 namespace mavsdk {
 
+namespace {
+
+MissionRaw::MissionItem empty_mission_item()
+{
+    // Params which are null or missing are NAN, or 0 for the integer ones.
+    MissionRaw::MissionItem item{};
+    item.param1 = NAN;
+    item.param2 = NAN;
+    item.param3 = NAN;
+    item.param4 = NAN;
+    item.z = NAN;
+    item.mission_type = MAV_MISSION_TYPE_MISSION;
+    return item;
+}
+
+} // namespace
+
 std::pair<MissionRaw::Result, MissionRaw::MissionImportData>
 MissionImport::parse_json(const std::string& raw_json)
 {
-    Json::CharReaderBuilder builder;
-    const std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
-    Json::Value root;
-    JSONCPP_STRING err;
+    MissionRaw::MissionImportData import_data;
+    // Items are written in place, so make sure the vector never has to grow.
+    import_data.mission_items.reserve(max_num_items(raw_json));
 
-    if (!reader->parse(raw_json.c_str(), raw_json.c_str() + raw_json.length(), &root, &err)) {
-        LogErr() << "Parse error: " << err;
+    JsonReader reader(raw_json);
+    if (!import_plan(reader, import_data.mission_items)) {
         return {MissionRaw::Result::FailedToParseQgcPlan, {}};
     }
 
-    if (!check_overall_version(root)) {
-        return {MissionRaw::Result::FailedToParseQgcPlan, {}};
+    return {MissionRaw::Result::Success, std::move(import_data)};
+}
+
+bool MissionImport::import_plan(JsonReader& reader, std::vector<MissionRaw::MissionItem>& items)
+{
+    if (reader.next() != JsonReader::Token::ObjectBegin) {
+        LogErr() << "Parse error: "
+                 << (reader.error().empty() ? "no JSON object" : reader.error());
+        return false;
     }
 
-    auto maybe_mission_items = import_mission(root);
-    if (!maybe_mission_items.has_value()) {
-        return {MissionRaw::Result::FailedToParseQgcPlan, {}};
+    // The keys can come in any order, QGroundControl sorts them alphabetically,
+    // so the versions are only checked at the end.
+    std::optional<double> overall_version;
+    bool mission_found = false;
+
+    auto token = reader.next();
+    for (; token == JsonReader::Token::Key; token = reader.next()) {
+        const auto key = reader.string();
+        if (key == "version") {
+            overall_version = read_number(reader);
+        } else if (key == "mission") {
+            mission_found = true;
+            if (!import_mission(reader, items)) {
+                return false;
+            }
+        } else if (!reader.skip_value()) {
+            break;
+        }
     }
 
-    MissionRaw::MissionImportData import_data;
-    import_data.mission_items = maybe_mission_items.value();
-    return {MissionRaw::Result::Success, import_data};
-}
+    if (token != JsonReader::Token::ObjectEnd || reader.next() != JsonReader::Token::End) {
+        LogErr() << "Parse error: " << reader.error();
+        return false;
+    }
 
-bool MissionImport::check_overall_version(const Json::Value& root)
-{
     const auto supported_overall_version = 1;
-    const auto overall_version = root["version"];
-    if (overall_version.empty() || overall_version.asInt() != supported_overall_version) {
-        LogErr() << "Overall .plan version not supported, found version: " << overall_version
+    if (!is_version(overall_version, supported_overall_version)) {
+        LogErr() << "Overall .plan version not supported, found version: "
+                 << (overall_version.has_value() ? std::to_string(overall_version.value()) :
+                                                   "none")
                  << ", supported: " << supported_overall_version;
         return false;
     }
 
+    // We need a mission part.
+    if (!mission_found) {
+        LogErr() << "No mission found in .plan.";
+        return false;
+    }
+
     return true;
 }
 
-std::optional<std::vector<MissionRaw::MissionItem>>
-MissionImport::import_mission(const Json::Value& root)
+bool MissionImport::import_mission(JsonReader& reader, std::vector<MissionRaw::MissionItem>& items)
 {
-    // We need a mission part.
-    const auto mission = root["mission"];
-    if (mission.empty()) {
+    auto token = reader.next();
+    if (token != JsonReader::Token::ObjectBegin) {
+        reader.skip(token);
         LogErr() << "No mission found in .plan.";
-        return std::nullopt;
+        return false;
+    }
+
+    std::optional<double> mission_version;
+
+    for (token = reader.next(); token == JsonReader::Token::Key; token = reader.next()) {
+        const auto key = reader.string();
+        if (key == "version") {
+            mission_version = read_number(reader);
+
+        } else if (key == "items") {
+            auto item_token = reader.next();
+            if (item_token != JsonReader::Token::ArrayBegin) {
+                if (!reader.skip(item_token)) {
+                    break;
+                }
+                continue;
+            }
+
+            for (item_token = reader.next(); item_token == JsonReader::Token::ObjectBegin;
+                 item_token = reader.next()) {
+                if (!import_mission_item(reader, items)) {
+                    return false;
+                }
+            }
+
+            if (item_token != JsonReader::Token::ArrayEnd) {
+                if (item_token != JsonReader::Token::Error) {
+                    LogErr() << "Mission item is not an object.";
+                    return false;
+                }
+                break;
+            }
+
+        } else if (!reader.skip_value()) {
+            break;
+        }
+    }
+
+    if (token != JsonReader::Token::ObjectEnd) {
+        LogErr() << "Parse error: " << reader.error();
+        return false;
     }
 
     // Check the mission version.
     const auto supported_mission_version = 2;
-    const auto mission_version = mission["version"];
-    if (mission_version.empty() || mission_version.asInt() != supported_mission_version) {
+    if (!is_version(mission_version, supported_mission_version)) {
         LogErr() << "mission version for .plan not supported, found version: "
-                 << mission_version.asInt() << ", supported: " << supported_mission_version;
-        return std::nullopt;
+                 << mission_version.value_or(0.0) << ", supported: " << supported_mission_version;
+        return false;
     }
 
-    std::vector<MissionRaw::MissionItem> mission_items;
+    // Mark first item as current
+    if (!items.empty()) {
+        items[0].current = 1;
+    }
 
-    // Go through items
-    for (const auto& json_item : mission["items"]) {
-        const auto type = json_item["type"];
+    // Returning an empty vector is ok here if there were really no mission items.
+    return true;
+}
 
-        if (!type.isNull() && type.asString() == "SimpleItem") {
-            const auto maybe_item = import_simple_mission_item(json_item);
-            if (maybe_item.has_value()) {
-                mission_items.push_back(maybe_item.value());
-            } else {
-                return std::nullopt;
+bool MissionImport::import_mission_item(
+    JsonReader& reader, std::vector<MissionRaw::MissionItem>& items)
+{
+    // Whether this is a simple or a complex item is only known once the type
+    // shows up, so both are collected until then. Survey items go straight to
+    // the end of the mission and are dropped again if it isn't a survey.
+    auto item = empty_mission_item();
+    SimpleItemFields fields;
+    const auto first_survey_item = items.size();
+
+    std::optional<std::string> type;
+    std::optional<std::string> complex_item_type;
+    std::optional<double> complex_item_version;
+    bool transect_style_found = false;
+    bool survey_items_found = false;
+
+    auto token = reader.next();
+    for (; token == JsonReader::Token::Key; token = reader.next()) {
+        const auto key = reader.string();
+        if (key == "type") {
+            type = read_string(reader);
+
+        } else if (key == "complexItemType") {
+            complex_item_type = read_string(reader);
+
+        } else if (key == "version") {
+            complex_item_version = read_number(reader);
+
+        } else if (key == "TransectStyleComplexItem") {
+            auto transect_token = reader.next();
+            if (transect_token != JsonReader::Token::ObjectBegin) {
+                if (!reader.skip(transect_token)) {
+                    break;
+                }
+                continue;
             }
 
-        } else if (!type.isNull() && type.asString() == "ComplexItem") {
-            const auto maybe_items = import_complex_mission_items(json_item);
-            if (maybe_items.has_value()) {
-                mission_items.insert(
-                    mission_items.end(), maybe_items.value().begin(), maybe_items.value().end());
-            } else {
-                return std::nullopt;
+            transect_style_found = true;
+            for (transect_token = reader.next(); transect_token == JsonReader::Token::Key;
+                 transect_token = reader.next()) {
+                // These are Items (capitalized!) inside the TransectStyleComplexItem.
+                if (reader.string() == "Items") {
+                    if (!import_survey_items(reader, items, survey_items_found)) {
+                        break;
+                    }
+                } else if (!reader.skip_value()) {
+                    break;
+                }
+            }
+            if (transect_token != JsonReader::Token::ObjectEnd) {
+                break;
             }
 
-        } else {
-            LogErr() << "Type " << type.asString() << " not understood.";
-            return std::nullopt;
+        } else if (!import_simple_item_field(reader, key, item, fields)) {
+            if (!reader.skip_value()) {
+                break;
+            }
         }
     }
 
-    // Mark first item as current
-    if (mission_items.size() > 0) {
-        mission_items[0].current = 1;
+    if (token != JsonReader::Token::ObjectEnd) {
+        LogErr() << "Parse error: " << reader.error();
+        return false;
     }
 
-    // Don't forget sequence number
-    unsigned sequence = 0;
-    for (auto& mission_item : mission_items) {
-        mission_item.seq = sequence++;
+    if (type == "SimpleItem") {
+        items.resize(first_survey_item);
+        if (!check_simple_item_fields(fields)) {
+            return false;
+        }
+        item.seq = static_cast<uint32_t>(items.size());
+        items.push_back(item);
+        return true;
     }
 
-    // Returning an empty vector is ok here if there were really no mission items.
-    return {mission_items};
+    if (type != "ComplexItem") {
+        LogErr() << "Type " << type.value_or("") << " not understood.";
+        return false;
+    }
+
+    if (!complex_item_type.has_value()) {
+        LogErr() << "Could not determine complexItemType";
+        return false;
+    }
+
+    if (complex_item_type.value() != "survey") {
+        LogErr() << "complexItemType: " << complex_item_type.value() << " not supported";
+        return false;
+    }
+
+    if (!complex_item_version.has_value()) {
+        LogErr() << "version of complexItem not found";
+        return false;
+    }
+
+    const int supported_complex_item_version = 5;
+    if (!is_version(complex_item_version, supported_complex_item_version)) {
+        LogErr() << "version of complexItem not supported, found version: "
+                 << complex_item_version.value()
+                 << ", supported: " << supported_complex_item_version;
+        return false;
+    }
+
+    if (!transect_style_found) {
+        LogErr() << "TransectStyleComplexItem not found";
+        return false;
+    }
+
+    if (!survey_items_found) {
+        LogErr() << "No survey items found";
+        return false;
+    }
+
+    return true;
 }
 
-std::optional<MissionRaw::MissionItem>
-MissionImport::import_simple_mission_item(const Json::Value& json_item)
+bool MissionImport::import_survey_items(
+    JsonReader& reader, std::vector<MissionRaw::MissionItem>& items, bool& items_found)
 {
-    if (json_item["command"].empty() || json_item["autoContinue"].empty() ||
-        json_item["frame"].empty() || json_item["params"].empty()) {
-        LogErr() << "Missing mission item field.";
-        return std::nullopt;
+    auto token = reader.next();
+    if (token != JsonReader::Token::ArrayBegin) {
+        return reader.skip(token);
     }
 
-    if (!json_item["params"].isArray()) {
-        LogErr() << "No param array found.";
-        return std::nullopt;
+    for (token = reader.next(); token != JsonReader::Token::ArrayEnd; token = reader.next()) {
+        items_found = true;
+
+        if (token != JsonReader::Token::ObjectBegin) {
+            if (!reader.skip(token)) {
+                return false;
+            }
+            continue;
+        }
+
+        auto& item = items.emplace_back(empty_mission_item());
+        SimpleItemFields fields;
+
+        auto field_token = reader.next();
+        for (; field_token == JsonReader::Token::Key; field_token = reader.next()) {
+            if (!import_simple_item_field(reader, reader.string(), item, fields) &&
+                !reader.skip_value()) {
+                return false;
+            }
+        }
+        if (field_token != JsonReader::Token::ObjectEnd) {
+            return false;
+        }
+
+        // Broken survey items are left out, but values we can't represent
+        // would change the mission.
+        if (fields.out_of_range) {
+            LogErr() << "Survey item field out of range.";
+            return false;
+        }
+        if (check_simple_item_fields(fields)) {
+            item.seq = static_cast<uint32_t>(items.size() - 1);
+        } else {
+            items.pop_back();
+        }
     }
 
-    MissionRaw::MissionItem item{};
-    item.command = json_item["command"].asInt();
-    item.autocontinue = json_item["autoContinue"].asBool() ? 1 : 0;
-    item.frame = json_item["frame"].asInt();
-    item.mission_type = MAV_MISSION_TYPE_MISSION;
+    return true;
+}
+
+bool MissionImport::import_simple_item_field(
+    JsonReader& reader,
+    std::string_view key,
+    MissionRaw::MissionItem& item,
+    SimpleItemFields& fields)
+{
+    if (key == "command") {
+        const auto command = read_number(reader);
+        if (command.has_value()) {
+            const auto value = to_integer(command.value(), UINT16_MAX);
+            item.command = value.value_or(0);
+            fields.command = true;
+            fields.out_of_range |= !value.has_value();
+        }
 
-    const auto set_float = [](const Json::Value& val) {
-        return val.isNull() ? NAN : val.asFloat();
+    } else if (key == "autoContinue") {
+        const auto autocontinue = read_number(reader);
+        if (autocontinue.has_value()) {
+            item.autocontinue = (autocontinue.value() != 0.0) ? 1 : 0;
+            fields.autocontinue = true;
+        }
+
+    } else if (key == "frame") {
+        const auto frame = read_number(reader);
+        if (frame.has_value()) {
+            const auto value = to_integer(frame.value(), UINT8_MAX);
+            item.frame = value.value_or(0);
+            fields.frame = true;
+            fields.out_of_range |= !value.has_value();
+        }
+
+    } else if (key == "params") {
+        const auto token = reader.next();
+        if (token == JsonReader::Token::ArrayBegin) {
+            fields.params_is_array = true;
+            import_params(reader, item, fields.params);
+        } else if (token != JsonReader::Token::Null) {
+            fields.params = true;
+            reader.skip(token);
+        }
+
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+void MissionImport::import_params(
+    JsonReader& reader, MissionRaw::MissionItem& item, bool& params_found)
+{
+    const auto to_float = [](const std::optional<double>& value) {
+        return value.has_value() ? static_cast<float>(value.value()) : NAN;
     };
 
-    const auto set_int32 = [](const Json::Value& val) {
-        return static_cast<int32_t>(val.isNull() ? 0 : (std::round(val.asDouble() * 1e7)));
+    const auto to_int32 = [](const std::optional<double>& value) {
+        return static_cast<int32_t>(value.has_value() ? std::round(value.value() * 1e7) : 0);
     };
 
-    for (unsigned i = 0; i < 7; ++i) {
+    unsigned i = 0;
+    for (auto token = reader.next(); token != JsonReader::Token::ArrayEnd;
+         token = reader.next(), ++i) {
+        if (token == JsonReader::Token::Error) {
+            return;
+        }
+        params_found = true;
+
+        const auto value = to_number(reader, token);
         switch (i) {
             case 0:
-                item.param1 = set_float(json_item["params"][i]);
+                item.param1 = to_float(value);
                 break;
             case 1:
-                item.param2 = set_float(json_item["params"][i]);
+                item.param2 = to_float(value);
                 break;
             case 2:
-                item.param3 = set_float(json_item["params"][i]);
+                item.param3 = to_float(value);
                 break;
             case 3:
-                item.param4 = set_float(json_item["params"][i]);
+                item.param4 = to_float(value);
                 break;
             case 4:
-                item.x = set_int32(json_item["params"][i]);
+                item.x = to_int32(value);
                 break;
             case 5:
-                item.y = set_int32(json_item["params"][i]);
+                item.y = to_int32(value);
                 break;
             case 6:
-                item.z = set_float(json_item["params"][i]);
+                item.z = to_float(value);
                 break;
             default:
-                // should never happen
+                // More than 7 params are ignored.
                 break;
         }
     }
-
-    return {item};
 }
 
-std::optional<std::vector<MissionRaw::MissionItem>>
-MissionImport::import_complex_mission_items(const Json::Value& json_item)
+bool MissionImport::check_simple_item_fields(const SimpleItemFields& fields)
 {
-    if (json_item["complexItemType"].empty()) {
-        LogErr() << "Could not determine complexItemType";
-        return std::nullopt;
+    if (!fields.command || !fields.autocontinue || !fields.frame || !fields.params) {
+        LogErr() << "Missing mission item field.";
+        return false;
     }
 
-    if (json_item["complexItemType"] != "survey") {
-        LogErr() << "complexItemType: " << json_item["complexItemType"] << " not supported";
-        return std::nullopt;
+    if (fields.out_of_range) {
+        LogErr() << "Mission item field out of range.";
+        return false;
     }
 
-    if (json_item["version"].empty()) {
-        LogErr() << "version of complexItem not found";
-        return std::nullopt;
+    if (!fields.params_is_array) {
+        LogErr() << "No param array found.";
+        return false;
     }
 
-    const int supported_complex_item_version = 5;
-    const int found_version = json_item["version"].asInt();
-    if (found_version != 5) {
-        LogErr() << "version of complexItem not supported, found version: " << found_version
-                 << ", supported: " << supported_complex_item_version;
-        return std::nullopt;
+    return true;
+}
+
+std::optional<double> MissionImport::to_number(JsonReader& reader, JsonReader::Token token)
+{
+    switch (token) {
+        case JsonReader::Token::Number:
+            return reader.number();
+        case JsonReader::Token::True:
+            return 1.0;
+        case JsonReader::Token::False:
+            return 0.0;
+        default:
+            reader.skip(token);
+            return std::nullopt;
     }
+}
 
-    if (json_item["TransectStyleComplexItem"].empty()) {
-        LogErr() << "TransectStyleComplexItem not found";
+std::optional<double> MissionImport::read_number(JsonReader& reader)
+{
+    return to_number(reader, reader.next());
+}
+
+std::optional<uint32_t> MissionImport::to_integer(double number, uint32_t max)
+{
+    // Written like this, NaN is rejected as well.
+    if (!(number >= 0.0 && number <= static_cast<double>(max))) {
         return std::nullopt;
     }
+    return static_cast<uint32_t>(number);
+}
 
-    // These are Items (capitalized!) inside the  TransectStyleComplexItem.
-    if (json_item["TransectStyleComplexItem"]["Items"].empty() ||
-        !json_item["TransectStyleComplexItem"]["Items"].isArray()) {
-        LogErr() << "No survey items found";
+bool MissionImport::is_version(const std::optional<double>& version, int supported_version)
+{
+    // Compared as doubles, as a version out of the range of int can't be converted.
+    return version.has_value() && version.value() == static_cast<double>(supported_version);
+}
+
+std::optional<std::string> MissionImport::read_string(JsonReader& reader)
+{
+    const auto token = reader.next();
+    if (token != JsonReader::Token::String) {
+        reader.skip(token);
         return std::nullopt;
     }
+    return std::string(reader.string());
+}
 
-    std::vector<MissionRaw::MissionItem> mission_items;
-    for (const auto& json_item_subitem : json_item["TransectStyleComplexItem"]["Items"]) {
-        const auto maybe_item = import_simple_mission_item(json_item_subitem);
-        if (maybe_item.has_value()) {
-            mission_items.push_back(maybe_item.value());
-        }
+std::size_t MissionImport::max_num_items(const std::string& raw_json)
+{
+    // Every item has a command, so this is an upper bound of the number of items.
+    static constexpr std::string_view command_key = "\"command\"";
+    std::size_t count = 0;
+    for (auto pos = raw_json.find(command_key); pos != std::string::npos;
+         pos = raw_json.find(command_key, pos + command_key.size())) {
+        ++count;
     }
-
-    return {mission_items};
+    return count;
 }
 
 } // namespace mavsdk
@@ -1,26 +1,59 @@
 #pragma once
 
 #include "plugins/mission_raw/mission_raw.h"
+#include "json_reader.h"
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
-#include <json/json.h>
+#include <vector>
 
 namespace mavsdk {
 
+// Import of QGroundControl .plan files.
+//
+// The plan is read in one pass with a pull parser, and mission items are written
+// straight into the result, so even plans with tens of thousands of survey items
+// don't need a JSON document in memory.
 class MissionImport {
 public:
     static std::pair<MissionRaw::Result, MissionRaw::MissionImportData>
     parse_json(const std::string& raw_json);
 
 private:
-    static bool check_overall_version(const Json::Value& root);
-    static std::optional<std::vector<MissionRaw::MissionItem>>
-    import_mission(const Json::Value& root);
-    static std::optional<MissionRaw::MissionItem>
-    import_simple_mission_item(const Json::Value& json_item);
-    static std::optional<std::vector<MissionRaw::MissionItem>>
-    import_complex_mission_items(const Json::Value& json_item);
+    // Fields of a simple item found so far.
+    struct SimpleItemFields {
+        bool command{false};
+        bool autocontinue{false};
+        bool frame{false};
+        bool params{false};
+        bool params_is_array{false};
+        // A field that doesn't fit into its MAVLink type.
+        bool out_of_range{false};
+    };
+
+    static bool import_plan(JsonReader& reader, std::vector<MissionRaw::MissionItem>& items);
+    static bool import_mission(JsonReader& reader, std::vector<MissionRaw::MissionItem>& items);
+    static bool
+    import_mission_item(JsonReader& reader, std::vector<MissionRaw::MissionItem>& items);
+    static bool import_survey_items(
+        JsonReader& reader, std::vector<MissionRaw::MissionItem>& items, bool& items_found);
+    static bool import_simple_item_field(
+        JsonReader& reader,
+        std::string_view key,
+        MissionRaw::MissionItem& item,
+        SimpleItemFields& fields);
+    static void
+    import_params(JsonReader& reader, MissionRaw::MissionItem& item, bool& params_found);
+    static bool check_simple_item_fields(const SimpleItemFields& fields);
+    static std::optional<double> to_number(JsonReader& reader, JsonReader::Token token);
+    static std::optional<double> read_number(JsonReader& reader);
+    // Integers are stored as doubles in JSON, anything outside [0, max] is rejected.
+    static std::optional<uint32_t> to_integer(double number, uint32_t max);
+    static bool is_version(const std::optional<double>& version, int supported_version);
+    static std::optional<std::string> read_string(JsonReader& reader);
+    static std::size_t max_num_items(const std::string& raw_json);
 };
 
 } // namespace mavsdk
@@ -396,3 +396,39 @@ TEST(MissionRaw, ImportSamplePlanWithComplexMissionSurveyMissingItems)
     EXPECT_EQ(result_pair.second.geofence_items.size(), 0);
     EXPECT_EQ(result_pair.second.rally_items.size(), 0);
 }
+
+static std::string plan_with_item(const std::string& version, const std::string& item)
+{
+    return R"({"fileType": "Plan", "version": )" + version +
+           R"(, "mission": {"version": 2, "items": [)" + item + "]}}";
+}
+
+TEST(MissionRaw, ImportPlanWithOutOfRangeValues)
+{
+    const std::string good_item =
+        R"({"type": "SimpleItem", "command": 16, "frame": 3, "autoContinue": true,)"
+        R"( "params": [0, 0, 0, 0, 47.3, 8.5, 20]})";
+    EXPECT_EQ(
+        MissionImport::parse_json(plan_with_item("1", good_item)).first,
+        MissionRaw::Result::Success);
+
+    for (const std::string version : {"1e300", "-1e300", "4294967297"}) {
+        EXPECT_EQ(
+            MissionImport::parse_json(plan_with_item(version, good_item)).first,
+            MissionRaw::Result::FailedToParseQgcPlan);
+    }
+
+    for (const std::string item :
+         {R"({"type": "SimpleItem", "command": 1e20, "frame": 3, "autoContinue": true,)"
+          R"( "params": [0, 0, 0, 0, 47.3, 8.5, 20]})",
+          R"({"type": "SimpleItem", "command": 65536, "frame": 3, "autoContinue": true,)"
+          R"( "params": [0, 0, 0, 0, 47.3, 8.5, 20]})",
+          R"({"type": "SimpleItem", "command": 16, "frame": -1, "autoContinue": true,)"
+          R"( "params": [0, 0, 0, 0, 47.3, 8.5, 20]})",
+          R"({"type": "SimpleItem", "command": 16, "frame": 256, "autoContinue": true,)"
+          R"( "params": [0, 0, 0, 0, 47.3, 8.5, 20]})"}) {
+        const auto result_pair = MissionImport::parse_json(plan_with_item("1", item));
+        EXPECT_EQ(result_pair.first, MissionRaw::Result::FailedToParseQgcPlan);
+        EXPECT_EQ(result_pair.second.mission_items.size(), 0);
+    }
+}
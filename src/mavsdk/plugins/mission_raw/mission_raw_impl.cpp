@@ -2,21 +2,42 @@
 #include "mission_import.h"
 #include "system.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <fstream> // for `std::ifstream`
-#include <sstream> // for `std::stringstream`
+#include <string>
 
 namespace mavsdk {
 
 // This is an empty item that can be sent to ArduPilot to mimic clearing of mission.
 constexpr MissionRaw::MissionItem empty_item{0, 3, 16, 1};
 
+namespace {
+
+bool upload_only_changes_from_env()
+{
+    // Uploads then only send the items which differ from the vehicle's copy,
+    // using partial writes, which doesn't reset the mission progress.
+    if (const char* env_p = std::getenv("MAVSDK_MISSION_UPLOAD_ONLY_CHANGES")) {
+        if (std::string(env_p) == "1") {
+            LogDebug() << "Mission uploads only send changed items.";
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
 MissionRawImpl::MissionRawImpl(System& system) : PluginImplBase(system)
 {
+    _upload_only_changes = upload_only_changes_from_env();
     _parent->register_plugin(this);
 }
 
 MissionRawImpl::MissionRawImpl(std::shared_ptr<System> system) : PluginImplBase(std::move(system))
 {
+    _upload_only_changes = upload_only_changes_from_env();
     _parent->register_plugin(this);
 }
 
@@ -48,6 +69,9 @@ void MissionRawImpl::enable() {}
 void MissionRawImpl::disable()
 {
     reset_mission_progress();
+
+    // Whatever happened meanwhile, the vehicle's mission is not known anymore.
+    _parent->mission_transfer().forget_vehicle_items(MAV_MISSION_TYPE_MISSION);
 }
 
 void MissionRawImpl::deinit()
@@ -144,18 +168,25 @@ void MissionRawImpl::upload_mission_async(
 
     const auto int_items = convert_to_int_items(mission_raw);
 
-    _last_upload = _parent->mission_transfer().upload_items_async(
-        MAV_MISSION_TYPE_MISSION,
-        int_items,
-        [this, callback, int_items](MavlinkMissionTransfer::Result result) {
-            auto converted_result = convert_result(result);
-            auto converted_items = convert_items(int_items);
-            _parent->call_user_callback([callback, converted_result, converted_items]() {
-                if (callback) {
-                    callback(converted_result);
-                }
-            });
+    const auto transfer_callback = [this, callback,
+                                    int_items](MavlinkMissionTransfer::Result result) {
+        auto converted_result = convert_result(result);
+        auto converted_items = convert_items(int_items);
+        _parent->call_user_callback([callback, converted_result, converted_items]() {
+            if (callback) {
+                callback(converted_result);
+            }
         });
+    };
+
+    auto& mission_transfer = _parent->mission_transfer();
+    if (_upload_only_changes) {
+        _last_upload = mission_transfer.update_items_async(
+            MAV_MISSION_TYPE_MISSION, int_items, transfer_callback);
+    } else {
+        _last_upload = mission_transfer.upload_items_async(
+            MAV_MISSION_TYPE_MISSION, int_items, transfer_callback);
+    }
 }
 
 MissionRaw::Result MissionRawImpl::cancel_mission_upload()
@@ -474,17 +505,22 @@ void MissionRawImpl::subscribe_mission_changed(MissionRaw::MissionChangedCallbac
 std::pair<MissionRaw::Result, MissionRaw::MissionImportData>
 MissionRawImpl::import_qgroundcontrol_mission(std::string qgc_plan_path)
 {
-    std::ifstream file(qgc_plan_path);
+    std::ifstream file(qgc_plan_path, std::ios::binary | std::ios::ate);
     if (!file) {
         return std::make_pair<MissionRaw::Result, MissionRaw::MissionImportData>(
             MissionRaw::Result::FailedToOpenQgcPlan, {});
     }
 
-    std::stringstream buf;
-    buf << file.rdbuf();
+    // Read it in one go, large plans are several megabytes.
+    std::string plan(static_cast<std::size_t>(std::max<std::streamoff>(file.tellg(), 0)), '\0');
+    file.seekg(0);
+    if (!file.read(plan.data(), static_cast<std::streamsize>(plan.size()))) {
+        return std::make_pair<MissionRaw::Result, MissionRaw::MissionImportData>(
+            MissionRaw::Result::FailedToOpenQgcPlan, {});
+    }
     file.close();
 
-    return MissionImport::parse_json(buf.str());
+    return MissionImport::parse_json(plan);
 }
 
 MissionRaw::Result MissionRawImpl::convert_result(MavlinkMissionTransfer::Result result)
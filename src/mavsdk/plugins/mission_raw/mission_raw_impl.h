@@ -104,6 +104,9 @@ private:
         std::mutex mutex{};
         MissionRaw::MissionChangedCallback callback{nullptr};
     } _mission_changed{};
+
+    // Set with MAVSDK_MISSION_UPLOAD_ONLY_CHANGES, see the constructor.
+    bool _upload_only_changes{false};
 };
 
 } // namespace mavsdk
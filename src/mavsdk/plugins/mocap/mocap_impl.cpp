@@ -1,14 +1,73 @@
 #include "mocap_impl.h"
+#include "log.h"
+#include "metrics.h"
 #include "system.h"
 #include "px4_custom_mode.h"
+#include <algorithm>
 #include <array>
+#include <cstdlib>
 #include <ctime>
+#include <string>
 
 namespace mavsdk {
 
-void MocapImpl::init() {}
+namespace {
 
-void MocapImpl::deinit() {}
+void read_stream_options(double& stream_interval_s, bool& align_timestamps)
+{
+    // Samples are then only queued by the setters, and the latest one of each
+    // kind is sent at this rate from a thread of its own.
+    if (const char* env_p = std::getenv("MAVSDK_MOCAP_STREAM_RATE_HZ")) {
+        const double rate_hz = std::atof(env_p);
+        if (rate_hz > 0.0) {
+            stream_interval_s = 1.0 / rate_hz;
+            LogDebug() << "Mocap streaming at " << rate_hz << " Hz";
+        }
+    }
+
+    // Measures the offset to the autopilot clock, which the timestamps are
+    // then shifted by.
+    if (const char* env_p = std::getenv("MAVSDK_MOCAP_TIMESYNC")) {
+        if (std::string(env_p) == "1") {
+            LogDebug() << "Mocap timestamps are aligned with timesync.";
+            align_timestamps = true;
+        }
+    }
+}
+
+// The timestamp field is not named the same in all samples.
+uint64_t& time_usec_of(mavlink_vision_position_estimate_t& sample)
+{
+    return sample.usec;
+}
+
+uint64_t& time_usec_of(mavlink_att_pos_mocap_t& sample)
+{
+    return sample.time_usec;
+}
+
+uint64_t& time_usec_of(mavlink_odometry_t& sample)
+{
+    return sample.time_usec;
+}
+
+} // namespace
+
+void MocapImpl::init()
+{
+    if (_align_timestamps) {
+        _parent->enable_timesync();
+    }
+
+    if (_stream_interval_s > 0.0) {
+        start_sender();
+    }
+}
+
+void MocapImpl::deinit()
+{
+    stop_sender();
+}
 
 void MocapImpl::enable() {}
 
@@ -16,11 +75,13 @@ void MocapImpl::disable() {}
 
 MocapImpl::MocapImpl(System& system) : PluginImplBase(system)
 {
+    read_stream_options(_stream_interval_s, _align_timestamps);
     _parent->register_plugin(this);
 }
 
 MocapImpl::MocapImpl(std::shared_ptr<System> system) : PluginImplBase(std::move(system))
 {
+    read_stream_options(_stream_interval_s, _align_timestamps);
     _parent->register_plugin(this);
 }
 
@@ -61,17 +122,7 @@ Mocap::Result MocapImpl::set_odometry(const Mocap::Odometry& odometry)
 Mocap::Result MocapImpl::send_vision_position_estimate(
     const Mocap::VisionPositionEstimate& vision_position_estimate)
 {
-    const uint64_t autopilot_time_usec =
-        (!vision_position_estimate.time_usec) ?
-            std::chrono::duration_cast<std::chrono::microseconds>(
-                _parent->get_autopilot_time().now().time_since_epoch())
-                .count() :
-            std::chrono::duration_cast<std::chrono::microseconds>(
-                _parent->get_autopilot_time()
-                    .time_in(dl_system_time_t(
-                        std::chrono::microseconds(vision_position_estimate.time_usec)))
-                    .time_since_epoch())
-                .count();
+    const uint64_t time_usec = sample_time_usec(vision_position_estimate.time_usec);
 
     std::array<float, 21> covariance{};
 
@@ -90,40 +141,24 @@ Mocap::Result MocapImpl::send_vision_position_estimate(
         return Mocap::Result::InvalidRequestData;
     }
 
-    mavlink_message_t message;
-    mavlink_msg_vision_position_estimate_pack(
-        _parent->get_own_system_id(),
-        _parent->get_own_component_id(),
-        &message,
-        autopilot_time_usec,
-        vision_position_estimate.position_body.x_m,
-        vision_position_estimate.position_body.y_m,
-        vision_position_estimate.position_body.z_m,
-        vision_position_estimate.angle_body.roll_rad,
-        vision_position_estimate.angle_body.pitch_rad,
-        vision_position_estimate.angle_body.yaw_rad,
-        covariance.data(),
-        0); // FIXME: reset_counter not set
-
-    return _parent->send_message(message) ? Mocap::Result::Success : Mocap::Result::ConnectionError;
+    mavlink_vision_position_estimate_t sample{};
+    sample.usec = time_usec;
+    sample.x = vision_position_estimate.position_body.x_m;
+    sample.y = vision_position_estimate.position_body.y_m;
+    sample.z = vision_position_estimate.position_body.z_m;
+    sample.roll = vision_position_estimate.angle_body.roll_rad;
+    sample.pitch = vision_position_estimate.angle_body.pitch_rad;
+    sample.yaw = vision_position_estimate.angle_body.yaw_rad;
+    std::copy(covariance.begin(), covariance.end(), sample.covariance);
+    sample.reset_counter = 0; // FIXME: reset_counter not set
+
+    return send_sample(_vision_position_estimates, sample);
 }
 
 Mocap::Result
 MocapImpl::send_attitude_position_mocap(const Mocap::AttitudePositionMocap& attitude_position_mocap)
 {
-    const uint64_t autopilot_time_usec =
-        (!attitude_position_mocap.time_usec) ?
-            std::chrono::duration_cast<std::chrono::microseconds>(
-                _parent->get_autopilot_time().now().time_since_epoch())
-                .count() :
-            std::chrono::duration_cast<std::chrono::microseconds>(
-                _parent->get_autopilot_time()
-                    .time_in(dl_system_time_t(
-                        std::chrono::microseconds(attitude_position_mocap.time_usec)))
-                    .time_since_epoch())
-                .count();
-
-    mavlink_message_t message;
+    const uint64_t time_usec = sample_time_usec(attitude_position_mocap.time_usec);
 
     std::array<float, 4> q{};
     q[0] = attitude_position_mocap.q.w;
@@ -148,34 +183,20 @@ MocapImpl::send_attitude_position_mocap(const Mocap::AttitudePositionMocap& atti
         return Mocap::Result::InvalidRequestData;
     }
 
-    mavlink_msg_att_pos_mocap_pack(
-        _parent->get_own_system_id(),
-        _parent->get_own_component_id(),
-        &message,
-        autopilot_time_usec,
-        q.data(),
-        attitude_position_mocap.position_body.x_m,
-        attitude_position_mocap.position_body.y_m,
-        attitude_position_mocap.position_body.z_m,
-        covariance.data());
+    mavlink_att_pos_mocap_t sample{};
+    sample.time_usec = time_usec;
+    std::copy(q.begin(), q.end(), sample.q);
+    sample.x = attitude_position_mocap.position_body.x_m;
+    sample.y = attitude_position_mocap.position_body.y_m;
+    sample.z = attitude_position_mocap.position_body.z_m;
+    std::copy(covariance.begin(), covariance.end(), sample.covariance);
 
-    return _parent->send_message(message) ? Mocap::Result::Success : Mocap::Result::ConnectionError;
+    return send_sample(_attitude_position_mocaps, sample);
 }
 
 Mocap::Result MocapImpl::send_odometry(const Mocap::Odometry& odometry)
 {
-    const uint64_t autopilot_time_usec =
-        (!odometry.time_usec) ?
-            std::chrono::duration_cast<std::chrono::microseconds>(
-                _parent->get_autopilot_time().now().time_since_epoch())
-                .count() :
-            std::chrono::duration_cast<std::chrono::microseconds>(
-                _parent->get_autopilot_time()
-                    .time_in(dl_system_time_t(std::chrono::microseconds(odometry.time_usec)))
-                    .time_since_epoch())
-                .count();
-
-    mavlink_message_t message;
+    const uint64_t time_usec = sample_time_usec(odometry.time_usec);
 
     std::array<float, 4> q{};
     q[0] = odometry.q.w;
@@ -214,29 +235,177 @@ Mocap::Result MocapImpl::send_odometry(const Mocap::Odometry& odometry)
         return Mocap::Result::InvalidRequestData;
     }
 
-    /*mavlink_msg_odometry_pack(
-        _parent->get_own_system_id(),
-        _parent->get_own_component_id(),
-        &message,
-        autopilot_time_usec,
-        static_cast<uint8_t>(odometry.frame_id),
-        static_cast<uint8_t>(MAV_FRAME_BODY_FRD),
-        odometry.position_body.x_m,
-        odometry.position_body.y_m,
-        odometry.position_body.z_m,
-        q.data(),
-        odometry.speed_body.x_m_s,
-        odometry.speed_body.y_m_s,
-        odometry.speed_body.z_m_s,
-        odometry.angular_velocity_body.roll_rad_s,
-        odometry.angular_velocity_body.pitch_rad_s,
-        odometry.angular_velocity_body.yaw_rad_s,
-        pose_covariance.data(),
-        velocity_covariance.data(),
-        0,
-        MAV_ESTIMATOR_TYPE_MOCAP);*/
-
-    return _parent->send_message(message) ? Mocap::Result::Success : Mocap::Result::ConnectionError;
+    mavlink_odometry_t sample{};
+    sample.time_usec = time_usec;
+    switch (odometry.frame_id) {
+        case Mocap::Odometry::MavFrame::MocapNed:
+            sample.frame_id = MAV_FRAME_MOCAP_NED;
+            break;
+        case Mocap::Odometry::MavFrame::LocalFrd:
+            sample.frame_id = MAV_FRAME_LOCAL_FRD;
+            break;
+    }
+    sample.child_frame_id = MAV_FRAME_BODY_FRD;
+    sample.x = odometry.position_body.x_m;
+    sample.y = odometry.position_body.y_m;
+    sample.z = odometry.position_body.z_m;
+    std::copy(q.begin(), q.end(), sample.q);
+    sample.vx = odometry.speed_body.x_m_s;
+    sample.vy = odometry.speed_body.y_m_s;
+    sample.vz = odometry.speed_body.z_m_s;
+    sample.rollspeed = odometry.angular_velocity_body.roll_rad_s;
+    sample.pitchspeed = odometry.angular_velocity_body.pitch_rad_s;
+    sample.yawspeed = odometry.angular_velocity_body.yaw_rad_s;
+    std::copy(pose_covariance.begin(), pose_covariance.end(), sample.pose_covariance);
+    std::copy(
+        velocity_covariance.begin(), velocity_covariance.end(), sample.velocity_covariance);
+    sample.reset_counter = 0;
+    sample.estimator_type = MAV_ESTIMATOR_TYPE_MOCAP;
+
+    return send_sample(_odometries, sample);
+}
+
+uint64_t MocapImpl::sample_time_usec(uint64_t time_usec)
+{
+    if (_stream_interval_s > 0.0) {
+        // The sender shifts it to the autopilot time, with the latest offset.
+        return (!time_usec) ? std::chrono::duration_cast<std::chrono::microseconds>(
+                                  _time.system_time().time_since_epoch())
+                                  .count() :
+                              time_usec;
+    }
+
+    return (!time_usec) ?
+               std::chrono::duration_cast<std::chrono::microseconds>(
+                   _parent->get_autopilot_time().now().time_since_epoch())
+                   .count() :
+               std::chrono::duration_cast<std::chrono::microseconds>(
+                   _parent->get_autopilot_time()
+                       .time_in(dl_system_time_t(std::chrono::microseconds(time_usec)))
+                       .time_since_epoch())
+                   .count();
+}
+
+void MocapImpl::pack(mavlink_message_t& message, const mavlink_vision_position_estimate_t& sample)
+{
+    mavlink_msg_vision_position_estimate_encode(
+        _parent->get_own_system_id(), _parent->get_own_component_id(), &message, &sample);
+}
+
+void MocapImpl::pack(mavlink_message_t& message, const mavlink_att_pos_mocap_t& sample)
+{
+    mavlink_msg_att_pos_mocap_encode(
+        _parent->get_own_system_id(), _parent->get_own_component_id(), &message, &sample);
+}
+
+void MocapImpl::pack(mavlink_message_t& message, const mavlink_odometry_t& sample)
+{
+    mavlink_msg_odometry_encode(
+        _parent->get_own_system_id(), _parent->get_own_component_id(), &message, &sample);
+}
+
+template<typename Message>
+Mocap::Result MocapImpl::send_sample(SampleSlot<Message>& slot, const Message& sample)
+{
+    if (_stream_interval_s <= 0.0) {
+        mavlink_message_t message;
+        pack(message, sample);
+        return _parent->send_message(message) ? Mocap::Result::Success :
+                                                Mocap::Result::ConnectionError;
+    }
+
+    Sample<Message> queued;
+    queued.message = sample;
+    queued.taken = dl_system_time_t(std::chrono::microseconds(time_usec_of(queued.message)));
+
+    std::lock_guard<std::mutex> lock(slot.producer_mutex);
+    if (slot.latest.store(queued)) {
+        Metrics::instance().mocap_samples_overwritten.add();
+    }
+    return Mocap::Result::Success;
+}
+
+void MocapImpl::start_sender()
+{
+    std::lock_guard<std::mutex> lock(_sender_mutex);
+    if (_sender_thread == nullptr) {
+        _should_exit = false;
+        _sender_thread = new std::thread(&MocapImpl::run_sender, this);
+    }
+}
+
+void MocapImpl::stop_sender()
+{
+    std::thread* thread = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_sender_mutex);
+        _should_exit = true;
+        thread = _sender_thread;
+        _sender_thread = nullptr;
+        _sender_cv.notify_one();
+    }
+
+    if (thread != nullptr) {
+        thread->join();
+        delete thread;
+    }
+}
+
+void MocapImpl::run_sender()
+{
+    auto next_due = _time.steady_time();
+
+    std::unique_lock<std::mutex> lock(_sender_mutex);
+    while (!_should_exit) {
+        lock.unlock();
+        send_latest_samples();
+        lock.lock();
+
+        Time::shift_steady_time_by(next_due, _stream_interval_s);
+        const auto now = _time.steady_time();
+        if (next_due <= now) {
+            // Behind by more than an interval, samples would only queue up anyway.
+            next_due = now;
+            Time::shift_steady_time_by(next_due, _stream_interval_s);
+        }
+
+        _sender_cv.wait_until(lock, next_due, [this]() { return _should_exit.load(); });
+    }
+}
+
+void MocapImpl::send_latest_samples()
+{
+    // Samples which were sent already are not repeated, the estimator
+    // on the autopilot would take them as new measurements.
+    send_latest_sample(_vision_position_estimates);
+    send_latest_sample(_attitude_position_mocaps);
+    send_latest_sample(_odometries);
+}
+
+template<typename Message> void MocapImpl::send_latest_sample(SampleSlot<Message>& slot)
+{
+    Sample<Message> sample;
+    if (!slot.latest.take(sample)) {
+        return;
+    }
+
+    time_usec_of(sample.message) = std::chrono::duration_cast<std::chrono::microseconds>(
+                                       _parent->get_autopilot_time()
+                                           .time_in(sample.taken)
+                                           .time_since_epoch())
+                                       .count();
+
+    mavlink_message_t message;
+    pack(message, sample.message);
+    if (!_parent->send_message(message)) {
+        return;
+    }
+
+    Metrics::instance().mocap_samples_sent.add();
+    const auto latency = _time.system_time() - sample.taken;
+    Metrics::instance().mocap_latency.record(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::max(latency, dl_system_time_t::duration::zero())));
 }
 
 } // namespace mavsdk
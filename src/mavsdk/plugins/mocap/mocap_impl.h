@@ -1,10 +1,17 @@
 #pragma once
 
 #include "plugins/mocap/mocap.h"
+#include "latest_value_slot.h"
 #include "mavlink_include.h"
+#include "mavsdk_time.h"
 #include "plugin_impl_base.h"
 #include "system.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 namespace mavsdk {
 
 class System;
@@ -31,10 +38,52 @@ public:
     MocapImpl& operator=(const MocapImpl&) = delete;
 
 private:
+    // A sample with its time_usec still in the local system time. It is only
+    // packed when it is sent, so that overwritten samples don't use up
+    // sequence numbers.
+    template<typename Message> struct Sample {
+        Message message{};
+        dl_system_time_t taken{};
+    };
+
+    // The slot only takes one producer at a time, the mutex serializes
+    // setters of the same kind called from different threads.
+    template<typename Message> struct SampleSlot {
+        std::mutex producer_mutex{};
+        LatestValueSlot<Sample<Message>> latest{};
+    };
+
     Mocap::Result
     send_vision_position_estimate(const Mocap::VisionPositionEstimate& vision_position_estimate);
     Mocap::Result
     send_attitude_position_mocap(const Mocap::AttitudePositionMocap& attitude_position_mocap);
     Mocap::Result send_odometry(const Mocap::Odometry& odometry);
+
+    uint64_t sample_time_usec(uint64_t time_usec);
+    void pack(mavlink_message_t& message, const mavlink_vision_position_estimate_t& sample);
+    void pack(mavlink_message_t& message, const mavlink_att_pos_mocap_t& sample);
+    void pack(mavlink_message_t& message, const mavlink_odometry_t& sample);
+    template<typename Message>
+    Mocap::Result send_sample(SampleSlot<Message>& slot, const Message& sample);
+
+    void start_sender();
+    void stop_sender();
+    void run_sender();
+    void send_latest_samples();
+    template<typename Message> void send_latest_sample(SampleSlot<Message>& slot);
+
+    // Streaming mode, set with MAVSDK_MOCAP_STREAM_RATE_HZ, see the constructor.
+    double _stream_interval_s{0.0};
+    bool _align_timestamps{false};
+
+    SampleSlot<mavlink_vision_position_estimate_t> _vision_position_estimates{};
+    SampleSlot<mavlink_att_pos_mocap_t> _attitude_position_mocaps{};
+    SampleSlot<mavlink_odometry_t> _odometries{};
+
+    Time _time{};
+    std::mutex _sender_mutex{};
+    std::condition_variable _sender_cv{};
+    std::thread* _sender_thread{nullptr};
+    std::atomic<bool> _should_exit{false};
 };
 } // namespace mavsdk
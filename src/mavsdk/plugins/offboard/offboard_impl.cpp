@@ -1,3 +1,4 @@
+#include <array>
 #include <cmath>
 #include <utility>
 #include "mavsdk_math.h"
@@ -7,13 +8,23 @@
 
 namespace mavsdk {
 
-OffboardImpl::OffboardImpl(System& system) : PluginImplBase(system)
+OffboardImpl::OffboardImpl(System& system) :
+    PluginImplBase(system),
+    _setpoint_streamer(_parent->get_time(), [this](mavlink_message_t& message) {
+        return _parent->send_message(message);
+    })
 {
+    _setpoint_streamer.set_interval(SEND_INTERVAL_S);
     _parent->register_plugin(this);
 }
 
-OffboardImpl::OffboardImpl(std::shared_ptr<System> system) : PluginImplBase(std::move(system))
+OffboardImpl::OffboardImpl(std::shared_ptr<System> system) :
+    PluginImplBase(std::move(system)),
+    _setpoint_streamer(_parent->get_time(), [this](mavlink_message_t& message) {
+        return _parent->send_message(message);
+    })
 {
+    _setpoint_streamer.set_interval(SEND_INTERVAL_S);
     _parent->register_plugin(this);
 }
 
@@ -121,259 +132,106 @@ void OffboardImpl::receive_command_result(
 
 Offboard::Result OffboardImpl::set_position_ned(Offboard::PositionNedYaw position_ned_yaw)
 {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _position_ned_yaw = position_ned_yaw;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _position_ned_yaw = position_ned_yaw;
 
-        if (_mode != Mode::PositionNed) {
-            if (_call_every_cookie) {
-                // If we're already sending other setpoints, stop that now.
-                _parent->remove_call_every(_call_every_cookie);
-                _call_every_cookie = nullptr;
-            }
-            // We automatically send Ned setpoints from now on.
-            _parent->add_call_every(
-                [this]() { send_position_ned(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-            _mode = Mode::PositionNed;
-        } else {
-            // We're already sending these kind of setpoints. Since the setpoint change, let's
-            // reschedule the next call, so we don't send setpoints too often.
-            _parent->reset_call_every(_call_every_cookie);
-        }
-    }
+    _mode = Mode::PositionNed;
 
-    // also send it right now to reduce latency
-    return send_position_ned();
+    // Sent right away to reduce latency, and then repeated until the next setpoint.
+    return send_position_ned_locked();
 }
 
 Offboard::Result OffboardImpl::set_position_global(Offboard::PositionGlobalYaw position_global_yaw)
 {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _position_global_yaw = position_global_yaw;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _position_global_yaw = position_global_yaw;
 
-        if (_mode != Mode::PositionGlobalAltRel) {
-            if (_call_every_cookie) {
-                // If we're already sending other setpoints, stop that now.
-                _parent->remove_call_every(_call_every_cookie);
-                _call_every_cookie = nullptr;
-            }
-            // We automatically send Global setpoints from now on.
-            _parent->add_call_every(
-                [this]() { send_position_global(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-            _mode = Mode::PositionGlobalAltRel;
-        } else {
-            // We're already sending these kind of setpoints. Since the setpoint change, let's
-            // reschedule the next call, so we don't send setpoints too often.
-            _parent->reset_call_every(_call_every_cookie);
-        }
-    }
+    _mode = Mode::PositionGlobalAltRel;
 
-    // also send it right now to reduce latency
-    return send_position_global();
+    // Sent right away to reduce latency, and then repeated until the next setpoint.
+    return send_position_global_locked();
 }
 
 Offboard::Result OffboardImpl::set_velocity_ned(Offboard::VelocityNedYaw velocity_ned_yaw)
 {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _velocity_ned_yaw = velocity_ned_yaw;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _velocity_ned_yaw = velocity_ned_yaw;
 
-        if (_mode != Mode::VelocityNed) {
-            if (_call_every_cookie) {
-                // If we're already sending other setpoints, stop that now.
-                _parent->remove_call_every(_call_every_cookie);
-                _call_every_cookie = nullptr;
-            }
-            // We automatically send Ned setpoints from now on.
-            _parent->add_call_every(
-                [this]() { send_velocity_ned(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-            _mode = Mode::VelocityNed;
-        } else {
-            // We're already sending these kind of setpoints. Since the setpoint change, let's
-            // reschedule the next call, so we don't send setpoints too often.
-            _parent->reset_call_every(_call_every_cookie);
-        }
-    }
-    // also send it right now to reduce latency
-    return send_velocity_ned();
+    _mode = Mode::VelocityNed;
+
+    // Sent right away to reduce latency, and then repeated until the next setpoint.
+    return send_velocity_ned_locked();
 }
 
 Offboard::Result OffboardImpl::set_position_velocity_ned(
     Offboard::PositionNedYaw position_ned_yaw, Offboard::VelocityNedYaw velocity_ned_yaw)
 {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _position_ned_yaw = position_ned_yaw;
-        _velocity_ned_yaw = velocity_ned_yaw;
-
-        if (_mode != Mode::PositionVelocityNed) {
-            if (_call_every_cookie) {
-                // If we're already sending other setpoints, stop that now.
-                _parent->remove_call_every(_call_every_cookie);
-                _call_every_cookie = nullptr;
-            }
-            // We automatically send Ned setpoints from now on.
-            _parent->add_call_every(
-                [this]() { send_position_velocity_ned(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-            _mode = Mode::PositionVelocityNed;
-        } else {
-            // We're already sending these kind of setpoints. Since the setpoint change, let's
-            // reschedule the next call, so we don't send setpoints too often.
-            _parent->reset_call_every(_call_every_cookie);
-        }
-    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    _position_ned_yaw = position_ned_yaw;
+    _velocity_ned_yaw = velocity_ned_yaw;
+
+    _mode = Mode::PositionVelocityNed;
 
-    // also send it right now to reduce latency
-    return send_position_velocity_ned();
+    // Sent right away to reduce latency, and then repeated until the next setpoint.
+    return send_position_velocity_ned_locked();
 }
 
 Offboard::Result OffboardImpl::set_acceleration_ned(Offboard::AccelerationNed acceleration_ned)
 {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _acceleration_ned = acceleration_ned;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _acceleration_ned = acceleration_ned;
 
-        if (_mode != Mode::AccelerationNed) {
-            if (_call_every_cookie) {
-                // If we're already sending other setpoints, stop that now.
-                _parent->remove_call_every(_call_every_cookie);
-                _call_every_cookie = nullptr;
-            }
-            // We automatically send Ned setpoints from now on.
-            _parent->add_call_every(
-                [this]() { send_acceleration_ned(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-            _mode = Mode::AccelerationNed;
-        } else {
-            // We're already sending these kind of setpoints. Since the setpoint change, let's
-            // reschedule the next call, so we don't send setpoints too often.
-            _parent->reset_call_every(_call_every_cookie);
-        }
-    }
+    _mode = Mode::AccelerationNed;
 
-    // also send it right now to reduce latency
-    return send_acceleration_ned();
+    // Sent right away to reduce latency, and then repeated until the next setpoint.
+    return send_acceleration_ned_locked();
 }
 
 Offboard::Result
 OffboardImpl::set_velocity_body(Offboard::VelocityBodyYawspeed velocity_body_yawspeed)
 {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _velocity_body_yawspeed = velocity_body_yawspeed;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _velocity_body_yawspeed = velocity_body_yawspeed;
 
-        if (_mode != Mode::VelocityBody) {
-            if (_call_every_cookie) {
-                // If we're already sending other setpoints, stop that now.
-                _parent->remove_call_every(_call_every_cookie);
-                _call_every_cookie = nullptr;
-            }
-            // We automatically send body setpoints from now on.
-            _parent->add_call_every(
-                [this]() { send_velocity_body(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-            _mode = Mode::VelocityBody;
-        } else {
-            // We're already sending these kind of setpoints. Since the setpoint change, let's
-            // reschedule the next call, so we don't send setpoints too often.
-            _parent->reset_call_every(_call_every_cookie);
-        }
-    }
+    _mode = Mode::VelocityBody;
 
-    // also send it right now to reduce latency
-    return send_velocity_body();
+    // Sent right away to reduce latency, and then repeated until the next setpoint.
+    return send_velocity_body_locked();
 }
 
 Offboard::Result OffboardImpl::set_attitude(Offboard::Attitude attitude)
 {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _attitude = attitude;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _attitude = attitude;
 
-        if (_mode != Mode::Attitude) {
-            if (_call_every_cookie) {
-                // If we're already sending other setpoints, stop that now.
-                _parent->remove_call_every(_call_every_cookie);
-                _call_every_cookie = nullptr;
-            }
-            // We automatically send body setpoints from now on.
-            _parent->add_call_every(
-                [this]() { send_attitude(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-            _mode = Mode::Attitude;
-        } else {
-            // We're already sending these kind of setpoints. Since the setpoint change, let's
-            // reschedule the next call, so we don't send setpoints too often.
-            _parent->reset_call_every(_call_every_cookie);
-        }
-    }
+    _mode = Mode::Attitude;
 
-    // also send it right now to reduce latency
-    return send_attitude();
+    // Sent right away to reduce latency, and then repeated until the next setpoint.
+    return send_attitude_locked();
 }
 
 Offboard::Result OffboardImpl::set_attitude_rate(Offboard::AttitudeRate attitude_rate)
 {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _attitude_rate = attitude_rate;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _attitude_rate = attitude_rate;
 
-        if (_mode != Mode::AttitudeRate) {
-            if (_call_every_cookie) {
-                // If we're already sending other setpoints, stop that now.
-                _parent->remove_call_every(_call_every_cookie);
-                _call_every_cookie = nullptr;
-            }
-            // We automatically send body setpoints from now on.
-            _parent->add_call_every(
-                [this]() { send_attitude_rate(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-            _mode = Mode::AttitudeRate;
-        } else {
-            // We're already sending these kind of setpoints. Since the setpoint change, let's
-            // reschedule the next call, so we don't send setpoints too often.
-            _parent->reset_call_every(_call_every_cookie);
-        }
-    }
+    _mode = Mode::AttitudeRate;
 
-    // also send it right now to reduce latency
-    return send_attitude_rate();
+    // Sent right away to reduce latency, and then repeated until the next setpoint.
+    return send_attitude_rate_locked();
 }
 
 Offboard::Result OffboardImpl::set_actuator_control(Offboard::ActuatorControl actuator_control)
 {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _actuator_control = actuator_control;
-
-        if (_mode != Mode::ActuatorControl) {
-            if (_call_every_cookie) {
-                // If we're already sending other setpoints, stop that now.
-                _parent->remove_call_every(_call_every_cookie);
-                _call_every_cookie = nullptr;
-            }
-            // We automatically send motor rate values from now on.
-            _parent->add_call_every(
-                [this]() { send_actuator_control(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-            _mode = Mode::ActuatorControl;
-        } else {
-            // We're already sending these kind of values. Since the value changes, let's
-            // reschedule the next call, so we don't send values too often.
-            _parent->reset_call_every(_call_every_cookie);
-        }
-    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    _actuator_control = actuator_control;
+    _mode = Mode::ActuatorControl;
 
-    // also send it right now to reduce latency
-    return send_actuator_control();
+    // Sent right away to reduce latency, and then repeated until the next setpoint.
+    return send_actuator_control_locked();
 }
 
-Offboard::Result OffboardImpl::send_position_ned()
+Offboard::Result OffboardImpl::send_position_ned_locked()
 {
     const static uint16_t IGNORE_VX = (1 << 3);
     const static uint16_t IGNORE_VY = (1 << 4);
@@ -383,10 +241,7 @@ Offboard::Result OffboardImpl::send_position_ned()
     const static uint16_t IGNORE_AZ = (1 << 8);
     const static uint16_t IGNORE_YAW_RATE = (1 << 11);
 
-    const auto position_ned_yaw = [this]() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _position_ned_yaw;
-    }();
+    const auto position_ned_yaw = _position_ned_yaw;
 
     mavlink_message_t message;
     mavlink_msg_set_position_target_local_ned_pack(
@@ -409,11 +264,10 @@ Offboard::Result OffboardImpl::send_position_ned()
         0.0f, // afz
         to_rad_from_deg(position_ned_yaw.yaw_deg), // yaw
         0.0f); // yaw_rate
-    return _parent->send_message(message) ? Offboard::Result::Success :
-                                            Offboard::Result::ConnectionError;
+    return send_setpoint_locked(message, MavlinkSetpointStreamer::Timestamp::TimeBootMs);
 }
 
-Offboard::Result OffboardImpl::send_position_global()
+Offboard::Result OffboardImpl::send_position_global_locked()
 {
     const static uint16_t IGNORE_VX = (1 << 3);
     const static uint16_t IGNORE_VY = (1 << 4);
@@ -423,10 +277,7 @@ Offboard::Result OffboardImpl::send_position_global()
     const static uint16_t IGNORE_AZ = (1 << 8);
     const static uint16_t IGNORE_YAW_RATE = (1 << 11);
 
-    const auto position_global_yaw = [this]() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _position_global_yaw;
-    }();
+    const auto position_global_yaw = _position_global_yaw;
 
     MAV_FRAME frame;
     switch (position_global_yaw.altitude_type) {
@@ -465,11 +316,10 @@ Offboard::Result OffboardImpl::send_position_global()
         0.0f, // afz
         to_rad_from_deg(position_global_yaw.yaw_deg), // yaw
         0.0f); // yaw_rate
-    return _parent->send_message(message) ? Offboard::Result::Success :
-                                            Offboard::Result::ConnectionError;
+    return send_setpoint_locked(message, MavlinkSetpointStreamer::Timestamp::TimeBootMs);
 }
 
-Offboard::Result OffboardImpl::send_velocity_ned()
+Offboard::Result OffboardImpl::send_velocity_ned_locked()
 {
     const static uint16_t IGNORE_X = (1 << 0);
     const static uint16_t IGNORE_Y = (1 << 1);
@@ -479,10 +329,7 @@ Offboard::Result OffboardImpl::send_velocity_ned()
     const static uint16_t IGNORE_AZ = (1 << 8);
     const static uint16_t IGNORE_YAW_RATE = (1 << 11);
 
-    const auto velocity_ned_yaw = [this]() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _velocity_ned_yaw;
-    }();
+    const auto velocity_ned_yaw = _velocity_ned_yaw;
 
     mavlink_message_t message;
     mavlink_msg_set_position_target_local_ned_pack(
@@ -505,21 +352,17 @@ Offboard::Result OffboardImpl::send_velocity_ned()
         0.0f, // afz
         to_rad_from_deg(velocity_ned_yaw.yaw_deg), // yaw
         0.0f); // yaw_rate
-    return _parent->send_message(message) ? Offboard::Result::Success :
-                                            Offboard::Result::ConnectionError;
+    return send_setpoint_locked(message, MavlinkSetpointStreamer::Timestamp::TimeBootMs);
 }
 
-Offboard::Result OffboardImpl::send_position_velocity_ned()
+Offboard::Result OffboardImpl::send_position_velocity_ned_locked()
 {
     const static uint16_t IGNORE_AX = (1 << 6);
     const static uint16_t IGNORE_AY = (1 << 7);
     const static uint16_t IGNORE_AZ = (1 << 8);
     const static uint16_t IGNORE_YAW_RATE = (1 << 11);
 
-    const auto position_and_velocity = [this]() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return std::make_pair<>(_position_ned_yaw, _velocity_ned_yaw);
-    }();
+    const auto position_and_velocity = std::make_pair<>(_position_ned_yaw, _velocity_ned_yaw);
 
     mavlink_message_t message;
     mavlink_msg_set_position_target_local_ned_pack(
@@ -542,11 +385,10 @@ Offboard::Result OffboardImpl::send_position_velocity_ned()
         0.0f, // afz
         to_rad_from_deg(position_and_velocity.first.yaw_deg), // yaw
         0.0f); // yaw_rate
-    return _parent->send_message(message) ? Offboard::Result::Success :
-                                            Offboard::Result::ConnectionError;
+    return send_setpoint_locked(message, MavlinkSetpointStreamer::Timestamp::TimeBootMs);
 }
 
-Offboard::Result OffboardImpl::send_acceleration_ned()
+Offboard::Result OffboardImpl::send_acceleration_ned_locked()
 {
     const static uint16_t IGNORE_X = (1 << 0);
     const static uint16_t IGNORE_Y = (1 << 1);
@@ -557,10 +399,7 @@ Offboard::Result OffboardImpl::send_acceleration_ned()
     const static uint16_t IGNORE_YAW = (1 << 10);
     const static uint16_t IGNORE_YAW_RATE = (1 << 11);
 
-    const auto acceleration_ned = [this]() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _acceleration_ned;
-    }();
+    const auto acceleration_ned = _acceleration_ned;
 
     mavlink_message_t message;
     mavlink_msg_set_position_target_local_ned_pack(
@@ -584,11 +423,10 @@ Offboard::Result OffboardImpl::send_acceleration_ned()
         acceleration_ned.down_m_s2,
         0.0f, // yaw
         0.0f); // yaw_rate
-    return _parent->send_message(message) ? Offboard::Result::Success :
-                                            Offboard::Result::ConnectionError;
+    return send_setpoint_locked(message, MavlinkSetpointStreamer::Timestamp::TimeBootMs);
 }
 
-Offboard::Result OffboardImpl::send_velocity_body()
+Offboard::Result OffboardImpl::send_velocity_body_locked()
 {
     const static uint16_t IGNORE_X = (1 << 0);
     const static uint16_t IGNORE_Y = (1 << 1);
@@ -598,10 +436,7 @@ Offboard::Result OffboardImpl::send_velocity_body()
     const static uint16_t IGNORE_AZ = (1 << 8);
     const static uint16_t IGNORE_YAW = (1 << 10);
 
-    const auto velocity_body_yawspeed = [this]() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _velocity_body_yawspeed;
-    }();
+    const auto velocity_body_yawspeed = _velocity_body_yawspeed;
 
     mavlink_message_t message;
     mavlink_msg_set_position_target_local_ned_pack(
@@ -624,20 +459,16 @@ Offboard::Result OffboardImpl::send_velocity_body()
         0.0f, // afz
         0.0f, // yaw
         to_rad_from_deg(velocity_body_yawspeed.yawspeed_deg_s));
-    return _parent->send_message(message) ? Offboard::Result::Success :
-                                            Offboard::Result::ConnectionError;
+    return send_setpoint_locked(message, MavlinkSetpointStreamer::Timestamp::TimeBootMs);
 }
 
-Offboard::Result OffboardImpl::send_attitude()
+Offboard::Result OffboardImpl::send_attitude_locked()
 {
     const static uint8_t IGNORE_BODY_ROLL_RATE = (1 << 0);
     const static uint8_t IGNORE_BODY_PITCH_RATE = (1 << 1);
     const static uint8_t IGNORE_BODY_YAW_RATE = (1 << 2);
 
-    const auto attitude = [this]() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _attitude;
-    }();
+    const auto attitude = _attitude;
 
     const float thrust = _attitude.thrust_value;
     const float roll = to_rad_from_deg(attitude.roll_deg);
@@ -675,18 +506,14 @@ Offboard::Result OffboardImpl::send_attitude()
         0,
         thrust,
         thrust_body);
-    return _parent->send_message(message) ? Offboard::Result::Success :
-                                            Offboard::Result::ConnectionError;
+    return send_setpoint_locked(message, MavlinkSetpointStreamer::Timestamp::TimeBootMs);
 }
 
-Offboard::Result OffboardImpl::send_attitude_rate()
+Offboard::Result OffboardImpl::send_attitude_rate_locked()
 {
     const static uint8_t IGNORE_ATTITUDE = (1 << 7);
 
-    const auto attitude_rate = [this]() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _attitude_rate;
-    }();
+    const auto attitude_rate = _attitude_rate;
 
     const float thrust_body[3] = {0.0f, 0.0f, 0.0f};
 
@@ -705,33 +532,29 @@ Offboard::Result OffboardImpl::send_attitude_rate()
         to_rad_from_deg(attitude_rate.yaw_deg_s),
         _attitude_rate.thrust_value,
         thrust_body);
-    return _parent->send_message(message) ? Offboard::Result::Success :
-                                            Offboard::Result::ConnectionError;
+    return send_setpoint_locked(message, MavlinkSetpointStreamer::Timestamp::TimeBootMs);
 }
 
-Offboard::Result
-OffboardImpl::send_actuator_control_message(const float* controls, uint8_t group_number)
+void OffboardImpl::pack_actuator_control_message(
+    mavlink_message_t& message, const float* controls, uint8_t group_number)
 {
-    mavlink_message_t message;
     mavlink_msg_set_actuator_control_target_pack(
         _parent->get_own_system_id(),
         _parent->get_own_component_id(),
         &message,
-        static_cast<uint32_t>(_parent->get_time().elapsed_ms()),
+        _parent->get_time().elapsed_us(),
         group_number,
         _parent->get_system_id(),
         _parent->get_autopilot_id(),
         controls);
-    return _parent->send_message(message) ? Offboard::Result::Success :
-                                            Offboard::Result::ConnectionError;
 }
 
-Offboard::Result OffboardImpl::send_actuator_control()
+Offboard::Result OffboardImpl::send_actuator_control_locked()
 {
-    Offboard::ActuatorControl actuator_control = [this]() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _actuator_control;
-    }();
+    Offboard::ActuatorControl actuator_control = _actuator_control;
+
+    std::array<mavlink_message_t, MavlinkSetpointStreamer::MAX_MESSAGES> messages;
+    std::size_t num_messages = 0;
 
     for (int i = 0; i < 2; i++) {
         int nan_count = 0;
@@ -742,13 +565,22 @@ Offboard::Result OffboardImpl::send_actuator_control()
             }
         }
         if (nan_count < 8) {
-            auto result = send_actuator_control_message(&actuator_control.groups[i].controls[0], i);
-            if (result != Offboard::Result::Success) {
-                return result;
-            }
+            pack_actuator_control_message(
+                messages[num_messages++], &actuator_control.groups[i].controls[0], i);
         }
     }
-    return Offboard::Result::Success;
+
+    return _setpoint_streamer.send(
+               messages.data(), num_messages, MavlinkSetpointStreamer::Timestamp::TimeUsec) ?
+               Offboard::Result::Success :
+               Offboard::Result::ConnectionError;
+}
+
+Offboard::Result OffboardImpl::send_setpoint_locked(
+    const mavlink_message_t& message, MavlinkSetpointStreamer::Timestamp timestamp)
+{
+    return _setpoint_streamer.send(message, timestamp) ? Offboard::Result::Success :
+                                                         Offboard::Result::ConnectionError;
 }
 
 void OffboardImpl::process_heartbeat(const mavlink_message_t& message)
@@ -790,10 +622,7 @@ void OffboardImpl::stop_sending_setpoints()
 {
     // We assume that we already acquired the mutex in this function.
 
-    if (_call_every_cookie != nullptr) {
-        _parent->remove_call_every(_call_every_cookie);
-        _call_every_cookie = nullptr;
-    }
+    _setpoint_streamer.stop();
     _mode = Mode::NotActive;
 }
 
@@ -3,6 +3,7 @@
 #include <mutex>
 
 #include "mavlink_include.h"
+#include "mavlink_setpoint_streamer.h"
 #include "plugins/offboard/offboard.h"
 #include "plugin_impl_base.h"
 #include "system.h"
@@ -44,16 +45,21 @@ public:
     OffboardImpl& operator=(const OffboardImpl&) = delete;
 
 private:
-    Offboard::Result send_position_ned();
-    Offboard::Result send_position_global();
-    Offboard::Result send_velocity_ned();
-    Offboard::Result send_position_velocity_ned();
-    Offboard::Result send_acceleration_ned();
-    Offboard::Result send_velocity_body();
-    Offboard::Result send_attitude_rate();
-    Offboard::Result send_attitude();
-    Offboard::Result send_actuator_control();
-    Offboard::Result send_actuator_control_message(const float* controls, uint8_t group_number = 0);
+    // These are called with the mutex held, so that a stop or another kind of
+    // setpoint can't come in between setting the mode and streaming the setpoint.
+    Offboard::Result send_position_ned_locked();
+    Offboard::Result send_position_global_locked();
+    Offboard::Result send_velocity_ned_locked();
+    Offboard::Result send_position_velocity_ned_locked();
+    Offboard::Result send_acceleration_ned_locked();
+    Offboard::Result send_velocity_body_locked();
+    Offboard::Result send_attitude_rate_locked();
+    Offboard::Result send_attitude_locked();
+    Offboard::Result send_actuator_control_locked();
+    void pack_actuator_control_message(
+        mavlink_message_t& message, const float* controls, uint8_t group_number);
+    Offboard::Result send_setpoint_locked(
+        const mavlink_message_t& message, MavlinkSetpointStreamer::Timestamp timestamp);
 
     void process_heartbeat(const mavlink_message_t& message);
     void receive_command_result(
@@ -90,9 +96,9 @@ private:
     Offboard::ActuatorControl _actuator_control{};
     dl_time_t _last_started{};
 
-    void* _call_every_cookie = nullptr;
-
-    const float SEND_INTERVAL_S = 0.05f;
+    // Repeats the latest setpoint, as the autopilot leaves offboard mode without them.
+    MavlinkSetpointStreamer _setpoint_streamer;
+    static constexpr double SEND_INTERVAL_S = 0.05;
 };
 
 } // namespace mavsdk
@@ -13,10 +13,6 @@ TelemetryServerImpl::TelemetryServerImpl(std::shared_ptr<ServerComponent> server
 TelemetryServerImpl::~TelemetryServerImpl()
 {
     _server_component_impl->unregister_plugin(this);
-    std::unique_lock<std::mutex> lock(_interval_mutex);
-    for (const auto& request : _interval_requests) {
-        _server_component_impl->remove_call_every(request.cookie);
-    }
 }
 
 void TelemetryServerImpl::init()
@@ -25,44 +21,25 @@ void TelemetryServerImpl::init()
     _server_component_impl->register_mavlink_command_handler(
         MAV_CMD_SET_MESSAGE_INTERVAL,
         [this](const MavlinkCommandReceiver::CommandLong& command) {
-            std::lock_guard<std::mutex> lock(_interval_mutex);
             uint32_t msgid = static_cast<uint32_t>(command.params.param1);
-            // Set interval to 1hz if 0 (default rate)
-            uint32_t interval_ms =
-                command.params.param2 == 0 ?
-                    1000 :
-                    static_cast<uint32_t>(static_cast<double>(command.params.param2) * 1E-3);
-            LogDebug() << "Setting interval for msg id: " << std::to_string(msgid)
-                       << " interval_ms:" << std::to_string(interval_ms);
-            auto found = std::find_if(
-                _interval_requests.begin(),
-                _interval_requests.end(),
-                [msgid](const RequestMsgInterval& item) { return item.msg_id == msgid; });
-
-            if (found == _interval_requests.end() && command.params.param2 != -1) {
-                // If not found interval already, add a new one
-                _interval_requests.push_back({msgid, interval_ms, nullptr});
-                _server_component_impl->add_call_every(
-                    [this, msgid]() {
-                        std::lock_guard<std::mutex> lock_interval(_interval_mutex);
-                        if (_msg_cache.find(msgid) != _msg_cache.end()) {
-                            // Publish if callback exists :)
-                            _server_component_impl->send_message(_msg_cache.at(msgid));
-                        }
-                    },
-                    static_cast<double>(interval_ms) * 1E-3,
-                    &_interval_requests.back().cookie);
+            auto& stream_scheduler = _server_component_impl->stream_scheduler();
+
+            if (command.params.param2 == -1) {
+                // Deregister with -1 interval
+                LogDebug() << "Stopping stream of msg id: " << std::to_string(msgid);
+                std::lock_guard<std::mutex> lock(_streamed_msgids_mutex);
+                stream_scheduler.remove_stream(msgid);
+                _streamed_msgids.erase(msgid);
             } else {
-                if (command.params.param2 == -1) {
-                    // Deregister with -1 interval
-                    _server_component_impl->remove_call_every(found->cookie);
-                    _interval_requests.erase(found);
-                } else {
-                    // Update Interval
-                    found->interval = interval_ms;
-                    _server_component_impl->change_call_every(
-                        static_cast<double>(interval_ms) * 1E-3, found->cookie);
-                }
+                // Set interval to 1hz if 0 (default rate)
+                const double interval_s = command.params.param2 == 0 ?
+                                              1.0 :
+                                              static_cast<double>(command.params.param2) * 1E-6;
+                LogDebug() << "Setting interval for msg id: " << std::to_string(msgid)
+                           << " interval_s:" << interval_s;
+                std::lock_guard<std::mutex> lock(_streamed_msgids_mutex);
+                stream_scheduler.set_stream(msgid, interval_s, stream_priority(msgid));
+                _streamed_msgids.insert(msgid);
             }
 
             return _server_component_impl->make_command_ack_message(
@@ -71,7 +48,48 @@ void TelemetryServerImpl::init()
         this);
 }
 
-void TelemetryServerImpl::deinit() {}
+void TelemetryServerImpl::deinit()
+{
+    _server_component_impl->unregister_all_mavlink_command_handlers(this);
+
+    // Otherwise the scheduler keeps sending the last published messages.
+    std::lock_guard<std::mutex> lock(_streamed_msgids_mutex);
+    auto& stream_scheduler = _server_component_impl->stream_scheduler();
+    for (const auto msgid : _streamed_msgids) {
+        stream_scheduler.remove_stream(msgid);
+    }
+    _streamed_msgids.clear();
+}
+
+MavlinkStreamScheduler::Priority TelemetryServerImpl::stream_priority(uint32_t msgid)
+{
+    // What is needed to fly and to know the state of the vehicle comes first,
+    // sensor details last.
+    switch (msgid) {
+        case MAVLINK_MSG_ID_SYS_STATUS:
+        case MAVLINK_MSG_ID_EXTENDED_SYS_STATE:
+        case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+        case MAVLINK_MSG_ID_LOCAL_POSITION_NED:
+            return MavlinkStreamScheduler::Priority::High;
+        case MAVLINK_MSG_ID_HIGHRES_IMU:
+        case MAVLINK_MSG_ID_SCALED_IMU:
+        case MAVLINK_MSG_ID_RAW_IMU:
+            return MavlinkStreamScheduler::Priority::Low;
+        default:
+            return MavlinkStreamScheduler::Priority::Normal;
+    }
+}
+
+TelemetryServer::Result TelemetryServerImpl::publish_message(uint32_t msgid, mavlink_message_t& msg)
+{
+    // If the message is streamed, the stream sends it at the requested rate.
+    if (_server_component_impl->stream_scheduler().update(msgid, msg)) {
+        return TelemetryServer::Result::Success;
+    }
+
+    return _server_component_impl->send_message(msg) ? TelemetryServer::Result::Success :
+                                                       TelemetryServer::Result::Unsupported;
+}
 
 TelemetryServer::Result TelemetryServerImpl::publish_position(
     TelemetryServer::Position position,
@@ -93,10 +111,7 @@ TelemetryServer::Result TelemetryServerImpl::publish_position(
         static_cast<int16_t>(static_cast<double>(velocity_ned.down_m_s) * 1E2),
         static_cast<uint16_t>(static_cast<double>(heading.heading_deg) * 1E2));
 
-    add_msg_cache(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, msg);
-
-    return _server_component_impl->send_message(msg) ? TelemetryServer::Result::Success :
-                                                       TelemetryServer::Result::Unsupported;
+    return publish_message(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, msg);
 }
 
 TelemetryServer::Result TelemetryServerImpl::publish_home(TelemetryServer::Position home)
@@ -120,10 +135,7 @@ TelemetryServer::Result TelemetryServerImpl::publish_home(TelemetryServer::Posit
         get_boot_time_ms() // TO-DO: System boot
     );
 
-    add_msg_cache(MAVLINK_MSG_ID_HOME_POSITION, msg);
-
-    return _server_component_impl->send_message(msg) ? TelemetryServer::Result::Success :
-                                                       TelemetryServer::Result::Unsupported;
+    return publish_message(MAVLINK_MSG_ID_HOME_POSITION, msg);
 }
 
 TelemetryServer::Result TelemetryServerImpl::publish_raw_gps(
@@ -151,10 +163,7 @@ TelemetryServer::Result TelemetryServerImpl::publish_raw_gps(
         static_cast<uint32_t>(static_cast<double>(raw_gps.heading_uncertainty_deg) * 1E5),
         static_cast<uint16_t>(static_cast<double>(raw_gps.yaw_deg) * 1E2));
 
-    add_msg_cache(MAVLINK_MSG_ID_GPS_RAW_INT, msg);
-
-    return _server_component_impl->send_message(msg) ? TelemetryServer::Result::Success :
-                                                       TelemetryServer::Result::Unsupported;
+    return publish_message(MAVLINK_MSG_ID_GPS_RAW_INT, msg);
 }
 
 TelemetryServer::Result TelemetryServerImpl::publish_battery(TelemetryServer::Battery battery)
@@ -184,10 +193,7 @@ TelemetryServer::Result TelemetryServerImpl::publish_battery(TelemetryServer::Ba
         MAV_BATTERY_MODE_UNKNOWN,
         0);
 
-    add_msg_cache(MAVLINK_MSG_ID_BATTERY_STATUS, msg);
-
-    return _server_component_impl->send_message(msg) ? TelemetryServer::Result::Success :
-                                                       TelemetryServer::Result::Unsupported;
+    return publish_message(MAVLINK_MSG_ID_BATTERY_STATUS, msg);
 }
 
 TelemetryServer::Result
@@ -264,10 +270,7 @@ TelemetryServer::Result TelemetryServerImpl::publish_position_velocity_ned(
         position_velocity_ned.velocity.east_m_s,
         position_velocity_ned.velocity.down_m_s);
 
-    add_msg_cache(MAVLINK_MSG_ID_LOCAL_POSITION_NED, msg);
-
-    return _server_component_impl->send_message(msg) ? TelemetryServer::Result::Success :
-                                                       TelemetryServer::Result::Unsupported;
+    return publish_message(MAVLINK_MSG_ID_LOCAL_POSITION_NED, msg);
 }
 
 TelemetryServer::Result
@@ -358,10 +361,7 @@ TelemetryServer::Result TelemetryServerImpl::publish_sys_status(
         0,
         0);
 
-    add_msg_cache(MAVLINK_MSG_ID_SYS_STATUS, msg);
-
-    return _server_component_impl->send_message(msg) ? TelemetryServer::Result::Success :
-                                                       TelemetryServer::Result::Unsupported;
+    return publish_message(MAVLINK_MSG_ID_SYS_STATUS, msg);
 }
 
 uint8_t to_mav_vtol_state(TelemetryServer::VtolState vtol_state)
@@ -409,16 +409,7 @@ TelemetryServer::Result TelemetryServerImpl::publish_extended_sys_state(
         to_mav_vtol_state(vtol_state),
         to_mav_landed_state(landed_state));
 
-    add_msg_cache(MAVLINK_MSG_ID_EXTENDED_SYS_STATE, msg);
-
-    return _server_component_impl->send_message(msg) ? TelemetryServer::Result::Success :
-                                                       TelemetryServer::Result::Unsupported;
-}
-
-void TelemetryServerImpl::add_msg_cache(uint64_t id, mavlink_message_t& msg)
-{
-    std::unique_lock<std::mutex> lock(_interval_mutex);
-    _msg_cache.insert_or_assign(id, msg);
+    return publish_message(MAVLINK_MSG_ID_EXTENDED_SYS_STATE, msg);
 }
 
 } // namespace mavsdk
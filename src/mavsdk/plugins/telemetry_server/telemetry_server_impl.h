@@ -2,20 +2,16 @@
 
 #include "plugins/telemetry_server/telemetry_server.h"
 #include "server_plugin_impl_base.h"
+#include "mavlink_stream_scheduler.h"
 
-#include <unordered_map>
 #include <chrono>
+#include <mutex>
+#include <set>
 
 namespace mavsdk {
 
 class TelemetryServerImpl : public ServerPluginImplBase {
 public:
-    struct RequestMsgInterval {
-        uint32_t msg_id{0};
-        uint32_t interval{0};
-        void* cookie{nullptr};
-    };
-
     explicit TelemetryServerImpl(std::shared_ptr<ServerComponent> server_component);
     ~TelemetryServerImpl() override;
 
@@ -75,11 +71,12 @@ public:
 private:
     std::chrono::time_point<std::chrono::steady_clock> _start_time;
 
-    std::vector<RequestMsgInterval> _interval_requests;
-    std::mutex _interval_mutex;
-    std::unordered_map<uint64_t, mavlink_message_t> _msg_cache;
+    // The streams set up by this plugin, so they can be removed on deinit.
+    std::mutex _streamed_msgids_mutex{};
+    std::set<uint32_t> _streamed_msgids{};
 
-    void add_msg_cache(uint64_t id, mavlink_message_t& msg);
+    static MavlinkStreamScheduler::Priority stream_priority(uint32_t msgid);
+    TelemetryServer::Result publish_message(uint32_t msgid, mavlink_message_t& msg);
 
     uint64_t get_boot_time_ms()
     {
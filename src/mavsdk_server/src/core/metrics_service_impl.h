@@ -0,0 +1,84 @@
+// This service is not generated from MAVSDK-Proto, the proto file lives in
+// src/mavsdk_server/src/protos/metrics/metrics.proto.
+
+#include "metrics/metrics.grpc.pb.h"
+#include "mavsdk.h"
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+template<typename Mavsdk = Mavsdk>
+class MetricsServiceImpl final : public mavsdk::rpc::metrics::MetricsService::Service {
+public:
+    MetricsServiceImpl(Mavsdk& mavsdk) : _mavsdk(mavsdk) {}
+
+    static rpc::metrics::Metric::Type translateToRpcType(const mavsdk::Mavsdk::Metric::Type& type)
+    {
+        switch (type) {
+            default:
+            case mavsdk::Mavsdk::Metric::Type::Counter:
+                return rpc::metrics::Metric_Type_TYPE_COUNTER;
+            case mavsdk::Mavsdk::Metric::Type::Gauge:
+                return rpc::metrics::Metric_Type_TYPE_GAUGE;
+            case mavsdk::Mavsdk::Metric::Type::Histogram:
+                return rpc::metrics::Metric_Type_TYPE_HISTOGRAM;
+        }
+    }
+
+    static void
+    translateToRpcMetric(const mavsdk::Mavsdk::Metric& metric, rpc::metrics::Metric* rpc_metric)
+    {
+        rpc_metric->set_name(metric.name);
+        rpc_metric->set_help(metric.help);
+        rpc_metric->set_type(translateToRpcType(metric.type));
+
+        for (const auto& label : metric.labels) {
+            auto* rpc_label = rpc_metric->add_labels();
+            rpc_label->set_name(label.first);
+            rpc_label->set_value(label.second);
+        }
+
+        rpc_metric->set_value(metric.value);
+        rpc_metric->set_count(metric.count);
+
+        for (const auto& bucket : metric.buckets) {
+            auto* rpc_bucket = rpc_metric->add_buckets();
+            rpc_bucket->set_upper_bound(bucket.first);
+            rpc_bucket->set_count(bucket.second);
+        }
+    }
+
+    grpc::Status GetMetrics(
+        grpc::ServerContext* /* context */,
+        const rpc::metrics::GetMetricsRequest* /* request */,
+        rpc::metrics::GetMetricsResponse* response) override
+    {
+        if (response != nullptr) {
+            for (const auto& metric : _mavsdk.metrics()) {
+                translateToRpcMetric(metric, response->add_metrics());
+            }
+        }
+
+        return grpc::Status::OK;
+    }
+
+    grpc::Status GetPrometheusText(
+        grpc::ServerContext* /* context */,
+        const rpc::metrics::GetPrometheusTextRequest* /* request */,
+        rpc::metrics::GetPrometheusTextResponse* response) override
+    {
+        if (response != nullptr) {
+            response->set_text(_mavsdk.metrics_prometheus());
+        }
+
+        return grpc::Status::OK;
+    }
+
+    void stop() {}
+
+private:
+    Mavsdk& _mavsdk;
+};
+
+} // namespace mavsdk_server
+} // namespace mavsdk
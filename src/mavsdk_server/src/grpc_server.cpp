@@ -19,6 +19,7 @@ int GrpcServer::run()
     setup_port(builder);
 
     builder.RegisterService(&_core);
+    builder.RegisterService(&_metrics_service);
     builder.RegisterService(&_action_service);
     builder.RegisterService(&_action_server_service);
     builder.RegisterService(&_calibration_service);
@@ -32,6 +33,7 @@ int GrpcServer::run()
     builder.RegisterService(&_info_service);
     builder.RegisterService(&_log_files_service);
     builder.RegisterService(&_manual_control_service);
+    builder.RegisterService(&_mavlink_passthrough_service);
     builder.RegisterService(&_mission_service);
     builder.RegisterService(&_mission_raw_service);
     builder.RegisterService(&_mission_raw_server_service);
@@ -72,6 +74,7 @@ void GrpcServer::stop()
 {
     if (_server != nullptr) {
         _core.stop();
+        _metrics_service.stop();
         _action_service.stop();
         _action_server_service.stop();
         _calibration_service.stop();
@@ -85,6 +88,7 @@ void GrpcServer::stop()
         _info_service.stop();
         _log_files_service.stop();
         _manual_control_service.stop();
+        _mavlink_passthrough_service.stop();
         _mission_service.stop();
         _mission_raw_service.stop();
         _mission_raw_server_service.stop();
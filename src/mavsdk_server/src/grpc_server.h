@@ -6,6 +6,7 @@
 
 #include "mavsdk.h"
 #include "core/core_service_impl.h"
+#include "core/metrics_service_impl.h"
 #include "plugins/action/action.h"
 #include "action/action_service_impl.h"
 #include "plugins/action_server/action_server.h"
@@ -32,6 +33,8 @@
 #include "log_files/log_files_service_impl.h"
 #include "plugins/manual_control/manual_control.h"
 #include "manual_control/manual_control_service_impl.h"
+#include "plugins/mavlink_passthrough/mavlink_passthrough.h"
+#include "mavlink_passthrough/mavlink_passthrough_service_impl.h"
 #include "plugins/mission/mission.h"
 #include "mission/mission_service_impl.h"
 #include "plugins/mission_raw/mission_raw.h"
@@ -68,6 +71,7 @@ class GrpcServer {
 public:
     GrpcServer(Mavsdk& mavsdk) :
         _core(mavsdk),
+        _metrics_service(mavsdk),
         _action_lazy_plugin(mavsdk),
         _action_service(_action_lazy_plugin),
         _action_server_lazy_plugin(mavsdk),
@@ -94,6 +98,8 @@ public:
         _log_files_service(_log_files_lazy_plugin),
         _manual_control_lazy_plugin(mavsdk),
         _manual_control_service(_manual_control_lazy_plugin),
+        _mavlink_passthrough_lazy_plugin(mavsdk),
+        _mavlink_passthrough_service(_mavlink_passthrough_lazy_plugin),
         _mission_lazy_plugin(mavsdk),
         _mission_service(_mission_lazy_plugin),
         _mission_raw_lazy_plugin(mavsdk),
@@ -133,6 +139,7 @@ private:
     void setup_port(grpc::ServerBuilder& builder);
 
     CoreServiceImpl<> _core;
+    MetricsServiceImpl<> _metrics_service;
     LazyPlugin<Action> _action_lazy_plugin;
     ActionServiceImpl<> _action_service;
     LazyServerPlugin<ActionServer> _action_server_lazy_plugin;
@@ -159,6 +166,8 @@ private:
     LogFilesServiceImpl<> _log_files_service;
     LazyPlugin<ManualControl> _manual_control_lazy_plugin;
     ManualControlServiceImpl<> _manual_control_service;
+    LazyPlugin<MavlinkPassthrough> _mavlink_passthrough_lazy_plugin;
+    MavlinkPassthroughServiceImpl<> _mavlink_passthrough_service;
     LazyPlugin<Mission> _mission_lazy_plugin;
     MissionServiceImpl<> _mission_service;
     LazyPlugin<MissionRaw> _mission_raw_lazy_plugin;
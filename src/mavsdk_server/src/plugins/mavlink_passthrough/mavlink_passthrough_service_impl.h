@@ -0,0 +1,166 @@
+// This service is not generated from MAVSDK-Proto, the proto file lives in
+// src/mavsdk_server/src/protos/mavlink_passthrough/mavlink_passthrough.proto.
+
+#include "mavlink_passthrough/mavlink_passthrough.grpc.pb.h"
+#include "plugins/mavlink_passthrough/mavlink_passthrough.h"
+
+#include "mavsdk.h"
+
+#include "lazy_plugin.h"
+
+#include "log.h"
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace mavsdk {
+namespace mavsdk_server {
+
+template<
+    typename MavlinkPassthrough = MavlinkPassthrough,
+    typename LazyPlugin = LazyPlugin<MavlinkPassthrough>>
+
+class MavlinkPassthroughServiceImpl final
+    : public rpc::mavlink_passthrough::MavlinkPassthroughService::Service {
+public:
+    static constexpr unsigned DEFAULT_MAX_FRAMES_PER_BATCH = 64;
+    static constexpr double DEFAULT_MAX_BATCH_LATENCY_S = 0.05;
+
+    MavlinkPassthroughServiceImpl(LazyPlugin& lazy_plugin) : _lazy_plugin(lazy_plugin) {}
+
+    static typename MavlinkPassthrough::RawFrameFilter
+    translateFromRpcRequest(const rpc::mavlink_passthrough::SubscribeRawFramesRequest& request)
+    {
+        typename MavlinkPassthrough::RawFrameFilter filter;
+
+        filter.message_ids.assign(request.message_ids().begin(), request.message_ids().end());
+
+        for (const auto system_id : request.system_ids()) {
+            filter.system_ids.push_back(static_cast<uint8_t>(system_id));
+        }
+
+        return filter;
+    }
+
+    static void translateToRpcRawFrameBatch(
+        const typename MavlinkPassthrough::RawFrameBatch& raw_frame_batch,
+        rpc::mavlink_passthrough::RawFrameBatch* rpc_raw_frame_batch)
+    {
+        rpc_raw_frame_batch->set_data(raw_frame_batch.data.data(), raw_frame_batch.data.size());
+
+        rpc_raw_frame_batch->mutable_frame_lengths()->Add(
+            raw_frame_batch.frame_lengths.begin(), raw_frame_batch.frame_lengths.end());
+
+        rpc_raw_frame_batch->mutable_timestamps_us()->Add(
+            raw_frame_batch.timestamps_us.begin(), raw_frame_batch.timestamps_us.end());
+    }
+
+    grpc::Status SubscribeRawFrames(
+        grpc::ServerContext* /* context */,
+        const mavsdk::rpc::mavlink_passthrough::SubscribeRawFramesRequest* request,
+        grpc::ServerWriter<rpc::mavlink_passthrough::RawFramesResponse>* writer) override
+    {
+        if (_lazy_plugin.maybe_plugin() == nullptr) {
+            return grpc::Status::OK;
+        }
+
+        if (request == nullptr) {
+            LogWarn() << "SubscribeRawFrames sent with a null request! Ignoring...";
+            return grpc::Status::OK;
+        }
+
+        const unsigned max_frames_per_batch = request->max_frames_per_batch() > 0 ?
+                                                  request->max_frames_per_batch() :
+                                                  DEFAULT_MAX_FRAMES_PER_BATCH;
+        const double max_batch_latency_s = request->max_batch_latency_s() > 0.0 ?
+                                               request->max_batch_latency_s() :
+                                               DEFAULT_MAX_BATCH_LATENCY_S;
+
+        auto stream_closed_promise = std::make_shared<std::promise<void>>();
+        auto stream_closed_future = stream_closed_promise->get_future();
+        register_stream_stop_promise(stream_closed_promise);
+
+        auto is_finished = std::make_shared<bool>(false);
+        auto subscribe_mutex = std::make_shared<std::mutex>();
+        // Each stream has a subscription of its own, so that concurrent
+        // clients don't replace each other's.
+        auto handle = std::make_shared<typename MavlinkPassthrough::RawFramesHandle>(0);
+
+        std::unique_lock<std::mutex> subscribe_lock(*subscribe_mutex);
+        *handle = _lazy_plugin.maybe_plugin()->subscribe_raw_frames(
+            translateFromRpcRequest(*request),
+            [this, &writer, &stream_closed_promise, is_finished, subscribe_mutex, handle](
+                const typename MavlinkPassthrough::RawFrameBatch& raw_frame_batch) {
+                rpc::mavlink_passthrough::RawFramesResponse rpc_response;
+
+                translateToRpcRawFrameBatch(
+                    raw_frame_batch, rpc_response.mutable_raw_frame_batch());
+
+                std::unique_lock<std::mutex> lock(*subscribe_mutex);
+                if (!*is_finished && !writer->Write(rpc_response)) {
+                    _lazy_plugin.maybe_plugin()->unsubscribe_raw_frames(*handle);
+
+                    *is_finished = true;
+                    unregister_stream_stop_promise(stream_closed_promise);
+                    stream_closed_promise->set_value();
+                }
+            },
+            max_frames_per_batch,
+            max_batch_latency_s);
+        subscribe_lock.unlock();
+
+        stream_closed_future.wait();
+        std::unique_lock<std::mutex> lock(*subscribe_mutex);
+        if (!*is_finished) {
+            // Stopped by the server, the callback must not use the writer anymore.
+            _lazy_plugin.maybe_plugin()->unsubscribe_raw_frames(*handle);
+        }
+        *is_finished = true;
+
+        return grpc::Status::OK;
+    }
+
+    void stop()
+    {
+        _stopped.store(true);
+        for (auto& prom : _stream_stop_promises) {
+            if (auto handle = prom.lock()) {
+                handle->set_value();
+            }
+        }
+    }
+
+private:
+    void register_stream_stop_promise(std::weak_ptr<std::promise<void>> prom)
+    {
+        // If we have already stopped, set promise immediately and don't add it to list.
+        if (_stopped.load()) {
+            if (auto handle = prom.lock()) {
+                handle->set_value();
+            }
+        } else {
+            _stream_stop_promises.push_back(prom);
+        }
+    }
+
+    void unregister_stream_stop_promise(std::shared_ptr<std::promise<void>> prom)
+    {
+        for (auto it = _stream_stop_promises.begin(); it != _stream_stop_promises.end();
+             /* ++it */) {
+            if (it->lock() == prom) {
+                it = _stream_stop_promises.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    LazyPlugin& _lazy_plugin;
+
+    std::atomic<bool> _stopped{false};
+    std::vector<std::weak_ptr<std::promise<void>>> _stream_stop_promises{};
+};
+
+} // namespace mavsdk_server
+} // namespace mavsdk
@@ -0,0 +1,75 @@
+#include "log.h"
+#include "mavsdk.h"
+#include "system_tests_helper.h"
+#include "plugins/mavlink_passthrough/mavlink_passthrough.h"
+#include "plugins/offboard/offboard.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace mavsdk;
+
+TEST(SystemTest, OffboardStopAndSet)
+{
+    Mavsdk mavsdk_groundstation;
+    mavsdk_groundstation.set_configuration(
+        Mavsdk::Configuration{Mavsdk::Configuration::UsageType::GroundStation});
+
+    Mavsdk mavsdk_autopilot;
+    mavsdk_autopilot.set_configuration(
+        Mavsdk::Configuration{Mavsdk::Configuration::UsageType::Autopilot});
+
+    ASSERT_EQ(mavsdk_groundstation.add_any_connection("udp://:17000"), ConnectionResult::Success);
+    ASSERT_EQ(
+        mavsdk_autopilot.add_any_connection("udp://127.0.0.1:17000"), ConnectionResult::Success);
+
+    auto fut = wait_for_first_system_detected(mavsdk_groundstation);
+    ASSERT_EQ(fut.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+    auto system = fut.get();
+
+    auto fut_groundstation = wait_for_first_system_detected(mavsdk_autopilot);
+    ASSERT_EQ(fut_groundstation.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+    auto groundstation = fut_groundstation.get();
+
+    // Count the setpoints arriving at the autopilot.
+    std::atomic<unsigned> num_setpoints{0};
+    auto passthrough = MavlinkPassthrough{groundstation};
+    passthrough.subscribe_message_sync(
+        MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED,
+        [&num_setpoints](const mavlink_message_t&) { ++num_setpoints; });
+
+    auto offboard = Offboard{system};
+
+    for (unsigned round = 0; round < 20; ++round) {
+        // Two kinds of setpoints, while offboard is being stopped.
+        std::thread setter([&offboard]() {
+            for (unsigned i = 0; i < 10; ++i) {
+                if (i % 2 == 0) {
+                    offboard.set_position_ned(Offboard::PositionNedYaw{});
+                } else {
+                    offboard.set_velocity_ned(Offboard::VelocityNedYaw{});
+                }
+            }
+        });
+        std::thread stopper([&offboard]() {
+            for (unsigned i = 0; i < 10; ++i) {
+                offboard.stop_async(nullptr);
+            }
+        });
+        setter.join();
+        stopper.join();
+
+        if (offboard.is_active()) {
+            continue;
+        }
+
+        // Once stopped, nothing is sent anymore. Setpoints already on their
+        // way get some time to arrive first.
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        const unsigned num_before = num_setpoints;
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        EXPECT_EQ(num_setpoints, num_before) << "in round " << round;
+    }
+
+    passthrough.subscribe_message_sync(MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED, nullptr);
+}